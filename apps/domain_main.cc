@@ -0,0 +1,162 @@
+#include <core/domain_simulator.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using idealgas::DomainChannel;
+using idealgas::DomainSimulator;
+using idealgas::Particle;
+using idealgas::SharedMemoryChannel;
+using idealgas::Simulator;
+
+namespace {
+
+/**
+ * Runs one strip of the simulation and prints what it ends with
+ *
+ * @return  The exit status of the process
+ */
+int RunStrip(const Simulator& initial, size_t num_strips, size_t strip,
+             DomainChannel* left, DomainChannel* right, size_t num_updates) {
+  try {
+    DomainSimulator simulator(initial.GetWidth(), initial.GetHeight(),
+                              num_strips, strip, left, right);
+    for (const Particle& particle : initial.GetParticles()) {
+      simulator.AddParticle(particle);
+    }
+    for (size_t update = 0; update < num_updates; update++) {
+      simulator.Update();
+    }
+
+    double kinetic_energy = 0;
+    for (const Particle& particle : simulator.GetParticles()) {
+      const glm::vec2& velocity = particle.GetVelocity();
+      kinetic_energy +=
+          0.5 * particle.GetMass() * glm::dot(velocity, velocity);
+    }
+    std::cout << "Strip " << strip << " [" << simulator.GetStripLeft() << ", "
+              << simulator.GetStripRight() << "): "
+              << simulator.GetParticles().size()
+              << " particles, kinetic energy " << kinetic_energy << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << "Strip " << strip << ": " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+/**
+ * Runs one simulation divided among processes, each of which owns a strip of
+ * the plane and exchanges particles with its neighbors through shared
+ * memory. Every process prints its particles' count and kinetic energy at
+ * the end, which add up to those of the same run in one process.
+ *
+ * Usage: ideal-gas-domain [processes] [particles of each size] [updates]
+ *                         [plane width]
+ */
+int main(int argc, char** argv) {
+  if (argc > 5) {
+    std::cerr << "Usage: " << argv[0]
+              << " [processes] [particles of each size] [updates]"
+                 " [plane width]"
+              << std::endl;
+    return 1;
+  }
+
+#ifndef _WIN32
+  try {
+    size_t num_strips = argc >= 2 ? std::stoul(argv[1]) : 4;
+    size_t num_particles = argc >= 3 ? std::stoul(argv[2]) : 1000;
+    size_t num_updates = argc >= 4 ? std::stoul(argv[3]) : 1000;
+    double plane_width = argc == 5 ? std::stod(argv[4]) : 400;
+    if (num_strips == 0) {
+      throw std::invalid_argument("there must be at least one process");
+    }
+    const uint32_t kSeed = 1;
+
+    /* Every process is given the same particles, and keeps those in its
+       strip */
+    Simulator initial(plane_width, plane_width, kSeed);
+    for (size_t i = 0; i < num_particles; i++) {
+      initial.AddRandomSmallParticle();
+      initial.AddRandomMediumParticle();
+      initial.AddRandomLargeParticle();
+    }
+
+    /* The channels are made before forking, so that every process has them
+       mapped from the start */
+    std::vector<std::unique_ptr<SharedMemoryChannel>> to_right;
+    std::vector<std::unique_ptr<SharedMemoryChannel>> to_left;
+    for (size_t edge = 0; edge + 1 < num_strips; edge++) {
+      std::string name = "/ideal-gas-domain-" + std::to_string(edge);
+      to_right.emplace_back(
+          new SharedMemoryChannel(SharedMemoryChannel::Create(name)));
+      to_left.emplace_back(
+          new SharedMemoryChannel(SharedMemoryChannel::Open(name)));
+    }
+
+    std::cout << "Simulating " << initial.GetNumParticles()
+              << " particles in " << num_strips << " processes" << std::endl;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    std::vector<pid_t> workers;
+    for (size_t strip = 0; strip < num_strips; strip++) {
+      pid_t pid = fork();
+      if (pid < 0) {
+        throw std::runtime_error("could not start process " +
+                                 std::to_string(strip));
+      }
+      if (pid == 0) {
+        DomainChannel* left = strip > 0 ? to_left[strip - 1].get() : nullptr;
+        DomainChannel* right =
+            strip + 1 < num_strips ? to_right[strip].get() : nullptr;
+        int status =
+            RunStrip(initial, num_strips, strip, left, right, num_updates);
+
+        /* Leave without destroying the parent's channels, which would
+           remove them while the other processes use them */
+        std::cout.flush();
+        _exit(status);
+      }
+      workers.push_back(pid);
+    }
+
+    bool has_failed = false;
+    for (pid_t worker : workers) {
+      int status = 0;
+      waitpid(worker, &status, 0);
+      has_failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    if (has_failed) {
+      throw std::runtime_error("a process failed");
+    }
+
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    std::cout << num_updates << " updates took " << seconds << " s"
+              << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+#else
+  std::cerr << "Domain decomposition is not supported on this platform"
+            << std::endl;
+  return 1;
+#endif
+}
@@ -0,0 +1,76 @@
+#include <visualizer/frame_exporter.h>
+
+#include <chrono>
+#include <iostream>
+
+using idealgas::ExportFormat;
+using idealgas::FrameExporter;
+using idealgas::FrameRasterizer;
+using idealgas::Simulator;
+using idealgas::ThreadPool;
+
+namespace {
+
+bool EndsWith(const std::string& text, const std::string& suffix) {
+  return text.size() >= suffix.size() &&
+         text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+/**
+ * Renders a run of the simulation to a video or images without opening a
+ * window, as fast as the simulation allows.
+ *
+ * Usage: ideal-gas-export <output> [number of frames] [steps per frame]
+ *                         [particles of each size] [frame height]
+ *
+ * An output ending in .y4m is written as one YUV4MPEG2 stream, which can be
+ * compressed with e.g. `ffmpeg -i run.y4m run.mp4`. Any other output is used
+ * as the prefix of a numbered sequence of PNG files.
+ */
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 6) {
+    std::cerr << "Usage: " << argv[0]
+              << " <output> [number of frames] [steps per frame]"
+                 " [particles of each size] [frame height]"
+              << std::endl;
+    return 1;
+  }
+
+  try {
+    std::string output_path = argv[1];
+    size_t num_frames = argc >= 3 ? std::stoul(argv[2]) : 600;
+    size_t steps_per_frame = argc >= 4 ? std::stoul(argv[3]) : 1;
+    size_t num_particles = argc >= 5 ? std::stoul(argv[4]) : 20;
+    size_t height = argc == 6 ? std::stoul(argv[5]) : 1000;
+    const uint32_t kSeed = 1;
+
+    Simulator simulator(kSeed);
+    for (size_t i = 0; i < num_particles; i++) {
+      simulator.AddRandomSmallParticle();
+      simulator.AddRandomMediumParticle();
+      simulator.AddRandomLargeParticle();
+    }
+
+    ExportFormat format = EndsWith(output_path, ".y4m") ? ExportFormat::kY4m
+                                                         : ExportFormat::kPng;
+    FrameRasterizer rasterizer(simulator, height);
+    FrameExporter exporter(rasterizer, format, output_path);
+    ThreadPool pool;
+
+    auto start = std::chrono::steady_clock::now();
+    exporter.Run(simulator, num_frames, steps_per_frame, pool);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::cout << "Exported " << num_frames << " frames in " << elapsed.count()
+              << " s (" << num_frames / elapsed.count() << " frames/s)"
+              << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
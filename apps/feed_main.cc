@@ -0,0 +1,107 @@
+#include <core/frame_feed.h>
+#include <core/metrics_server.h>
+
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+using idealgas::FramePublisher;
+using idealgas::MetricsRecorder;
+using idealgas::MetricsServer;
+using idealgas::Simulator;
+
+namespace {
+
+volatile std::sig_atomic_t is_interrupted = 0;
+
+void Interrupt(int signal) {
+  is_interrupted = 1;
+}
+
+}  // namespace
+
+/**
+ * Runs a simulation without a window and publishes every update to a frame
+ * feed, which any number of ideal-gas-viewer processes can show. Runs until
+ * interrupted, and then closes the feed.
+ *
+ * If a metrics port is given, throughput and observables are also served in
+ * the Prometheus text format at http://localhost:<port>/metrics.
+ *
+ * Usage: ideal-gas-feed [feed name] [particles of each size]
+ *                       [updates per second, 0 for as fast as possible]
+ *                       [metrics port, 0 for none]
+ */
+int main(int argc, char** argv) {
+  if (argc > 5) {
+    std::cerr << "Usage: " << argv[0]
+              << " [feed name] [particles of each size] [updates per second]"
+                 " [metrics port]"
+              << std::endl;
+    return 1;
+  }
+
+  try {
+    std::string name = argc >= 2 ? argv[1] : "/ideal-gas";
+    size_t num_particles = argc >= 3 ? std::stoul(argv[2]) : 100;
+    size_t updates_per_second = argc >= 4 ? std::stoul(argv[3]) : 60;
+    unsigned long metrics_port = argc == 5 ? std::stoul(argv[4]) : 0;
+    if (metrics_port > 65535) {
+      throw std::invalid_argument("the metrics port must be at most 65535");
+    }
+    const uint32_t kSeed = 1;
+
+    Simulator simulator(kSeed);
+    for (size_t i = 0; i < num_particles; i++) {
+      simulator.AddRandomSmallParticle();
+      simulator.AddRandomMediumParticle();
+      simulator.AddRandomLargeParticle();
+    }
+
+    FramePublisher publisher(name, simulator, simulator.GetNumParticles());
+
+    /* Without a port, nothing is recorded or served */
+    std::unique_ptr<MetricsRecorder> recorder;
+    std::unique_ptr<MetricsServer> server;
+    if (metrics_port > 0) {
+      recorder.reset(new MetricsRecorder());
+      recorder->Record(simulator);
+      server.reset(
+          new MetricsServer(*recorder, static_cast<uint16_t>(metrics_port)));
+      std::cout << "Serving metrics at http://localhost:" << server->GetPort()
+                << "/metrics" << std::endl;
+    }
+
+    std::signal(SIGINT, Interrupt);
+    std::signal(SIGTERM, Interrupt);
+    std::cout << "Publishing " << simulator.GetNumParticles()
+              << " particles to " << name << std::endl;
+
+    /* Pace the updates to the requested rate, like the app's frame rate */
+    std::chrono::steady_clock::time_point next_update =
+        std::chrono::steady_clock::now();
+    while (!is_interrupted) {
+      simulator.Update();
+      publisher.Publish(simulator);
+      if (recorder) {
+        recorder->Record(simulator);
+      }
+
+      if (updates_per_second > 0) {
+        next_update += std::chrono::microseconds(1000000 / updates_per_second);
+        std::this_thread::sleep_until(next_update);
+      }
+    }
+
+    std::cout << "Published " << publisher.GetNumFrames() << " frames"
+              << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
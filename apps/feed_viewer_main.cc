@@ -0,0 +1,14 @@
+#include "visualizer/feed_viewer_app.h"
+
+using idealgas::FeedViewerApp;
+
+/**
+ * Shows a simulation published by ideal-gas-feed.
+ *
+ * Usage: ideal-gas-viewer [feed name]
+ */
+void prepareSettings(FeedViewerApp::Settings* settings) {
+  settings->setResizable(false);
+}
+
+CINDER_APP(FeedViewerApp, ci::app::RendererGl, prepareSettings);
@@ -0,0 +1,40 @@
+#include <core/precision_benchmark.h>
+
+#include <iostream>
+
+using idealgas::DriftReport;
+using idealgas::MeasureDrift;
+using idealgas::PreciseSimulator;
+using idealgas::Simulator;
+
+/**
+ * Simulates the same gas in single and double precision and reports how fast
+ * each runs and how far each drifts from conserving energy and momentum.
+ *
+ * Usage: ideal-gas-precision [particles of each size] [number of steps]
+ */
+int main(int argc, char** argv) {
+  if (argc > 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " [particles of each size] [number of steps]" << std::endl;
+    return 1;
+  }
+
+  try {
+    size_t num_particles = argc >= 2 ? std::stoul(argv[1]) : 100;
+    size_t num_steps = argc == 3 ? std::stoul(argv[2]) : 10000;
+    const uint32_t kSeed = 1;
+
+    std::vector<DriftReport> reports;
+    reports.push_back(
+        MeasureDrift<Simulator>("float", num_particles, num_steps, kSeed));
+    reports.push_back(MeasureDrift<PreciseSimulator>("double", num_particles,
+                                                     num_steps, kSeed));
+    idealgas::WriteDriftReports(reports, std::cout);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,42 @@
+#include <core/sweep.h>
+
+#include <iostream>
+
+using idealgas::SweepConfig;
+using idealgas::SweepDriver;
+using idealgas::ThreadPool;
+
+/**
+ * Runs a parameter sweep without the visualizer.
+ *
+ * Usage: ideal-gas-sweep <config file> <output csv> [number of threads]
+ *
+ * Re-running with the same output file only runs the jobs missing from it.
+ */
+int main(int argc, char** argv) {
+  if (argc < 3 || argc > 4) {
+    std::cerr << "Usage: " << argv[0]
+              << " <config file> <output csv> [number of threads]"
+              << std::endl;
+    return 1;
+  }
+
+  try {
+    SweepConfig config = SweepConfig::Load(argv[1]);
+    SweepDriver driver(config, argv[2]);
+
+    size_t num_threads = argc == 4 ? std::stoul(argv[3])
+                                   : std::thread::hardware_concurrency();
+    ThreadPool pool(num_threads);
+
+    size_t num_jobs = config.ExpandJobs().size();
+    size_t num_run = driver.Run(pool);
+    std::cout << "Ran " << num_run << " of " << num_jobs << " jobs ("
+              << num_jobs - num_run << " already completed)" << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,1530 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "cinder/Rand.h"
+#include "cinder/gl/gl.h"
+#include "core/boundary.h"
+#include "core/collision_log.h"
+#include "core/compensated_sum.h"
+#include "core/elastic_collision.h"
+#include "core/flow_boundary.h"
+#include "core/force_field.h"
+#include "core/morton_order.h"
+#include "core/obstacle_set.h"
+#include "core/particle.h"
+#include "core/particle_store.h"
+#include "core/spatial_grid.h"
+
+namespace idealgas {
+
+/**
+ * A control object used to simulate the interaction between particles.
+ *
+ * The simulation is run on a rectangular coordinate plane, 100x100 unless
+ * specified otherwise, with (0,0) at the lower left corner of the plane and
+ * increasing x and y from left to right and bottom to top, respectively. A 3D
+ * simulation is run in a box, 100x100x100 unless specified otherwise, which
+ * extends the plane along a z axis.
+ *
+ * The physics are chosen at compile time, so that each variant's update
+ * loops are specialized for it instead of branching on options per particle:
+ *
+ * @tparam Dim         The number of dimensions, 2 or 3. Every loop over the
+ *                     components of a vector has a fixed length, so 2D
+ *                     simulations do not pay for a third component.
+ * @tparam Boundary    How particles interact with the edges of the plane, see
+ *                     core/boundary.h
+ * @tparam Force       The external force on the particles, see
+ *                     core/force_field.h
+ * @tparam Scalar      The precision velocities are stored and collisions are
+ *                     computed in, float or double. Positions are stored in
+ *                     double precision either way, and the energy and
+ *                     momentum of the gas are always summed in compensated
+ *                     double precision, so that measuring a float run does
+ *                     not add error of its own.
+ *
+ * Simulator, in core/simulator.h, is the variant used by the app, and
+ * Simulator3d is its 3D counterpart.
+ */
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+class BasicSimulator {
+ public:
+  /** The particles simulated, and the vector types of their members */
+  typedef BasicParticle<Dim, Scalar> ParticleType;
+  typedef typename ParticleType::Vector Vector;
+  typedef typename ParticleType::PreciseVector PreciseVector;
+
+  /** Default constructor, seeds the random particle generator randomly */
+  BasicSimulator();
+
+  /**
+   * Creates a simulator whose random particles are generated from the
+   * specified seed, so that runs can be reproduced. Every simulator owns its
+   * own generator, so separate instances can be used from separate threads.
+   */
+  explicit BasicSimulator(uint32_t seed);
+
+  /**
+   * Creates a simulator on a plane of the specified size. The sizes of the
+   * particles do not depend on the size of the plane, so larger planes hold
+   * more particles at the same density.
+   *
+   * @param size          The size of the plane along each axis
+   * @param seed          The seed used to generate random particles
+   * @param boundary      The boundary policy, for policies with settings
+   * @param force_field   The force policy, for policies with settings
+   */
+  BasicSimulator(const PreciseVector& size, uint32_t seed,
+                 const Boundary& boundary = Boundary(),
+                 const Force& force_field = Force());
+
+  /**
+   * Creates a simulator on a plane of the specified width and height. In 3D
+   * the box is as deep as it is wide.
+   */
+  BasicSimulator(double plane_width, double plane_height, uint32_t seed,
+                 const Boundary& boundary = Boundary(),
+                 const Force& force_field = Force());
+
+  /** Updates the current state of the particles' positions and velocities */
+  void Update();
+
+  /** Resets the simulation to zero particles */
+  void Reset();
+
+  /**
+   * Adds the specified particle to the simulation.
+   *
+   * @return  The handle of the particle, which identifies it for as long as
+   *          it is in the simulation even if the particles are reordered
+   */
+  ParticleHandle AddParticle(const ParticleType& particle);
+
+  /**
+   * Reserves memory for the specified total number of particles, so that
+   * adding many particles at once does not repeatedly grow the storage
+   */
+  void ReserveParticles(size_t num_particles);
+
+  /**
+   * Removes the particle with the specified handle in O(1) time. The last
+   * stored particle takes its place in GetParticles().
+   *
+   * @return  False if the handle does not refer to a particle
+   */
+  bool RemoveParticle(const ParticleHandle& handle);
+
+  /**
+   * Queue particles to be inserted or removed in one batch before the next
+   * update, e.g. from within a loop over GetParticles(). The queues keep
+   * their memory between batches, so a steady flow of particles in and out
+   * does not allocate every step.
+   */
+  void QueueParticleInsertion(const ParticleType& particle);
+  void QueueParticleRemoval(const ParticleHandle& handle);
+
+  /**
+   * Applies the queued removals followed by the queued insertions. Called at
+   * the start of every update.
+   */
+  void ApplyQueuedChanges();
+
+  /** The boundary and force policies used by the simulation */
+  Boundary& GetBoundary();
+  const Boundary& GetBoundary() const;
+  Force& GetForceField();
+  const Force& GetForceField() const;
+
+  /**
+   * The boundary mode used by the simulation, walls by default. Only
+   * available with SelectableBoundary.
+   */
+  void SetBoundaryMode(BoundaryMode mode);
+  BoundaryMode GetBoundaryMode() const;
+
+  /**
+   * Turns a segment of a wall into a source or a sink of particles, so that
+   * the simulation can model a steady flow through the plane. Sources and
+   * sinks only apply while the boundary has walls.
+   *
+   * Particles are emitted and absorbed in one batch per update, and the
+   * memory of absorbed particles is reused by emitted ones, so a steady flow
+   * does not allocate.
+   */
+  void AddSource(const ParticleSource& source);
+  void AddSink(const ParticleSink& sink);
+
+  /** Removes every source and sink */
+  void ClearFlowBoundaries();
+
+  /**
+   * Places static obstacles on the plane, which particles bounce off of with
+   * any boundary. The obstacles' hierarchy is built once here.
+   */
+  void SetObstacles(const ObstacleSet& obstacles);
+  const ObstacleSet& GetObstacles() const;
+
+  /**
+   * Methods to add a particle with specified size and random position/velocity
+   * to the simulation
+   */
+  /** Mass 1, radius 1 */
+  void AddRandomSmallParticle();
+  /** Mass 2, radius 1.25 */
+  void AddRandomMediumParticle();
+  /** Mass 4, radius 1.5 */
+  void AddRandomLargeParticle();
+
+  /**
+   * Returns the particles in the order they are stored in, which is the order
+   * they were added in unless reordering is enabled. The view is invalidated
+   * by the next change to the simulation.
+   */
+  ChunkedView<ParticleType> GetParticles() const;
+  size_t GetNumParticles() const;
+
+  /** Returns the handle of the particle stored at the specified index */
+  ParticleHandle GetParticleHandle(size_t index) const;
+
+  /**
+   * Returns the particle with the specified handle.
+   *
+   * @throws std::out_of_range if the handle does not refer to a particle
+   */
+  const ParticleType& GetParticle(const ParticleHandle& handle) const;
+
+  /** Returns true if the handle refers to a particle in the simulation */
+  bool ContainsParticle(const ParticleHandle& handle) const;
+
+  /**
+   * Sets how often the particles are reordered in memory along a Morton
+   * curve, so that particles which are close on the plane are also close in
+   * memory. Reordering keeps the collision pass cache friendly as the gas
+   * mixes, but changes the order of GetParticles().
+   *
+   * @param num_steps  The number of updates between reorders, or 0 to never
+   *                   reorder, which is the default
+   */
+  void SetReorderInterval(size_t num_steps);
+
+  /**
+   * Rearranges the particles into the order of the specified handles, for
+   * callers which need the particles updated in an order of their own.
+   * Handles keep referring to the same particles.
+   *
+   * @param handles  The handle of every particle, each once
+   * @throws std::invalid_argument if there are not as many handles as
+   *         particles, or a handle is given more than once
+   * @throws std::out_of_range if a handle does not refer to a particle
+   */
+  void SetParticleOrder(const std::vector<ParticleHandle>& handles);
+
+  /**
+   * Sets the volume, or area in 2D, which the particles are spread over, for
+   * simulations which only use part of the plane. The grid of the collision
+   * pass has about one cell per particle in this volume, so that its cells
+   * are not made coarser by the empty part of the plane. The results do not
+   * depend on it.
+   *
+   * @param volume  The occupied volume, or 0 for the whole plane, which is
+   *                the default
+   * @throws std::invalid_argument if the volume is negative
+   */
+  void SetOccupiedVolume(double volume);
+
+  /**
+   * Enables block time steps, for mixtures of particles with very different
+   * speeds. Each particle has a level L and is moved every 2^L steps by 2^L
+   * times its velocity, so slow particles are updated less often than fast
+   * ones instead of every particle taking the step of the fastest.
+   *
+   * A particle's level is chosen at the start of each of its blocks as the
+   * highest at which it moves at most max_displacement per update, and a
+   * particle which collides drops to level 0, so particles in busy regions
+   * are updated every step. Walls and obstacles are checked when a particle
+   * is updated, and pairs whenever either particle is, against where the
+   * other particle is at that step.
+   *
+   * @param max_level         The highest level, or 0 to update every particle
+   *                          every step, which is the default
+   * @param max_displacement  The furthest a particle above level 0 moves in
+   *                          one update
+   * @throws std::invalid_argument if max_level is not between 0 and
+   *         kMaxTimeStepLevel, or max_displacement is not positive
+   */
+  void SetBlockTimeSteps(int max_level, double max_displacement);
+  int GetMaxTimeStepLevel() const;
+  static constexpr int kMaxTimeStepLevel = 16;
+
+  /**
+   * Appends every collision with a wall, an obstacle, or another particle to
+   * a channel of a collision log, which must only be used by the thread
+   * updating this simulation. Logging is off by default.
+   *
+   * @param channel  The channel appended to, or null to stop logging
+   * @param source   The source the events are tagged with
+   */
+  void SetCollisionLog(CollisionLogChannel* channel, uint32_t source = 0);
+
+  /**
+   * Returns the position of the particle at the current step. With block
+   * time steps, GetParticles() holds the position of each particle at its
+   * last update, which may be behind.
+   */
+  PreciseVector GetCurrentPosition(const ParticleType& particle) const;
+
+  /**
+   * Returns the number of times a particle has been moved, which block time
+   * steps reduce
+   */
+  size_t GetNumParticleUpdates() const;
+
+  /**
+   * Returns the number of updates run and the number of collisions between
+   * pairs of particles resolved by them, for monitoring long runs
+   */
+  size_t GetNumSteps() const;
+  size_t GetNumCollisions() const;
+
+  /**
+   * Everything about a simulation which changes as it runs, from which it
+   * can be continued exactly. Settings, such as the boundary, obstacles,
+   * sources, and sinks, are not part of it.
+   */
+  struct Checkpoint {
+    std::vector<ParticleType> particles;
+    ci::Rand rand;
+    std::vector<double> source_backlogs;
+    size_t num_steps;
+    size_t num_steps_since_reorder;
+    size_t num_particle_updates;
+    size_t num_collisions;
+  };
+
+  /**
+   * Saves the state of the simulation, or restores it to a saved state. A
+   * restored simulation updates exactly as the saved one did, as long as its
+   * settings are the same. Handles given out before a restore are
+   * invalidated.
+   *
+   * @throws std::invalid_argument on restoring a checkpoint saved with a
+   *         different number of sources, which is left unrestored
+   */
+  Checkpoint SaveCheckpoint() const;
+  void RestoreCheckpoint(const Checkpoint& checkpoint);
+
+  /**
+   * Returns a copy of the simulation, with the same settings and state, which
+   * shares the memory of its particles with this one until either changes
+   * them, e.g. to explore what-if variations of one state. Forks may be
+   * updated on separate threads, concurrently with each other and this
+   * simulation, and do not inherit its collision log.
+   *
+   * Reading a fork's particles copies nothing. Changing them copies only the
+   * chunks of particles written to, see BasicParticleStore::Share(), so an
+   * update copies the chunks of the particles it moves or bounces.
+   */
+  BasicSimulator Fork();
+
+  /** Returns the bytes of particle memory not shared with any fork */
+  size_t GetUnsharedMemoryUsage() const;
+
+  /** The dimensions of the coordinate plane used for the simulation */
+  double GetWidth() const;
+  double GetHeight() const;
+  const PreciseVector& GetSize() const;
+  static constexpr double kDefaultPlaneWidth = 100;
+
+  /** Returns a vector of the speeds of particles filtered by size, used for
+   *  histogram computation */
+  std::vector<double> GetSmallParticleSpeeds() const;
+  std::vector<double> GetMediumParticleSpeeds() const;
+  std::vector<double> GetLargeParticleSpeeds() const;
+
+  /**
+   * The same speeds, written over the contents of the specified vector. Its
+   * memory is reused, so that drawing histograms every frame does not
+   * allocate once the vector has grown to fit.
+   */
+  void GetSmallParticleSpeeds(std::vector<double>& speeds) const;
+  void GetMediumParticleSpeeds(std::vector<double>& speeds) const;
+  void GetLargeParticleSpeeds(std::vector<double>& speeds) const;
+
+  /**
+   * Returns the species of the specified particle, by its radius and mass as
+   * the histograms and the collision log sort particles. Particles of any
+   * other radius or mass are of CollisionSpecies::kOther, whatever color.
+   */
+  CollisionSpecies GetSpecies(const ParticleType& p) const;
+
+  /** Returns the total kinetic energy of all of the particles */
+  double GetKineticEnergy() const;
+
+  /** Returns the total momentum of all of the particles */
+  PreciseVector GetMomentum() const;
+
+  /** Measurements for the small, medium, and large particles */
+  static constexpr double kSmallMass = 1;
+  static constexpr double kSmallRadius = 1;
+  const ci::Color kSmallColor = ci::Color("red");
+  static constexpr double kMediumMass = 2;
+  static constexpr double kMediumRadius = 1.25;
+  const ci::Color kMediumColor = ci::Color("blue");
+  static constexpr double kLargeMass = 4;
+  static constexpr double kLargeRadius = 1.5;
+  const ci::Color kLargeColor = ci::Color("green");
+
+ private:
+  /** The size of the plane along each axis */
+  PreciseVector size_;
+  Boundary boundary_;
+  Force force_field_;
+  BasicParticleStore<ParticleType> store_;
+  ci::Rand rand_;
+
+  std::vector<ParticleType> queued_insertions_;
+  std::vector<ParticleHandle> queued_removals_;
+
+  ObstacleSet obstacles_;
+  std::vector<ParticleSource> sources_;
+  std::vector<ParticleSink> sinks_;
+
+  /**
+   * The fractional number of particles each source is due to emit, carried
+   * over to the next update
+   */
+  std::vector<double> source_backlogs_;
+
+  size_t reorder_interval_;
+  size_t num_steps_since_reorder_;
+  MortonOrder morton_order_;
+  std::vector<size_t> particle_order_;
+  double occupied_volume_;
+
+  int max_time_step_level_;
+  double max_block_displacement_;
+  size_t num_steps_;
+  size_t num_particle_updates_;
+  size_t num_collisions_;
+
+  CollisionLogChannel* collision_log_;
+  uint32_t collision_source_;
+
+  /** Used to find the pairs of particles which may be in contact */
+  BasicSpatialGrid<ParticleType> grid_;
+  std::vector<size_t> neighbors_;
+  std::vector<bool> is_due_;
+
+  /** Returns the size of a plane of the specified width and height */
+  static PreciseVector MakeSize(double width, double height);
+
+  /**
+   * Returns a random position on the plane at which a particle of the
+   * specified radius does not overlap any wall
+   */
+  PreciseVector GenerateRandomPosition(double radius);
+
+  /**
+   * Returns a random velocity whose components are between 0 and the
+   * specified maximum
+   */
+  Vector GenerateRandomVelocity(double max_component);
+
+  /**
+   * Returns true if the particle is updated in the current step, i.e. the
+   * step is at the start of one of its blocks
+   */
+  bool IsDue(const ParticleType& particle) const;
+
+  /** Helper methods used during updating the state of the simulation */
+  void ReorderParticles();
+  void AssignTimeStepLevels();
+  void UpdateWallCollisions();
+  void UpdateObstacleCollisions();
+  void EmitParticles();
+  void UpdateParticleCollisions();
+  void UpdatePositions();
+
+  /**
+   * Returns true if the particle is in contact with the specified wall and
+   * moving towards it
+   */
+  bool IsAgainstWall(const ParticleType& particle, Wall wall) const;
+
+  /** Returns true if the particle is hitting one of the sinks */
+  bool IsInSink(const ParticleType& particle) const;
+
+  bool IsCollision(const ParticleType& particle1,
+                   const ParticleType& particle2) const;
+
+  /**
+   * Returns the position of p1 relative to p2. On a periodic plane this is the
+   * shortest displacement between p1 and any periodic image of p2.
+   */
+  PreciseVector GetDisplacement(const ParticleType& p1,
+                                const ParticleType& p2) const;
+
+  /**
+   * Computes the post-collision of two particles that are assumed to be in
+   * contact with each other.
+   *
+   * @param p1  The first particle specified
+   * @param p2  The second particle specified
+   * @return    A std::pair of the post-collision velocities.
+   *            The first element in the pair is the post-collision velocity of
+   *            particle1.
+   *            The second element in the pair is the post-collision velocity
+   *            of particle2.
+   */
+  std::pair<Vector, Vector> ComputePostCollisionVelocities(
+      const ParticleType& p1, const ParticleType& p2) const;
+
+  /** Returns true if the specified particle is of a certain size, false
+   * otherwise */
+  bool IsSmall(const ParticleType& p) const;
+  bool IsMedium(const ParticleType& p) const;
+  bool IsLarge(const ParticleType& p) const;
+
+  /**
+   * Appends a collision of the particle at index1 to the collision log.
+   *
+   * @param index2             The index of the other particle, only used for
+   *                           collisions between pairs
+   * @param relative_velocity  The velocity of the first particle relative to
+   *                           what it hit, before the collision
+   * @param velocity_change    The change in the first particle's velocity
+   */
+  void LogCollision(CollisionKind kind, size_t index1, size_t index2,
+                    const Vector& relative_velocity,
+                    const Vector& velocity_change);
+};
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+constexpr double
+    BasicSimulator<Dim, Boundary, Force, Scalar>::kDefaultPlaneWidth;
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+constexpr int BasicSimulator<Dim, Boundary, Force, Scalar>::kMaxTimeStepLevel;
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+constexpr double BasicSimulator<Dim, Boundary, Force, Scalar>::kSmallMass;
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+constexpr double BasicSimulator<Dim, Boundary, Force, Scalar>::kSmallRadius;
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+constexpr double BasicSimulator<Dim, Boundary, Force, Scalar>::kMediumMass;
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+constexpr double BasicSimulator<Dim, Boundary, Force, Scalar>::kMediumRadius;
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+constexpr double BasicSimulator<Dim, Boundary, Force, Scalar>::kLargeMass;
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+constexpr double BasicSimulator<Dim, Boundary, Force, Scalar>::kLargeRadius;
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+BasicSimulator<Dim, Boundary, Force, Scalar>::BasicSimulator()
+    : BasicSimulator(std::random_device()()) {
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+BasicSimulator<Dim, Boundary, Force, Scalar>::BasicSimulator(uint32_t seed)
+    : BasicSimulator(PreciseVector(kDefaultPlaneWidth), seed) {
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+BasicSimulator<Dim, Boundary, Force, Scalar>::BasicSimulator(
+    double plane_width, double plane_height, uint32_t seed,
+    const Boundary& boundary, const Force& force_field)
+    : BasicSimulator(MakeSize(plane_width, plane_height), seed, boundary,
+                     force_field) {
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+BasicSimulator<Dim, Boundary, Force, Scalar>::BasicSimulator(
+    const PreciseVector& size, uint32_t seed, const Boundary& boundary,
+    const Force& force_field)
+    : size_(size),
+      boundary_(boundary),
+      force_field_(force_field),
+      rand_(seed),
+      reorder_interval_(0),
+      num_steps_since_reorder_(0),
+      occupied_volume_(0),
+      max_time_step_level_(0),
+      max_block_displacement_(0),
+      num_steps_(0),
+      num_particle_updates_(0),
+      num_collisions_(0),
+      collision_log_(nullptr),
+      collision_source_(0) {
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::Update() {
+  ApplyQueuedChanges();
+  if (max_time_step_level_ > 0) {
+    AssignTimeStepLevels();
+  }
+
+  if (boundary_.HasWalls()) {
+    UpdateWallCollisions();
+    EmitParticles();
+
+    /* Absorbed and emitted particles are swapped in before pairs are
+       checked, so that absorbed particles no longer collide */
+    ApplyQueuedChanges();
+  }
+  if (!obstacles_.IsEmpty()) {
+    UpdateObstacleCollisions();
+  }
+  UpdateParticleCollisions();
+  UpdatePositions();
+
+  if (reorder_interval_ > 0 &&
+      ++num_steps_since_reorder_ >= reorder_interval_) {
+    ReorderParticles();
+    num_steps_since_reorder_ = 0;
+  }
+  num_steps_++;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::Reset() {
+  store_.Clear();
+  queued_insertions_.clear();
+  queued_removals_.clear();
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+ParticleHandle BasicSimulator<Dim, Boundary, Force, Scalar>::AddParticle(
+    const ParticleType& particle) {
+  return store_.Insert(particle);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::ReserveParticles(
+    size_t num_particles) {
+  store_.Reserve(num_particles);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+bool BasicSimulator<Dim, Boundary, Force, Scalar>::RemoveParticle(
+    const ParticleHandle& handle) {
+  return store_.Remove(handle);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::QueueParticleInsertion(
+    const ParticleType& particle) {
+  queued_insertions_.push_back(particle);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::QueueParticleRemoval(
+    const ParticleHandle& handle) {
+  queued_removals_.push_back(handle);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::ApplyQueuedChanges() {
+  /* Removals go first so that their slots and memory are reused by the
+     insertions. Handles queued twice are stale by their second removal. */
+  for (const ParticleHandle& handle : queued_removals_) {
+    store_.Remove(handle);
+  }
+
+  /* The storage grows geometrically, so a flow which emits more particles
+     than it absorbs does not reallocate the store every update */
+  for (const ParticleType& particle : queued_insertions_) {
+    store_.Insert(particle);
+  }
+
+  /* Clearing keeps the queues' memory for the next batch */
+  queued_removals_.clear();
+  queued_insertions_.clear();
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+Boundary& BasicSimulator<Dim, Boundary, Force, Scalar>::GetBoundary() {
+  return boundary_;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+const Boundary& BasicSimulator<Dim, Boundary, Force, Scalar>::GetBoundary()
+    const {
+  return boundary_;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+Force& BasicSimulator<Dim, Boundary, Force, Scalar>::GetForceField() {
+  return force_field_;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+const Force& BasicSimulator<Dim, Boundary, Force, Scalar>::GetForceField()
+    const {
+  return force_field_;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::SetBoundaryMode(
+    BoundaryMode mode) {
+  boundary_.SetMode(mode);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+BoundaryMode BasicSimulator<Dim, Boundary, Force, Scalar>::GetBoundaryMode()
+    const {
+  return boundary_.GetMode();
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::AddSource(
+    const ParticleSource& source) {
+  sources_.push_back(source);
+  source_backlogs_.push_back(0);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::AddSink(
+    const ParticleSink& sink) {
+  sinks_.push_back(sink);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::ClearFlowBoundaries() {
+  sources_.clear();
+  sinks_.clear();
+  source_backlogs_.clear();
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::SetObstacles(
+    const ObstacleSet& obstacles) {
+  obstacles_ = obstacles;
+  obstacles_.Build();
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+const ObstacleSet& BasicSimulator<Dim, Boundary, Force, Scalar>::GetObstacles()
+    const {
+  return obstacles_;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::AddRandomSmallParticle() {
+  /* Position calculated at random anywhere on the coordinate plane accounting
+     for radius size */
+  PreciseVector pos = GenerateRandomPosition(kSmallRadius);
+
+  /* Velocity calculated at random but maximum scaled down based on radius */
+  Vector vel = GenerateRandomVelocity(kSmallRadius * 0.5);
+
+  AddParticle(ParticleType(kSmallRadius, kSmallMass, pos, vel, kSmallColor));
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::AddRandomMediumParticle() {
+  PreciseVector pos = GenerateRandomPosition(kMediumRadius);
+  Vector vel = GenerateRandomVelocity(kMediumRadius * 0.375);
+
+  AddParticle(ParticleType(kMediumRadius, kMediumMass, pos, vel, kMediumColor));
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::AddRandomLargeParticle() {
+  PreciseVector pos = GenerateRandomPosition(kLargeRadius);
+  Vector vel = GenerateRandomVelocity(kLargeRadius * 0.25);
+
+  AddParticle(ParticleType(kLargeRadius, kLargeMass, pos, vel, kLargeColor));
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+typename BasicSimulator<Dim, Boundary, Force, Scalar>::PreciseVector
+BasicSimulator<Dim, Boundary, Force, Scalar>::GenerateRandomPosition(
+    double radius) {
+  /* Scale a unit random number in double precision, since the plane may be
+     too large for a float to hold positions accurately */
+  PreciseVector position;
+  for (int axis = 0; axis < Dim; axis++) {
+    position[axis] = radius + rand_.nextFloat() * (size_[axis] - 2 * radius);
+  }
+  return position;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+typename BasicSimulator<Dim, Boundary, Force, Scalar>::Vector
+BasicSimulator<Dim, Boundary, Force, Scalar>::GenerateRandomVelocity(
+    double max_component) {
+  Vector velocity;
+  for (int axis = 0; axis < Dim; axis++) {
+    velocity[axis] = rand_.nextFloat(max_component);
+  }
+  return velocity;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+ChunkedView<BasicParticle<Dim, Scalar>>
+BasicSimulator<Dim, Boundary, Force, Scalar>::GetParticles() const {
+  return store_.GetParticles();
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+size_t BasicSimulator<Dim, Boundary, Force, Scalar>::GetNumParticles() const {
+  return store_.Size();
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+ParticleHandle BasicSimulator<Dim, Boundary, Force, Scalar>::GetParticleHandle(
+    size_t index) const {
+  return store_.GetHandle(index);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+const BasicParticle<Dim, Scalar>&
+BasicSimulator<Dim, Boundary, Force, Scalar>::GetParticle(
+    const ParticleHandle& handle) const {
+  return store_.Get(handle);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+bool BasicSimulator<Dim, Boundary, Force, Scalar>::ContainsParticle(
+    const ParticleHandle& handle) const {
+  return store_.Contains(handle);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::SetReorderInterval(
+    size_t num_steps) {
+  reorder_interval_ = num_steps;
+  num_steps_since_reorder_ = 0;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::SetParticleOrder(
+    const std::vector<ParticleHandle>& handles) {
+  if (handles.size() != store_.Size()) {
+    throw std::invalid_argument("every particle must be given an order");
+  }
+
+  /* Mark the index of each handle's particle first, so that a handle given
+     twice is caught before any particle is moved */
+  const size_t kUnmarked = std::numeric_limits<size_t>::max();
+  particle_order_.assign(handles.size(), kUnmarked);
+  for (size_t i = 0; i < handles.size(); i++) {
+    size_t index = store_.GetIndex(handles[i]);
+    if (particle_order_[index] != kUnmarked) {
+      throw std::invalid_argument("a particle cannot be given two orders");
+    }
+    particle_order_[index] = i;
+  }
+
+  /* Particles which are already in order are not copied */
+  bool is_in_order = true;
+  for (size_t i = 0; i < handles.size(); i++) {
+    particle_order_[i] = store_.GetIndex(handles[i]);
+    is_in_order = is_in_order && particle_order_[i] == i;
+  }
+  if (!is_in_order) {
+    store_.Permute(particle_order_);
+  }
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::SetOccupiedVolume(
+    double volume) {
+  if (volume < 0) {
+    throw std::invalid_argument("the occupied volume cannot be negative");
+  }
+  occupied_volume_ = volume;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::SetBlockTimeSteps(
+    int max_level, double max_displacement) {
+  if (max_level < 0 || max_level > kMaxTimeStepLevel) {
+    throw std::invalid_argument("time step level must be between 0 and " +
+                                std::to_string(kMaxTimeStepLevel));
+  }
+  if (max_level > 0 && max_displacement <= 0) {
+    throw std::invalid_argument("block displacement must be positive");
+  }
+
+  /* Lowering the highest level would leave particles mid-block, so bring
+     every particle up to date and restart them at level 0 */
+  ChunkedView<ParticleType> particles = store_.GetParticles();
+  for (size_t i = 0; i < particles.size(); i++) {
+    if (particles[i].GetTimeStepLevel() == 0) {
+      continue;
+    }
+    ParticleType& particle = store_.GetMutable(i);
+    particle.SetPosition(GetCurrentPosition(particle));
+    particle.SetTimeStepLevel(0);
+  }
+  max_time_step_level_ = max_level;
+  max_block_displacement_ = max_displacement;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+int BasicSimulator<Dim, Boundary, Force, Scalar>::GetMaxTimeStepLevel() const {
+  return max_time_step_level_;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::SetCollisionLog(
+    CollisionLogChannel* channel, uint32_t source) {
+  collision_log_ = channel;
+  collision_source_ = source;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+typename BasicSimulator<Dim, Boundary, Force, Scalar>::PreciseVector
+BasicSimulator<Dim, Boundary, Force, Scalar>::GetCurrentPosition(
+    const ParticleType& particle) const {
+  if (IsDue(particle)) {
+    return particle.GetPrecisePosition();
+  }
+
+  /* The particle was last moved at the start of its current block, the
+     latest multiple of 2^level steps */
+  size_t block_length = size_t(1) << particle.GetTimeStepLevel();
+  double elapsed = static_cast<double>(num_steps_ & (block_length - 1));
+  PreciseVector position = particle.GetPrecisePosition() +
+                           PreciseVector(particle.GetVelocity()) * elapsed;
+  boundary_.Wrap(position, size_);
+  return position;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+size_t BasicSimulator<Dim, Boundary, Force, Scalar>::GetNumParticleUpdates()
+    const {
+  return num_particle_updates_;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+size_t BasicSimulator<Dim, Boundary, Force, Scalar>::GetNumSteps() const {
+  return num_steps_;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+size_t BasicSimulator<Dim, Boundary, Force, Scalar>::GetNumCollisions()
+    const {
+  return num_collisions_;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+typename BasicSimulator<Dim, Boundary, Force, Scalar>::Checkpoint
+BasicSimulator<Dim, Boundary, Force, Scalar>::SaveCheckpoint() const {
+  Checkpoint checkpoint;
+  checkpoint.particles = store_.GetParticles();
+  checkpoint.rand = rand_;
+  checkpoint.source_backlogs = source_backlogs_;
+  checkpoint.num_steps = num_steps_;
+  checkpoint.num_steps_since_reorder = num_steps_since_reorder_;
+  checkpoint.num_particle_updates = num_particle_updates_;
+  checkpoint.num_collisions = num_collisions_;
+  return checkpoint;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::RestoreCheckpoint(
+    const Checkpoint& checkpoint) {
+  /* The backlogs are what the sources emit next, so a checkpoint of a
+     simulation with other sources cannot be continued exactly */
+  if (checkpoint.source_backlogs.size() != source_backlogs_.size()) {
+    throw std::invalid_argument(
+        "the checkpoint was saved with " +
+        std::to_string(checkpoint.source_backlogs.size()) +
+        " sources, not " + std::to_string(source_backlogs_.size()));
+  }
+
+  /* Only the order of the particles affects how they update, so the slots
+     their handles had need not be restored */
+  Reset();
+  store_.Reserve(checkpoint.particles.size());
+  for (const ParticleType& particle : checkpoint.particles) {
+    store_.Insert(particle);
+  }
+  rand_ = checkpoint.rand;
+  source_backlogs_ = checkpoint.source_backlogs;
+  num_steps_ = checkpoint.num_steps;
+  num_steps_since_reorder_ = checkpoint.num_steps_since_reorder;
+  num_particle_updates_ = checkpoint.num_particle_updates;
+  num_collisions_ = checkpoint.num_collisions;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+BasicSimulator<Dim, Boundary, Force, Scalar>
+BasicSimulator<Dim, Boundary, Force, Scalar>::Fork() {
+  /* The grid and other buffers reused between updates are left for the fork
+     to grow, as they would otherwise be copied whole */
+  store_.Share();
+  BasicSimulator fork(size_, 0, boundary_, force_field_);
+  fork.store_ = store_;
+  fork.rand_ = rand_;
+  fork.queued_insertions_ = queued_insertions_;
+  fork.queued_removals_ = queued_removals_;
+  fork.obstacles_ = obstacles_;
+  fork.sources_ = sources_;
+  fork.sinks_ = sinks_;
+  fork.source_backlogs_ = source_backlogs_;
+  fork.reorder_interval_ = reorder_interval_;
+  fork.num_steps_since_reorder_ = num_steps_since_reorder_;
+  fork.occupied_volume_ = occupied_volume_;
+  fork.max_time_step_level_ = max_time_step_level_;
+  fork.max_block_displacement_ = max_block_displacement_;
+  fork.num_steps_ = num_steps_;
+  fork.num_particle_updates_ = num_particle_updates_;
+  fork.num_collisions_ = num_collisions_;
+  return fork;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+size_t BasicSimulator<Dim, Boundary, Force, Scalar>::GetUnsharedMemoryUsage()
+    const {
+  return store_.GetUnsharedMemoryUsage();
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+double BasicSimulator<Dim, Boundary, Force, Scalar>::GetWidth() const {
+  return size_.x;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+double BasicSimulator<Dim, Boundary, Force, Scalar>::GetHeight() const {
+  return size_.y;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+const typename BasicSimulator<Dim, Boundary, Force, Scalar>::PreciseVector&
+BasicSimulator<Dim, Boundary, Force, Scalar>::GetSize() const {
+  return size_;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+typename BasicSimulator<Dim, Boundary, Force, Scalar>::PreciseVector
+BasicSimulator<Dim, Boundary, Force, Scalar>::MakeSize(double width,
+                                                       double height) {
+  PreciseVector size(width);
+  size.y = height;
+  return size;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+bool BasicSimulator<Dim, Boundary, Force, Scalar>::IsDue(
+    const ParticleType& particle) const {
+  size_t block_length = size_t(1) << particle.GetTimeStepLevel();
+  return (num_steps_ & (block_length - 1)) == 0;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::AssignTimeStepLevels() {
+  ChunkedView<ParticleType> particles = store_.GetParticles();
+  for (size_t i = 0; i < particles.size(); i++) {
+    const ParticleType& particle = particles[i];
+    if (!IsDue(particle)) {
+      continue;
+    }
+
+    /* Raise the level while the particle still moves little enough per
+       update, and while the step is also the start of a block of the next
+       level, so that blocks of every level stay aligned */
+    double speed = glm::length(PreciseVector(particle.GetVelocity()));
+    int level = 0;
+    while (level < max_time_step_level_) {
+      size_t next_length = size_t(2) << level;
+      if ((num_steps_ & (next_length - 1)) != 0 ||
+          speed * next_length > max_block_displacement_) {
+        break;
+      }
+      level++;
+    }
+    if (level != particle.GetTimeStepLevel()) {
+      store_.GetMutable(i).SetTimeStepLevel(level);
+    }
+  }
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::ReorderParticles() {
+  store_.Permute(morton_order_.Compute(store_.GetParticles(), size_));
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::UpdateWallCollisions() {
+  ChunkedView<ParticleType> particles = store_.GetParticles();
+  for (size_t i = 0; i < particles.size(); i++) {
+    const ParticleType& particle = particles[i];
+    if (!IsDue(particle)) {
+      continue;
+    }
+
+    /* Particles hitting a sink leave the plane instead of bouncing */
+    if (!sinks_.empty() && IsInSink(particle)) {
+      QueueParticleRemoval(store_.GetHandle(i));
+      continue;
+    }
+
+    Vector velocity = particle.GetVelocity();
+    if (boundary_.Reflect(particle.GetPrecisePosition(), particle.GetRadius(),
+                          velocity, size_)) {
+      if (collision_log_ != nullptr) {
+        LogCollision(CollisionKind::kWall, i, i, particle.GetVelocity(),
+                     velocity - particle.GetVelocity());
+      }
+      store_.GetMutable(i).SetVelocity(velocity);
+    }
+  }
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::UpdateObstacleCollisions() {
+  ChunkedView<ParticleType> particles = store_.GetParticles();
+  for (size_t i = 0; i < particles.size(); i++) {
+    const ParticleType& particle = particles[i];
+    if (!IsDue(particle)) {
+      continue;
+    }
+
+    /* Obstacles are shapes on the x-y plane, which in 3D extend through the
+       whole depth of the box, so only the x and y components take part */
+    const PreciseVector& position = particle.GetPrecisePosition();
+    Vector velocity = particle.GetVelocity();
+    Vec<2, Scalar> planar_velocity(velocity.x, velocity.y);
+    if (obstacles_.Reflect(glm::dvec2(position.x, position.y),
+                           particle.GetRadius(), planar_velocity)) {
+      velocity.x = planar_velocity.x;
+      velocity.y = planar_velocity.y;
+      if (collision_log_ != nullptr) {
+        LogCollision(CollisionKind::kObstacle, i, i, particle.GetVelocity(),
+                     velocity - particle.GetVelocity());
+      }
+      store_.GetMutable(i).SetVelocity(velocity);
+    }
+  }
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::EmitParticles() {
+  for (size_t i = 0; i < sources_.size(); i++) {
+    const ParticleSource& source = sources_[i];
+    source_backlogs_[i] += source.rate;
+
+    for (; source_backlogs_[i] >= 1; source_backlogs_[i]--) {
+      /* Place the particle just inside the wall, at a random point along the
+         segment, moving into the plane */
+      double length = source.segment.end - source.segment.start;
+      double along = source.segment.start + rand_.nextFloat() * length;
+      double normal_speed =
+          source.drift_speed + rand_.nextFloat() * source.thermal_speed;
+      double tangent_speed =
+          rand_.nextFloat(-source.thermal_speed, source.thermal_speed);
+
+      PreciseVector position(0);
+      Vector velocity(0);
+      switch (source.segment.wall) {
+        case Wall::kLeft:
+          position.x = source.radius;
+          position.y = along;
+          velocity.x = normal_speed;
+          velocity.y = tangent_speed;
+          break;
+        case Wall::kRight:
+          position.x = size_.x - source.radius;
+          position.y = along;
+          velocity.x = -normal_speed;
+          velocity.y = tangent_speed;
+          break;
+        case Wall::kBottom:
+          position.x = along;
+          position.y = source.radius;
+          velocity.x = tangent_speed;
+          velocity.y = normal_speed;
+          break;
+        case Wall::kTop:
+          position.x = along;
+          position.y = size_.y - source.radius;
+          velocity.x = tangent_speed;
+          velocity.y = -normal_speed;
+          break;
+      }
+
+      /* In 3D the segment is a strip across the depth of the box, so pick a
+         random depth and a random velocity along it */
+      for (int axis = 2; axis < Dim; axis++) {
+        position[axis] = source.radius + rand_.nextFloat() *
+                                             (size_[axis] - 2 * source.radius);
+        velocity[axis] =
+            rand_.nextFloat(-source.thermal_speed, source.thermal_speed);
+      }
+
+      QueueParticleInsertion(ParticleType(source.radius, source.mass, position,
+                                      velocity, source.color));
+    }
+  }
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::UpdateParticleCollisions() {
+  /* Particles are read through the view and written one at a time, so that
+     a shared store only copies the chunks of particles which collide */
+  ChunkedView<ParticleType> particles = store_.GetParticles();
+
+  /* Since we use index-based iteration, first ensure there are enough
+     particles to check for collisions */
+  if (particles.size() > 1) {
+    /* Particles can only be in contact if they are closer than the sum of the
+       largest radii. Cells are kept at least large enough that the grid has
+       about one cell per particle, so sparse planes do not need huge grids. */
+    double max_radius = 0;
+    for (const ParticleType& particle : particles) {
+      max_radius = std::max(max_radius, particle.GetRadius());
+    }
+    double volume = occupied_volume_;
+    if (volume == 0) {
+      volume = 1;
+      for (int axis = 0; axis < Dim; axis++) {
+        volume *= size_[axis];
+      }
+    }
+    double volume_per_particle = volume / particles.size();
+    double spacing = Dim == 2 ? std::sqrt(volume_per_particle)
+                              : std::cbrt(volume_per_particle);
+    double contact_distance = 2 * max_radius;
+
+    /* Particles between two of their updates are up to a block displacement
+       away from their stored positions */
+    if (max_time_step_level_ > 0) {
+      contact_distance += max_block_displacement_;
+    }
+    double cell_size = std::max(contact_distance, spacing);
+    grid_.Build(particles, size_, cell_size, boundary_.IsPeriodic());
+
+    /* No search finds more neighbors than there are particles, so the buffer
+       only grows when the number of particles does, never from a crowded
+       cell in an otherwise steady state */
+    neighbors_.reserve(particles.size());
+
+    /* Collisions move particles to level 0, so note which particles are
+       updated in this step before any of them collide */
+    is_due_.resize(particles.size());
+    for (size_t i = 0; i < particles.size(); i++) {
+      is_due_[i] = IsDue(particles[i]);
+    }
+
+    for (size_t i = 0; i < particles.size(); i++) {
+      if (!is_due_[i]) {
+        continue;
+      }
+
+      /* Search every pair with a particle in a nearby cell, in the same order
+         as searching every pair on the plane would */
+      neighbors_.clear();
+      grid_.FindNeighbors(particles[i].GetPrecisePosition(), neighbors_);
+      std::sort(neighbors_.begin(), neighbors_.end());
+
+      for (size_t j : neighbors_) {
+        /* Pairs of particles updated in this step are checked once, from the
+           first of them, and others from the side being updated */
+        if (j == i || (j < i && is_due_[j])) {
+          continue;
+        }
+        if (!is_due_[j]) {
+          ParticleType current = particles[j];
+          current.SetPosition(GetCurrentPosition(current));
+          if (!IsCollision(particles[i], current)) {
+            continue;
+          }
+
+          /* Bring the particle up to date before its velocity changes, and
+             update it every step until its next level is assigned */
+          current.SetTimeStepLevel(0);
+          store_.GetMutable(j) = current;
+        }
+
+        /* Update velocities if the pair of particles are in contact. The
+           particles are read after any write above, which may have copied
+           their chunk. */
+        const ParticleType& p1 = particles[i];
+        const ParticleType& p2 = particles[j];
+        if (IsCollision(p1, p2)) {
+          auto new_velocities = ComputePostCollisionVelocities(p1, p2);
+          if (collision_log_ != nullptr) {
+            LogCollision(CollisionKind::kPair, i, j,
+                         p1.GetVelocity() - p2.GetVelocity(),
+                         new_velocities.first - p1.GetVelocity());
+          }
+          ParticleType& updated1 = store_.GetMutable(i);
+          updated1.SetVelocity(new_velocities.first);
+          updated1.SetTimeStepLevel(0);
+          store_.GetMutable(j).SetVelocity(new_velocities.second);
+          num_collisions_++;
+        }
+      }
+    }
+  }
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::UpdatePositions() {
+  ChunkedView<ParticleType> particles = store_.GetParticles();
+  for (size_t i = 0; i < particles.size(); i++) {
+    /* Particles are moved at the end of their blocks, by the whole block */
+    size_t block_length = size_t(1) << particles[i].GetTimeStepLevel();
+    if (((num_steps_ + 1) & (block_length - 1)) != 0) {
+      continue;
+    }
+    double duration = static_cast<double>(block_length);
+    ParticleType& particle = store_.GetMutable(i);
+
+    /* Accelerate before moving, so that the new velocity is the one the
+       particle moves with */
+    if (Force::kIsActive) {
+      Vector velocity = particle.GetVelocity();
+      velocity += Vector(
+          force_field_.GetAcceleration(particle.GetPrecisePosition()) *
+          duration);
+      particle.SetVelocity(velocity);
+    }
+
+    particle.UpdatePosition(duration);
+    num_particle_updates_++;
+
+    /* Wrap particles that left the plane around to the opposite edge */
+    if (boundary_.IsPeriodic()) {
+      PreciseVector position = particle.GetPrecisePosition();
+      boundary_.Wrap(position, size_);
+      particle.SetPosition(position);
+    }
+  }
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+bool BasicSimulator<Dim, Boundary, Force, Scalar>::IsAgainstWall(
+    const ParticleType& particle, Wall wall) const {
+  const PreciseVector& position = particle.GetPrecisePosition();
+  const Vector& velocity = particle.GetVelocity();
+  double radius = particle.GetRadius();
+
+  switch (wall) {
+    case Wall::kLeft:
+      return position.x <= radius && velocity.x <= 0;
+    case Wall::kRight:
+      return position.x >= size_.x - radius && velocity.x >= 0;
+    case Wall::kBottom:
+      return position.y <= radius && velocity.y <= 0;
+    case Wall::kTop:
+      return position.y >= size_.y - radius && velocity.y >= 0;
+  }
+  return false;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+bool BasicSimulator<Dim, Boundary, Force, Scalar>::IsInSink(
+    const ParticleType& particle) const {
+  const PreciseVector& position = particle.GetPrecisePosition();
+  for (const ParticleSink& sink : sinks_) {
+    /* The coordinate of the particle along the sink's wall */
+    bool is_vertical_wall =
+        sink.segment.wall == Wall::kLeft || sink.segment.wall == Wall::kRight;
+    double along = is_vertical_wall ? position.y : position.x;
+
+    if (along >= sink.segment.start && along <= sink.segment.end &&
+        IsAgainstWall(particle, sink.segment.wall)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+bool BasicSimulator<Dim, Boundary, Force, Scalar>::IsCollision(
+    const ParticleType& p1, const ParticleType& p2) const {
+  /* Take the difference of the positions in double precision, where it is
+     exact, before narrowing it to the precision of the velocities */
+  return IsElasticCollision(Vector(GetDisplacement(p1, p2)),
+                            p1.GetVelocity(), p2.GetVelocity(),
+                            p1.GetRadius() + p2.GetRadius());
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+typename BasicSimulator<Dim, Boundary, Force, Scalar>::PreciseVector
+BasicSimulator<Dim, Boundary, Force, Scalar>::GetDisplacement(
+    const ParticleType& p1, const ParticleType& p2) const {
+  return boundary_.GetDisplacement(
+      p1.GetPrecisePosition() - p2.GetPrecisePosition(), size_);
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+std::pair<typename BasicSimulator<Dim, Boundary, Force, Scalar>::Vector,
+          typename BasicSimulator<Dim, Boundary, Force, Scalar>::Vector>
+BasicSimulator<Dim, Boundary, Force, Scalar>::ComputePostCollisionVelocities(
+    const ParticleType& p1, const ParticleType& p2) const {
+  /* Only the displacement between the particles matters, so compute it in
+     double precision before narrowing it */
+  return ComputeElasticCollision(Vector(GetDisplacement(p1, p2)),
+                                 p1.GetVelocity(), p2.GetVelocity(),
+                                 static_cast<Scalar>(p1.GetMass()),
+                                 static_cast<Scalar>(p2.GetMass()));
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+std::vector<double>
+BasicSimulator<Dim, Boundary, Force, Scalar>::GetSmallParticleSpeeds() const {
+  std::vector<double> speeds;
+  GetSmallParticleSpeeds(speeds);
+  return speeds;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::GetSmallParticleSpeeds(
+    std::vector<double>& speeds) const {
+  speeds.clear();
+  for (const ParticleType& p : store_.GetParticles()) {
+    if (IsSmall(p)) {
+      speeds.push_back(glm::length(p.GetVelocity()));
+    }
+  }
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+std::vector<double>
+BasicSimulator<Dim, Boundary, Force, Scalar>::GetMediumParticleSpeeds() const {
+  std::vector<double> speeds;
+  GetMediumParticleSpeeds(speeds);
+  return speeds;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::GetMediumParticleSpeeds(
+    std::vector<double>& speeds) const {
+  speeds.clear();
+  for (const ParticleType& p : store_.GetParticles()) {
+    if (IsMedium(p)) {
+      speeds.push_back(glm::length(p.GetVelocity()));
+    }
+  }
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+std::vector<double>
+BasicSimulator<Dim, Boundary, Force, Scalar>::GetLargeParticleSpeeds() const {
+  std::vector<double> speeds;
+  GetLargeParticleSpeeds(speeds);
+  return speeds;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::GetLargeParticleSpeeds(
+    std::vector<double>& speeds) const {
+  speeds.clear();
+  for (const ParticleType& p : store_.GetParticles()) {
+    if (IsLarge(p)) {
+      speeds.push_back(glm::length(p.GetVelocity()));
+    }
+  }
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+double BasicSimulator<Dim, Boundary, Force, Scalar>::GetKineticEnergy() const {
+  /* Each term is widened to double before it is squared, so a float run's
+     energy is measured as accurately as a double run's */
+  CompensatedSum energy;
+  for (const ParticleType& p : store_.GetParticles()) {
+    double speed = glm::length(PreciseVector(p.GetVelocity()));
+    energy.Add(0.5 * p.GetMass() * speed * speed);
+  }
+  return energy.GetSum();
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+typename BasicSimulator<Dim, Boundary, Force, Scalar>::PreciseVector
+BasicSimulator<Dim, Boundary, Force, Scalar>::GetMomentum() const {
+  CompensatedSum momentum[Dim];
+  for (const ParticleType& p : store_.GetParticles()) {
+    PreciseVector velocity(p.GetVelocity());
+    for (int axis = 0; axis < Dim; axis++) {
+      momentum[axis].Add(p.GetMass() * velocity[axis]);
+    }
+  }
+
+  PreciseVector total;
+  for (int axis = 0; axis < Dim; axis++) {
+    total[axis] = momentum[axis].GetSum();
+  }
+  return total;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+bool BasicSimulator<Dim, Boundary, Force, Scalar>::IsSmall(
+    const ParticleType& p) const {
+  double epsilon = 0.001;
+  return std::abs(p.GetRadius() - kSmallRadius) < epsilon &&
+         std::abs(p.GetMass() - kSmallMass) < epsilon;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+bool BasicSimulator<Dim, Boundary, Force, Scalar>::IsMedium(
+    const ParticleType& p) const {
+  double epsilon = 0.001;
+  return std::abs(p.GetRadius() - kMediumRadius) < epsilon &&
+         std::abs(p.GetMass() - kMediumMass) < epsilon;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+bool BasicSimulator<Dim, Boundary, Force, Scalar>::IsLarge(
+    const ParticleType& p) const {
+  double epsilon = 0.001;
+  return std::abs(p.GetRadius() - kLargeRadius) < epsilon &&
+         std::abs(p.GetMass() - kLargeMass) < epsilon;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+CollisionSpecies BasicSimulator<Dim, Boundary, Force, Scalar>::GetSpecies(
+    const ParticleType& p) const {
+  if (IsSmall(p)) {
+    return CollisionSpecies::kSmall;
+  } else if (IsMedium(p)) {
+    return CollisionSpecies::kMedium;
+  } else if (IsLarge(p)) {
+    return CollisionSpecies::kLarge;
+  }
+  return CollisionSpecies::kOther;
+}
+
+template <int Dim, typename Boundary, typename Force, typename Scalar>
+void BasicSimulator<Dim, Boundary, Force, Scalar>::LogCollision(
+    CollisionKind kind, size_t index1, size_t index2,
+    const Vector& relative_velocity, const Vector& velocity_change) {
+  ChunkedView<ParticleType> particles = store_.GetParticles();
+  const ParticleType& p1 = particles[index1];
+
+  CollisionEvent event = CollisionEvent();
+  event.step = num_steps_;
+  event.particle1 = store_.GetHandle(index1).slot;
+  event.particle2 = kNoParticle;
+  event.relative_speed =
+      static_cast<float>(glm::length(PreciseVector(relative_velocity)));
+  event.impulse = static_cast<float>(
+      p1.GetMass() * glm::length(PreciseVector(velocity_change)));
+  event.source = collision_source_;
+  event.kind = kind;
+  event.species1 = GetSpecies(p1);
+  event.species2 = CollisionSpecies::kOther;
+  if (kind == CollisionKind::kPair) {
+    event.particle2 = store_.GetHandle(index2).slot;
+    event.species2 = GetSpecies(particles[index2]);
+  }
+  collision_log_->Append(event);
+}
+
+}  // namespace idealgas
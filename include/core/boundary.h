@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cmath>
+
+#include "core/vector.h"
+
+namespace idealgas {
+
+/**
+ * Boundary policies for BasicSimulator, which decide how particles interact
+ * with the edges of the coordinate plane.
+ *
+ * A policy provides:
+ *   bool HasWalls() const       True if particles bounce off of the edges,
+ *                               and sources and sinks apply
+ *   bool IsPeriodic() const     True if the edges wrap around
+ *   Reflect(position, radius, velocity, size)
+ *                               Bounces a particle off of the walls, returns
+ *                               true if its velocity changed
+ *   GetDisplacement(displacement, size)
+ *                               Maps the difference of two positions to the
+ *                               displacement used for collisions
+ *   Wrap(position, size)        Moves a position which left the plane back
+ *                               onto it
+ *
+ * Positions, velocities, and sizes are 2D or 3D glm vectors, so one policy
+ * serves simulations of either dimension. The simulator calls these from its
+ * per-particle loops, so they are defined here to be inlined, and policies
+ * whose answers are fixed let the compiler drop the passes which do not
+ * apply.
+ */
+
+/** Particles bounce off of walls at the edges of the plane */
+class WallBoundary {
+ public:
+  bool HasWalls() const {
+    return true;
+  }
+
+  bool IsPeriodic() const {
+    return false;
+  }
+
+  template <typename Position, typename Velocity>
+  bool Reflect(const Position& position, double radius, Velocity& velocity,
+               const Position& size) const {
+    bool is_reflected = false;
+
+    /* Only reflect particles in contact with a wall which are moving towards
+       it, so that particles do not get stuck in the walls */
+    for (int axis = 0; axis < VectorSize<Position>::value; axis++) {
+      if ((position[axis] <= radius && velocity[axis] <= 0) ||
+          (position[axis] >= size[axis] - radius && velocity[axis] >= 0)) {
+        velocity[axis] = -velocity[axis];
+        is_reflected = true;
+      }
+    }
+
+    return is_reflected;
+  }
+
+  template <typename Position>
+  Position GetDisplacement(const Position& displacement,
+                           const Position& size) const {
+    return displacement;
+  }
+
+  template <typename Position>
+  void Wrap(Position& position, const Position& size) const {
+  }
+};
+
+/**
+ * Particles leaving one edge re-enter at the opposite edge, and collide with
+ * the nearest periodic image of each other particle
+ */
+class PeriodicBoundary {
+ public:
+  bool HasWalls() const {
+    return false;
+  }
+
+  bool IsPeriodic() const {
+    return true;
+  }
+
+  template <typename Position, typename Velocity>
+  bool Reflect(const Position& position, double radius, Velocity& velocity,
+               const Position& size) const {
+    return false;
+  }
+
+  template <typename Position>
+  Position GetDisplacement(const Position& displacement,
+                           const Position& size) const {
+    /* Use the nearest periodic image, i.e. wrap the displacement into
+       [-size / 2, size / 2] along each axis */
+    Position image = displacement;
+    for (int axis = 0; axis < VectorSize<Position>::value; axis++) {
+      image[axis] -= size[axis] * std::round(image[axis] / size[axis]);
+    }
+    return image;
+  }
+
+  template <typename Position>
+  void Wrap(Position& position, const Position& size) const {
+    for (int axis = 0; axis < VectorSize<Position>::value; axis++) {
+      position[axis] -= size[axis] * std::floor(position[axis] / size[axis]);
+    }
+  }
+};
+
+/** How particles interact with the edges of the coordinate plane */
+enum class BoundaryMode {
+  /** Particles bounce off of walls at the edges */
+  kWalls,
+  /**
+   * Particles leaving one edge re-enter at the opposite edge, and collide
+   * with the nearest periodic image of each other particle
+   */
+  kPeriodic
+};
+
+/**
+ * Either of the boundaries above, chosen at runtime. This is what Simulator
+ * uses, so that the app can switch modes while running; it costs a
+ * predictable branch per call.
+ */
+class SelectableBoundary {
+ public:
+  SelectableBoundary() : mode_(BoundaryMode::kWalls) {
+  }
+
+  void SetMode(BoundaryMode mode) {
+    mode_ = mode;
+  }
+
+  BoundaryMode GetMode() const {
+    return mode_;
+  }
+
+  bool HasWalls() const {
+    return mode_ == BoundaryMode::kWalls;
+  }
+
+  bool IsPeriodic() const {
+    return mode_ == BoundaryMode::kPeriodic;
+  }
+
+  template <typename Position, typename Velocity>
+  bool Reflect(const Position& position, double radius, Velocity& velocity,
+               const Position& size) const {
+    return HasWalls() && walls_.Reflect(position, radius, velocity, size);
+  }
+
+  template <typename Position>
+  Position GetDisplacement(const Position& displacement,
+                           const Position& size) const {
+    return IsPeriodic() ? periodic_.GetDisplacement(displacement, size)
+                        : displacement;
+  }
+
+  template <typename Position>
+  void Wrap(Position& position, const Position& size) const {
+    if (IsPeriodic()) {
+      periodic_.Wrap(position, size);
+    }
+  }
+
+ private:
+  BoundaryMode mode_;
+  WallBoundary walls_;
+  PeriodicBoundary periodic_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/spsc_ring.h"
+
+namespace idealgas {
+
+/** What a particle collided with */
+enum class CollisionKind : uint8_t { kPair, kWall, kObstacle };
+
+/** The species of a collision's particles, by radius and mass */
+enum class CollisionSpecies : uint8_t { kSmall, kMedium, kLarge, kOther };
+
+/**
+ * One collision, as stored in a collision log. Records are 32 bytes with no
+ * implicit padding, and are written to the log in the host's byte order.
+ */
+struct CollisionEvent {
+  /** The number of updates run before the one the collision happened in */
+  uint64_t step;
+
+  /**
+   * The slots of the particles' handles, which stay the same for as long as
+   * the particles do. particle2 is kNoParticle for walls and obstacles.
+   */
+  uint32_t particle1;
+  uint32_t particle2;
+
+  /**
+   * The speed of the particles relative to each other before the collision,
+   * or of the particle for walls and obstacles
+   */
+  float relative_speed;
+
+  /** The magnitude of the change in the first particle's momentum */
+  float impulse;
+
+  /** Tells apart the simulations sharing a log, e.g. ensemble members */
+  uint32_t source;
+
+  /** species2 is kOther for walls and obstacles */
+  CollisionKind kind;
+  CollisionSpecies species1;
+  CollisionSpecies species2;
+  uint8_t reserved;
+};
+
+static_assert(sizeof(CollisionEvent) == 32,
+              "collision records have a fixed layout");
+
+/** The particle2 of collisions with walls and obstacles */
+const uint32_t kNoParticle = UINT32_MAX;
+
+/**
+ * The producer side of a collision log, used by one thread at a time.
+ *
+ * Appending never blocks: once the log's writer falls a whole ring behind,
+ * further events are dropped and counted instead, so that logging cannot
+ * hold up a simulation.
+ */
+class CollisionLogChannel {
+ public:
+  CollisionLogChannel(const CollisionLogChannel&) = delete;
+  CollisionLogChannel& operator=(const CollisionLogChannel&) = delete;
+
+  void Append(const CollisionEvent& event) {
+    if (!ring_.TryPush(event)) {
+      /* Only the producer writes the counter, so it needs no
+         read-modify-write */
+      num_dropped_.store(num_dropped_.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+    }
+  }
+
+  /** Returns the number of events dropped because the ring was full */
+  uint64_t GetNumDropped() const {
+    return num_dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class CollisionLog;
+
+  explicit CollisionLogChannel(size_t capacity)
+      : ring_(capacity), num_dropped_(0) {
+  }
+
+  SpscRing<CollisionEvent> ring_;
+  std::atomic<uint64_t> num_dropped_;
+};
+
+/**
+ * A binary log of collision events, for analyses such as mean free paths and
+ * collision rates.
+ *
+ * Each thread which produces events appends them to a channel of its own,
+ * and a background thread drains every channel into the file, so producers
+ * never contend with each other or wait on the disk. The file starts with
+ * kCollisionLogMagic, followed by CollisionEvent records. Records from
+ * different channels are interleaved, but each channel's are in order.
+ */
+class CollisionLog {
+ public:
+  /**
+   * Creates the log file and starts the writer.
+   *
+   * @param path              The file to write, which is overwritten
+   * @param channel_capacity  The number of events each channel buffers
+   *                          before dropping them
+   * @throws std::runtime_error if the file cannot be created
+   */
+  explicit CollisionLog(const std::string& path,
+                        size_t channel_capacity = 65536);
+
+  /** Writes the events still buffered, and closes the file */
+  ~CollisionLog();
+
+  CollisionLog(const CollisionLog&) = delete;
+  CollisionLog& operator=(const CollisionLog&) = delete;
+
+  /**
+   * Adds a channel for a producer thread. Channels live as long as the log.
+   * Safe to call while other channels are in use.
+   */
+  CollisionLogChannel& AddChannel();
+  size_t GetNumChannels() const;
+
+  /** Returns the number of events written to the file so far */
+  uint64_t GetNumWritten() const;
+
+  /** Returns the number of events dropped by every channel */
+  uint64_t GetNumDropped() const;
+
+ private:
+  std::ofstream output_;
+  size_t channel_capacity_;
+
+  /** Guards the list of channels, which producers never need */
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<CollisionLogChannel>> channels_;
+
+  std::atomic<bool> is_stopping_;
+  std::atomic<uint64_t> num_written_;
+  std::vector<CollisionEvent> buffer_;
+  std::thread writer_;
+
+  /** Drains the channels until the log is destroyed */
+  void Write();
+
+  /** Writes out every buffered event, returns false if there were none */
+  bool Drain();
+};
+
+/** The first 8 bytes of every collision log, naming its format */
+extern const char kCollisionLogMagic[8];
+
+/**
+ * Reads every event from a collision log.
+ *
+ * @throws std::runtime_error if the file cannot be read or is not a log
+ */
+std::vector<CollisionEvent> ReadCollisionLog(const std::string& path);
+
+}  // namespace idealgas
@@ -0,0 +1,28 @@
+#pragma once
+
+namespace idealgas {
+
+/**
+ * Sums doubles with Neumaier's variant of Kahan summation, which carries the
+ * rounding error of every addition in a separate term. The error of the sum
+ * does not grow with the number of terms, so sums over many particles of
+ * terms with mixed magnitudes stay accurate to about one rounding.
+ */
+class CompensatedSum {
+ public:
+  /** Creates a sum of zero */
+  CompensatedSum();
+
+  void Add(double value);
+
+  /** Returns the sum of every value added so far */
+  double GetSum() const;
+
+ private:
+  double sum_;
+
+  /** The rounding error lost from sum_, to be added back in at the end */
+  double compensation_;
+};
+
+}  // namespace idealgas
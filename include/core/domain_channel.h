@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/shared_memory.h"
+
+namespace idealgas {
+
+/**
+ * A two-way link between the processes of neighboring strips of a
+ * DomainSimulator, over which messages of bytes arrive whole and in order.
+ * Transports implement it, so that the simulation does not depend on how
+ * its processes are connected.
+ */
+class DomainChannel {
+ public:
+  virtual ~DomainChannel() {
+  }
+
+  /** Sends a message, waiting for the other end if need be */
+  virtual void Send(const std::vector<char>& message) = 0;
+
+  /** Replaces the contents of message with the next message received */
+  virtual void Receive(std::vector<char>& message) = 0;
+};
+
+/**
+ * A channel between two processes on one machine through a POSIX shared
+ * memory segment, which holds a buffer for each direction.
+ *
+ * Each buffer holds one part of a message at a time. The sender writes a
+ * part and then publishes it by bumping a count of parts sent, and the
+ * receiver copies it and bumps a count of parts received, which frees the
+ * buffer for the next part. Messages larger than the buffer are sent in
+ * several parts. Both ends spin briefly while waiting, as the other end is
+ * usually about to arrive, and then sleep between checks.
+ */
+class SharedMemoryChannel : public DomainChannel {
+ public:
+  /**
+   * Creates the channel's shared memory, replacing any segment of the same
+   * name. The process at the other end then attaches with Open().
+   *
+   * @param name      The name of the segment, e.g. "/ideal-gas-domain-0"
+   * @param capacity  The bytes each direction can hold at once
+   * @param timeout   How long to wait for the other end, in seconds
+   * @throws std::runtime_error if the shared memory cannot be created
+   */
+  static SharedMemoryChannel Create(const std::string& name,
+                                    size_t capacity = 1 << 20,
+                                    double timeout = 30);
+
+  /**
+   * Attaches to a channel created by another process.
+   *
+   * @throws std::runtime_error if the channel does not exist yet
+   */
+  static SharedMemoryChannel Open(const std::string& name,
+                                  double timeout = 30);
+
+  /** @throws std::runtime_error if the other end does not respond in time */
+  void Send(const std::vector<char>& message) override;
+  void Receive(std::vector<char>& message) override;
+
+ private:
+  struct Buffer;
+
+  SharedMemoryChannel(SharedMemory memory, bool is_creator, double timeout);
+
+  SharedMemory memory_;
+  Buffer* outgoing_;
+  Buffer* incoming_;
+  size_t capacity_;
+  double timeout_;
+
+  /** Returns the buffer of one direction, 0 being from the creator */
+  Buffer* GetBuffer(size_t direction) const;
+
+  /** Waits until a buffer's counts satisfy a condition */
+  template <typename Condition>
+  void Wait(const Condition& condition) const;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/domain_channel.h"
+#include "core/simulator.h"
+
+namespace idealgas {
+
+/**
+ * One process's part of a simulation divided among processes, so that one
+ * large simulation can use the cores and memory of several NUMA nodes.
+ *
+ * The plane, which has walls on every edge, is cut into vertical strips of
+ * equal width, and each process owns the particles in its strip. Before
+ * every update, a process sends copies of the particles near each edge of
+ * its strip to the neighbor across it. These ghosts are simulated alongside
+ * its own particles, so that pairs across the edge collide in both
+ * processes, and are discarded after the update. Particles which have left
+ * the strip are then handed over to the neighbor they moved to.
+ *
+ * The particles and ghosts stay in one Simulator between updates. Each
+ * update adds the new ghosts and the particles handed over, removes the old
+ * ghosts and the particles handed away, and merges the rest back into order,
+ * so that a step costs time linear in the particles of the strip.
+ *
+ * Pairs are resolved one after another, so a particle's new velocity can
+ * depend on the collisions of its partners earlier in the same step. Every
+ * particle is therefore numbered in the order it was added, and each step
+ * simulates a process's particles and ghosts in that order, as a single
+ * process would. Ghosts come from up to two interaction ranges away, so
+ * that the partners of the particles which cross edges are there too. A run
+ * then gives the same results as a single Simulator given the particles in
+ * the same order, unless a chain of three collisions in one step reaches
+ * across an edge, which the halo would have to be deeper to reproduce.
+ */
+class DomainSimulator {
+ public:
+  /**
+   * @param plane_width   The size of the whole plane
+   * @param plane_height
+   * @param num_strips    The number of processes the plane is divided among
+   * @param strip         The strip of this process, counted from the left
+   * @param left          The channel to the process of the strip to the
+   *                      left, or null for the first strip
+   * @param right         The channel to the process of the strip to the
+   *                      right, or null for the last strip
+   * @throws std::invalid_argument if the strip does not exist, strips are
+   *         narrower than the ghosts' halo, or a strip's channels do not
+   *         match its neighbors
+   */
+  DomainSimulator(double plane_width, double plane_height, size_t num_strips,
+                  size_t strip, DomainChannel* left, DomainChannel* right);
+
+  /**
+   * Adds a particle if it is in this process's strip. Every process must be
+   * given the same particles in the same order, which numbers them.
+   *
+   * @return  True if the particle was added
+   * @throws std::invalid_argument if the particle is larger than a large
+   *         particle, which sets the interaction range
+   */
+  bool AddParticle(const Particle& particle);
+
+  /**
+   * Updates the particles by one step. Every process must update the same
+   * number of times, as each update exchanges particles with the neighbors.
+   */
+  void Update();
+
+  /** Returns the particles this process owns, in the order they were added */
+  const std::vector<Particle>& GetParticles() const;
+
+  /** The left and right edges of this process's strip */
+  double GetStripLeft() const;
+  double GetStripRight() const;
+
+ private:
+  /**
+   * A particle with the number it was added as, and its handle in the
+   * simulation once it has been added to it
+   */
+  struct NumberedParticle {
+    uint64_t number;
+    bool is_ghost;
+    Particle particle;
+    ParticleHandle handle;
+  };
+
+  Simulator simulator_;
+  size_t strip_;
+  double strip_left_;
+  double strip_right_;
+  double halo_depth_;
+  DomainChannel* left_;
+  DomainChannel* right_;
+  uint64_t num_added_;
+
+  /** The particles this process owns, ordered by number */
+  std::vector<NumberedParticle> owned_;
+  std::vector<Particle> particles_;
+
+  /** Buffers reused between updates */
+  std::vector<NumberedParticle> local_;
+  std::vector<NumberedParticle> arrivals_;
+  std::vector<NumberedParticle> sorted_arrivals_;
+  std::vector<ParticleHandle> local_handles_;
+  std::vector<ParticleHandle> removals_;
+  std::vector<char> to_left_;
+  std::vector<char> to_right_;
+  std::vector<char> received_;
+
+  /**
+   * Sends the messages to the neighbors, and appends the particles they
+   * sent to arrivals_
+   */
+  void Exchange(bool are_ghosts);
+
+  /**
+   * Adds the arrivals to the simulation, and merges them into
+   * sorted_arrivals_ in order of number. Each neighbor's particles arrive in
+   * that order, as its messages are built by walking owned_.
+   */
+  void AddArrivals();
+
+  static bool IsEarlier(const NumberedParticle& p1,
+                        const NumberedParticle& p2);
+
+  /** Sends a message across one edge and receives the neighbor's */
+  void ExchangeAcross(DomainChannel* channel, const std::vector<char>& message,
+                      bool is_first_to_send, bool are_ghosts);
+};
+
+}  // namespace idealgas
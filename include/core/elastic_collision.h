@@ -0,0 +1,62 @@
+#pragma once
+
+#include <utility>
+
+#include "cinder/gl/gl.h"
+
+namespace idealgas {
+
+/**
+ * The collision kernel of the simulations: an elastic collision between two
+ * particles, given their relative position, velocities, and masses. Every
+ * simulation of the gas resolves pairs with these, so that they all agree.
+ */
+
+/**
+ * Returns true if two particles are in contact and moving towards each
+ * other.
+ *
+ * @param displacement      The position of the first particle relative to
+ *                          the second
+ * @param v1                The velocity of the first particle
+ * @param v2                The velocity of the second particle
+ * @param contact_distance  The sum of the particles' radii
+ */
+template <typename Vector>
+bool IsElasticCollision(const Vector& displacement, const Vector& v1,
+                        const Vector& v2, double contact_distance) {
+  bool are_touching = glm::length(displacement) <= contact_distance;
+  bool are_moving_towards_each_other = glm::dot(v1 - v2, displacement) < 0;
+
+  return are_touching && are_moving_towards_each_other;
+}
+
+/**
+ * Computes the velocities of two particles after they collide, assuming they
+ * are in contact.
+ *
+ * @param displacement  The position of the first particle relative to the
+ *                      second
+ * @param m1            The masses of the particles, in the precision of their
+ * @param m2            velocities
+ * @return              A std::pair of the post-collision velocities of the
+ *                      first and the second particle
+ */
+template <typename Vector, typename Scalar>
+std::pair<Vector, Vector> ComputeElasticCollision(const Vector& displacement,
+                                                  const Vector& v1,
+                                                  const Vector& v2, Scalar m1,
+                                                  Scalar m2) {
+  Vector v1_prime =
+      v1 - ((2 * m2) / (m1 + m2) * (glm::dot(v1 - v2, displacement)) /
+            (glm::length(displacement) * glm::length(displacement))) *
+               displacement;
+  Vector v2_prime =
+      v2 - ((2 * m1) / (m1 + m2) * (glm::dot(v2 - v1, -displacement)) /
+            (glm::length(displacement) * glm::length(displacement)) *
+            (-displacement));
+
+  return std::pair<Vector, Vector>(v1_prime, v2_prime);
+}
+
+}  // namespace idealgas
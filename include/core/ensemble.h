@@ -0,0 +1,142 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "core/collision_log.h"
+#include "core/simulator.h"
+#include "core/thread_pool.h"
+
+namespace idealgas {
+
+/**
+ * Adds a histogram of the specified speeds to a running sum.
+ *
+ * @param speeds       The speeds to be sorted into bins
+ * @param max_speed    The upper bound of the histogram, faster speeds are
+ *                     counted in the last bin
+ * @param frequencies  The running sum of each bin, whose size is the number
+ *                     of bins
+ */
+void AccumulateSpeedFrequencies(const std::vector<double>& speeds,
+                                double max_speed,
+                                std::vector<double>& frequencies);
+
+/**
+ * The description of a single independent simulation in an ensemble.
+ */
+struct EnsembleMember {
+  /** The seed used to generate the member's random particles */
+  uint32_t seed;
+
+  /** The number of random particles of each size the member starts with */
+  size_t num_small;
+  size_t num_medium;
+  size_t num_large;
+};
+
+/**
+ * Observables reduced over every member of an ensemble. All values are
+ * averages over the members.
+ */
+struct EnsembleResult {
+  size_t num_members;
+
+  /**
+   * Speed histograms of the small, medium, and large particles. The i-th
+   * value is the average number of particles with speeds between i and i + 1
+   * times the bin width, with the last bin being unbounded.
+   */
+  std::vector<double> small_speed_frequencies;
+  std::vector<double> medium_speed_frequencies;
+  std::vector<double> large_speed_frequencies;
+
+  double kinetic_energy;
+  double num_steps;
+};
+
+/**
+ * Runs many independent simulations in parallel and averages their
+ * observables.
+ *
+ * Every member's Simulator is created, run, and measured entirely within one
+ * task of a thread pool, so its particles only ever live on the worker that
+ * runs it. Only the reduced observables leave the worker.
+ */
+class Ensemble {
+ public:
+  /**
+   * Called after every step of a member with the member's simulator and the
+   * number of steps it has run. The member stops once it returns true.
+   */
+  typedef std::function<bool(const Simulator&, size_t)> StopCondition;
+
+  /**
+   * Creates an empty ensemble.
+   *
+   * @param max_speed       The upper bound of the speed histograms, faster
+   *                        particles are counted in the last bin
+   * @param num_speed_bins  The number of bins in the speed histograms
+   */
+  Ensemble(double max_speed, size_t num_speed_bins);
+
+  void AddMember(const EnsembleMember& member);
+  const std::vector<EnsembleMember>& GetMembers() const;
+
+  /**
+   * Logs the collisions of every member run from now on, tagged with the
+   * member's index, or stops logging if the log is null. Each worker appends
+   * to a channel of its own, so members never contend on the log.
+   *
+   * The channels are added to the log by the first run and reused by later
+   * runs.
+   */
+  void SetCollisionLog(CollisionLog* log);
+
+  /**
+   * Runs every member of the ensemble and averages their observables.
+   *
+   * @param max_steps  The number of steps each member is run for, unless it
+   *                   is stopped earlier
+   * @param pool       The thread pool the members are scheduled on
+   * @param stop       An optional condition used to stop members early
+   * @return           The observables averaged over all of the members
+   */
+  EnsembleResult Run(size_t max_steps, ThreadPool& pool,
+                     const StopCondition& stop = StopCondition());
+
+ private:
+  double max_speed_;
+  size_t num_speed_bins_;
+  std::vector<EnsembleMember> members_;
+  CollisionLog* collision_log_;
+
+  /**
+   * The channels of the collision log, one per worker plus one for members
+   * run from outside of the pool. Added by runs as needed.
+   */
+  std::vector<CollisionLogChannel*> collision_channels_;
+
+  /** Running sums of the observables of the members run by one worker */
+  struct Accumulator {
+    std::vector<double> small_speed_frequencies;
+    std::vector<double> medium_speed_frequencies;
+    std::vector<double> large_speed_frequencies;
+    double kinetic_energy;
+    double num_steps;
+    size_t num_members;
+  };
+
+  /**
+   * Creates, runs, and measures a single member, logging its collisions to
+   * the channel if it is not null
+   */
+  void RunMember(const EnsembleMember& member, uint32_t source,
+                 size_t max_steps, const StopCondition& stop,
+                 Accumulator& accumulator,
+                 CollisionLogChannel* channel) const;
+
+  Accumulator CreateAccumulator() const;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "cinder/gl/gl.h"
+
+namespace idealgas {
+
+/** The four walls at the edges of the coordinate plane */
+enum class Wall { kLeft, kRight, kBottom, kTop };
+
+/**
+ * A stretch of one of the walls of the coordinate plane.
+ */
+struct WallSegment {
+  Wall wall;
+
+  /**
+   * The bounds of the segment along the wall, i.e. y coordinates for the left
+   * and right walls and x coordinates for the bottom and top walls
+   */
+  double start;
+  double end;
+};
+
+/**
+ * A wall segment which emits particles into the plane.
+ *
+ * Particles enter moving away from the wall with a speed of drift_speed plus
+ * a random amount of up to thermal_speed, and a random velocity along the
+ * wall of up to thermal_speed in either direction.
+ */
+struct ParticleSource {
+  WallSegment segment;
+
+  /** The average number of particles emitted per update */
+  double rate;
+
+  double radius;
+  double mass;
+  ci::Color color;
+
+  double drift_speed;
+  double thermal_speed;
+};
+
+/**
+ * A wall segment which absorbs every particle that hits it, instead of
+ * reflecting it.
+ */
+struct ParticleSink {
+  WallSegment segment;
+};
+
+}  // namespace idealgas
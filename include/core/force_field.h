@@ -0,0 +1,60 @@
+#pragma once
+
+#include "core/vector.h"
+
+namespace idealgas {
+
+/**
+ * External force policies for BasicSimulator.
+ *
+ * A policy provides kIsActive, which is false if it never accelerates
+ * particles so that the simulator can skip the force pass entirely, and
+ * GetAcceleration(position), the change in velocity per update of a particle
+ * at the specified double precision position.
+ */
+
+/** No external force, particles move in straight lines between collisions */
+class NoForce {
+ public:
+  static constexpr bool kIsActive = false;
+
+  template <typename Position>
+  Position GetAcceleration(const Position& position) const {
+    return Position(0);
+  }
+};
+
+/**
+ * The same acceleration everywhere on the plane, e.g. gravity.
+ *
+ * @tparam Dim  The number of dimensions of the simulation
+ */
+template <int Dim>
+class BasicUniformForce {
+ public:
+  static constexpr bool kIsActive = true;
+  typedef Vec<Dim, double> PreciseVector;
+
+  BasicUniformForce() : acceleration_(0) {
+  }
+
+  explicit BasicUniformForce(const PreciseVector& acceleration)
+      : acceleration_(acceleration) {
+  }
+
+  void SetAcceleration(const PreciseVector& acceleration) {
+    acceleration_ = acceleration;
+  }
+
+  const PreciseVector& GetAcceleration(const PreciseVector& position) const {
+    return acceleration_;
+  }
+
+ private:
+  PreciseVector acceleration_;
+};
+
+typedef BasicUniformForce<2> UniformForce;
+typedef BasicUniformForce<3> UniformForce3d;
+
+}  // namespace idealgas
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/shared_memory.h"
+#include "core/simulator.h"
+
+namespace idealgas {
+
+/**
+ * A live feed of simulation frames through shared memory, so that a headless
+ * simulation can be watched by viewers and dashboards in other processes
+ * which attach and detach while it runs.
+ *
+ * The segment holds a small ring of frame slots, each guarded by a seqlock: a
+ * sequence number which the publisher makes odd before writing a slot and
+ * even again after. A reader copies the newest slot and keeps the copy only
+ * if the sequence number was even and unchanged around it, and otherwise
+ * retries with the slot written since. The publisher therefore never waits
+ * for readers, and slow readers skip frames instead of holding it back.
+ *
+ * Every shared word is accessed atomically, as lock-free atomics work across
+ * processes, and relaxed word accesses cost the same as plain ones.
+ */
+
+/**
+ * The species a particle of the feed belongs to, by its radius and mass as
+ * the simulator sorts them
+ */
+enum class FeedSpecies : uint8_t { kSmall, kMedium, kLarge, kOther };
+
+/** A particle as read from the feed */
+struct FeedParticle {
+  glm::dvec2 position;
+  glm::vec2 velocity;
+  float radius;
+  float mass;
+  FeedSpecies species;
+  ci::Color color;
+};
+
+/** A frame as read from the feed */
+struct FeedFrame {
+  /** The number of frames published before this one */
+  uint64_t frame_number;
+  std::vector<FeedParticle> particles;
+};
+
+/** Writes the frames of a simulation to a feed */
+class FramePublisher {
+ public:
+  /**
+   * Creates the feed's shared memory, replacing any feed of the same name.
+   *
+   * @param name           The name of the feed, e.g. "/ideal-gas"
+   * @param simulator      The simulation, whose plane size is recorded for
+   *                       readers
+   * @param max_particles  The most particles a frame can hold, which sets
+   *                       the size of the shared memory
+   * @param num_slots      The number of frames kept in the ring. More slots
+   *                       give slow readers longer to copy a frame before it
+   *                       is overwritten.
+   * @throws std::runtime_error if the shared memory cannot be created
+   */
+  FramePublisher(const std::string& name, const Simulator& simulator,
+                 size_t max_particles, size_t num_slots = 4);
+
+  /** Marks the feed as closed, so that readers know to detach */
+  ~FramePublisher();
+
+  /**
+   * Writes the current state of the simulation as the next frame. Never
+   * waits for readers and does not allocate.
+   *
+   * @throws std::invalid_argument if the simulation has more particles than
+   *         the feed can hold
+   */
+  void Publish(const Simulator& simulator);
+
+  /** Returns the number of frames published */
+  uint64_t GetNumFrames() const;
+
+ private:
+  SharedMemory memory_;
+  size_t max_particles_;
+  size_t num_slots_;
+  uint64_t num_frames_;
+};
+
+/** Reads the newest frames of a feed */
+class FrameReader {
+ public:
+  /**
+   * Attaches to a feed.
+   *
+   * @throws std::runtime_error if there is no feed of that name or it is not
+   *         a feed of this version
+   */
+  explicit FrameReader(const std::string& name);
+
+  /**
+   * Copies the newest frame into the specified frame, if one was published
+   * since the last frame read. Frames published in between are skipped.
+   *
+   * @param frame  Overwritten with the frame. Its memory is reused, so steady
+   *               reads do not allocate.
+   * @return       False if no new frame was read, either because none was
+   *               published or because the publisher overwrote every frame
+   *               while it was being copied
+   */
+  bool ReadLatest(FeedFrame& frame);
+
+  /** The size of the publisher's plane */
+  double GetPlaneWidth() const;
+  double GetPlaneHeight() const;
+
+  /** Returns true once the publisher has closed the feed */
+  bool IsClosed() const;
+
+  /**
+   * Returns the number of frames published between frames read, which the
+   * reader was too slow to see
+   */
+  uint64_t GetNumSkippedFrames() const;
+
+ private:
+  SharedMemory memory_;
+  bool has_read_;
+  uint64_t last_frame_number_;
+  uint64_t num_skipped_frames_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+
+#include "core/simulator.h"
+#include "core/thread_pool.h"
+
+namespace idealgas {
+
+/**
+ * Loaders for initial conditions stored in files, for reproducing
+ * experiments with more particles than are practical to add one at a time.
+ *
+ * CSV files have one particle per line with the columns
+ *
+ *   x, y, vx, vy, species
+ *
+ * where the species is small, medium, or large and gives the particle its
+ * radius, mass, and color. A first line which does not start with a number
+ * is taken to be a header and skipped, as are blank lines.
+ *
+ * Binary files store the same columns one after another, so that they can
+ * be read without parsing. After the 8 bytes of kParticleFileMagic and the
+ * number of particles as a uint64, the file holds every x as a double, then
+ * every y as a double, every vx as a float, every vy as a float, and every
+ * species as a uint8 of 0 for small, 1 for medium, or 2 for large. Values
+ * are in the host's byte order.
+ *
+ * Both loaders add the particles after any already in the simulation, in the
+ * order of the file.
+ */
+
+/**
+ * Adds the particles of a CSV file to a simulation. The file is mapped into
+ * memory and split into chunks at line breaks, which the pool parses in
+ * parallel without allocating per line.
+ *
+ * @throws std::runtime_error if the file cannot be read, or naming the line
+ *         of the first malformed row
+ */
+void LoadCsvParticles(const std::string& path, Simulator& simulator,
+                      ThreadPool& pool);
+
+/**
+ * Adds the particles of a binary file to a simulation. The columns are read
+ * straight from the mapped file without parsing, and the simulation's
+ * storage is reserved for every particle before they are added one by one.
+ *
+ * @throws std::runtime_error if the file cannot be read or is malformed
+ */
+void LoadBinaryParticles(const std::string& path, Simulator& simulator);
+
+/**
+ * Writes the particles of a simulation to a binary file.
+ *
+ * @throws std::invalid_argument if a particle is not small, medium, or large
+ * @throws std::runtime_error if the file cannot be written
+ */
+void SaveBinaryParticles(const std::string& path, const Simulator& simulator);
+
+/** The first 8 bytes of every binary particle file, naming its format */
+extern const char kParticleFileMagic[8];
+
+}  // namespace idealgas
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace idealgas {
+
+/**
+ * A file mapped into memory, so that large inputs can be parsed in place
+ * instead of being copied into buffers first, and files larger than memory
+ * can be worked on in place. The mapping is released when the object is
+ * destroyed.
+ */
+class MappedFile {
+ public:
+  /**
+   * Maps the whole of a file. Empty files have no data.
+   *
+   * @throws std::runtime_error if the file cannot be opened or mapped
+   */
+  static MappedFile Open(const std::string& path);
+
+  /**
+   * Maps the whole of a file for reading and writing. Writes to the mapping
+   * are written back to the file, and the kernel can page the mapping out
+   * to it under memory pressure.
+   *
+   * @throws std::runtime_error if the file cannot be opened or mapped
+   */
+  static MappedFile OpenWritable(const std::string& path);
+
+  MappedFile(MappedFile&& other);
+  MappedFile& operator=(MappedFile&& other);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* GetData() const;
+  size_t GetSize() const;
+
+  /** Returns the data of a mapping opened with OpenWritable() */
+  char* GetMutableData() const;
+
+ private:
+  MappedFile(void* data, size_t size);
+
+  void* data_;
+  size_t size_;
+
+  void Release();
+};
+
+}  // namespace idealgas
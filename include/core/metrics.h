@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "core/seqlock.h"
+#include "core/simulator.h"
+
+namespace idealgas {
+
+/** Throughput and observables of a simulation at one point in time */
+struct MetricsSnapshot {
+  uint64_t num_steps;
+  uint64_t num_collisions;
+  double steps_per_second;
+  double collisions_per_step;
+  double kinetic_energy;
+  /**
+   * The change in kinetic energy since the first snapshot, relative to it.
+   * Only meaningful while no particles are added or removed.
+   */
+  double energy_drift;
+  uint64_t num_small;
+  uint64_t num_medium;
+  uint64_t num_large;
+  uint64_t num_other;
+};
+
+/**
+ * Takes snapshots of a simulation's metrics on the thread which updates it,
+ * and publishes them for other threads, e.g. a MetricsServer, to read
+ * without locks.
+ *
+ * Record() is meant to be called after every update. It only reads the
+ * clock until the sampling interval has passed, so that the observables,
+ * which take a pass over the particles, are not computed every step.
+ */
+class MetricsRecorder {
+ public:
+  /**
+   * @param sample_interval  The least time between snapshots, in seconds
+   */
+  explicit MetricsRecorder(double sample_interval = 0.1);
+
+  /** Takes a snapshot of the simulation if the sampling interval passed */
+  void Record(const Simulator& simulator);
+
+  /** Returns the latest snapshot. Safe to call from any thread. */
+  MetricsSnapshot GetSnapshot() const;
+
+ private:
+  std::chrono::steady_clock::duration sample_interval_;
+  SeqLock<MetricsSnapshot> snapshot_;
+
+  /** The state at the previous snapshot, which rates are measured from */
+  bool has_recorded_;
+  std::chrono::steady_clock::time_point last_time_;
+  uint64_t last_num_steps_;
+  uint64_t last_num_collisions_;
+  double initial_energy_;
+};
+
+/**
+ * Formats a snapshot in the Prometheus text exposition format, with every
+ * metric named with an "idealgas_" prefix
+ */
+std::string FormatPrometheus(const MetricsSnapshot& snapshot);
+
+}  // namespace idealgas
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "core/metrics.h"
+
+namespace idealgas {
+
+/**
+ * A minimal HTTP server on localhost which serves the latest snapshot of a
+ * MetricsRecorder at /metrics in the Prometheus text format, e.g. for
+ *
+ *   curl http://localhost:9100/metrics
+ *
+ * Requests are answered one at a time on the server's own thread, which only
+ * reads the recorder's published snapshot, so scrapes never hold up the
+ * simulation.
+ */
+class MetricsServer {
+ public:
+  /**
+   * Starts listening on 127.0.0.1.
+   *
+   * @param recorder  The recorder whose snapshots are served, which must
+   *                  outlive the server
+   * @param port      The port to listen on, or 0 for any free port
+   * @throws std::runtime_error if the port cannot be listened on
+   */
+  MetricsServer(const MetricsRecorder& recorder, uint16_t port);
+
+  /** Stops listening and joins the server's thread */
+  ~MetricsServer();
+
+  MetricsServer(const MetricsServer&) = delete;
+  MetricsServer& operator=(const MetricsServer&) = delete;
+
+  /** Returns the port the server listens on */
+  uint16_t GetPort() const;
+
+ private:
+  const MetricsRecorder& recorder_;
+  int socket_;
+  uint16_t port_;
+  std::atomic<bool> is_stopping_;
+  std::thread thread_;
+
+  /** Accepts and answers connections until the server is stopped */
+  void Serve();
+
+  /** Reads one request from a connection and writes its response */
+  void Respond(int connection);
+};
+
+}  // namespace idealgas
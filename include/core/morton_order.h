@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/particle.h"
+#include "core/shared_chunked_vector.h"
+
+namespace idealgas {
+
+/**
+ * Interleaves the bits of two 16-bit coordinates into a 32-bit Morton code,
+ * with the bits of x in the even positions and the bits of y in the odd
+ * positions. Sorting by Morton code orders points along a Z-shaped
+ * space-filling curve, so points that are close in the sorted order are close
+ * on the plane.
+ */
+uint32_t EncodeMorton(uint32_t x, uint32_t y);
+
+/**
+ * Interleaves the bits of three 10-bit coordinates into a 30-bit Morton code,
+ * with the bits of x, y, and z in every third position starting from bits 0,
+ * 1, and 2 respectively.
+ */
+uint32_t EncodeMorton(uint32_t x, uint32_t y, uint32_t z);
+
+/**
+ * Computes the order of particles along a Morton curve over the plane, or
+ * the box of a 3D simulation.
+ *
+ * Positions are quantised to a 65536x65536 lattice in 2D or a 1024x1024x1024
+ * lattice in 3D, and their codes are sorted with a radix sort, so ordering n
+ * particles takes O(n) time. The buffers used for sorting are kept between
+ * calls.
+ */
+class MortonOrder {
+ public:
+  /**
+   * Sorts the specified particles along a Morton curve.
+   *
+   * @param particles  The particles to be ordered, of one of the types in
+   *                   core/particle.h
+   * @param size       The size of the plane along each axis
+   * @return           The indices of the particles in Morton order. Particles
+   *                   with equal codes keep their relative order.
+   */
+  template <typename ParticleType>
+  const std::vector<size_t>& Compute(
+      const ChunkedView<ParticleType>& particles,
+      const typename ParticleType::PreciseVector& size);
+
+  /** Sorts particles held in a std::vector along a Morton curve */
+  template <typename ParticleType>
+  const std::vector<size_t>& Compute(
+      const std::vector<ParticleType>& particles,
+      const typename ParticleType::PreciseVector& size) {
+    return Compute(ChunkedView<ParticleType>(particles), size);
+  }
+
+ private:
+  std::vector<uint32_t> codes_;
+  std::vector<uint32_t> sorted_codes_;
+  std::vector<size_t> order_;
+  std::vector<size_t> sorted_order_;
+
+  /** Sorts order_ by codes_ */
+  void SortCodes();
+};
+
+}  // namespace idealgas
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "cinder/gl/gl.h"
+
+namespace idealgas {
+
+/**
+ * A static obstacle: every point within thickness of the segment from start
+ * to end. Line segments have no thickness and fixed discs are segments whose
+ * ends are both at the disc's center.
+ */
+struct Obstacle {
+  glm::dvec2 start;
+  glm::dvec2 end;
+  double thickness;
+};
+
+/**
+ * A set of static obstacles which particles bounce off of.
+ *
+ * The obstacles are stored in a bounding volume hierarchy, a binary tree of
+ * axis-aligned boxes, so finding the obstacles touching a particle takes time
+ * logarithmic in the number of obstacles.
+ */
+class ObstacleSet {
+ public:
+  /** Methods to add obstacles, which take effect at the next Build() */
+  void AddSegment(const glm::dvec2& start, const glm::dvec2& end);
+  void AddDisc(const glm::dvec2& center, double radius);
+  /** Adds the edges of a closed polygon with the specified vertices */
+  void AddPolygon(const std::vector<glm::dvec2>& vertices);
+
+  /** Builds the hierarchy over the obstacles added so far */
+  void Build();
+
+  /**
+   * Parses a set of obstacles, one per line, where '#' begins a comment:
+   *
+   *   segment x1 y1 x2 y2
+   *   disc x y radius
+   *   polygon x1 y1 x2 y2 x3 y3 ...
+   *
+   * @return  The obstacles, with the hierarchy built
+   * @throws std::invalid_argument if the input is malformed
+   */
+  static ObstacleSet Parse(std::istream& input);
+
+  /**
+   * Reads and parses a file of obstacles.
+   *
+   * @throws std::runtime_error if the file cannot be read
+   * @throws std::invalid_argument if the file is malformed
+   */
+  static ObstacleSet Load(const std::string& path);
+
+  /**
+   * Reflects the velocity of a particle off of every obstacle it touches and
+   * is moving towards.
+   *
+   * @param position  The position of the particle
+   * @param radius    The radius of the particle
+   * @param velocity  The velocity of the particle, updated in place
+   * @return          True if the particle was reflected
+   */
+  bool Reflect(const glm::dvec2& position, double radius,
+               glm::vec2& velocity) const;
+  bool Reflect(const glm::dvec2& position, double radius,
+               glm::dvec2& velocity) const;
+
+  const std::vector<Obstacle>& GetObstacles() const;
+  bool IsEmpty() const;
+
+ private:
+  /**
+   * A node of the hierarchy. Leaves hold a range of obstacles_, and inner
+   * nodes hold the index of their second child, the first child being the
+   * next node.
+   */
+  struct Node {
+    glm::dvec2 min;
+    glm::dvec2 max;
+    size_t first;
+    size_t count;
+    size_t second_child;
+  };
+
+  static const size_t kMaxLeafSize = 4;
+
+  std::vector<Obstacle> obstacles_;
+  std::vector<Node> nodes_;
+
+  /** Builds the subtree over obstacles_[first, first + count) */
+  void BuildNode(size_t first, size_t count);
+
+  /** Reflect(), in the precision of the velocity */
+  template <typename T>
+  bool ReflectVelocity(const glm::dvec2& position, double radius,
+                       glm::tvec2<T>& velocity) const;
+};
+
+}  // namespace idealgas
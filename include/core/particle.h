@@ -3,29 +3,53 @@
 #include <string>
 
 #include "cinder/gl/gl.h"
+#include "core/vector.h"
 
 namespace idealgas {
 
 /**
  * A representation of a gas particle with radius, position, and velocity.
+ *
+ * @tparam Dim     The number of dimensions the particle moves in, 2 or 3
+ * @tparam Scalar  The precision the velocity is stored in. Float halves the
+ *                 memory the collision pass streams through, while double
+ *                 keeps long runs from drifting. Positions are always stored
+ *                 in double precision, see GetPrecisePosition().
  */
-class Particle {
+template <int Dim, typename Scalar>
+class BasicParticle {
  public:
+  static const int kDimensions = Dim;
+  typedef Scalar ScalarType;
+
+  /** The vector types of the particle's velocity and position */
+  typedef Vec<Dim, Scalar> Vector;
+  typedef Vec<Dim, double> PreciseVector;
+
   /**
    * Creates a new gas particle.
    *
    * @param radius    The radius of the particle.
    * @param mass      The mass of the particle.
-   * @param position  A 2D vector representing the particle's current position.
-   * @param velocity  A 2D vector representing the particle's current velocity.
+   * @param position  A vector representing the particle's current position.
+   * @param velocity  A vector representing the particle's current velocity.
    * @param color     A Cinder Color object representing the particle's color.
    */
-  Particle(double radius, double mass, const glm::vec2& position,
-           const glm::vec2& velocity, const ci::Color& color);
+  BasicParticle(double radius, double mass, const Vec<Dim, float>& position,
+                const Vector& velocity, const ci::Color& color);
 
   /** Constructor for when color is not needed, e.g. not using Cinder */
-  Particle(double radius, double mass, const glm::vec2& position,
-           const glm::vec2& velocity);
+  BasicParticle(double radius, double mass, const Vec<Dim, float>& position,
+                const Vector& velocity);
+
+  /**
+   * Constructors taking a double precision position, for positions too far
+   * from the origin to be held accurately by a float.
+   */
+  BasicParticle(double radius, double mass, const PreciseVector& position,
+                const Vector& velocity, const ci::Color& color);
+  BasicParticle(double radius, double mass, const PreciseVector& position,
+                const Vector& velocity);
 
   /**
    * Updates the position of the object by a unit of time based on its current
@@ -33,22 +57,58 @@ class Particle {
    */
   void UpdatePosition();
 
-  bool operator==(const Particle& other) const;
+  /** Updates the position of the object by the specified amount of time */
+  void UpdatePosition(double duration);
+
+  bool operator==(const BasicParticle& other) const;
 
   /** Necessary getters and setters */
-  const glm::vec2& GetPosition() const;
-  const glm::vec2& GetVelocity() const;
+  Vec<Dim, float> GetPosition() const;
+  /**
+   * Returns the position at the precision it is stored in. Positions are
+   * stored in double precision so that particles far from the origin still
+   * move by their velocity accurately.
+   */
+  const PreciseVector& GetPrecisePosition() const;
+  const Vector& GetVelocity() const;
   double GetRadius() const;
   double GetMass() const;
   const ci::Color& GetColor() const;
-  void SetVelocity(const glm::vec2& velocity);
+  void SetVelocity(const Vector& velocity);
+  void SetPosition(const PreciseVector& position);
+
+  /**
+   * The block time step level of the particle, which is updated every
+   * 2^level steps of a simulation with block time steps, see
+   * BasicSimulator::SetBlockTimeSteps(). 0 unless the simulation says
+   * otherwise, and not compared by operator==.
+   */
+  int GetTimeStepLevel() const;
+  void SetTimeStepLevel(int level);
 
  private:
   double radius_;
   double mass_;
-  glm::vec2 position_;
-  glm::vec2 velocity_;
+  PreciseVector position_;
+  Vector velocity_;
   ci::Color color_;
+  int time_step_level_;
 };
 
-}  // namespace idealgas
\ No newline at end of file
+/** A particle of the 2D simulation, which the app draws */
+typedef BasicParticle<2, float> Particle;
+
+/** A particle of a 3D hard-sphere gas */
+typedef BasicParticle<3, float> Particle3d;
+
+/** Particles whose velocities are stored in double precision */
+typedef BasicParticle<2, double> PreciseParticle;
+typedef BasicParticle<3, double> PreciseParticle3d;
+
+/* Every combination is compiled once in particle.cc */
+extern template class BasicParticle<2, float>;
+extern template class BasicParticle<3, float>;
+extern template class BasicParticle<2, double>;
+extern template class BasicParticle<3, double>;
+
+}  // namespace idealgas
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/particle.h"
+#include "core/shared_chunked_vector.h"
+
+namespace idealgas {
+
+/**
+ * Identifies a particle in a BasicParticleStore for as long as it is stored,
+ * regardless of where it is moved to in memory.
+ *
+ * A handle is made up of the slot the particle occupies and the generation of
+ * that slot. Slots are reused once their particle is removed, but their
+ * generation is bumped, so stale handles never refer to a different particle.
+ */
+struct ParticleHandle {
+  uint32_t slot;
+  uint32_t generation;
+
+  bool operator==(const ParticleHandle& other) const;
+  bool operator!=(const ParticleHandle& other) const;
+};
+
+/**
+ * A slot map of particles of one of the types in core/particle.h.
+ *
+ * Particles are stored contiguously so that the simulation can loop over them
+ * quickly. A table of slots maps each handle to the particle's index, so that
+ * particles can be inserted and removed in O(1) time: a removed particle is
+ * replaced by the last particle, and only the moved particle's slot changes.
+ *
+ * Copies of a store can share its memory, see Share().
+ */
+template <typename ParticleType>
+class BasicParticleStore {
+ public:
+  BasicParticleStore() = default;
+  BasicParticleStore(const BasicParticleStore& other);
+  BasicParticleStore& operator=(const BasicParticleStore& other);
+
+  /**
+   * Adds a particle to the end of the store.
+   *
+   * @return  The handle of the new particle
+   */
+  ParticleHandle Insert(const ParticleType& particle);
+
+  /**
+   * Removes the particle with the specified handle by moving the last
+   * particle into its place.
+   *
+   * @return  False if the handle does not refer to a stored particle
+   */
+  bool Remove(const ParticleHandle& handle);
+
+  /** Removes every particle. Handles given out before are invalidated. */
+  void Clear();
+
+  /** Reserves memory for the specified number of particles */
+  void Reserve(size_t num_particles);
+
+  /** Returns true if the handle refers to a stored particle */
+  bool Contains(const ParticleHandle& handle) const;
+
+  /**
+   * Returns the particle with the specified handle.
+   *
+   * @throws std::out_of_range if the handle does not refer to a stored
+   *         particle
+   */
+  const ParticleType& Get(const ParticleHandle& handle) const;
+
+  /** Returns the handle of the particle stored at the specified index */
+  ParticleHandle GetHandle(size_t index) const;
+
+  /** Returns the index of the particle with the specified handle */
+  size_t GetIndex(const ParticleHandle& handle) const;
+
+  /**
+   * Returns the stored particles in their storage order. Reading them never
+   * copies them, even if the store is shared.
+   */
+  ChunkedView<ParticleType> GetParticles() const;
+
+  /**
+   * Returns the particle at the specified index so that it can be updated in
+   * place. If the store is shared, the chunk holding the particle is copied
+   * first, so references to particles obtained before may no longer be up
+   * to date.
+   */
+  ParticleType& GetMutable(size_t index);
+
+  size_t Size() const;
+
+  /**
+   * Rearranges the particles such that the particle at index order[i] moves
+   * to index i. Handles keep referring to the same particles.
+   *
+   * @param order  A permutation of the indices of the stored particles
+   */
+  void Permute(const std::vector<size_t>& order);
+
+  /**
+   * Moves the particles and the slot tables into chunks which copies of the
+   * store share until one of them writes to a chunk, so that many copies of
+   * a large store take up little more memory than one. Reading a shared
+   * store copies nothing, and writing to it copies only the chunks written
+   * to. Copies may be used from separate threads.
+   *
+   * Until Share() is first called, everything is stored contiguously, so
+   * that a store which is never shared pays nothing for it.
+   */
+  void Share();
+
+  /** Returns the bytes taken up by the store which no copy shares */
+  size_t GetUnsharedMemoryUsage() const;
+
+ private:
+  struct Slot {
+    /** The index of the slot's particle, if it has one */
+    size_t index;
+    uint32_t generation;
+  };
+
+  SharedChunkedVector<ParticleType> particles_;
+
+  /** The slot of the particle at each index */
+  SharedChunkedVector<uint32_t> particle_slots_;
+  SharedChunkedVector<Slot> slots_;
+
+  /** Slots without a particle, reused before new slots are created */
+  std::vector<uint32_t> free_slots_;
+
+  /** Buffers reused between permutations */
+  std::vector<ParticleType> permuted_particles_;
+  std::vector<uint32_t> permuted_slots_;
+};
+
+typedef BasicParticleStore<Particle> ParticleStore;
+
+/* Compiled once in particle_store.cc for each type of particle */
+extern template class BasicParticleStore<Particle>;
+extern template class BasicParticleStore<Particle3d>;
+extern template class BasicParticleStore<PreciseParticle>;
+extern template class BasicParticleStore<PreciseParticle3d>;
+
+}  // namespace idealgas
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "core/simulator.h"
+
+namespace idealgas {
+
+/**
+ * How well a simulator of one precision conserves energy and momentum over a
+ * run, and how fast it runs.
+ */
+struct DriftReport {
+  /** The name of the precision, e.g. "float" or "double" */
+  std::string precision;
+  size_t num_particles;
+  size_t num_steps;
+  double seconds_per_step;
+
+  /**
+   * The largest and the final change in the kinetic energy of the gas,
+   * relative to its initial energy
+   */
+  double max_energy_drift;
+  double final_energy_drift;
+
+  /**
+   * The largest change in the magnitude of the total momentum, relative to
+   * the sum of the magnitudes of the particles' momenta
+   */
+  double max_momentum_drift;
+};
+
+/**
+ * Simulates a periodic plane of random particles, which conserves energy and
+ * momentum exactly but for rounding, and measures how far both drift.
+ *
+ * @tparam SimulatorType  Simulator or PreciseSimulator
+ * @param precision       The name of the precision, copied to the report
+ * @param num_particles   The number of random particles of each size
+ * @param num_steps       The number of updates to be simulated
+ * @param seed            The seed of the random particles, so that runs of
+ *                        different precisions start from the same gas
+ */
+template <typename SimulatorType>
+DriftReport MeasureDrift(const std::string& precision, size_t num_particles,
+                         size_t num_steps, uint32_t seed);
+
+extern template DriftReport MeasureDrift<Simulator>(const std::string&,
+                                                    size_t, size_t, uint32_t);
+extern template DriftReport MeasureDrift<PreciseSimulator>(const std::string&,
+                                                           size_t, size_t,
+                                                           uint32_t);
+
+/** Writes the reports as a table with a row per report */
+void WriteDriftReports(const std::vector<DriftReport>& reports,
+                       std::ostream& output);
+
+}  // namespace idealgas
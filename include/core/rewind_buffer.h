@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "core/simulator.h"
+
+namespace idealgas {
+
+/**
+ * A bounded history of a simulation, which can be scrubbed through and
+ * continued from any point it holds.
+ *
+ * Every few steps the simulation is captured. Most captures are compact
+ * previews: positions quantized to 16 bits across the plane and velocities
+ * to 16 bits of the frame's fastest component, enough to be drawn but not to
+ * be continued from. Every few captures is instead a keyframe, an exact
+ * checkpoint with each particle's radius, mass, and color replaced by an
+ * index into the few kinds of particle the simulation holds. Continuing from
+ * a capture restores the keyframe at or before it and updates the simulation
+ * forward to the capture's step, which reproduces it exactly.
+ *
+ * Once the captures outgrow the memory budget, the oldest keyframe is
+ * dropped along with the previews which depend on it, so memory stays
+ * bounded however long the simulation runs.
+ */
+class RewindBuffer {
+ public:
+  /**
+   * @param capture_interval   The number of updates between captures
+   * @param keyframe_interval  The number of captures between keyframes
+   * @param memory_budget      The bytes the captures may take up. At least
+   *                           the newest keyframe and its previews are kept
+   *                           regardless.
+   * @throws std::invalid_argument if either interval is 0
+   */
+  RewindBuffer(size_t capture_interval = 4, size_t keyframe_interval = 32,
+               size_t memory_budget = 64 << 20);
+
+  /**
+   * Captures the simulation if capture_interval updates have run since the
+   * last capture. Meant to be called after every update.
+   */
+  void Record(const Simulator& simulator);
+
+  /**
+   * Captures a keyframe of the simulation now. Must be called after any
+   * change to the simulation other than an update, e.g. adding particles,
+   * since continuing from earlier keyframes would not repeat the change.
+   */
+  void RecordKeyframe(const Simulator& simulator);
+
+  /** Discards every capture */
+  void Clear();
+
+  /** Returns the number of captures held, the oldest at index 0 */
+  size_t GetNumCaptures() const;
+
+  /** Returns the number of updates the simulation had run at a capture */
+  size_t GetStep(size_t index) const;
+
+  /** Returns the bytes the captures take up */
+  size_t GetMemoryUsage() const;
+
+  /**
+   * Replaces the particles of a simulation with those of a capture, to show
+   * it. The simulation must not be updated from this state; see Restore().
+   */
+  void Preview(size_t index, Simulator& simulator) const;
+
+  /**
+   * Returns a simulation with the same settings as the captured one to its
+   * exact state at a capture, and discards the captures after it, so that
+   * recording continues from there.
+   */
+  void Restore(size_t index, Simulator& simulator);
+
+ private:
+  /** The attributes shared by every particle of one kind */
+  struct ParticleKind {
+    double radius;
+    double mass;
+    ci::Color color;
+  };
+
+  struct Capture {
+    size_t step;
+    bool is_keyframe;
+    std::vector<ParticleKind> kinds;
+    std::vector<uint16_t> kind_indices;
+
+    /**
+     * Keyframes: exact particles, and the rest of the checkpoint, which is
+     * held apart as its random generator state alone is kilobytes
+     */
+    std::vector<glm::dvec2> positions;
+    std::vector<glm::vec2> velocities;
+    std::vector<uint8_t> time_step_levels;
+    std::unique_ptr<Simulator::Checkpoint> checkpoint;
+
+    /** Previews: two values per particle, an x and a y */
+    std::vector<uint16_t> quantized_positions;
+    std::vector<int16_t> quantized_velocities;
+    glm::dvec2 plane_size;
+    double velocity_scale;
+
+    size_t memory_usage;
+  };
+
+  size_t capture_interval_;
+  size_t keyframe_interval_;
+  size_t memory_budget_;
+
+  std::deque<Capture> captures_;
+  size_t memory_usage_;
+  size_t num_captures_since_keyframe_;
+
+  /** Captures the simulation and drops old captures past the budget */
+  void Add(const Simulator& simulator, bool is_keyframe);
+
+  /** Fills in the kinds of a capture's particles */
+  static void IndexKinds(const ChunkedView<Particle>& particles,
+                         Capture& capture);
+  static bool IsKind(const ParticleKind& kind, const Particle& particle);
+
+  static size_t ComputeMemoryUsage(const Capture& capture);
+};
+
+}  // namespace idealgas
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace idealgas {
+
+/**
+ * A value which one thread publishes and any number of threads read without
+ * locks.
+ *
+ * The value is stored as atomic words next to a sequence number, which the
+ * writer makes odd while it stores the words and even again after. Readers
+ * copy the words and keep the copy only if the sequence number was even and
+ * unchanged around it. Storing never waits for readers, so the writer can
+ * publish from a hot loop, while a reader which races a store retries.
+ *
+ * @tparam T  A trivially copyable type
+ */
+template <typename T>
+class SeqLock {
+ public:
+  SeqLock() : sequence_(0) {
+    for (std::atomic<uint64_t>& word : words_) {
+      word.store(0, std::memory_order_relaxed);
+    }
+    Store(T());
+  }
+
+  /** Publishes a new value. Must only be called from one thread at a time. */
+  void Store(const T& value) {
+    std::array<uint64_t, kNumWords> bits;
+    bits.fill(0);
+    std::memcpy(bits.data(), &value, sizeof(T));
+
+    uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kNumWords; i++) {
+      words_[i].store(bits[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  /** Returns the last value published, retrying while a store is underway */
+  T Load() const {
+    std::array<uint64_t, kNumWords> bits;
+    uint64_t sequence;
+    do {
+      sequence = sequence_.load(std::memory_order_acquire);
+      for (size_t i = 0; i < kNumWords; i++) {
+        bits[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (sequence % 2 == 1 ||
+             sequence_.load(std::memory_order_relaxed) != sequence);
+
+    T value;
+    std::memcpy(&value, bits.data(), sizeof(T));
+    return value;
+  }
+
+ private:
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock values are copied bitwise");
+  static const size_t kNumWords = (sizeof(T) + 7) / 8;
+
+  std::atomic<uint64_t> sequence_;
+  std::array<std::atomic<uint64_t>, kNumWords> words_;
+};
+
+}  // namespace idealgas
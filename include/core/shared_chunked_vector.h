@@ -0,0 +1,305 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace idealgas {
+
+template <typename T>
+class SharedChunkedVector;
+
+/**
+ * A read-only view of the elements of a std::vector or a SharedChunkedVector,
+ * so that code which only reads elements can walk either without copying
+ * them into one contiguous array.
+ *
+ * A view refers to the storage of what it views, so it is invalidated by
+ * anything which would invalidate a reference into a std::vector. Writes to
+ * single elements of a SharedChunkedVector are seen through the view, even
+ * if they copied the element's chunk.
+ */
+template <typename T>
+class ChunkedView {
+ public:
+  class const_iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T* pointer;
+    typedef const T& reference;
+
+    const_iterator(const ChunkedView* view, size_t index)
+        : view_(view), index_(index) {
+    }
+
+    const T& operator*() const {
+      return (*view_)[index_];
+    }
+    const T* operator->() const {
+      return &(*view_)[index_];
+    }
+    const_iterator& operator++() {
+      index_++;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator previous = *this;
+      index_++;
+      return previous;
+    }
+    bool operator==(const const_iterator& other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    const ChunkedView* view_;
+    size_t index_;
+  };
+
+  /** Views the elements of a std::vector */
+  ChunkedView(const std::vector<T>& values)
+      : flat_(values.data()), chunks_(nullptr), size_(values.size()) {
+  }
+
+  /** Views the elements of a SharedChunkedVector, wherever they are stored */
+  ChunkedView(const SharedChunkedVector<T>& values);
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  const T& operator[](size_t index) const {
+    if (chunks_ == nullptr) {
+      return flat_[index];
+    }
+    return (*chunks_[index >> SharedChunkedVector<T>::kChunkShift])
+        [index & (SharedChunkedVector<T>::kChunkSize - 1)];
+  }
+
+  const_iterator begin() const {
+    return const_iterator(this, 0);
+  }
+
+  const_iterator end() const {
+    return const_iterator(this, size_);
+  }
+
+  /** Copies the elements into a std::vector of their own */
+  operator std::vector<T>() const {
+    std::vector<T> values;
+    values.reserve(size_);
+    values.insert(values.end(), begin(), end());
+    return values;
+  }
+
+  friend bool operator==(const ChunkedView& view1, const ChunkedView& view2) {
+    return view1.size_ == view2.size_ &&
+           std::equal(view1.begin(), view1.end(), view2.begin());
+  }
+
+  friend bool operator!=(const ChunkedView& view1, const ChunkedView& view2) {
+    return !(view1 == view2);
+  }
+
+ private:
+  /** The elements if they are contiguous, otherwise the chunks holding them */
+  const T* flat_;
+  const std::shared_ptr<std::vector<T>>* chunks_;
+  size_t size_;
+};
+
+/**
+ * A vector which copies of it can share, split into fixed-size chunks once
+ * Share() is called. Copies share the chunks until one of them writes to a
+ * chunk, at which point only that chunk is copied. Copying a shared vector is
+ * therefore cheap however large it is, and a copy which changes little of it
+ * takes up little memory of its own.
+ *
+ * Until Share() is first called, the elements are held in one std::vector,
+ * so that a vector which is never shared costs no more to access than one.
+ *
+ * Separate copies can be used from separate threads, as chunks are never
+ * written to while shared. A single copy is no more thread safe than a
+ * std::vector.
+ */
+template <typename T>
+class SharedChunkedVector {
+ public:
+  static const size_t kChunkShift = 12;
+  static const size_t kChunkSize = size_t(1) << kChunkShift;
+
+  SharedChunkedVector() : size_(0), is_chunked_(false) {
+  }
+
+  size_t Size() const {
+    return size_;
+  }
+
+  /** Returns true once the elements are held in chunks, see Share() */
+  bool IsChunked() const {
+    return is_chunked_;
+  }
+
+  const T& operator[](size_t index) const {
+    if (!is_chunked_) {
+      return flat_[index];
+    }
+    return (*chunks_[index >> kChunkShift])[index & (kChunkSize - 1)];
+  }
+
+  /** Returns an element to write to, copying its chunk first if shared */
+  T& GetMutable(size_t index) {
+    if (!is_chunked_) {
+      return flat_[index];
+    }
+    return GetMutableChunk(index >> kChunkShift)[index & (kChunkSize - 1)];
+  }
+
+  void PushBack(const T& value) {
+    if (!is_chunked_) {
+      flat_.push_back(value);
+      size_++;
+      return;
+    }
+
+    size_t chunk = size_ >> kChunkShift;
+    if (chunk == chunks_.size()) {
+      chunks_.push_back(std::make_shared<std::vector<T>>());
+      chunks_.back()->reserve(kChunkSize);
+    }
+    GetMutableChunk(chunk).push_back(value);
+    size_++;
+  }
+
+  /**
+   * Removes the last element. Emptied chunks are kept for the next elements
+   * pushed, so that a vector which shrinks and grows does not allocate.
+   */
+  void PopBack() {
+    size_--;
+    if (!is_chunked_) {
+      flat_.pop_back();
+    } else {
+      GetMutableChunk(size_ >> kChunkShift).pop_back();
+    }
+  }
+
+  /**
+   * Removes every element. A flat vector keeps its memory, while a chunked
+   * one releases its chunks and goes back to being flat, as it no longer
+   * shares anything.
+   */
+  void Clear() {
+    flat_.clear();
+    chunks_.clear();
+    size_ = 0;
+    is_chunked_ = false;
+  }
+
+  /** Reserves memory for the specified number of elements while flat */
+  void Reserve(size_t size) {
+    if (!is_chunked_) {
+      flat_.reserve(size);
+    }
+  }
+
+  /**
+   * Replaces the contents with the specified values. A chunked vector writes
+   * the values over its chunks, copying only the chunks which are shared.
+   */
+  void Assign(const std::vector<T>& values) {
+    if (!is_chunked_) {
+      flat_.assign(values.begin(), values.end());
+      size_ = values.size();
+      return;
+    }
+
+    while (size_ > values.size()) {
+      PopBack();
+    }
+    for (size_t first = 0; first < size_; first += kChunkSize) {
+      size_t last = std::min(first + kChunkSize, size_);
+      std::copy(values.begin() + first, values.begin() + last,
+                GetMutableChunk(first >> kChunkShift).begin());
+    }
+    for (size_t i = size_; i < values.size(); i++) {
+      PushBack(values[i]);
+    }
+  }
+
+  /**
+   * Moves the elements into chunks, so that copies of the vector share them.
+   * The vector stays chunked until it is cleared.
+   */
+  void Share() {
+    if (is_chunked_) {
+      return;
+    }
+    chunks_.reserve((size_ + kChunkSize - 1) >> kChunkShift);
+    for (size_t first = 0; first < size_; first += kChunkSize) {
+      size_t last = std::min(first + kChunkSize, size_);
+      chunks_.push_back(std::make_shared<std::vector<T>>());
+      chunks_.back()->reserve(kChunkSize);
+      chunks_.back()->assign(flat_.begin() + first, flat_.begin() + last);
+    }
+    std::vector<T>().swap(flat_);
+    is_chunked_ = true;
+  }
+
+  /** Returns the bytes taken up by memory which no copy shares */
+  size_t GetUnsharedMemoryUsage() const {
+    size_t usage = flat_.capacity() * sizeof(T) +
+                   chunks_.capacity() * sizeof(chunks_[0]);
+    for (const std::shared_ptr<std::vector<T>>& chunk : chunks_) {
+      if (chunk.use_count() == 1) {
+        usage += chunk->capacity() * sizeof(T);
+      }
+    }
+    return usage;
+  }
+
+ private:
+  friend class ChunkedView<T>;
+
+  /** The elements until the vector is shared, and its chunks after */
+  std::vector<T> flat_;
+  std::vector<std::shared_ptr<std::vector<T>>> chunks_;
+  size_t size_;
+  bool is_chunked_;
+
+  std::vector<T>& GetMutableChunk(size_t chunk) {
+    std::shared_ptr<std::vector<T>>& pointer = chunks_[chunk];
+    if (pointer.use_count() > 1) {
+      std::shared_ptr<std::vector<T>> copy = std::make_shared<std::vector<T>>();
+      copy->reserve(kChunkSize);
+      copy->assign(pointer->begin(), pointer->end());
+      pointer.swap(copy);
+    } else {
+      /* Copies which last read the chunk on other threads have released it,
+         and their reads must happen before this write */
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *pointer;
+  }
+};
+
+template <typename T>
+ChunkedView<T>::ChunkedView(const SharedChunkedVector<T>& values)
+    : flat_(values.flat_.data()),
+      chunks_(values.is_chunked_ ? values.chunks_.data() : nullptr),
+      size_(values.Size()) {
+}
+
+}  // namespace idealgas
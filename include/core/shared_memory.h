@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace idealgas {
+
+/**
+ * A named POSIX shared memory segment mapped into this process, which other
+ * processes can map by name. The mapping is released when the object is
+ * destroyed, and a segment created by this object is also removed, so that
+ * processes which map it later see that it is gone.
+ */
+class SharedMemory {
+ public:
+  /**
+   * Creates a segment of the specified size filled with zeros, replacing any
+   * segment of the same name.
+   *
+   * @param name  The name of the segment, which starts with a '/' and has
+   *              no other slashes, e.g. "/ideal-gas"
+   * @throws std::runtime_error if the segment cannot be created
+   */
+  static SharedMemory Create(const std::string& name, size_t size);
+
+  /**
+   * Maps an existing segment for reading.
+   *
+   * @throws std::runtime_error if there is no segment of that name
+   */
+  static SharedMemory Open(const std::string& name);
+
+  /**
+   * Maps an existing segment for reading and writing, for segments which
+   * both processes write to.
+   *
+   * @throws std::runtime_error if there is no segment of that name
+   */
+  static SharedMemory OpenWritable(const std::string& name);
+
+  SharedMemory(SharedMemory&& other);
+  SharedMemory& operator=(SharedMemory&& other);
+  ~SharedMemory();
+
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+  void* GetData() const;
+  size_t GetSize() const;
+
+ private:
+  SharedMemory(const std::string& name, void* data, size_t size,
+               bool is_owner);
+
+  std::string name_;
+  void* data_;
+  size_t size_;
+  /** True if this object created the segment and removes it */
+  bool is_owner_;
+
+  void Release();
+};
+
+}  // namespace idealgas
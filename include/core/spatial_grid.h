@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+
+#include "core/particle.h"
+#include "core/shared_chunked_vector.h"
+
+namespace idealgas {
+
+/**
+ * A uniform grid of cells over the coordinate plane, or the box of a 3D
+ * simulation, used to find the particles near a position without checking
+ * every particle.
+ *
+ * Particles are bucketed by a counting sort, so the grid stores one index per
+ * particle plus one offset per cell, and rebuilding it reuses its memory.
+ *
+ * @tparam ParticleType  One of the particle types in core/particle.h
+ */
+template <typename ParticleType>
+class BasicSpatialGrid {
+ public:
+  static const int kDim = ParticleType::kDimensions;
+  typedef typename ParticleType::PreciseVector PreciseVector;
+
+  /** Creates an empty grid */
+  BasicSpatialGrid();
+
+  /**
+   * Sorts the specified particles into cells.
+   *
+   * @param particles    The particles to be sorted
+   * @param size         The size of the plane along each axis
+   * @param cell_size    The minimum length of a cell along each axis.
+   *                     Particles closer than this are always in the same or
+   *                     adjacent cells.
+   * @param is_periodic  Whether the plane wraps around at its edges, in which
+   *                     case cells on opposite edges are adjacent
+   */
+  void Build(const ChunkedView<ParticleType>& particles,
+             const PreciseVector& size, double cell_size, bool is_periodic);
+
+  /**
+   * Appends the indices of the particles in the cell containing the specified
+   * position and in the cells adjacent to it, i.e. 3x3 cells in 2D and
+   * 3x3x3 cells in 3D. Every index is appended at most once.
+   */
+  void FindNeighbors(const PreciseVector& position,
+                     std::vector<size_t>& neighbors) const;
+
+  size_t GetNumCells() const;
+
+ private:
+  PreciseVector size_;
+  bool is_periodic_;
+
+  /** The number of cells along each axis */
+  size_t num_cells_[kDim];
+
+  /**
+   * The particles of cell c are cell_particles_[cell_starts_[c]] up to, but not
+   * including, cell_particles_[cell_starts_[c + 1]]
+   */
+  std::vector<size_t> cell_starts_;
+  std::vector<size_t> cell_particles_;
+
+  /** The cell of every particle, kept between the passes of a rebuild */
+  std::vector<size_t> particle_cells_;
+
+  /**
+   * Returns the index of the cell containing a position. Cells are numbered
+   * along the x axis first, then y, then z.
+   */
+  size_t GetCell(const PreciseVector& position) const;
+};
+
+typedef BasicSpatialGrid<Particle> SpatialGrid;
+
+/* Compiled once in spatial_grid.cc for each type of particle */
+extern template class BasicSpatialGrid<Particle>;
+extern template class BasicSpatialGrid<Particle3d>;
+extern template class BasicSpatialGrid<PreciseParticle>;
+extern template class BasicSpatialGrid<PreciseParticle3d>;
+
+}  // namespace idealgas
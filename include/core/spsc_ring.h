@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * A bounded queue between exactly one producer thread and one consumer
+ * thread, which neither of them ever waits on.
+ *
+ * The producer only writes the head and the consumer only writes the tail,
+ * so each side owns one atomic and reads the other's. The two are kept on
+ * separate cache lines so that they do not bounce between the threads' cores
+ * on every push and pop.
+ *
+ * @tparam T  A copyable type
+ */
+template <typename T>
+class SpscRing {
+ public:
+  /**
+   * @param capacity  The most values held at once, rounded up to a power of
+   *                  two
+   */
+  explicit SpscRing(size_t capacity) : head_(0), tail_(0) {
+    size_t size = 1;
+    while (size < capacity) {
+      size *= 2;
+    }
+    slots_.resize(size);
+    mask_ = size - 1;
+  }
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  /**
+   * Adds a value to the ring. Only called from the producer thread.
+   *
+   * @return  False, without adding the value, if the ring is full
+   */
+  bool TryPush(const T& value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) > mask_) {
+      return false;
+    }
+    slots_[head & mask_] = value;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Moves every value in the ring to the end of a vector, oldest first. Only
+   * called from the consumer thread.
+   *
+   * @return  The number of values moved
+   */
+  size_t PopAll(std::vector<T>& output) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    for (size_t i = tail; i != head; i++) {
+      output.push_back(slots_[i & mask_]);
+    }
+    tail_.store(head, std::memory_order_release);
+    return head - tail;
+  }
+
+  size_t GetCapacity() const {
+    return slots_.size();
+  }
+
+ private:
+  static const size_t kCacheLineSize = 64;
+
+  std::vector<T> slots_;
+  size_t mask_;
+  char head_padding_[kCacheLineSize];
+  std::atomic<size_t> head_;
+  char tail_padding_[kCacheLineSize];
+  std::atomic<size_t> tail_;
+  char end_padding_[kCacheLineSize];
+};
+
+}  // namespace idealgas
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <istream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "core/thread_pool.h"
+
+namespace idealgas {
+
+/**
+ * A single simulation run of a parameter sweep.
+ */
+struct SweepJob {
+  double plane_width;
+  double plane_height;
+  size_t num_small;
+  size_t num_medium;
+  size_t num_large;
+  uint32_t seed;
+  size_t num_steps;
+
+  /**
+   * Returns the job's parameters formatted as the leading columns of its row
+   * in the output file. Two jobs are the same run if their keys are equal.
+   */
+  std::string GetKey() const;
+};
+
+/**
+ * A declarative description of a parameter sweep.
+ *
+ * The configuration is read from a text file of `key = value` lines, where
+ * '#' begins a comment. Grid parameters accept a comma separated list of
+ * values and/or `start:stop` or `start:stop:step` ranges (stop inclusive), and
+ * the sweep runs every combination of them:
+ *
+ *   plane_width = 100, 200
+ *   plane_height = 100, 1000
+ *   num_small   = 0:100:25
+ *   num_medium  = 10
+ *   num_large   = 0, 10
+ *   seed        = 1:8
+ *   steps       = 1000
+ *
+ * If plane_height is not given, every plane is square. The scalar parameters
+ * `max_speed` and `speed_bins` describe the speed histograms written for
+ * every job.
+ */
+class SweepConfig {
+ public:
+  /** Creates a configuration of a single job using the default parameters */
+  SweepConfig();
+
+  /**
+   * Parses a configuration.
+   *
+   * @throws std::invalid_argument if the configuration is malformed
+   */
+  static SweepConfig Parse(std::istream& input);
+
+  /**
+   * Reads and parses a configuration file.
+   *
+   * @throws std::runtime_error if the file cannot be read
+   * @throws std::invalid_argument if the configuration is malformed
+   */
+  static SweepConfig Load(const std::string& path);
+
+  /** Expands the parameter grids into every combination of parameters */
+  std::vector<SweepJob> ExpandJobs() const;
+
+  double GetMaxSpeed() const;
+  size_t GetNumSpeedBins() const;
+
+ private:
+  std::vector<double> plane_widths_;
+  /** Empty if the plane height should match the plane width */
+  std::vector<double> plane_heights_;
+  std::vector<size_t> nums_small_;
+  std::vector<size_t> nums_medium_;
+  std::vector<size_t> nums_large_;
+  std::vector<uint32_t> seeds_;
+  std::vector<size_t> nums_steps_;
+  double max_speed_;
+  size_t num_speed_bins_;
+};
+
+/**
+ * Runs the jobs of a parameter sweep in parallel and writes a row of
+ * observables per job to a CSV file.
+ *
+ * Rows are appended and flushed as soon as their job finishes, so an
+ * interrupted sweep can be restarted with the same output file and will only
+ * run the jobs that are missing from it.
+ */
+class SweepDriver {
+ public:
+  /**
+   * @param config       The sweep to be run
+   * @param output_path  The CSV file the results are appended to
+   */
+  SweepDriver(const SweepConfig& config, const std::string& output_path);
+
+  /**
+   * Runs every job that does not already have a row in the output file.
+   *
+   * @param pool  The thread pool the jobs are scheduled on
+   * @return      The number of jobs that were run
+   * @throws std::runtime_error if the output file cannot be written or holds
+   *         results of a sweep with different columns
+   */
+  size_t Run(ThreadPool& pool);
+
+  /** Returns the column names of the output file */
+  std::vector<std::string> GetColumns() const;
+
+  /**
+   * Returns the keys of the jobs that already have a complete row in the
+   * output file.
+   */
+  std::set<std::string> LoadCompletedJobs() const;
+
+ private:
+  SweepConfig config_;
+  std::string output_path_;
+
+  /**
+   * Reads the complete rows of the output file, skipping its header.
+   * Incomplete rows, e.g. the last row of a killed run, are skipped.
+   *
+   * @param rows  Filled with the complete rows
+   * @return      False if the file has rows that were skipped
+   * @throws std::runtime_error if the header does not match GetColumns()
+   */
+  bool ReadCompleteRows(std::vector<std::string>& rows) const;
+
+  /** Simulates the specified job and formats its row of the output file */
+  std::string RunJob(const SweepJob& job) const;
+};
+
+}  // namespace idealgas
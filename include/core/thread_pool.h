@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * A fixed-size pool of worker threads with work stealing.
+ *
+ * Every worker owns a queue of tasks. A worker takes tasks from the back of
+ * its own queue and, once that runs dry, steals from the front of the other
+ * workers' queues, so long-running tasks do not leave cores idle.
+ */
+class ThreadPool {
+ public:
+  /**
+   * Creates a thread pool and starts its workers.
+   *
+   * @param num_threads  The number of worker threads, defaults to the number
+   *                     of hardware threads available
+   */
+  explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency());
+
+  /** Waits for the remaining tasks to finish and joins the workers */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * Schedules a task to be run by one of the workers. Tasks submitted from a
+   * worker thread are placed on that worker's own queue.
+   */
+  void Submit(const std::function<void()>& task);
+
+  /**
+   * Blocks until every submitted task has finished. If any task threw an
+   * exception, the first one thrown is rethrown here.
+   */
+  void Wait();
+
+  size_t GetNumThreads() const;
+
+  /**
+   * Returns the index of the pool worker running the calling thread, or
+   * kNotAWorker if it is called from outside of a pool.
+   */
+  static size_t GetWorkerIndex();
+  static const size_t kNotAWorker = static_cast<size_t>(-1);
+
+ private:
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::vector<std::thread> workers_;
+
+  /** Guards the counters below and is used to park idle workers */
+  std::mutex mutex_;
+  std::condition_variable has_work_;
+  std::condition_variable all_done_;
+  size_t num_queued_;
+  size_t num_unfinished_;
+  bool is_stopping_;
+  std::exception_ptr first_exception_;
+
+  /** Used to spread tasks submitted from outside the pool over the queues */
+  std::atomic<size_t> next_queue_;
+
+  void RunWorker(size_t index);
+
+  /**
+   * Takes a task from the specified worker's own queue, or steals one from
+   * another worker if it is empty.
+   *
+   * @return True if a task was found, false otherwise
+   */
+  bool TryPopTask(size_t index, std::function<void()>& task);
+};
+
+}  // namespace idealgas
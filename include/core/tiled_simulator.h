@@ -0,0 +1,187 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/mapped_file.h"
+
+namespace idealgas {
+
+/** A particle as stored in the tile files of a TiledSimulator */
+struct TiledParticle {
+  double x;
+  double y;
+  float vx;
+  float vy;
+  /** 0 for small, 1 for medium, or 2 for large, as in particle files */
+  uint32_t species;
+  uint32_t reserved;
+};
+
+/**
+ * An out-of-core simulation of the same gas as Simulator, between walls on
+ * every edge, for more particles than fit in memory.
+ *
+ * The plane is divided into a grid of tiles, each of which keeps its
+ * particles in a file of its own. An update streams through the tiles row by
+ * row, mapping each tile together with the neighbors whose particles it can
+ * collide with, and keeps at most max_resident_tiles mapped at once. The
+ * kernel pages the mapped tiles in and out of memory as they are used, and
+ * a background thread reads the next tiles into the page cache while the
+ * current ones are updated, so that updates are bounded by the speed of the
+ * disk rather than by the size of memory.
+ *
+ * Every pair of particles is resolved once, by the tile which comes first of
+ * the pair's tiles, and a tile's particles are moved as soon as it has been
+ * resolved, since no later tile collides with them. Particles which move
+ * into another tile are appended to its file at the next update, so that no
+ * particle is moved twice in one update. Results only differ from those of
+ * Simulator in the order in which collisions are resolved.
+ */
+class TiledSimulator {
+ public:
+  /**
+   * Creates an empty simulation whose tiles are stored in the specified
+   * directory. Tile files of an earlier simulation in the directory are
+   * overwritten, and the files are removed when the simulation is destroyed.
+   *
+   * @param directory           An existing directory for the tile files
+   * @param plane_width         The size of the plane
+   * @param plane_height
+   * @param num_columns         The number of tiles across the plane
+   * @param num_rows            The number of tiles up the plane
+   * @param max_resident_tiles  The most tiles mapped into memory at once
+   * @throws std::invalid_argument if a tile is narrower than
+   *         kInteractionRange, or max_resident_tiles is less than the
+   *         kStencilSize tiles updated together
+   * @throws std::runtime_error if the tile files cannot be created
+   */
+  TiledSimulator(const std::string& directory, double plane_width,
+                 double plane_height, size_t num_columns, size_t num_rows,
+                 size_t max_resident_tiles = 64);
+
+  /** Stops the prefetching thread and removes the tile files */
+  ~TiledSimulator();
+
+  TiledSimulator(const TiledSimulator&) = delete;
+  TiledSimulator& operator=(const TiledSimulator&) = delete;
+
+  /**
+   * Adds a particle to the tile at its position. Particles are written to
+   * the tile's file in batches, so that populations larger than memory can
+   * be added before the first update.
+   *
+   * @throws std::invalid_argument if the particle is not on the plane or
+   *         its species is not 0, 1, or 2
+   */
+  void AddParticle(const TiledParticle& particle);
+
+  /** Updates the particles' positions and velocities by one step */
+  void Update();
+
+  /**
+   * Calls a function with every particle, mapping one tile at a time and
+   * reading the next tiles ahead as an update does
+   */
+  void ForEachParticle(const std::function<void(const TiledParticle&)>& f);
+
+  /** Returns the total kinetic energy of all of the particles */
+  double GetKineticEnergy();
+
+  size_t GetNumParticles() const;
+  size_t GetNumSteps() const;
+
+  /** Returns the most tiles which have been mapped into memory at once */
+  size_t GetPeakResidentTiles() const;
+
+  /**
+   * The distance within which particles can collide, the sum of the radii
+   * of two large particles. Tiles must be at least this wide and tall, so
+   * that particles only collide with those of neighboring tiles.
+   */
+  static constexpr double kInteractionRange = 3;
+
+  /** A tile and the neighbors it resolves pairs with */
+  static const size_t kStencilSize = 5;
+
+ private:
+  /** A tile mapped into memory */
+  struct ResidentTile {
+    size_t tile;
+    MappedFile file;
+    /** The number of particles in the tile, which shrinks as they leave */
+    size_t num_particles;
+    size_t last_use;
+  };
+
+  /** An entry of the collision grid: a tile of the stencil and a particle */
+  struct GridEntry {
+    uint32_t member;
+    uint32_t index;
+  };
+
+  std::string directory_;
+  double plane_width_;
+  double plane_height_;
+  size_t num_columns_;
+  size_t num_rows_;
+  double tile_width_;
+  double tile_height_;
+  size_t max_resident_tiles_;
+
+  /** The number of particles in each tile's file */
+  std::vector<size_t> tile_sizes_;
+  /** Particles to be appended to each tile at the next update */
+  std::vector<std::vector<TiledParticle>> arrivals_;
+
+  std::vector<ResidentTile> resident_tiles_;
+  size_t num_uses_;
+  size_t peak_resident_tiles_;
+  size_t num_steps_;
+
+  /** The collision grid of the current stencil, reused between tiles */
+  std::vector<uint32_t> cell_starts_;
+  std::vector<GridEntry> cell_entries_;
+
+  /** Tiles for the prefetching thread to read ahead */
+  std::thread prefetch_thread_;
+  std::mutex prefetch_mutex_;
+  std::condition_variable prefetch_condition_;
+  std::deque<size_t> prefetch_queue_;
+  bool is_stopping_;
+
+  std::string GetTilePath(size_t tile) const;
+
+  /** Returns the tile at a position, clamped to the plane */
+  size_t GetTile(double x, double y) const;
+
+  /** Appends the arrived particles to their tiles' files */
+  void WriteArrivals();
+
+  /**
+   * Maps a tile if it is not already, unmapping the least recently used
+   * tile outside the stencil if need be.
+   *
+   * @return  The index of the tile in resident_tiles_
+   */
+  size_t MapTile(size_t tile, const size_t* stencil, size_t stencil_size);
+
+  /** Unmaps every tile, truncating the files of tiles particles left */
+  void UnmapTiles();
+  void UnmapTile(ResidentTile& resident_tile);
+
+  /** Resolves the collisions of a tile's particles and moves them */
+  void UpdateTile(size_t tile);
+
+  /** Asks the prefetching thread to read a tile ahead */
+  void Prefetch(size_t tile);
+  void RunPrefetcher();
+};
+
+}  // namespace idealgas
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "cinder/gl/gl.h"
+
+namespace idealgas {
+
+/**
+ * Maps a number of dimensions to the glm vector type with that many
+ * components, so that code can be written once for the 2D and 3D simulations
+ * while each still uses its own fixed-size vectors.
+ */
+template <int Dim, typename T>
+struct VectorTraits;
+
+template <typename T>
+struct VectorTraits<2, T> {
+  typedef glm::tvec2<T> Type;
+};
+
+template <typename T>
+struct VectorTraits<3, T> {
+  typedef glm::tvec3<T> Type;
+};
+
+/** The Dim-dimensional vector with components of type T */
+template <int Dim, typename T>
+using Vec = typename VectorTraits<Dim, T>::Type;
+
+/** The number of components of a glm vector type */
+template <typename Vector>
+struct VectorSize;
+
+template <typename T>
+struct VectorSize<glm::tvec2<T>> {
+  static const int value = 2;
+};
+
+template <typename T>
+struct VectorSize<glm::tvec3<T>> {
+  static const int value = 3;
+};
+
+}  // namespace idealgas
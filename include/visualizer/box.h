@@ -1,9 +1,13 @@
 #pragma once
 
 #include <cinder/app/KeyEvent.h>
+#include <memory>
 
 #include "cinder/gl/gl.h"
 #include "core/simulator.h"
+#include "core/thread_pool.h"
+#include "visualizer/density_heatmap.h"
+#include "visualizer/particle_instances.h"
 
 namespace idealgas {
 
@@ -19,13 +23,34 @@ class Box {
    * @param Simulator        A reference to a simulator used to draw data from
    * @param top_left_corner  The screen coordinates for fhe top left corner of
    *                         the box
-   * @param box_length       The length the box should be drawn, in pixels
+   * @param box_length       The length of the longer side of the box, in
+   *                         pixels. The shorter side is scaled to match the
+   *                         proportions of the simulator's plane.
    */
   Box(Simulator& simulator, const glm::vec2& top_left_corner,
       const double box_length);
 
-  /** Cinder-related methods */
-  void Draw() const;
+  /**
+   * Creates the shader and buffers the particles are drawn with. Requires the
+   * app's GL context, so it is called from the app's setup().
+   */
+  void Setup();
+
+  /**
+   * Sets the number of particles from which they are drawn as a density
+   * heatmap, one pixel per cell, instead of as circles. The heatmap is only
+   * used while particles are too small on screen to be told apart anyway.
+   */
+  void SetHeatmapThreshold(size_t num_particles);
+
+  /**
+   * Draws the parts of the box which do not change between frames, i.e. the
+   * plane and its border, which the app renders once and caches
+   */
+  void DrawStaticLayer() const;
+
+  /** Draws the obstacles and particles over the static layer */
+  void Draw();
 
   /**
    * Returns the number of particles currently being drawn to the application
@@ -37,9 +62,42 @@ class Box {
   double box_length_;
   Simulator& simulator_;
 
+  /**
+   * Every particle is drawn by one instanced draw call of a unit square,
+   * which the shader turns into a disc with a black outline. The instances
+   * are rebuilt on the CPU and uploaded to instance_buffer_ each frame.
+   */
+  ParticleInstanceBuilder instance_builder_;
+  ci::gl::VboRef instance_buffer_;
+  ci::gl::BatchRef particle_batch_;
+
+  /**
+   * Large populations of small particles are instead splatted into heatmap_
+   * by the workers of heatmap_pool_, and its image is uploaded to
+   * heatmap_texture_ and drawn over the box
+   */
+  size_t heatmap_threshold_;
+  std::unique_ptr<ThreadPool> heatmap_pool_;
+  std::unique_ptr<DensityHeatmap> heatmap_;
+  ci::gl::Texture2dRef heatmap_texture_;
+
+  /** The largest radius a particle is drawn with using the heatmap */
+  const double kMaxHeatmapPixelRadius = 2;
+
+  /**
+   * Returns the conversion factor between the dimensions used by the
+   * simulation and pixels
+   */
+  double GetScaleFactor() const;
+
   /** Helper methods for drawing the box onto the Cinder application */
   void DrawBox() const;
-  void DrawParticles() const;
+  void DrawObstacles() const;
+  void DrawParticles();
+  void DrawHeatmap();
+
+  /** Returns true if the particles should be drawn as a heatmap */
+  bool IsHeatmapUsed() const;
 };
 
 }  // namespace idealgas
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "cinder/gl/gl.h"
+#include "core/particle.h"
+#include "core/shared_chunked_vector.h"
+#include "core/thread_pool.h"
+
+namespace idealgas {
+
+/**
+ * Rasterises particles into a grid of per-species particle counts with one
+ * cell per pixel, and colors it as an image, for drawing populations too
+ * large for their particles to be visible individually.
+ *
+ * Splatting is split over a thread pool without any shared counters: chunks
+ * of particles are first sorted into horizontal tiles of the image by a
+ * parallel counting sort, then each tile is counted and colored by one task
+ * which owns its rows. Every buffer is reused between frames. Building needs
+ * no window, so it can be tested headlessly.
+ */
+class DensityHeatmap {
+ public:
+  /**
+   * @param width           The width of the image in pixels
+   * @param height          The height of the image in pixels
+   * @param plane_size      The size of the plane the image covers
+   * @param species_colors  The color of each species. A particle belongs to
+   *                        the species of its color, and particles of any
+   *                        other color are counted as the last species.
+   * @throws std::invalid_argument if the image or the list of species is
+   *         empty
+   */
+  DensityHeatmap(size_t width, size_t height, const glm::dvec2& plane_size,
+                 const std::vector<ci::Color>& species_colors);
+
+  /**
+   * Sets the number of particles in a pixel at which it is drawn opaque.
+   * Emptier pixels are drawn more transparent. 4 by default.
+   *
+   * @throws std::invalid_argument if the number is not positive
+   */
+  void SetSaturation(double num_particles);
+
+  /** Counts the particles in each pixel and colors the image */
+  void Build(const ChunkedView<Particle>& particles, ThreadPool& pool);
+
+  size_t GetWidth() const;
+  size_t GetHeight() const;
+
+  /**
+   * Returns the number of particles of a species in a pixel, where y = 0 is
+   * the top row of the image, i.e. the top of the plane
+   */
+  uint32_t GetCount(size_t x, size_t y, size_t species) const;
+
+  /**
+   * Returns the image, 4 bytes of RGBA per pixel with rows from top to
+   * bottom. A pixel's color is the average of its particles' species colors,
+   * and its alpha grows with their number.
+   */
+  const std::vector<uint8_t>& GetPixels() const;
+
+ private:
+  size_t width_;
+  size_t height_;
+  glm::dvec2 plane_size_;
+  std::vector<ci::Color> species_colors_;
+  double saturation_;
+
+  /** The per-species counts of every pixel, species fastest */
+  std::vector<uint32_t> counts_;
+  std::vector<uint8_t> pixels_;
+
+  /**
+   * Scratch space of the counting sort: the count slot of every particle,
+   * the number of particles of each chunk in each tile, and the slots sorted
+   * by tile, with each tile's range starting at its tile_starts_
+   */
+  std::vector<uint32_t> particle_slots_;
+  std::vector<size_t> tile_offsets_;
+  std::vector<uint32_t> sorted_slots_;
+  std::vector<size_t> tile_starts_;
+
+  /** Returns the index in counts_ of the particle's pixel and species */
+  uint32_t GetSlot(const Particle& particle) const;
+
+  /** Counts and colors the rows of the specified tile */
+  void SplatTile(size_t tile, size_t num_tiles, size_t first, size_t last);
+};
+
+}  // namespace idealgas
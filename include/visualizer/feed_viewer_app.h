@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "cinder/app/App.h"
+#include "cinder/app/RendererGl.h"
+#include "cinder/gl/gl.h"
+#include "core/frame_feed.h"
+#include "histograms.h"
+#include "visualizer/box.h"
+
+namespace idealgas {
+
+/**
+ * Shows the frames of a simulation running in another process, read from
+ * its frame feed, with the same box and histograms as IdealGasApp.
+ *
+ * The viewer waits for the feed to appear, and attaches to a new feed of the
+ * same name whenever its publisher restarts. Frames which arrive while a
+ * frame is being drawn are skipped, so the simulation never waits for the
+ * viewer.
+ */
+class FeedViewerApp : public ci::app::App {
+ public:
+  /** The feed read if none is given on the command line */
+  static const char* const kDefaultFeedName;
+
+  FeedViewerApp();
+
+  /** Overriding Cinder methods */
+  void setup() override;
+  void update() override;
+  void draw() override;
+
+ private:
+  const double kWindowWidth = 1500;
+  const double kWindowHeight = 1000;
+  const double kMargin = 100;
+  const double kBoxWidth = kWindowHeight - 2 * kMargin;
+
+  std::string feed_name_;
+  std::unique_ptr<FrameReader> reader_;
+  FeedFrame frame_;
+
+  /**
+   * A simulator which is never updated, holding the particles of the latest
+   * frame for the box and histograms to draw. It is created once the feed
+   * is attached, on a plane of the feed's size.
+   */
+  std::unique_ptr<Simulator> mirror_;
+  std::unique_ptr<Box> box_;
+  std::unique_ptr<Histograms> histograms_;
+
+  std::string status_;
+
+  /** Attaches to the feed, if it has been published */
+  void Attach();
+
+  /** Replaces the mirror's particles with those of the latest frame */
+  void LoadFrame();
+};
+
+}  // namespace idealgas
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "visualizer/frame_rasterizer.h"
+
+namespace idealgas {
+
+/** The file formats frames can be exported to */
+enum class ExportFormat {
+  /**
+   * One YUV4MPEG2 stream holding every frame, which video encoders such as
+   * ffmpeg read directly
+   */
+  kY4m,
+  /** One PNG file per frame */
+  kPng
+};
+
+/**
+ * Returns the header of a YUV4MPEG2 stream of frames of the specified size,
+ * in 4:4:4 chroma so that no chroma is lost to subsampling
+ */
+std::string GetY4mHeader(size_t width, size_t height,
+                         size_t frames_per_second);
+
+/**
+ * Encodes an image as one frame of a YUV4MPEG2 stream, converting it to
+ * studio range BT.601 YCbCr.
+ *
+ * @param output  Overwritten with the encoded frame. Its memory is reused, so
+ *                encoding steady frames does not allocate.
+ */
+void EncodeY4mFrame(const RgbImage& image, std::vector<uint8_t>& output);
+
+/**
+ * Encodes an image as a PNG file.
+ *
+ * The image data is stored in uncompressed deflate blocks: the files are
+ * larger than compressed ones, but encoding costs little more than copying
+ * the image, so it keeps up with rasterising.
+ *
+ * @param output  Overwritten with the encoded file. Its memory is reused.
+ */
+void EncodePng(const RgbImage& image, std::vector<uint8_t>& output);
+
+}  // namespace idealgas
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "core/simulator.h"
+#include "core/thread_pool.h"
+#include "visualizer/frame_encoder.h"
+#include "visualizer/frame_rasterizer.h"
+
+namespace idealgas {
+
+/**
+ * Simulates a gas and exports frames of it to video or image files without a
+ * window, faster than real time.
+ *
+ * The export is a pipeline of three stages which run at the same time: the
+ * calling thread simulates and copies each frame's state into a snapshot,
+ * the workers of a thread pool rasterise and encode snapshots in parallel,
+ * and a writer thread writes the encoded frames to disk in order. A fixed
+ * ring of frame slots is passed between the stages, so the simulation only
+ * waits when every slot is still being rendered or written, and steady
+ * frames reuse the slots' buffers instead of allocating.
+ */
+class FrameExporter {
+ public:
+  /**
+   * @param rasterizer         Renders the frames, sized for the simulator
+   * @param format             The format the frames are exported to
+   * @param output_path        For Y4M, the file the stream is written to. For
+   *                           PNG, the prefix of the files, to which the
+   *                           zero padded frame number and ".png" are added.
+   * @param frames_per_second  The frame rate recorded in Y4M streams
+   */
+  FrameExporter(FrameRasterizer& rasterizer, ExportFormat format,
+                const std::string& output_path, size_t frames_per_second = 60);
+
+  /**
+   * Exports the frames of a simulation, starting with its current state.
+   *
+   * @param simulator        The simulation, which is updated on the calling
+   *                         thread
+   * @param num_frames       The number of frames to export
+   * @param steps_per_frame  The number of updates between frames
+   * @param pool             The pool the frames are rendered and encoded on.
+   *                         Twice as many frames as it has workers are kept
+   *                         in flight.
+   * @throws std::runtime_error if an output file cannot be written
+   */
+  void Run(Simulator& simulator, size_t num_frames, size_t steps_per_frame,
+           ThreadPool& pool);
+
+  /** Returns the path of the PNG file of the specified frame */
+  std::string GetPngPath(size_t frame) const;
+
+ private:
+  /** The stage of the pipeline a slot is waiting for */
+  enum class SlotState { kFree, kRendering, kEncoded };
+
+  struct FrameSlot {
+    SlotState state;
+    FrameSnapshot snapshot;
+    RgbImage image;
+    std::vector<uint8_t> encoded;
+  };
+
+  FrameRasterizer& rasterizer_;
+  ExportFormat format_;
+  std::string output_path_;
+  size_t frames_per_second_;
+
+  /** Kept between runs so that their buffers are reused */
+  std::vector<FrameSlot> slots_;
+
+  /** Guards the states of the slots and the first error of the run */
+  std::mutex mutex_;
+  std::condition_variable state_changed_;
+  std::exception_ptr error_;
+
+  /** Rasterises and encodes the frame in a slot, on a pool worker */
+  void RenderSlot(FrameSlot& slot);
+
+  /** Writes the frames in order as they are encoded, on the writer thread */
+  void WriteFrames(size_t num_frames);
+
+  /** Records the first error of the run and stops the other stages */
+  void Fail(std::exception_ptr error);
+};
+
+}  // namespace idealgas
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "cinder/gl/gl.h"
+#include "core/simulator.h"
+#include "visualizer/particle_instances.h"
+
+namespace idealgas {
+
+/** An image with 3 bytes of RGB per pixel and rows from top to bottom */
+struct RgbImage {
+  size_t width;
+  size_t height;
+  std::vector<uint8_t> pixels;
+};
+
+/**
+ * Everything that changes between frames, copied out of the simulator so
+ * that the frame can be rasterised while the simulation moves on
+ */
+struct FrameSnapshot {
+  std::vector<ParticleInstance> particles;
+  std::vector<double> small_speeds;
+  std::vector<double> medium_speeds;
+  std::vector<double> large_speeds;
+};
+
+/**
+ * Renders the box and histograms of the app into an image on the CPU, so
+ * that frames can be exported without a window or a GL context.
+ *
+ * The layout follows the app's window scaled to the height of the image.
+ * Text is not rasterised, so the frames have no labels.
+ */
+class FrameRasterizer {
+ public:
+  /**
+   * @param simulator  The simulator to be rendered. Its plane size and
+   *                   obstacles are read once here.
+   * @param height     The height of the frames in pixels. Frames are 3/2 as
+   *                   wide as they are high, like the app's window.
+   * @throws std::invalid_argument if the frames would be too small to hold
+   *         the box
+   */
+  FrameRasterizer(const Simulator& simulator, size_t height);
+
+  size_t GetWidth() const;
+  size_t GetHeight() const;
+
+  /**
+   * Copies the state of the simulator which is drawn into the snapshot. The
+   * snapshot's buffers are reused, so steady frames do not allocate.
+   */
+  void TakeSnapshot(const Simulator& simulator, FrameSnapshot& snapshot);
+
+  /**
+   * Renders a snapshot into the image, which is resized to the frame size.
+   * Does not modify the rasterizer, so several threads can render at once.
+   */
+  void Render(const FrameSnapshot& snapshot, RgbImage& image) const;
+
+ private:
+  /** Histogram ranges, as drawn by Histograms */
+  static const size_t kMaxFrequency = 15;
+  static const size_t kNumSpeedIntervals = 20;
+  const double kMaxSpeed = 1;
+
+  size_t width_;
+  size_t height_;
+  double margin_;
+  double box_width_;
+  double scale_factor_;
+  std::vector<glm::vec2> histogram_corners_;
+  double histogram_width_;
+  double histogram_height_;
+
+  ParticleInstanceBuilder instance_builder_;
+  std::vector<ci::Color> histogram_colors_;
+
+  /**
+   * The background, box, obstacles, and histogram borders, which do not
+   * change between frames and so are rendered once and copied into every
+   * frame, as the app does with its static layer
+   */
+  RgbImage static_layer_;
+
+  /** Helper methods for drawing each part of the frame */
+  void RenderStaticLayer(const Simulator& simulator);
+  void DrawParticles(const std::vector<ParticleInstance>& particles,
+                     RgbImage& image) const;
+  void DrawHistogram(const glm::vec2& top_left_corner,
+                     const std::vector<double>& speeds,
+                     const ci::Color& color, RgbImage& image) const;
+};
+
+}  // namespace idealgas
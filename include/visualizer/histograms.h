@@ -3,6 +3,7 @@
 #include <core/simulator.h>
 
 #include "cinder/gl/gl.h"
+#include "speed_histogram.h"
 
 namespace idealgas {
 
@@ -27,6 +28,14 @@ class Histograms {
 
   /** Cinder-related methods */
   void Setup();
+
+  /**
+   * Draws the parts of the histograms which do not change after Setup(), i.e.
+   * the borders, axes, and labels, which the app renders once and caches
+   */
+  void DrawStaticLayer() const;
+
+  /** Draws the bars of the histograms over the static layer */
   void Draw() const;
 
  private:
@@ -36,35 +45,34 @@ class Histograms {
 
   const double kMaxSpeed = 1;
   const size_t kNumSpeedIntervals = 20;
-  const double kSpeedIntervalWidth = kMaxSpeed / kNumSpeedIntervals;
 
   std::vector<glm::vec2> top_left_corners_;
   double graph_width_;
   double graph_height_;
   const Simulator& simulator_;
 
+  /** The interval boundaries for frequency (y-axis) */
+  std::vector<size_t> freq_intervals_;
+
   /**
-   * Vectors containing the interval boundaries for speed (x-axis) and
-   * frequency (y-axis)
+   * The axis labels and their font, which do not change between frames and
+   * so are created once in Setup()
    */
-  std::vector<double> speed_intervals_;
-  std::vector<size_t> freq_intervals_;
+  std::vector<std::string> speed_labels_;
+  std::vector<std::string> freq_labels_;
+  ci::Font label_font_;
+
+  /**
+   * Sorts the speeds into intervals each frame, and holds the boundaries of
+   * the speed intervals (x-axis). Its buffers are kept between frames so
+   * that drawing does not allocate.
+   */
+  mutable SpeedHistogramBuilder speed_histogram_;
 
   /** Helper methods used during the drawing of the histogram */
   void DrawBorders() const;
   void DrawGraphs() const;
 
-  /**
-   * Sorts the specified speeds into ranges and returns their frequency.
-   *
-   * @param speeds The specified speeds to be sorted
-   * @return A vector representing the frequency in which the speeds occur in a
-   *         given range. The i-th indexed value refers to the frequency of
-   *         speeds between speed_intervals[i] and speed_intervals[i+1].
-   */
-  std::vector<size_t> GetSpeedFrequencies(
-      const std::vector<double>& speeds) const;
-
   /**
    * Draws a set of histogram bars based on the specified parameters
    *
@@ -3,6 +3,7 @@
 #include "cinder/app/App.h"
 #include "cinder/app/RendererGl.h"
 #include "cinder/gl/gl.h"
+#include "core/rewind_buffer.h"
 #include "histograms.h"
 #include "visualizer/box.h"
 
@@ -22,6 +23,7 @@ class IdealGasApp : public ci ::app ::App {
   void draw() override;
   void update() override;
   void keyDown(ci::app::KeyEvent event) override;
+  void resize() override;
 
  private:
   /** The width of the Cinder application window in pixels */
@@ -35,9 +37,63 @@ class IdealGasApp : public ci ::app ::App {
   /** The width of the box holding the particles in pixels */
   const double kBoxWidth = kWindowHeight - 2 * kMargin;
 
+  /**
+   * Text drawn every frame, stored once rather than converted from a string
+   * literal each frame
+   */
+  const std::string kInstructions =
+      "Press 1, 2, or 3 to add a random small, medium, or large particle, "
+      "respectively. Press Backspace to empty the box.";
+  const std::string kRewindInstructions =
+      "Press Space to pause or resume, and Left or Right to rewind or "
+      "fast-forward while paused.";
+  const std::string kHistogramsTitle =
+      "Histograms of small, medium, and large particles";
+
   Simulator simulator_;
   Box box_;
   Histograms histograms_;
+
+  /**
+   * The recent history of the simulation. While paused, the simulation
+   * shows the capture being scrubbed to, and is restored to it exactly when
+   * resumed or changed.
+   */
+  RewindBuffer rewind_;
+  bool is_paused_;
+  size_t scrub_index_;
+  std::string paused_label_;
+
+  /**
+   * The label showing the number of particles, only formatted again when the
+   * number changes so that steady frames do not allocate
+   */
+  std::string num_particles_label_;
+  size_t labeled_num_particles_;
+
+  /**
+   * Everything drawn which does not change between frames: the background,
+   * the instructions and titles, the box, and the histograms' borders and
+   * axes. Text is slow to draw, so these are rendered once into an offscreen
+   * framebuffer, drawn as a single texture every frame, and rendered again
+   * only when the window is resized.
+   */
+  ci::gl::FboRef static_layer_;
+
+  /** Renders the static layer into a new framebuffer the size of the window */
+  void RenderStaticLayer();
+
+  /** Pauses at the current step, or resumes from the capture scrubbed to */
+  void TogglePause();
+
+  /** Shows the capture a number of captures away from the current one */
+  void Scrub(int num_captures);
+
+  /**
+   * Continues the simulation from the capture scrubbed to, so that it can
+   * be changed
+   */
+  void RestoreScrubbedCapture();
 };
 
 }  // namespace idealgas
\ No newline at end of file
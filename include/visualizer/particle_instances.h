@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include "cinder/gl/gl.h"
+#include "core/particle.h"
+#include "core/shared_chunked_vector.h"
+
+namespace idealgas {
+
+/**
+ * The attributes of one particle as the instanced particle shader reads them,
+ * in window pixels. The members are tightly packed floats, so a vector of
+ * instances can be copied into a vertex buffer as is.
+ */
+struct ParticleInstance {
+  glm::vec2 position;
+  float radius;
+  ci::Color color;
+};
+
+/**
+ * Packs the particles of a simulation into one buffer of instances per
+ * frame, so that the box can draw every particle with a single instanced draw
+ * call. Building the buffer needs no window, so it can be tested headlessly.
+ */
+class ParticleInstanceBuilder {
+ public:
+  /**
+   * @param top_left_corner  The position of the top left corner of the plane
+   *                         in the window, in pixels
+   * @param scale_factor     The number of pixels per unit of the plane
+   * @param plane_height     The height of the plane, used to flip the y axis
+   *                         so that it increases from bottom to top
+   */
+  ParticleInstanceBuilder(const glm::vec2& top_left_corner,
+                          double scale_factor, double plane_height);
+
+  /**
+   * Replaces the instances with those of the specified particles. The
+   * buffer's memory is reused, so steady frames do not allocate.
+   */
+  void Build(const ChunkedView<Particle>& particles);
+
+  const std::vector<ParticleInstance>& GetInstances() const;
+
+ private:
+  glm::vec2 top_left_corner_;
+  double scale_factor_;
+  double plane_height_;
+  std::vector<ParticleInstance> instances_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "core/simulator.h"
+
+namespace idealgas {
+
+/**
+ * Sorts the speeds of the small, medium, and large particles of a simulation
+ * into the intervals of the app's speed histograms and counts them. The
+ * speeds and frequencies are kept between frames, so steady frames do not
+ * allocate. Binning needs no window, so it can be tested headlessly.
+ */
+class SpeedHistogramBuilder {
+ public:
+  /**
+   * @param max_speed      The speed at the end of the last interval on the
+   *                       axis. The last interval is unbounded, so faster
+   *                       particles are counted in it as well.
+   * @param num_intervals  The number of equally wide speed intervals
+   */
+  SpeedHistogramBuilder(double max_speed, size_t num_intervals);
+
+  /** Replaces the frequencies with those of the specified simulation */
+  void Build(const Simulator& simulator);
+
+  /**
+   * The frequencies of each size of particle. The i-th value is the number
+   * of particles with a speed between GetIntervals()[i] and
+   * GetIntervals()[i + 1].
+   */
+  const std::vector<size_t>& GetSmallFrequencies() const;
+  const std::vector<size_t>& GetMediumFrequencies() const;
+  const std::vector<size_t>& GetLargeFrequencies() const;
+
+  /** The boundaries of the speed intervals, starting at 0 */
+  const std::vector<double>& GetIntervals() const;
+
+ private:
+  std::vector<double> intervals_;
+  std::vector<double> speeds_;
+  std::vector<size_t> small_frequencies_;
+  std::vector<size_t> medium_frequencies_;
+  std::vector<size_t> large_frequencies_;
+
+  /** Overwrites the frequencies with the counts of the specified speeds */
+  void CountSpeeds(const std::vector<double>& speeds,
+                   std::vector<size_t>& frequencies) const;
+};
+
+}  // namespace idealgas
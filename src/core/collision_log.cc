@@ -0,0 +1,113 @@
+#include <core/collision_log.h>
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace idealgas {
+
+namespace {
+
+/** How long the writer sleeps once every channel is empty */
+const std::chrono::milliseconds kIdleInterval(1);
+
+}  // namespace
+
+const char kCollisionLogMagic[8] = {'I', 'G', 'C', 'O', 'L', 'L', '0', '1'};
+
+CollisionLog::CollisionLog(const std::string& path, size_t channel_capacity)
+    : output_(path, std::ios::binary | std::ios::trunc),
+      channel_capacity_(channel_capacity),
+      is_stopping_(false),
+      num_written_(0) {
+  if (!output_) {
+    throw std::runtime_error("could not open " + path);
+  }
+  output_.write(kCollisionLogMagic, sizeof(kCollisionLogMagic));
+  writer_ = std::thread(&CollisionLog::Write, this);
+}
+
+CollisionLog::~CollisionLog() {
+  is_stopping_ = true;
+  writer_.join();
+}
+
+CollisionLogChannel& CollisionLog::AddChannel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  channels_.emplace_back(new CollisionLogChannel(channel_capacity_));
+  return *channels_.back();
+}
+
+size_t CollisionLog::GetNumChannels() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return channels_.size();
+}
+
+uint64_t CollisionLog::GetNumWritten() const {
+  return num_written_;
+}
+
+uint64_t CollisionLog::GetNumDropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t num_dropped = 0;
+  for (const std::unique_ptr<CollisionLogChannel>& channel : channels_) {
+    num_dropped += channel->GetNumDropped();
+  }
+  return num_dropped;
+}
+
+void CollisionLog::Write() {
+  while (!is_stopping_) {
+    if (!Drain()) {
+      std::this_thread::sleep_for(kIdleInterval);
+    }
+  }
+
+  /* Producers are done by the time the log is destroyed, so one more pass
+     empties every channel */
+  Drain();
+  output_.flush();
+}
+
+bool CollisionLog::Drain() {
+  buffer_.clear();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const std::unique_ptr<CollisionLogChannel>& channel : channels_) {
+      channel->ring_.PopAll(buffer_);
+    }
+  }
+  if (buffer_.empty()) {
+    return false;
+  }
+
+  output_.write(reinterpret_cast<const char*>(buffer_.data()),
+                buffer_.size() * sizeof(CollisionEvent));
+  num_written_ += buffer_.size();
+  return true;
+}
+
+std::vector<CollisionEvent> ReadCollisionLog(const std::string& path) {
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    throw std::runtime_error("could not open " + path);
+  }
+
+  char magic[sizeof(kCollisionLogMagic)];
+  if (!input.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kCollisionLogMagic, sizeof(magic)) != 0) {
+    throw std::runtime_error(path + " is not a collision log");
+  }
+
+  std::vector<CollisionEvent> events;
+  CollisionEvent event;
+  while (input.read(reinterpret_cast<char*>(&event), sizeof(event))) {
+    events.push_back(event);
+  }
+  if (input.gcount() != 0) {
+    throw std::runtime_error(path + " ends in a partial record");
+  }
+  return events;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,26 @@
+#include <core/compensated_sum.h>
+
+#include <cmath>
+
+namespace idealgas {
+
+CompensatedSum::CompensatedSum() : sum_(0), compensation_(0) {
+}
+
+void CompensatedSum::Add(double value) {
+  double new_sum = sum_ + value;
+
+  /* The low order bits of the smaller operand are the ones lost */
+  if (std::abs(sum_) >= std::abs(value)) {
+    compensation_ += (sum_ - new_sum) + value;
+  } else {
+    compensation_ += (value - new_sum) + sum_;
+  }
+  sum_ = new_sum;
+}
+
+double CompensatedSum::GetSum() const {
+  return sum_ + compensation_;
+}
+
+}  // namespace idealgas
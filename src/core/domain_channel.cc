@@ -0,0 +1,153 @@
+#include <core/domain_channel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace idealgas {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "channels need lock-free 64 bit atomics to share them");
+
+/**
+ * The header of one direction's buffer, which is followed by the buffer's
+ * data. Headers take up a whole cache line, so that the data of both
+ * directions starts on one.
+ */
+struct SharedMemoryChannel::Buffer {
+  std::atomic<uint64_t> num_sent;
+  std::atomic<uint64_t> num_received;
+  /** The size of the part in the buffer, and whether it ends a message */
+  std::atomic<uint64_t> part_size;
+  std::atomic<uint64_t> is_last_part;
+  char padding[32];
+};
+
+namespace {
+
+/** Buffers are a whole number of cache lines */
+const size_t kCacheLineSize = 64;
+
+/** How many times a waiting end checks before it starts sleeping */
+const size_t kNumSpins = 1000;
+const std::chrono::microseconds kSleepInterval(50);
+
+}  // namespace
+
+SharedMemoryChannel SharedMemoryChannel::Create(const std::string& name,
+                                                size_t capacity,
+                                                double timeout) {
+  if (capacity == 0) {
+    throw std::invalid_argument("a channel needs a positive capacity");
+  }
+  capacity = (capacity + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+  SharedMemory memory =
+      SharedMemory::Create(name, 2 * (sizeof(Buffer) + capacity));
+
+  /* The memory starts out zeroed, so constructing the atomics in place only
+     makes their lifetimes official */
+  char* data = static_cast<char*>(memory.GetData());
+  new (data) Buffer();
+  new (data + sizeof(Buffer) + capacity) Buffer();
+  return SharedMemoryChannel(std::move(memory), true, timeout);
+}
+
+SharedMemoryChannel SharedMemoryChannel::Open(const std::string& name,
+                                              double timeout) {
+  SharedMemory memory = SharedMemory::OpenWritable(name);
+  if (memory.GetSize() <= 2 * sizeof(Buffer)) {
+    throw std::runtime_error("could not open channel " + name);
+  }
+  return SharedMemoryChannel(std::move(memory), false, timeout);
+}
+
+SharedMemoryChannel::SharedMemoryChannel(SharedMemory memory, bool is_creator,
+                                         double timeout)
+    : memory_(std::move(memory)),
+      outgoing_(nullptr),
+      incoming_(nullptr),
+      capacity_(memory_.GetSize() / 2 - sizeof(Buffer)),
+      timeout_(timeout) {
+  outgoing_ = GetBuffer(is_creator ? 0 : 1);
+  incoming_ = GetBuffer(is_creator ? 1 : 0);
+}
+
+void SharedMemoryChannel::Send(const std::vector<char>& message) {
+  size_t offset = 0;
+  do {
+    /* The buffer is free once the other end has received the last part */
+    uint64_t num_sent = outgoing_->num_sent.load(std::memory_order_relaxed);
+    Wait([this, num_sent] {
+      return outgoing_->num_received.load(std::memory_order_acquire) ==
+             num_sent;
+    });
+
+    size_t part_size = std::min(capacity_, message.size() - offset);
+    if (part_size > 0) {
+      char* data = reinterpret_cast<char*>(outgoing_ + 1);
+      std::memcpy(data, message.data() + offset, part_size);
+    }
+    offset += part_size;
+    outgoing_->part_size.store(part_size, std::memory_order_relaxed);
+    outgoing_->is_last_part.store(offset == message.size(),
+                                  std::memory_order_relaxed);
+    outgoing_->num_sent.store(num_sent + 1, std::memory_order_release);
+  } while (offset < message.size());
+}
+
+void SharedMemoryChannel::Receive(std::vector<char>& message) {
+  message.clear();
+  bool is_last_part = false;
+  while (!is_last_part) {
+    uint64_t num_received =
+        incoming_->num_received.load(std::memory_order_relaxed);
+    Wait([this, num_received] {
+      return incoming_->num_sent.load(std::memory_order_acquire) >
+             num_received;
+    });
+
+    size_t part_size = static_cast<size_t>(
+        incoming_->part_size.load(std::memory_order_relaxed));
+    is_last_part =
+        incoming_->is_last_part.load(std::memory_order_relaxed) != 0;
+    const char* data = reinterpret_cast<const char*>(incoming_ + 1);
+    message.insert(message.end(), data, data + part_size);
+    incoming_->num_received.store(num_received + 1,
+                                  std::memory_order_release);
+  }
+}
+
+SharedMemoryChannel::Buffer* SharedMemoryChannel::GetBuffer(
+    size_t direction) const {
+  char* data = static_cast<char*>(memory_.GetData());
+  return reinterpret_cast<Buffer*>(data +
+                                   direction * (sizeof(Buffer) + capacity_));
+}
+
+template <typename Condition>
+void SharedMemoryChannel::Wait(const Condition& condition) const {
+  for (size_t spin = 0; spin < kNumSpins; spin++) {
+    if (condition()) {
+      return;
+    }
+    std::this_thread::yield();
+  }
+
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(timeout_));
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      throw std::runtime_error(
+          "timed out waiting for the other end of a channel");
+    }
+    std::this_thread::sleep_for(kSleepInterval);
+  }
+}
+
+}  // namespace idealgas
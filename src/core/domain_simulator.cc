@@ -0,0 +1,252 @@
+#include <core/domain_simulator.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace idealgas {
+
+namespace {
+
+/** A particle as sent between processes, with every member exactly */
+struct WireParticle {
+  uint64_t number;
+  double x;
+  double y;
+  double radius;
+  double mass;
+  float vx;
+  float vy;
+  float red;
+  float green;
+  float blue;
+  int32_t time_step_level;
+};
+
+void AppendParticle(uint64_t number, const Particle& particle,
+                    std::vector<char>& message) {
+  const glm::dvec2& position = particle.GetPrecisePosition();
+  const glm::vec2& velocity = particle.GetVelocity();
+  const ci::Color& color = particle.GetColor();
+  WireParticle wire = {number,
+                       position.x,
+                       position.y,
+                       particle.GetRadius(),
+                       particle.GetMass(),
+                       velocity.x,
+                       velocity.y,
+                       color.r,
+                       color.g,
+                       color.b,
+                       particle.GetTimeStepLevel()};
+  const char* bytes = reinterpret_cast<const char*>(&wire);
+  message.insert(message.end(), bytes, bytes + sizeof(wire));
+}
+
+WireParticle ReadParticle(const char* data) {
+  WireParticle wire;
+  std::memcpy(&wire, data, sizeof(wire));
+  return wire;
+}
+
+}  // namespace
+
+DomainSimulator::DomainSimulator(double plane_width, double plane_height,
+                                 size_t num_strips, size_t strip,
+                                 DomainChannel* left, DomainChannel* right)
+    : simulator_(plane_width, plane_height, 0),
+      strip_(strip),
+      strip_left_(plane_width * strip / num_strips),
+      strip_right_(plane_width * (strip + 1) / num_strips),
+      halo_depth_(4 * simulator_.kLargeRadius),
+      left_(left),
+      right_(right),
+      num_added_(0) {
+  if (strip >= num_strips) {
+    throw std::invalid_argument("there is no strip " + std::to_string(strip));
+  }
+  if (plane_width / num_strips < halo_depth_) {
+    throw std::invalid_argument("strips must be as wide as the halo");
+  }
+  if ((strip > 0) != (left != nullptr) ||
+      (strip + 1 < num_strips) != (right != nullptr)) {
+    throw std::invalid_argument(
+        "a strip needs a channel to each neighbor, and only to them");
+  }
+
+  /* Only the strip and the halos beside it hold particles */
+  double occupied_width = strip_right_ - strip_left_;
+  if (left_ != nullptr) {
+    occupied_width += halo_depth_;
+  }
+  if (right_ != nullptr) {
+    occupied_width += halo_depth_;
+  }
+  simulator_.SetOccupiedVolume(occupied_width * plane_height);
+}
+
+bool DomainSimulator::AddParticle(const Particle& particle) {
+  if (particle.GetRadius() > simulator_.kLargeRadius) {
+    throw std::invalid_argument(
+        "particles must be no larger than large particles");
+  }
+
+  /* Every process numbers every particle, so numbers agree between them */
+  uint64_t number = num_added_++;
+  double x = particle.GetPrecisePosition().x;
+  if ((left_ != nullptr && x < strip_left_) ||
+      (right_ != nullptr && x >= strip_right_)) {
+    return false;
+  }
+  ParticleHandle handle = simulator_.AddParticle(particle);
+  owned_.push_back({number, false, particle, handle});
+  particles_.push_back(particle);
+  return true;
+}
+
+void DomainSimulator::Update() {
+  /* Send copies of the particles the neighbors' particles can collide with,
+     or collide with partners of */
+  to_left_.clear();
+  to_right_.clear();
+  for (const NumberedParticle& owned : owned_) {
+    double x = owned.particle.GetPrecisePosition().x;
+    if (left_ != nullptr && x < strip_left_ + halo_depth_) {
+      AppendParticle(owned.number, owned.particle, to_left_);
+    }
+    if (right_ != nullptr && x >= strip_right_ - halo_depth_) {
+      AppendParticle(owned.number, owned.particle, to_right_);
+    }
+  }
+  arrivals_.clear();
+  Exchange(true);
+  AddArrivals();
+
+  /* Simulate the particles and ghosts in the order they were added. The
+     simulation holds the owned particles already, so only the ghosts were
+     added, and merging is linear in the particles of the strip. */
+  local_.clear();
+  std::merge(owned_.begin(), owned_.end(), sorted_arrivals_.begin(),
+             sorted_arrivals_.end(), std::back_inserter(local_), IsEarlier);
+  local_handles_.clear();
+  for (const NumberedParticle& local : local_) {
+    local_handles_.push_back(local.handle);
+  }
+  simulator_.SetParticleOrder(local_handles_);
+  simulator_.Update();
+
+  /* Each particle is found by its handle, so that the simulation is free to
+     reorder its storage. The ghosts' own processes have updated them too,
+     so they are removed along with the particles handed over to the
+     neighbors. */
+  owned_.clear();
+  to_left_.clear();
+  to_right_.clear();
+  removals_.clear();
+  for (const NumberedParticle& local : local_) {
+    const Particle& updated = simulator_.GetParticle(local.handle);
+    double x = updated.GetPrecisePosition().x;
+    if (local.is_ghost) {
+      removals_.push_back(local.handle);
+    } else if (left_ != nullptr && x < strip_left_) {
+      AppendParticle(local.number, updated, to_left_);
+      removals_.push_back(local.handle);
+    } else if (right_ != nullptr && x >= strip_right_) {
+      AppendParticle(local.number, updated, to_right_);
+      removals_.push_back(local.handle);
+    } else {
+      owned_.push_back({local.number, false, updated, local.handle});
+    }
+  }
+  for (const ParticleHandle& handle : removals_) {
+    simulator_.RemoveParticle(handle);
+  }
+
+  /* Take over the particles which entered the strip */
+  arrivals_.clear();
+  Exchange(false);
+  AddArrivals();
+  local_.clear();
+  std::merge(owned_.begin(), owned_.end(), sorted_arrivals_.begin(),
+             sorted_arrivals_.end(), std::back_inserter(local_), IsEarlier);
+  owned_.swap(local_);
+
+  particles_.clear();
+  for (const NumberedParticle& owned : owned_) {
+    particles_.push_back(owned.particle);
+  }
+}
+
+const std::vector<Particle>& DomainSimulator::GetParticles() const {
+  return particles_;
+}
+
+double DomainSimulator::GetStripLeft() const {
+  return strip_left_;
+}
+
+double DomainSimulator::GetStripRight() const {
+  return strip_right_;
+}
+
+bool DomainSimulator::IsEarlier(const NumberedParticle& p1,
+                                const NumberedParticle& p2) {
+  return p1.number < p2.number;
+}
+
+void DomainSimulator::AddArrivals() {
+  for (NumberedParticle& arrival : arrivals_) {
+    arrival.handle = simulator_.AddParticle(arrival.particle);
+  }
+
+  /* The arrivals are two ordered runs, one from each neighbor */
+  std::vector<NumberedParticle>::iterator split =
+      std::is_sorted_until(arrivals_.begin(), arrivals_.end(), IsEarlier);
+  sorted_arrivals_.clear();
+  std::merge(arrivals_.begin(), split, split, arrivals_.end(),
+             std::back_inserter(sorted_arrivals_), IsEarlier);
+}
+
+void DomainSimulator::Exchange(bool are_ghosts) {
+  /* A message larger than a channel holds at once is sent in parts, each
+     waiting for the last to be received, so two neighbors must not send to
+     each other at the same time. On each edge the process of the even strip
+     sends first, and every process starts with the edge it shares with an
+     even strip, so that the edges are exchanged in two rounds. */
+  if (strip_ % 2 == 0) {
+    ExchangeAcross(right_, to_right_, true, are_ghosts);
+    ExchangeAcross(left_, to_left_, true, are_ghosts);
+  } else {
+    ExchangeAcross(left_, to_left_, false, are_ghosts);
+    ExchangeAcross(right_, to_right_, false, are_ghosts);
+  }
+}
+
+void DomainSimulator::ExchangeAcross(DomainChannel* channel,
+                                     const std::vector<char>& message,
+                                     bool is_first_to_send, bool are_ghosts) {
+  if (channel == nullptr) {
+    return;
+  }
+  if (is_first_to_send) {
+    channel->Send(message);
+    channel->Receive(received_);
+  } else {
+    channel->Receive(received_);
+    channel->Send(message);
+  }
+
+  for (size_t offset = 0; offset + sizeof(WireParticle) <= received_.size();
+       offset += sizeof(WireParticle)) {
+    WireParticle wire = ReadParticle(received_.data() + offset);
+    Particle particle(wire.radius, wire.mass, glm::dvec2(wire.x, wire.y),
+                      glm::vec2(wire.vx, wire.vy),
+                      ci::Color(wire.red, wire.green, wire.blue));
+    particle.SetTimeStepLevel(wire.time_step_level);
+    arrivals_.push_back({wire.number, are_ghosts, particle, {0, 0}});
+  }
+}
+
+}  // namespace idealgas
@@ -0,0 +1,168 @@
+#include <core/ensemble.h>
+
+#include <algorithm>
+
+namespace idealgas {
+
+void AccumulateSpeedFrequencies(const std::vector<double>& speeds,
+                                double max_speed,
+                                std::vector<double>& frequencies) {
+  size_t num_bins = frequencies.size();
+  if (num_bins == 0) {
+    return;
+  }
+
+  double bin_width = max_speed / num_bins;
+  for (double speed : speeds) {
+    /* Speeds past the last bin boundary all fall into the last bin */
+    size_t bin = speed < max_speed ? (size_t)(speed / bin_width) : num_bins - 1;
+    if (bin >= num_bins) {
+      bin = num_bins - 1;
+    }
+    frequencies[bin]++;
+  }
+}
+
+Ensemble::Ensemble(double max_speed, size_t num_speed_bins)
+    : max_speed_(max_speed),
+      num_speed_bins_(num_speed_bins),
+      collision_log_(nullptr) {
+}
+
+void Ensemble::AddMember(const EnsembleMember& member) {
+  members_.push_back(member);
+}
+
+const std::vector<EnsembleMember>& Ensemble::GetMembers() const {
+  return members_;
+}
+
+void Ensemble::SetCollisionLog(CollisionLog* log) {
+  if (log != collision_log_) {
+    collision_channels_.clear();
+  }
+  collision_log_ = log;
+}
+
+EnsembleResult Ensemble::Run(size_t max_steps, ThreadPool& pool,
+                             const StopCondition& stop) {
+  /* One accumulator per worker so that members never contend on shared
+     sums, plus one for members run from outside of the pool */
+  std::vector<Accumulator> accumulators(pool.GetNumThreads() + 1,
+                                        CreateAccumulator());
+
+  /* Collision log channels are split the same way, as each may only be
+     appended to by one thread. Channels live as long as the log, so those
+     added by earlier runs are reused. */
+  std::vector<CollisionLogChannel*> channels(accumulators.size(), nullptr);
+  if (collision_log_ != nullptr) {
+    while (collision_channels_.size() < channels.size()) {
+      collision_channels_.push_back(&collision_log_->AddChannel());
+    }
+    std::copy(collision_channels_.begin(),
+              collision_channels_.begin() + channels.size(), channels.begin());
+  }
+
+  for (size_t i = 0; i < members_.size(); i++) {
+    const EnsembleMember* member_ptr = &members_[i];
+    uint32_t source = static_cast<uint32_t>(i);
+    std::vector<Accumulator>* accumulators_ptr = &accumulators;
+    std::vector<CollisionLogChannel*>* channels_ptr = &channels;
+    pool.Submit([this, member_ptr, source, max_steps, &stop, accumulators_ptr,
+                 channels_ptr] {
+      size_t index = ThreadPool::GetWorkerIndex();
+      if (index >= accumulators_ptr->size() - 1) {
+        index = accumulators_ptr->size() - 1;
+      }
+      RunMember(*member_ptr, source, max_steps, stop,
+                (*accumulators_ptr)[index], (*channels_ptr)[index]);
+    });
+  }
+  pool.Wait();
+
+  /* Reduce the per-worker sums into averages */
+  Accumulator total = CreateAccumulator();
+  for (const Accumulator& accumulator : accumulators) {
+    for (size_t i = 0; i < num_speed_bins_; i++) {
+      total.small_speed_frequencies[i] +=
+          accumulator.small_speed_frequencies[i];
+      total.medium_speed_frequencies[i] +=
+          accumulator.medium_speed_frequencies[i];
+      total.large_speed_frequencies[i] +=
+          accumulator.large_speed_frequencies[i];
+    }
+    total.kinetic_energy += accumulator.kinetic_energy;
+    total.num_steps += accumulator.num_steps;
+    total.num_members += accumulator.num_members;
+  }
+
+  EnsembleResult result;
+  result.num_members = total.num_members;
+  result.small_speed_frequencies = total.small_speed_frequencies;
+  result.medium_speed_frequencies = total.medium_speed_frequencies;
+  result.large_speed_frequencies = total.large_speed_frequencies;
+  result.kinetic_energy = total.kinetic_energy;
+  result.num_steps = total.num_steps;
+
+  if (total.num_members > 0) {
+    double scale = 1.0 / total.num_members;
+    for (size_t i = 0; i < num_speed_bins_; i++) {
+      result.small_speed_frequencies[i] *= scale;
+      result.medium_speed_frequencies[i] *= scale;
+      result.large_speed_frequencies[i] *= scale;
+    }
+    result.kinetic_energy *= scale;
+    result.num_steps *= scale;
+  }
+
+  return result;
+}
+
+void Ensemble::RunMember(const EnsembleMember& member, uint32_t source,
+                         size_t max_steps, const StopCondition& stop,
+                         Accumulator& accumulator,
+                         CollisionLogChannel* channel) const {
+  Simulator simulator(member.seed);
+  simulator.SetCollisionLog(channel, source);
+  for (size_t i = 0; i < member.num_small; i++) {
+    simulator.AddRandomSmallParticle();
+  }
+  for (size_t i = 0; i < member.num_medium; i++) {
+    simulator.AddRandomMediumParticle();
+  }
+  for (size_t i = 0; i < member.num_large; i++) {
+    simulator.AddRandomLargeParticle();
+  }
+
+  size_t step = 0;
+  while (step < max_steps) {
+    simulator.Update();
+    step++;
+    if (stop && stop(simulator, step)) {
+      break;
+    }
+  }
+
+  AccumulateSpeedFrequencies(simulator.GetSmallParticleSpeeds(), max_speed_,
+                             accumulator.small_speed_frequencies);
+  AccumulateSpeedFrequencies(simulator.GetMediumParticleSpeeds(), max_speed_,
+                             accumulator.medium_speed_frequencies);
+  AccumulateSpeedFrequencies(simulator.GetLargeParticleSpeeds(), max_speed_,
+                             accumulator.large_speed_frequencies);
+  accumulator.kinetic_energy += simulator.GetKineticEnergy();
+  accumulator.num_steps += step;
+  accumulator.num_members++;
+}
+
+Ensemble::Accumulator Ensemble::CreateAccumulator() const {
+  Accumulator accumulator;
+  accumulator.small_speed_frequencies.assign(num_speed_bins_, 0);
+  accumulator.medium_speed_frequencies.assign(num_speed_bins_, 0);
+  accumulator.large_speed_frequencies.assign(num_speed_bins_, 0);
+  accumulator.kinetic_energy = 0;
+  accumulator.num_steps = 0;
+  accumulator.num_members = 0;
+  return accumulator;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,319 @@
+#include <core/frame_feed.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace idealgas {
+
+namespace {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "the feed needs lock-free 64 bit atomics to share them");
+
+/** "IGFEED" followed by the version of the layout below */
+const uint64_t kFeedMagic = 0x4947464545440001ull;
+
+/**
+ * The layout of the shared memory: a header, followed by the slots, each of
+ * which is a slot header followed by kWordsPerParticle words per particle
+ */
+struct FeedHeader {
+  /** Written last by the publisher, once the rest of the header is set */
+  std::atomic<uint64_t> magic;
+  std::atomic<uint64_t> num_slots;
+  std::atomic<uint64_t> max_particles;
+  std::atomic<uint64_t> plane_width;
+  std::atomic<uint64_t> plane_height;
+  /** The number of frames published, the newest of which is complete */
+  std::atomic<uint64_t> num_frames;
+  std::atomic<uint64_t> is_closed;
+};
+
+struct SlotHeader {
+  /** Odd while the publisher is writing the slot */
+  std::atomic<uint64_t> sequence;
+  std::atomic<uint64_t> frame_number;
+  std::atomic<uint64_t> num_particles;
+};
+
+typedef std::atomic<uint64_t> Word;
+
+/**
+ * A particle's words: its position's x and y, its velocity's x and y as
+ * floats, its radius and mass as floats, and its species and 8 bit color
+ */
+const size_t kWordsPerParticle = 5;
+
+uint64_t ToBits(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double ToDouble(uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+uint64_t PackFloats(float high, float low) {
+  uint32_t high_bits;
+  uint32_t low_bits;
+  std::memcpy(&high_bits, &high, sizeof(high_bits));
+  std::memcpy(&low_bits, &low, sizeof(low_bits));
+  return static_cast<uint64_t>(high_bits) << 32 | low_bits;
+}
+
+void UnpackFloats(uint64_t bits, float& high, float& low) {
+  uint32_t high_bits = static_cast<uint32_t>(bits >> 32);
+  uint32_t low_bits = static_cast<uint32_t>(bits);
+  std::memcpy(&high, &high_bits, sizeof(high));
+  std::memcpy(&low, &low_bits, sizeof(low));
+}
+
+uint64_t ToByte(float channel) {
+  return static_cast<uint64_t>(
+      std::round(std::min(std::max(channel, 0.0f), 1.0f) * 255));
+}
+
+FeedSpecies ToFeedSpecies(CollisionSpecies species) {
+  switch (species) {
+    case CollisionSpecies::kSmall:
+      return FeedSpecies::kSmall;
+    case CollisionSpecies::kMedium:
+      return FeedSpecies::kMedium;
+    case CollisionSpecies::kLarge:
+      return FeedSpecies::kLarge;
+    default:
+      return FeedSpecies::kOther;
+  }
+}
+
+size_t GetSlotSize(size_t max_particles) {
+  return sizeof(SlotHeader) + max_particles * kWordsPerParticle * sizeof(Word);
+}
+
+SlotHeader* GetSlot(void* memory, size_t slot, size_t max_particles) {
+  char* first_slot = static_cast<char*>(memory) + sizeof(FeedHeader);
+  return reinterpret_cast<SlotHeader*>(first_slot +
+                                       slot * GetSlotSize(max_particles));
+}
+
+Word* GetWords(SlotHeader* slot) {
+  return reinterpret_cast<Word*>(slot + 1);
+}
+
+}  // namespace
+
+FramePublisher::FramePublisher(const std::string& name,
+                               const Simulator& simulator,
+                               size_t max_particles, size_t num_slots)
+    : memory_(SharedMemory::Create(
+          name, sizeof(FeedHeader) + num_slots * GetSlotSize(max_particles))),
+      max_particles_(max_particles),
+      num_slots_(num_slots),
+      num_frames_(0) {
+  if (num_slots == 0) {
+    throw std::invalid_argument("a feed needs at least one slot");
+  }
+
+  /* The memory starts out zeroed, so constructing the atomics in place only
+     makes their lifetimes official */
+  FeedHeader* header = new (memory_.GetData()) FeedHeader();
+  for (size_t slot = 0; slot < num_slots_; slot++) {
+    SlotHeader* slot_header = new (GetSlot(memory_.GetData(), slot,
+                                           max_particles_)) SlotHeader();
+    Word* words = GetWords(slot_header);
+    for (size_t i = 0; i < max_particles_ * kWordsPerParticle; i++) {
+      new (words + i) Word(0);
+    }
+  }
+
+  header->num_slots.store(num_slots_, std::memory_order_relaxed);
+  header->max_particles.store(max_particles_, std::memory_order_relaxed);
+  header->plane_width.store(ToBits(simulator.GetWidth()),
+                            std::memory_order_relaxed);
+  header->plane_height.store(ToBits(simulator.GetHeight()),
+                             std::memory_order_relaxed);
+  header->magic.store(kFeedMagic, std::memory_order_release);
+}
+
+FramePublisher::~FramePublisher() {
+  if (memory_.GetData() != nullptr) {
+    FeedHeader* header = static_cast<FeedHeader*>(memory_.GetData());
+    header->is_closed.store(1, std::memory_order_release);
+  }
+}
+
+void FramePublisher::Publish(const Simulator& simulator) {
+  ChunkedView<Particle> particles = simulator.GetParticles();
+  if (particles.size() > max_particles_) {
+    throw std::invalid_argument("too many particles for the feed");
+  }
+
+  FeedHeader* header = static_cast<FeedHeader*>(memory_.GetData());
+  SlotHeader* slot =
+      GetSlot(memory_.GetData(), num_frames_ % num_slots_, max_particles_);
+  Word* words = GetWords(slot);
+
+  /* Mark the slot as being written before any of its words change */
+  uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+  slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot->frame_number.store(num_frames_, std::memory_order_relaxed);
+  slot->num_particles.store(particles.size(), std::memory_order_relaxed);
+  for (size_t i = 0; i < particles.size(); i++) {
+    const Particle& particle = particles[i];
+    Word* particle_words = words + i * kWordsPerParticle;
+
+    /* The species goes by radius and mass, as in the simulator */
+    uint64_t species = static_cast<uint64_t>(
+        ToFeedSpecies(simulator.GetSpecies(particle)));
+    const ci::Color& color = particle.GetColor();
+    uint64_t tag = species | ToByte(color.r) << 8 | ToByte(color.g) << 16 |
+                   ToByte(color.b) << 24;
+
+    glm::dvec2 position = particle.GetPrecisePosition();
+    particle_words[0].store(ToBits(position.x), std::memory_order_relaxed);
+    particle_words[1].store(ToBits(position.y), std::memory_order_relaxed);
+    particle_words[2].store(
+        PackFloats(particle.GetVelocity().x, particle.GetVelocity().y),
+        std::memory_order_relaxed);
+    particle_words[3].store(
+        PackFloats(static_cast<float>(particle.GetRadius()),
+                   static_cast<float>(particle.GetMass())),
+        std::memory_order_relaxed);
+    particle_words[4].store(tag, std::memory_order_relaxed);
+  }
+
+  /* Publish the slot, then announce it as the newest */
+  slot->sequence.store(sequence + 2, std::memory_order_release);
+  num_frames_++;
+  header->num_frames.store(num_frames_, std::memory_order_release);
+}
+
+uint64_t FramePublisher::GetNumFrames() const {
+  return num_frames_;
+}
+
+FrameReader::FrameReader(const std::string& name)
+    : memory_(SharedMemory::Open(name)),
+      has_read_(false),
+      last_frame_number_(0),
+      num_skipped_frames_(0) {
+  const FeedHeader* header =
+      static_cast<const FeedHeader*>(memory_.GetData());
+  if (memory_.GetSize() < sizeof(FeedHeader) ||
+      header->magic.load(std::memory_order_acquire) != kFeedMagic) {
+    throw std::runtime_error("shared memory " + name +
+                             " is not a frame feed of this version");
+  }
+
+  size_t num_slots = header->num_slots.load(std::memory_order_relaxed);
+  size_t max_particles =
+      header->max_particles.load(std::memory_order_relaxed);
+  if (memory_.GetSize() <
+      sizeof(FeedHeader) + num_slots * GetSlotSize(max_particles)) {
+    throw std::runtime_error("frame feed " + name + " is truncated");
+  }
+}
+
+bool FrameReader::ReadLatest(FeedFrame& frame) {
+  FeedHeader* header = static_cast<FeedHeader*>(memory_.GetData());
+  size_t num_slots = header->num_slots.load(std::memory_order_relaxed);
+  size_t max_particles =
+      header->max_particles.load(std::memory_order_relaxed);
+
+  /* Each retry reads a frame published since the last attempt, so only a
+     publisher which keeps lapping the reader makes it give up */
+  const size_t kMaxAttempts = 4;
+  for (size_t attempt = 0; attempt < kMaxAttempts; attempt++) {
+    uint64_t num_frames = header->num_frames.load(std::memory_order_acquire);
+    if (num_frames == 0 ||
+        (has_read_ && num_frames - 1 <= last_frame_number_)) {
+      return false;
+    }
+
+    SlotHeader* slot =
+        GetSlot(memory_.GetData(), (num_frames - 1) % num_slots,
+                max_particles);
+    uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence % 2 == 1) {
+      continue;
+    }
+
+    uint64_t frame_number =
+        slot->frame_number.load(std::memory_order_relaxed);
+    size_t num_particles = std::min<size_t>(
+        slot->num_particles.load(std::memory_order_relaxed), max_particles);
+    frame.particles.resize(num_particles);
+
+    const Word* words = GetWords(slot);
+    for (size_t i = 0; i < num_particles; i++) {
+      const Word* particle_words = words + i * kWordsPerParticle;
+      FeedParticle& particle = frame.particles[i];
+
+      particle.position.x =
+          ToDouble(particle_words[0].load(std::memory_order_relaxed));
+      particle.position.y =
+          ToDouble(particle_words[1].load(std::memory_order_relaxed));
+      UnpackFloats(particle_words[2].load(std::memory_order_relaxed),
+                   particle.velocity.x, particle.velocity.y);
+      UnpackFloats(particle_words[3].load(std::memory_order_relaxed),
+                   particle.radius, particle.mass);
+
+      uint64_t tag = particle_words[4].load(std::memory_order_relaxed);
+      particle.species = static_cast<FeedSpecies>(
+          std::min<uint64_t>(tag & 0xFF,
+                             static_cast<uint64_t>(FeedSpecies::kOther)));
+      particle.color = ci::Color((tag >> 8 & 0xFF) / 255.0f,
+                                 (tag >> 16 & 0xFF) / 255.0f,
+                                 (tag >> 24 & 0xFF) / 255.0f);
+    }
+
+    /* Keep the copy only if the publisher did not touch the slot meanwhile */
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;
+    }
+
+    if (has_read_) {
+      num_skipped_frames_ += frame_number - last_frame_number_ - 1;
+    }
+    has_read_ = true;
+    last_frame_number_ = frame_number;
+    frame.frame_number = frame_number;
+    return true;
+  }
+
+  return false;
+}
+
+double FrameReader::GetPlaneWidth() const {
+  const FeedHeader* header =
+      static_cast<const FeedHeader*>(memory_.GetData());
+  return ToDouble(header->plane_width.load(std::memory_order_relaxed));
+}
+
+double FrameReader::GetPlaneHeight() const {
+  const FeedHeader* header =
+      static_cast<const FeedHeader*>(memory_.GetData());
+  return ToDouble(header->plane_height.load(std::memory_order_relaxed));
+}
+
+bool FrameReader::IsClosed() const {
+  const FeedHeader* header =
+      static_cast<const FeedHeader*>(memory_.GetData());
+  return header->is_closed.load(std::memory_order_acquire) != 0;
+}
+
+uint64_t FrameReader::GetNumSkippedFrames() const {
+  return num_skipped_frames_;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,422 @@
+#include <core/initial_conditions.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "core/mapped_file.h"
+
+namespace idealgas {
+
+const char kParticleFileMagic[8] = {'I', 'G', 'P', 'A', 'R', 'T', '0', '1'};
+
+namespace {
+
+/** Chunks per worker, so that uneven lines still balance across the pool */
+const size_t kChunksPerThread = 4;
+
+/** Files smaller than this are not worth splitting further */
+const size_t kMinChunkSize = 1 << 16;
+
+/** The size of the header of binary particle files */
+const size_t kBinaryHeaderSize = sizeof(kParticleFileMagic) + sizeof(uint64_t);
+
+/** The bytes each particle takes in a binary particle file */
+const size_t kBinaryParticleSize =
+    2 * sizeof(double) + 2 * sizeof(float) + sizeof(uint8_t);
+
+/** Powers of ten which are exactly representable as doubles */
+const double kExactPowersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                    1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                    1e18, 1e19, 1e20, 1e21, 1e22};
+
+/** Signals a malformed row, and where in the file it is */
+struct CsvError {
+  const char* position;
+  const char* message;
+};
+
+/**
+ * The particles parsed from one chunk of a CSV file, or the first malformed
+ * row of the chunk if the error's position is not null
+ */
+struct CsvChunk {
+  const char* begin;
+  const char* end;
+  std::vector<Particle> particles;
+  CsvError error;
+};
+
+bool IsBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+void SkipBlanks(const char*& cursor, const char* end) {
+  while (cursor != end && IsBlank(*cursor)) {
+    cursor++;
+  }
+}
+
+/**
+ * Parses a decimal number at the cursor and moves the cursor past it.
+ *
+ * Numbers of at most 15 significant digits with small exponents are exactly
+ * a whole number times or divided by an exact power of ten, which is rounded
+ * correctly by a single multiplication or division. Others fall back to
+ * strtod on a copy of the number.
+ */
+double ParseNumber(const char*& cursor, const char* end) {
+  const char* start = cursor;
+  bool is_negative = false;
+  if (cursor != end && (*cursor == '-' || *cursor == '+')) {
+    is_negative = *cursor == '-';
+    cursor++;
+  }
+
+  uint64_t mantissa = 0;
+  int num_digits = 0;
+  int exponent = 0;
+  bool has_digits = false;
+  for (; cursor != end && *cursor >= '0' && *cursor <= '9'; cursor++) {
+    has_digits = true;
+    if (mantissa != 0 || *cursor != '0') {
+      mantissa = mantissa * 10 + static_cast<uint64_t>(*cursor - '0');
+      num_digits++;
+    }
+    if (num_digits > 19) {
+      break;
+    }
+  }
+  if (cursor != end && *cursor == '.') {
+    cursor++;
+    for (; cursor != end && *cursor >= '0' && *cursor <= '9'; cursor++) {
+      has_digits = true;
+      if (mantissa != 0 || *cursor != '0') {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*cursor - '0');
+        num_digits++;
+      }
+      exponent--;
+      if (num_digits > 19) {
+        break;
+      }
+    }
+  }
+  if (!has_digits) {
+    throw CsvError{start, "expected a number"};
+  }
+  if (cursor != end && (*cursor == 'e' || *cursor == 'E')) {
+    const char* exponent_start = cursor++;
+    bool is_exponent_negative = false;
+    if (cursor != end && (*cursor == '-' || *cursor == '+')) {
+      is_exponent_negative = *cursor == '-';
+      cursor++;
+    }
+    int value = 0;
+    bool has_exponent = false;
+    for (; cursor != end && *cursor >= '0' && *cursor <= '9'; cursor++) {
+      has_exponent = true;
+      value = std::min(value * 10 + (*cursor - '0'), 100000);
+    }
+    if (!has_exponent) {
+      cursor = exponent_start;
+    } else {
+      exponent += is_exponent_negative ? -value : value;
+    }
+  }
+
+  if (num_digits <= 15 && exponent >= -22 && exponent <= 22) {
+    double value = static_cast<double>(mantissa);
+    value = exponent < 0 ? value / kExactPowersOfTen[-exponent]
+                         : value * kExactPowersOfTen[exponent];
+    return is_negative ? -value : value;
+  }
+
+  /* Past the fast path, find the end of the number and let strtod round
+     it */
+  while (cursor != end && ((*cursor >= '0' && *cursor <= '9') ||
+                           *cursor == '.' || *cursor == 'e' ||
+                           *cursor == 'E' || *cursor == '-' ||
+                           *cursor == '+')) {
+    cursor++;
+  }
+  char buffer[128];
+  size_t length = static_cast<size_t>(cursor - start);
+  if (length >= sizeof(buffer)) {
+    throw CsvError{start, "number is too long"};
+  }
+  std::memcpy(buffer, start, length);
+  buffer[length] = '\0';
+  char* number_end;
+  double value = std::strtod(buffer, &number_end);
+  if (number_end != buffer + length) {
+    throw CsvError{start, "expected a number"};
+  }
+  return value;
+}
+
+/** Moves the cursor past the separator between two columns */
+void SkipSeparator(const char*& cursor, const char* end) {
+  SkipBlanks(cursor, end);
+  if (cursor == end || *cursor != ',') {
+    throw CsvError{cursor, "expected 5 columns"};
+  }
+  cursor++;
+  SkipBlanks(cursor, end);
+}
+
+/** Returns true if the word between begin and end is the specified name */
+bool IsWord(const char* begin, const char* end, const char* name) {
+  size_t length = std::strlen(name);
+  return static_cast<size_t>(end - begin) == length &&
+         std::memcmp(begin, name, length) == 0;
+}
+
+/** Parses the rows between two line breaks, or the ends of the file */
+void ParseCsvChunk(const Simulator& simulator, CsvChunk& chunk) {
+  /* Every row but the last ends in a line break, so counting them first
+     sizes the particles in one allocation */
+  chunk.particles.reserve(
+      static_cast<size_t>(std::count(chunk.begin, chunk.end, '\n')) + 1);
+
+  const char* cursor = chunk.begin;
+  const char* end = chunk.end;
+  while (cursor != end) {
+    SkipBlanks(cursor, end);
+    if (cursor == end || *cursor == '\n') {
+      if (cursor != end) {
+        cursor++;
+      }
+      continue;
+    }
+
+    double x = ParseNumber(cursor, end);
+    SkipSeparator(cursor, end);
+    double y = ParseNumber(cursor, end);
+    SkipSeparator(cursor, end);
+    double vx = ParseNumber(cursor, end);
+    SkipSeparator(cursor, end);
+    double vy = ParseNumber(cursor, end);
+    SkipSeparator(cursor, end);
+
+    const char* species = cursor;
+    while (cursor != end && *cursor != ',' && *cursor != '\n' &&
+           !IsBlank(*cursor)) {
+      cursor++;
+    }
+    const char* species_end = cursor;
+    SkipBlanks(cursor, end);
+    if (cursor != end && *cursor != '\n') {
+      throw CsvError{cursor, "expected 5 columns"};
+    }
+
+    glm::dvec2 position(x, y);
+    glm::vec2 velocity(vx, vy);
+    if (IsWord(species, species_end, "small")) {
+      chunk.particles.push_back(Particle(simulator.kSmallRadius,
+                                         simulator.kSmallMass, position,
+                                         velocity, simulator.kSmallColor));
+    } else if (IsWord(species, species_end, "medium")) {
+      chunk.particles.push_back(Particle(simulator.kMediumRadius,
+                                         simulator.kMediumMass, position,
+                                         velocity, simulator.kMediumColor));
+    } else if (IsWord(species, species_end, "large")) {
+      chunk.particles.push_back(Particle(simulator.kLargeRadius,
+                                         simulator.kLargeMass, position,
+                                         velocity, simulator.kLargeColor));
+    } else {
+      throw CsvError{species, "species must be small, medium, or large"};
+    }
+  }
+}
+
+/** Returns the 1-based line of a position in a file */
+size_t GetLineNumber(const char* data, const char* position) {
+  return static_cast<size_t>(std::count(data, position, '\n')) + 1;
+}
+
+/** Returns the code of a particle's species in binary particle files */
+uint8_t GetSpeciesCode(const Simulator& simulator, const Particle& particle) {
+  const double kEpsilon = 0.001;
+  const double radii[] = {simulator.kSmallRadius, simulator.kMediumRadius,
+                          simulator.kLargeRadius};
+  const double masses[] = {simulator.kSmallMass, simulator.kMediumMass,
+                           simulator.kLargeMass};
+  for (uint8_t code = 0; code < 3; code++) {
+    if (std::abs(particle.GetRadius() - radii[code]) < kEpsilon &&
+        std::abs(particle.GetMass() - masses[code]) < kEpsilon) {
+      return code;
+    }
+  }
+  throw std::invalid_argument(
+      "only small, medium, and large particles can be saved");
+}
+
+}  // namespace
+
+void LoadCsvParticles(const std::string& path, Simulator& simulator,
+                      ThreadPool& pool) {
+  MappedFile file = MappedFile::Open(path);
+  const char* data = file.GetData();
+  const char* end = data + file.GetSize();
+
+  /* Skip a header, i.e. a first line which is not a row of numbers */
+  const char* begin = data;
+  SkipBlanks(begin, end);
+  if (begin != end && !std::strchr("0123456789+-.", *begin)) {
+    begin = std::find(begin, end, '\n');
+  }
+
+  /* Split the file into chunks which each end at a line break */
+  size_t size = static_cast<size_t>(end - begin);
+  size_t num_chunks = std::max<size_t>(
+      1, std::min(pool.GetNumThreads() * kChunksPerThread,
+                  size / kMinChunkSize));
+  std::vector<CsvChunk> chunks(num_chunks);
+  const char* chunk_begin = begin;
+  for (size_t i = 0; i < num_chunks; i++) {
+    const char* chunk_end =
+        i + 1 == num_chunks
+            ? end
+            : std::find(std::max(chunk_begin, begin + size * (i + 1) /
+                                                       num_chunks),
+                        end, '\n');
+    chunks[i].begin = chunk_begin;
+    chunks[i].end = chunk_end;
+    chunks[i].error = CsvError{nullptr, nullptr};
+    chunk_begin = chunk_end;
+  }
+
+  for (CsvChunk& chunk : chunks) {
+    CsvChunk* chunk_ptr = &chunk;
+    const Simulator* simulator_ptr = &simulator;
+    pool.Submit([chunk_ptr, simulator_ptr] {
+      try {
+        ParseCsvChunk(*simulator_ptr, *chunk_ptr);
+      } catch (const CsvError& error) {
+        chunk_ptr->error = error;
+      }
+    });
+  }
+  pool.Wait();
+
+  /* Each chunk stops at its first malformed row and the chunks are in the
+     order of the file, so the first chunk with an error has the first
+     malformed row of the file, whichever chunk failed first */
+  for (const CsvChunk& chunk : chunks) {
+    if (chunk.error.position != nullptr) {
+      throw std::runtime_error(
+          path + ":" +
+          std::to_string(GetLineNumber(data, chunk.error.position)) + ": " +
+          chunk.error.message);
+    }
+  }
+
+  size_t num_particles = simulator.GetNumParticles();
+  for (const CsvChunk& chunk : chunks) {
+    num_particles += chunk.particles.size();
+  }
+  simulator.ReserveParticles(num_particles);
+  for (CsvChunk& chunk : chunks) {
+    for (const Particle& particle : chunk.particles) {
+      simulator.AddParticle(particle);
+    }
+
+    /* Free each chunk once it is stored, so that the file's particles are
+       not held twice over at the end */
+    std::vector<Particle>().swap(chunk.particles);
+  }
+}
+
+void LoadBinaryParticles(const std::string& path, Simulator& simulator) {
+  MappedFile file = MappedFile::Open(path);
+  const char* data = file.GetData();
+  if (file.GetSize() < kBinaryHeaderSize ||
+      std::memcmp(data, kParticleFileMagic, sizeof(kParticleFileMagic)) !=
+          0) {
+    throw std::runtime_error(path + " is not a particle file");
+  }
+
+  uint64_t num_particles;
+  std::memcpy(&num_particles, data + sizeof(kParticleFileMagic),
+              sizeof(num_particles));
+  if ((file.GetSize() - kBinaryHeaderSize) / kBinaryParticleSize !=
+          num_particles ||
+      (file.GetSize() - kBinaryHeaderSize) % kBinaryParticleSize != 0) {
+    throw std::runtime_error(path + " does not hold " +
+                             std::to_string(num_particles) + " particles");
+  }
+
+  /* Every column starts at a multiple of its alignment, as the mapping
+     starts on a page */
+  size_t n = static_cast<size_t>(num_particles);
+  const double* x = reinterpret_cast<const double*>(data + kBinaryHeaderSize);
+  const double* y = x + n;
+  const float* vx = reinterpret_cast<const float*>(y + n);
+  const float* vy = vx + n;
+  const uint8_t* species = reinterpret_cast<const uint8_t*>(vy + n);
+
+  for (size_t i = 0; i < n; i++) {
+    if (species[i] > 2) {
+      throw std::runtime_error(path + " has a particle of unknown species " +
+                               std::to_string(species[i]));
+    }
+  }
+
+  const double radii[] = {simulator.kSmallRadius, simulator.kMediumRadius,
+                          simulator.kLargeRadius};
+  const double masses[] = {simulator.kSmallMass, simulator.kMediumMass,
+                           simulator.kLargeMass};
+  const ci::Color colors[] = {simulator.kSmallColor, simulator.kMediumColor,
+                              simulator.kLargeColor};
+  simulator.ReserveParticles(simulator.GetNumParticles() + n);
+  for (size_t i = 0; i < n; i++) {
+    uint8_t code = species[i];
+    simulator.AddParticle(Particle(radii[code], masses[code],
+                                   glm::dvec2(x[i], y[i]),
+                                   glm::vec2(vx[i], vy[i]), colors[code]));
+  }
+}
+
+void SaveBinaryParticles(const std::string& path,
+                         const Simulator& simulator) {
+  ChunkedView<Particle> particles = simulator.GetParticles();
+  std::vector<uint8_t> species(particles.size());
+  for (size_t i = 0; i < particles.size(); i++) {
+    species[i] = GetSpeciesCode(simulator, particles[i]);
+  }
+
+  std::ofstream output(path, std::ios::binary | std::ios::trunc);
+  if (!output) {
+    throw std::runtime_error("could not open " + path);
+  }
+  uint64_t num_particles = particles.size();
+  output.write(kParticleFileMagic, sizeof(kParticleFileMagic));
+  output.write(reinterpret_cast<const char*>(&num_particles),
+               sizeof(num_particles));
+
+  /* Write one column at a time */
+  for (int axis = 0; axis < 2; axis++) {
+    for (const Particle& particle : particles) {
+      double value = particle.GetPrecisePosition()[axis];
+      output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+  }
+  for (int axis = 0; axis < 2; axis++) {
+    for (const Particle& particle : particles) {
+      float value = particle.GetVelocity()[axis];
+      output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+  }
+  output.write(reinterpret_cast<const char*>(species.data()),
+               static_cast<std::streamsize>(species.size()));
+
+  if (!output) {
+    throw std::runtime_error("could not write " + path);
+  }
+}
+
+}  // namespace idealgas
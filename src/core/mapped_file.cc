@@ -0,0 +1,129 @@
+#include <core/mapped_file.h>
+
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace idealgas {
+
+#ifndef _WIN32
+
+namespace {
+
+/**
+ * Maps the whole of a file, or returns null if it is empty, as zero-length
+ * mappings are not allowed
+ */
+void* Map(const std::string& path, bool is_writable, size_t& size) {
+  int fd = open(path.c_str(), is_writable ? O_RDWR : O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("could not open " + path);
+  }
+
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    close(fd);
+    throw std::runtime_error("could not open " + path);
+  }
+
+  size = static_cast<size_t>(status.st_size);
+  if (size == 0) {
+    close(fd);
+    return nullptr;
+  }
+
+  /* Writable mappings are shared, so that writes reach the file */
+  int protection = is_writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  int flags = is_writable ? MAP_SHARED : MAP_PRIVATE;
+  void* data = mmap(nullptr, size, protection, flags, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("could not map " + path);
+  }
+  return data;
+}
+
+}  // namespace
+
+MappedFile MappedFile::Open(const std::string& path) {
+  size_t size;
+  void* data = Map(path, false, size);
+
+  /* Files are read front to back, so let the kernel read ahead */
+  if (data != nullptr) {
+    madvise(data, size, MADV_SEQUENTIAL);
+  }
+  return MappedFile(data, size);
+}
+
+MappedFile MappedFile::OpenWritable(const std::string& path) {
+  size_t size;
+  void* data = Map(path, true, size);
+  return MappedFile(data, size);
+}
+
+void MappedFile::Release() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#else
+
+MappedFile MappedFile::Open(const std::string& path) {
+  throw std::runtime_error("mapped files are not supported on this platform");
+}
+
+MappedFile MappedFile::OpenWritable(const std::string& path) {
+  throw std::runtime_error("mapped files are not supported on this platform");
+}
+
+void MappedFile::Release() {
+}
+
+#endif
+
+MappedFile::MappedFile(void* data, size_t size) : data_(data), size_(size) {
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+    : data_(other.data_), size_(other.size_) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  if (this != &other) {
+    Release();
+    data_ = other.data_;
+    size_ = other.size_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  Release();
+}
+
+const char* MappedFile::GetData() const {
+  return static_cast<const char*>(data_);
+}
+
+size_t MappedFile::GetSize() const {
+  return size_;
+}
+
+char* MappedFile::GetMutableData() const {
+  return static_cast<char*>(data_);
+}
+
+}  // namespace idealgas
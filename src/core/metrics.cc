@@ -0,0 +1,125 @@
+#include <core/metrics.h>
+
+#include <sstream>
+
+namespace idealgas {
+
+namespace {
+
+void WriteMetric(std::ostream& output, const std::string& name,
+                 const std::string& type, const std::string& help,
+                 double value) {
+  output << "# HELP idealgas_" << name << ' ' << help << '\n'
+         << "# TYPE idealgas_" << name << ' ' << type << '\n'
+         << "idealgas_" << name << ' ' << value << '\n';
+}
+
+}  // namespace
+
+MetricsRecorder::MetricsRecorder(double sample_interval)
+    : sample_interval_(std::chrono::duration_cast<
+                       std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(sample_interval))),
+      has_recorded_(false),
+      last_num_steps_(0),
+      last_num_collisions_(0),
+      initial_energy_(0) {
+}
+
+void MetricsRecorder::Record(const Simulator& simulator) {
+  std::chrono::steady_clock::time_point now =
+      std::chrono::steady_clock::now();
+  if (has_recorded_ && now - last_time_ < sample_interval_) {
+    return;
+  }
+
+  MetricsSnapshot snapshot = MetricsSnapshot();
+  snapshot.num_steps = simulator.GetNumSteps();
+  snapshot.num_collisions = simulator.GetNumCollisions();
+  snapshot.kinetic_energy = simulator.GetKineticEnergy();
+
+  if (!has_recorded_) {
+    initial_energy_ = snapshot.kinetic_energy;
+  } else {
+    std::chrono::duration<double> elapsed = now - last_time_;
+    uint64_t num_steps = snapshot.num_steps - last_num_steps_;
+    snapshot.steps_per_second = num_steps / elapsed.count();
+    if (num_steps > 0) {
+      snapshot.collisions_per_step =
+          static_cast<double>(snapshot.num_collisions -
+                              last_num_collisions_) /
+          num_steps;
+    }
+  }
+  if (initial_energy_ > 0) {
+    snapshot.energy_drift =
+        (snapshot.kinetic_energy - initial_energy_) / initial_energy_;
+  }
+
+  /* Particles belong to the species of their radius and mass, as in the
+     histograms and the collision log */
+  for (const Particle& particle : simulator.GetParticles()) {
+    switch (simulator.GetSpecies(particle)) {
+      case CollisionSpecies::kSmall:
+        snapshot.num_small++;
+        break;
+      case CollisionSpecies::kMedium:
+        snapshot.num_medium++;
+        break;
+      case CollisionSpecies::kLarge:
+        snapshot.num_large++;
+        break;
+      case CollisionSpecies::kOther:
+        snapshot.num_other++;
+        break;
+    }
+  }
+
+  snapshot_.Store(snapshot);
+  has_recorded_ = true;
+  last_time_ = now;
+  last_num_steps_ = snapshot.num_steps;
+  last_num_collisions_ = snapshot.num_collisions;
+}
+
+MetricsSnapshot MetricsRecorder::GetSnapshot() const {
+  return snapshot_.Load();
+}
+
+std::string FormatPrometheus(const MetricsSnapshot& snapshot) {
+  std::stringstream output;
+  output.precision(17);
+
+  WriteMetric(output, "steps_total", "counter", "Simulation updates run.",
+              static_cast<double>(snapshot.num_steps));
+  WriteMetric(output, "collisions_total", "counter",
+              "Collisions between pairs of particles.",
+              static_cast<double>(snapshot.num_collisions));
+  WriteMetric(output, "steps_per_second", "gauge",
+              "Updates per second since the previous snapshot.",
+              snapshot.steps_per_second);
+  WriteMetric(output, "collisions_per_step", "gauge",
+              "Collisions per update since the previous snapshot.",
+              snapshot.collisions_per_step);
+  WriteMetric(output, "kinetic_energy", "gauge",
+              "Total kinetic energy of the particles.",
+              snapshot.kinetic_energy);
+  WriteMetric(output, "energy_drift", "gauge",
+              "Relative change in kinetic energy since the first snapshot.",
+              snapshot.energy_drift);
+
+  output << "# HELP idealgas_particles Particles of each species.\n"
+         << "# TYPE idealgas_particles gauge\n"
+         << "idealgas_particles{species=\"small\"} " << snapshot.num_small
+         << '\n'
+         << "idealgas_particles{species=\"medium\"} " << snapshot.num_medium
+         << '\n'
+         << "idealgas_particles{species=\"large\"} " << snapshot.num_large
+         << '\n'
+         << "idealgas_particles{species=\"other\"} " << snapshot.num_other
+         << '\n';
+
+  return output.str();
+}
+
+}  // namespace idealgas
@@ -0,0 +1,164 @@
+#include <core/metrics_server.h>
+
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace idealgas {
+
+#ifndef _WIN32
+
+namespace {
+
+/** How often the server checks whether it is being stopped, in ms */
+const int kPollInterval = 100;
+
+/** Requests larger than this are cut off, as only the first line is used */
+const size_t kMaxRequestSize = 4096;
+
+/* A client which hangs up early must not kill the process with SIGPIPE */
+#ifdef MSG_NOSIGNAL
+const int kSendFlags = MSG_NOSIGNAL;
+#else
+const int kSendFlags = 0;
+#endif
+
+void SendAll(int connection, const std::string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t result =
+        send(connection, data.data() + sent, data.size() - sent,
+             kSendFlags);
+    if (result <= 0) {
+      return;
+    }
+    sent += static_cast<size_t>(result);
+  }
+}
+
+}  // namespace
+
+MetricsServer::MetricsServer(const MetricsRecorder& recorder, uint16_t port)
+    : recorder_(recorder), socket_(-1), port_(0), is_stopping_(false) {
+  socket_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (socket_ < 0) {
+    throw std::runtime_error("could not create the metrics socket");
+  }
+  int reuse = 1;
+  setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  /* Only local clients, such as a Prometheus agent on the same host, can
+     connect */
+  sockaddr_in address = sockaddr_in();
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  socklen_t length = sizeof(address);
+  if (bind(socket_, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+      listen(socket_, 16) != 0 ||
+      getsockname(socket_, reinterpret_cast<sockaddr*>(&address),
+                  &length) != 0) {
+    close(socket_);
+    throw std::runtime_error("could not listen for metrics on port " +
+                             std::to_string(port));
+  }
+  port_ = ntohs(address.sin_port);
+
+  thread_ = std::thread(&MetricsServer::Serve, this);
+}
+
+MetricsServer::~MetricsServer() {
+  is_stopping_ = true;
+  thread_.join();
+  close(socket_);
+}
+
+void MetricsServer::Serve() {
+  pollfd listener = pollfd();
+  listener.fd = socket_;
+  listener.events = POLLIN;
+
+  while (!is_stopping_) {
+    if (poll(&listener, 1, kPollInterval) <= 0 ||
+        !(listener.revents & POLLIN)) {
+      continue;
+    }
+
+    int connection = accept(socket_, nullptr, nullptr);
+    if (connection >= 0) {
+      Respond(connection);
+      close(connection);
+    }
+  }
+}
+
+void MetricsServer::Respond(int connection) {
+  /* Read until the end of the request line, giving up on clients which
+     stall so that they cannot block the server */
+  std::string request;
+  char buffer[512];
+  pollfd client = pollfd();
+  client.fd = connection;
+  client.events = POLLIN;
+  while (request.find("\r\n") == std::string::npos &&
+         request.size() < kMaxRequestSize) {
+    if (poll(&client, 1, kPollInterval * 10) <= 0) {
+      return;
+    }
+    ssize_t result = recv(connection, buffer, sizeof(buffer), 0);
+    if (result <= 0) {
+      return;
+    }
+    request.append(buffer, static_cast<size_t>(result));
+  }
+
+  std::string status;
+  std::string body;
+  if (request.compare(0, 13, "GET /metrics ") == 0 ||
+      request.compare(0, 13, "GET /metrics?") == 0) {
+    status = "200 OK";
+    body = FormatPrometheus(recorder_.GetSnapshot());
+  } else {
+    status = "404 Not Found";
+    body = "Metrics are served at /metrics\n";
+  }
+
+  SendAll(connection,
+          "HTTP/1.1 " + status +
+              "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8"
+              "\r\nContent-Length: " +
+              std::to_string(body.size()) +
+              "\r\nConnection: close\r\n\r\n" + body);
+}
+
+#else
+
+MetricsServer::MetricsServer(const MetricsRecorder& recorder, uint16_t port)
+    : recorder_(recorder), socket_(-1), port_(0), is_stopping_(false) {
+  throw std::runtime_error("the metrics server is not supported on this "
+                           "platform");
+}
+
+MetricsServer::~MetricsServer() {
+}
+
+void MetricsServer::Serve() {
+}
+
+void MetricsServer::Respond(int connection) {
+}
+
+#endif
+
+uint16_t MetricsServer::GetPort() const {
+  return port_;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,125 @@
+#include <core/morton_order.h>
+
+namespace idealgas {
+
+namespace {
+
+/** Spreads the lower 16 bits of a value out into the even bits */
+uint32_t SpreadBits(uint32_t value) {
+  value &= 0x0000ffff;
+  value = (value | (value << 8)) & 0x00ff00ff;
+  value = (value | (value << 4)) & 0x0f0f0f0f;
+  value = (value | (value << 2)) & 0x33333333;
+  value = (value | (value << 1)) & 0x55555555;
+  return value;
+}
+
+/** Spreads the lower 10 bits of a value out into every third bit */
+uint32_t SpreadBitsByThree(uint32_t value) {
+  value &= 0x000003ff;
+  value = (value | (value << 16)) & 0x030000ff;
+  value = (value | (value << 8)) & 0x0300f00f;
+  value = (value | (value << 4)) & 0x030c30c3;
+  value = (value | (value << 2)) & 0x09249249;
+  return value;
+}
+
+/**
+ * Returns the lattice coordinate of a position along one axis, on a lattice
+ * with the specified number of points per axis
+ */
+uint32_t Quantize(double coordinate, double length, uint32_t lattice_size) {
+  double scaled = coordinate / length * lattice_size;
+
+  /* Particles may be slightly past a wall */
+  if (scaled <= 0) {
+    return 0;
+  }
+  if (scaled >= lattice_size - 1) {
+    return lattice_size - 1;
+  }
+  return (uint32_t)scaled;
+}
+
+/** Returns the Morton code of a position, with a lattice per dimension */
+uint32_t GetMortonCode(const glm::dvec2& position, const glm::dvec2& size) {
+  const uint32_t kLatticeSize = 1 << 16;
+  return EncodeMorton(Quantize(position.x, size.x, kLatticeSize),
+                      Quantize(position.y, size.y, kLatticeSize));
+}
+
+uint32_t GetMortonCode(const glm::dvec3& position, const glm::dvec3& size) {
+  const uint32_t kLatticeSize = 1 << 10;
+  return EncodeMorton(Quantize(position.x, size.x, kLatticeSize),
+                      Quantize(position.y, size.y, kLatticeSize),
+                      Quantize(position.z, size.z, kLatticeSize));
+}
+
+}  // namespace
+
+uint32_t EncodeMorton(uint32_t x, uint32_t y) {
+  return SpreadBits(x) | (SpreadBits(y) << 1);
+}
+
+uint32_t EncodeMorton(uint32_t x, uint32_t y, uint32_t z) {
+  return SpreadBitsByThree(x) | (SpreadBitsByThree(y) << 1) |
+         (SpreadBitsByThree(z) << 2);
+}
+
+template <typename ParticleType>
+const std::vector<size_t>& MortonOrder::Compute(
+    const ChunkedView<ParticleType>& particles,
+    const typename ParticleType::PreciseVector& size) {
+  size_t num_particles = particles.size();
+  codes_.resize(num_particles);
+  sorted_codes_.resize(num_particles);
+  order_.resize(num_particles);
+  sorted_order_.resize(num_particles);
+
+  for (size_t i = 0; i < num_particles; i++) {
+    codes_[i] = GetMortonCode(particles[i].GetPrecisePosition(), size);
+    order_[i] = i;
+  }
+
+  SortCodes();
+  return order_;
+}
+
+template const std::vector<size_t>& MortonOrder::Compute<Particle>(
+    const ChunkedView<Particle>& particles,
+    const Particle::PreciseVector& size);
+template const std::vector<size_t>& MortonOrder::Compute<Particle3d>(
+    const ChunkedView<Particle3d>& particles,
+    const Particle3d::PreciseVector& size);
+template const std::vector<size_t>& MortonOrder::Compute<PreciseParticle>(
+    const ChunkedView<PreciseParticle>& particles,
+    const PreciseParticle::PreciseVector& size);
+template const std::vector<size_t>& MortonOrder::Compute<PreciseParticle3d>(
+    const ChunkedView<PreciseParticle3d>& particles,
+    const PreciseParticle3d::PreciseVector& size);
+
+void MortonOrder::SortCodes() {
+  size_t num_particles = codes_.size();
+
+  /* Least significant digit radix sort, one byte of the code per pass. Every
+     pass is stable, so the sort as a whole is stable. */
+  for (size_t shift = 0; shift < 32; shift += 8) {
+    size_t offsets[257] = {0};
+    for (size_t i = 0; i < num_particles; i++) {
+      offsets[((codes_[i] >> shift) & 0xff) + 1]++;
+    }
+    for (size_t digit = 0; digit < 256; digit++) {
+      offsets[digit + 1] += offsets[digit];
+    }
+
+    for (size_t i = 0; i < num_particles; i++) {
+      size_t slot = offsets[(codes_[i] >> shift) & 0xff]++;
+      sorted_codes_[slot] = codes_[i];
+      sorted_order_[slot] = order_[i];
+    }
+    codes_.swap(sorted_codes_);
+    order_.swap(sorted_order_);
+  }
+}
+
+}  // namespace idealgas
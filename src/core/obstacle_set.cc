@@ -0,0 +1,226 @@
+#include <core/obstacle_set.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace idealgas {
+
+namespace {
+
+glm::dvec2 GetMin(const Obstacle& obstacle) {
+  return glm::dvec2(std::min(obstacle.start.x, obstacle.end.x),
+                    std::min(obstacle.start.y, obstacle.end.y)) -
+         glm::dvec2(obstacle.thickness, obstacle.thickness);
+}
+
+glm::dvec2 GetMax(const Obstacle& obstacle) {
+  return glm::dvec2(std::max(obstacle.start.x, obstacle.end.x),
+                    std::max(obstacle.start.y, obstacle.end.y)) +
+         glm::dvec2(obstacle.thickness, obstacle.thickness);
+}
+
+glm::dvec2 GetCenter(const Obstacle& obstacle) {
+  return (obstacle.start + obstacle.end) * 0.5;
+}
+
+/** Returns the point of the obstacle's segment closest to the position */
+glm::dvec2 GetClosestPoint(const Obstacle& obstacle,
+                           const glm::dvec2& position) {
+  glm::dvec2 direction = obstacle.end - obstacle.start;
+  double length_squared = glm::dot(direction, direction);
+  if (length_squared == 0) {
+    return obstacle.start;
+  }
+
+  double t = glm::dot(position - obstacle.start, direction) / length_squared;
+  t = std::max(0.0, std::min(1.0, t));
+  return obstacle.start + direction * t;
+}
+
+std::invalid_argument ObstacleError(size_t line_number,
+                                    const std::string& message) {
+  return std::invalid_argument("obstacle line " +
+                               std::to_string(line_number) + ": " + message);
+}
+
+}  // namespace
+
+void ObstacleSet::AddSegment(const glm::dvec2& start, const glm::dvec2& end) {
+  obstacles_.push_back({start, end, 0});
+}
+
+void ObstacleSet::AddDisc(const glm::dvec2& center, double radius) {
+  obstacles_.push_back({center, center, radius});
+}
+
+void ObstacleSet::AddPolygon(const std::vector<glm::dvec2>& vertices) {
+  for (size_t i = 0; i < vertices.size(); i++) {
+    AddSegment(vertices[i], vertices[(i + 1) % vertices.size()]);
+  }
+}
+
+void ObstacleSet::Build() {
+  nodes_.clear();
+  if (!obstacles_.empty()) {
+    /* A tree over n obstacles has fewer than 2n nodes */
+    nodes_.reserve(2 * obstacles_.size());
+    BuildNode(0, obstacles_.size());
+  }
+}
+
+void ObstacleSet::BuildNode(size_t first, size_t count) {
+  size_t index = nodes_.size();
+  nodes_.push_back({GetMin(obstacles_[first]), GetMax(obstacles_[first]),
+                    first, count, 0});
+
+  for (size_t i = first + 1; i < first + count; i++) {
+    nodes_[index].min = glm::min(nodes_[index].min, GetMin(obstacles_[i]));
+    nodes_[index].max = glm::max(nodes_[index].max, GetMax(obstacles_[i]));
+  }
+
+  if (count <= kMaxLeafSize) {
+    return;
+  }
+
+  /* Split at the median center along the longer side of the box */
+  glm::dvec2 extent = nodes_[index].max - nodes_[index].min;
+  bool split_x = extent.x >= extent.y;
+  size_t half = count / 2;
+  std::nth_element(obstacles_.begin() + first,
+                   obstacles_.begin() + first + half,
+                   obstacles_.begin() + first + count,
+                   [split_x](const Obstacle& a, const Obstacle& b) {
+                     return split_x ? GetCenter(a).x < GetCenter(b).x
+                                    : GetCenter(a).y < GetCenter(b).y;
+                   });
+
+  /* Inner nodes are marked by having no obstacles of their own */
+  nodes_[index].count = 0;
+  BuildNode(first, half);
+  nodes_[index].second_child = nodes_.size();
+  BuildNode(first + half, count - half);
+}
+
+ObstacleSet ObstacleSet::Parse(std::istream& input) {
+  ObstacleSet obstacles;
+
+  std::string line;
+  size_t line_number = 0;
+  while (std::getline(input, line)) {
+    line_number++;
+    std::istringstream fields(line.substr(0, line.find('#')));
+
+    std::string type;
+    if (!(fields >> type)) {
+      continue;
+    }
+
+    std::vector<double> values;
+    double value;
+    while (fields >> value) {
+      values.push_back(value);
+    }
+    if (!fields.eof()) {
+      throw ObstacleError(line_number, "expected numbers after " + type);
+    }
+
+    if (type == "segment" && values.size() == 4) {
+      obstacles.AddSegment(glm::dvec2(values[0], values[1]),
+                           glm::dvec2(values[2], values[3]));
+    } else if (type == "disc" && values.size() == 3 && values[2] > 0) {
+      obstacles.AddDisc(glm::dvec2(values[0], values[1]), values[2]);
+    } else if (type == "polygon" && values.size() >= 6 &&
+               values.size() % 2 == 0) {
+      std::vector<glm::dvec2> vertices;
+      for (size_t i = 0; i < values.size(); i += 2) {
+        vertices.push_back(glm::dvec2(values[i], values[i + 1]));
+      }
+      obstacles.AddPolygon(vertices);
+    } else {
+      throw ObstacleError(line_number, "malformed " + type);
+    }
+  }
+
+  obstacles.Build();
+  return obstacles;
+}
+
+ObstacleSet ObstacleSet::Load(const std::string& path) {
+  std::ifstream input(path);
+  if (!input) {
+    throw std::runtime_error("could not open obstacle file " + path);
+  }
+  return Parse(input);
+}
+
+bool ObstacleSet::Reflect(const glm::dvec2& position, double radius,
+                          glm::vec2& velocity) const {
+  return ReflectVelocity(position, radius, velocity);
+}
+
+bool ObstacleSet::Reflect(const glm::dvec2& position, double radius,
+                          glm::dvec2& velocity) const {
+  return ReflectVelocity(position, radius, velocity);
+}
+
+template <typename T>
+bool ObstacleSet::ReflectVelocity(const glm::dvec2& position, double radius,
+                                  glm::tvec2<T>& velocity) const {
+  if (nodes_.empty()) {
+    return false;
+  }
+
+  bool is_reflected = false;
+
+  /* Depth-first traversal of the nodes whose boxes overlap the particle's
+     bounding box. The tree is balanced, so the stack stays shallow. */
+  size_t stack[64];
+  size_t stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    const Node& node = nodes_[stack[--stack_size]];
+    if (position.x + radius < node.min.x || position.x - radius > node.max.x ||
+        position.y + radius < node.min.y || position.y - radius > node.max.y) {
+      continue;
+    }
+
+    if (node.count == 0) {
+      size_t first_child = &node - &nodes_[0] + 1;
+      stack[stack_size++] = first_child;
+      stack[stack_size++] = node.second_child;
+      continue;
+    }
+
+    for (size_t i = node.first; i < node.first + node.count; i++) {
+      const Obstacle& obstacle = obstacles_[i];
+      glm::dvec2 normal = position - GetClosestPoint(obstacle, position);
+      double distance = glm::length(normal);
+      if (distance > radius + obstacle.thickness || distance == 0) {
+        continue;
+      }
+
+      /* Specular reflection, if the particle is moving into the obstacle */
+      glm::tvec2<T> unit_normal(normal / distance);
+      T normal_speed = glm::dot(velocity, unit_normal);
+      if (normal_speed < 0) {
+        velocity -= unit_normal * (2 * normal_speed);
+        is_reflected = true;
+      }
+    }
+  }
+
+  return is_reflected;
+}
+
+const std::vector<Obstacle>& ObstacleSet::GetObstacles() const {
+  return obstacles_;
+}
+
+bool ObstacleSet::IsEmpty() const {
+  return obstacles_.empty();
+}
+
+}  // namespace idealgas
@@ -2,57 +2,129 @@
 
 namespace idealgas {
 
-Particle::Particle(double radius, double mass, const glm::vec2& position,
-                   const glm::vec2& velocity, const ci::Color& color)
+template <int Dim, typename Scalar>
+BasicParticle<Dim, Scalar>::BasicParticle(double radius, double mass,
+                                          const Vec<Dim, float>& position,
+                                          const Vector& velocity,
+                                          const ci::Color& color)
     : radius_(radius),
       mass_(mass),
       position_(position),
       velocity_(velocity),
-      color_(color) {
+      color_(color),
+      time_step_level_(0) {
 }
 
-Particle::Particle(double radius, double mass, const glm::vec2& position,
-                   const glm::vec2& velocity)
+template <int Dim, typename Scalar>
+BasicParticle<Dim, Scalar>::BasicParticle(double radius, double mass,
+                                          const Vec<Dim, float>& position,
+                                          const Vector& velocity)
     : radius_(radius),
       mass_(mass),
       position_(position),
       velocity_(velocity),
-      color_("red") {
+      color_("red"),
+      time_step_level_(0) {
 }
 
-void Particle::UpdatePosition() {
-  position_ += velocity_;
+template <int Dim, typename Scalar>
+BasicParticle<Dim, Scalar>::BasicParticle(double radius, double mass,
+                                          const PreciseVector& position,
+                                          const Vector& velocity,
+                                          const ci::Color& color)
+    : radius_(radius),
+      mass_(mass),
+      position_(position),
+      velocity_(velocity),
+      color_(color),
+      time_step_level_(0) {
+}
+
+template <int Dim, typename Scalar>
+BasicParticle<Dim, Scalar>::BasicParticle(double radius, double mass,
+                                          const PreciseVector& position,
+                                          const Vector& velocity)
+    : radius_(radius),
+      mass_(mass),
+      position_(position),
+      velocity_(velocity),
+      color_("red"),
+      time_step_level_(0) {
+}
+
+template <int Dim, typename Scalar>
+void BasicParticle<Dim, Scalar>::UpdatePosition() {
+  position_ += PreciseVector(velocity_);
 }
 
-const glm::vec2& Particle::GetPosition() const {
+template <int Dim, typename Scalar>
+void BasicParticle<Dim, Scalar>::UpdatePosition(double duration) {
+  position_ += PreciseVector(velocity_) * duration;
+}
+
+template <int Dim, typename Scalar>
+Vec<Dim, float> BasicParticle<Dim, Scalar>::GetPosition() const {
+  return Vec<Dim, float>(position_);
+}
+
+template <int Dim, typename Scalar>
+const typename BasicParticle<Dim, Scalar>::PreciseVector&
+BasicParticle<Dim, Scalar>::GetPrecisePosition() const {
   return position_;
 }
 
-const glm::vec2& Particle::GetVelocity() const {
+template <int Dim, typename Scalar>
+const typename BasicParticle<Dim, Scalar>::Vector&
+BasicParticle<Dim, Scalar>::GetVelocity() const {
   return velocity_;
 }
 
-double Particle::GetRadius() const {
+template <int Dim, typename Scalar>
+double BasicParticle<Dim, Scalar>::GetRadius() const {
   return radius_;
 }
 
-double Particle::GetMass() const {
+template <int Dim, typename Scalar>
+double BasicParticle<Dim, Scalar>::GetMass() const {
   return mass_;
 }
 
-const ci::Color& Particle::GetColor() const {
+template <int Dim, typename Scalar>
+const ci::Color& BasicParticle<Dim, Scalar>::GetColor() const {
   return color_;
 }
 
-void Particle::SetVelocity(const glm::vec2& velocity) {
+template <int Dim, typename Scalar>
+void BasicParticle<Dim, Scalar>::SetVelocity(const Vector& velocity) {
   velocity_ = velocity;
 }
 
-bool Particle::operator==(const Particle& other) const {
+template <int Dim, typename Scalar>
+void BasicParticle<Dim, Scalar>::SetPosition(const PreciseVector& position) {
+  position_ = position;
+}
+
+template <int Dim, typename Scalar>
+int BasicParticle<Dim, Scalar>::GetTimeStepLevel() const {
+  return time_step_level_;
+}
+
+template <int Dim, typename Scalar>
+void BasicParticle<Dim, Scalar>::SetTimeStepLevel(int level) {
+  time_step_level_ = level;
+}
+
+template <int Dim, typename Scalar>
+bool BasicParticle<Dim, Scalar>::operator==(const BasicParticle& other) const {
   return (this->GetRadius() == other.GetRadius()) &&
          (this->GetMass() == other.GetMass()) &&
-         (this->GetPosition() == other.GetPosition()) &&
+         (this->GetPrecisePosition() == other.GetPrecisePosition()) &&
          (this->GetVelocity() == other.GetVelocity());
 }
 
+template class BasicParticle<2, float>;
+template class BasicParticle<3, float>;
+template class BasicParticle<2, double>;
+template class BasicParticle<3, double>;
+
 }  // namespace idealgas
\ No newline at end of file
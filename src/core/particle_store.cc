@@ -0,0 +1,185 @@
+#include <core/particle_store.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace idealgas {
+
+bool ParticleHandle::operator==(const ParticleHandle& other) const {
+  return slot == other.slot && generation == other.generation;
+}
+
+bool ParticleHandle::operator!=(const ParticleHandle& other) const {
+  return !(*this == other);
+}
+
+template <typename ParticleType>
+BasicParticleStore<ParticleType>::BasicParticleStore(
+    const BasicParticleStore& other) {
+  *this = other;
+}
+
+template <typename ParticleType>
+BasicParticleStore<ParticleType>& BasicParticleStore<ParticleType>::operator=(
+    const BasicParticleStore& other) {
+  /* The permutation buffers are not worth copying */
+  particles_ = other.particles_;
+  particle_slots_ = other.particle_slots_;
+  slots_ = other.slots_;
+  free_slots_ = other.free_slots_;
+  return *this;
+}
+
+template <typename ParticleType>
+ParticleHandle BasicParticleStore<ParticleType>::Insert(
+    const ParticleType& particle) {
+  uint32_t slot;
+  if (free_slots_.empty()) {
+    slot = (uint32_t)slots_.Size();
+    slots_.PushBack({0, 0});
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  }
+
+  slots_.GetMutable(slot).index = Size();
+  particles_.PushBack(particle);
+  particle_slots_.PushBack(slot);
+
+  return {slot, slots_[slot].generation};
+}
+
+template <typename ParticleType>
+bool BasicParticleStore<ParticleType>::Remove(const ParticleHandle& handle) {
+  if (!Contains(handle)) {
+    return false;
+  }
+
+  /* Move the last particle into the hole, so that only its slot changes.
+     A shared store copies only the chunks of the hole and the last
+     particle. */
+  size_t index = slots_[handle.slot].index;
+  size_t last = Size() - 1;
+  if (index != last) {
+    particles_.GetMutable(index) = particles_[last];
+    particle_slots_.GetMutable(index) = particle_slots_[last];
+    slots_.GetMutable(particle_slots_[index]).index = index;
+  }
+  particles_.PopBack();
+  particle_slots_.PopBack();
+
+  /* Bumping the generation invalidates every handle to the removed
+     particle */
+  slots_.GetMutable(handle.slot).generation++;
+  free_slots_.push_back(handle.slot);
+  return true;
+}
+
+template <typename ParticleType>
+void BasicParticleStore<ParticleType>::Clear() {
+  for (size_t i = 0; i < particle_slots_.Size(); i++) {
+    uint32_t slot = particle_slots_[i];
+    slots_.GetMutable(slot).generation++;
+    free_slots_.push_back(slot);
+  }
+  particles_.Clear();
+  particle_slots_.Clear();
+}
+
+template <typename ParticleType>
+void BasicParticleStore<ParticleType>::Reserve(size_t num_particles) {
+  /* Shared stores grow a chunk at a time, so they need no reserving */
+  particles_.Reserve(num_particles);
+  particle_slots_.Reserve(num_particles);
+}
+
+template <typename ParticleType>
+bool BasicParticleStore<ParticleType>::Contains(
+    const ParticleHandle& handle) const {
+  if (handle.slot >= slots_.Size()) {
+    return false;
+  }
+
+  /* A slot whose generation matches always holds a particle, since removing
+     its particle bumps the generation */
+  return slots_[handle.slot].generation == handle.generation;
+}
+
+template <typename ParticleType>
+const ParticleType& BasicParticleStore<ParticleType>::Get(
+    const ParticleHandle& handle) const {
+  return particles_[GetIndex(handle)];
+}
+
+template <typename ParticleType>
+ParticleHandle BasicParticleStore<ParticleType>::GetHandle(
+    size_t index) const {
+  if (index >= particle_slots_.Size()) {
+    throw std::out_of_range("no particle at index " + std::to_string(index));
+  }
+  uint32_t slot = particle_slots_[index];
+  return {slot, slots_[slot].generation};
+}
+
+template <typename ParticleType>
+size_t BasicParticleStore<ParticleType>::GetIndex(
+    const ParticleHandle& handle) const {
+  if (!Contains(handle)) {
+    throw std::out_of_range("particle handle does not refer to a particle");
+  }
+  return slots_[handle.slot].index;
+}
+
+template <typename ParticleType>
+ChunkedView<ParticleType> BasicParticleStore<ParticleType>::GetParticles()
+    const {
+  return ChunkedView<ParticleType>(particles_);
+}
+
+template <typename ParticleType>
+ParticleType& BasicParticleStore<ParticleType>::GetMutable(size_t index) {
+  return particles_.GetMutable(index);
+}
+
+template <typename ParticleType>
+size_t BasicParticleStore<ParticleType>::Size() const {
+  return particle_slots_.Size();
+}
+
+template <typename ParticleType>
+void BasicParticleStore<ParticleType>::Permute(
+    const std::vector<size_t>& order) {
+  permuted_particles_.clear();
+  permuted_slots_.clear();
+  for (size_t i = 0; i < order.size(); i++) {
+    permuted_particles_.push_back(particles_[order[i]]);
+    permuted_slots_.push_back(particle_slots_[order[i]]);
+    slots_.GetMutable(permuted_slots_[i]).index = i;
+  }
+  particles_.Assign(permuted_particles_);
+  particle_slots_.Assign(permuted_slots_);
+}
+
+template <typename ParticleType>
+void BasicParticleStore<ParticleType>::Share() {
+  particles_.Share();
+  particle_slots_.Share();
+  slots_.Share();
+}
+
+template <typename ParticleType>
+size_t BasicParticleStore<ParticleType>::GetUnsharedMemoryUsage() const {
+  return particles_.GetUnsharedMemoryUsage() +
+         particle_slots_.GetUnsharedMemoryUsage() +
+         slots_.GetUnsharedMemoryUsage() +
+         free_slots_.capacity() * sizeof(uint32_t) +
+         permuted_particles_.capacity() * sizeof(ParticleType) +
+         permuted_slots_.capacity() * sizeof(uint32_t);
+}
+
+template class BasicParticleStore<Particle>;
+template class BasicParticleStore<Particle3d>;
+template class BasicParticleStore<PreciseParticle>;
+template class BasicParticleStore<PreciseParticle3d>;
+
+}  // namespace idealgas
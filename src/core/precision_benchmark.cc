@@ -0,0 +1,89 @@
+#include <core/precision_benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+namespace idealgas {
+
+template <typename SimulatorType>
+DriftReport MeasureDrift(const std::string& precision, size_t num_particles,
+                         size_t num_steps, uint32_t seed) {
+  SimulatorType simulator(seed);
+  simulator.SetBoundaryMode(BoundaryMode::kPeriodic);
+  for (size_t i = 0; i < num_particles; i++) {
+    simulator.AddRandomSmallParticle();
+    simulator.AddRandomMediumParticle();
+    simulator.AddRandomLargeParticle();
+  }
+
+  double initial_energy = simulator.GetKineticEnergy();
+  glm::dvec2 initial_momentum = simulator.GetMomentum();
+
+  /* Momentum cancels out over the particles, so its drift is measured
+     against the scale of the individual terms instead */
+  double momentum_scale = 0;
+  for (const typename SimulatorType::ParticleType& particle :
+       simulator.GetParticles()) {
+    momentum_scale +=
+        particle.GetMass() * glm::length(glm::dvec2(particle.GetVelocity()));
+  }
+
+  DriftReport report;
+  report.precision = precision;
+  report.num_particles = simulator.GetNumParticles();
+  report.num_steps = num_steps;
+  report.max_energy_drift = 0;
+  report.final_energy_drift = 0;
+  report.max_momentum_drift = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t step = 0; step < num_steps; step++) {
+    simulator.Update();
+
+    double energy_drift =
+        std::abs(simulator.GetKineticEnergy() - initial_energy) /
+        initial_energy;
+    double momentum_drift =
+        glm::length(simulator.GetMomentum() - initial_momentum) /
+        momentum_scale;
+    report.max_energy_drift = std::max(report.max_energy_drift, energy_drift);
+    report.final_energy_drift = energy_drift;
+    report.max_momentum_drift =
+        std::max(report.max_momentum_drift, momentum_drift);
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  report.seconds_per_step =
+      num_steps > 0 ? elapsed.count() / static_cast<double>(num_steps) : 0;
+
+  return report;
+}
+
+template DriftReport MeasureDrift<Simulator>(const std::string&, size_t,
+                                             size_t, uint32_t);
+template DriftReport MeasureDrift<PreciseSimulator>(const std::string&,
+                                                    size_t, size_t, uint32_t);
+
+void WriteDriftReports(const std::vector<DriftReport>& reports,
+                       std::ostream& output) {
+  output << std::left << std::setw(10) << "precision" << std::right
+         << std::setw(11) << "particles" << std::setw(9) << "steps"
+         << std::setw(14) << "ms/step" << std::setw(16) << "max dE/E"
+         << std::setw(16) << "final dE/E" << std::setw(16) << "max dP/P"
+         << std::endl;
+
+  for (const DriftReport& report : reports) {
+    output << std::left << std::setw(10) << report.precision << std::right
+           << std::setw(11) << report.num_particles << std::setw(9)
+           << report.num_steps << std::fixed << std::setprecision(4)
+           << std::setw(14) << report.seconds_per_step * 1000
+           << std::scientific << std::setprecision(3) << std::setw(16)
+           << report.max_energy_drift << std::setw(16)
+           << report.final_energy_drift << std::setw(16)
+           << report.max_momentum_drift << std::defaultfloat << std::endl;
+  }
+}
+
+}  // namespace idealgas
@@ -0,0 +1,258 @@
+#include <core/rewind_buffer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace idealgas {
+
+namespace {
+
+/** The largest codes of quantized positions and velocities */
+const double kMaxPositionCode = 65535;
+const double kMaxVelocityCode = 32767;
+
+/** Kinds are indexed by 16 bits */
+const size_t kMaxKinds = 65536;
+
+}  // namespace
+
+RewindBuffer::RewindBuffer(size_t capture_interval, size_t keyframe_interval,
+                           size_t memory_budget)
+    : capture_interval_(capture_interval),
+      keyframe_interval_(keyframe_interval),
+      memory_budget_(memory_budget),
+      memory_usage_(0),
+      num_captures_since_keyframe_(0) {
+  if (capture_interval == 0 || keyframe_interval == 0) {
+    throw std::invalid_argument("rewind intervals must be positive");
+  }
+}
+
+void RewindBuffer::Record(const Simulator& simulator) {
+  if (!captures_.empty() &&
+      simulator.GetNumSteps() < captures_.back().step + capture_interval_) {
+    return;
+  }
+  Add(simulator, captures_.empty() ||
+                     num_captures_since_keyframe_ + 1 >= keyframe_interval_);
+}
+
+void RewindBuffer::RecordKeyframe(const Simulator& simulator) {
+  /* A keyframe of the same step is replaced, as nothing can be continued
+     from it without repeating the change made since */
+  if (!captures_.empty() && captures_.back().is_keyframe &&
+      captures_.back().step == simulator.GetNumSteps()) {
+    memory_usage_ -= captures_.back().memory_usage;
+    captures_.pop_back();
+  }
+  Add(simulator, true);
+}
+
+void RewindBuffer::Clear() {
+  captures_.clear();
+  memory_usage_ = 0;
+  num_captures_since_keyframe_ = 0;
+}
+
+size_t RewindBuffer::GetNumCaptures() const {
+  return captures_.size();
+}
+
+size_t RewindBuffer::GetStep(size_t index) const {
+  return captures_.at(index).step;
+}
+
+size_t RewindBuffer::GetMemoryUsage() const {
+  return memory_usage_;
+}
+
+void RewindBuffer::Preview(size_t index, Simulator& simulator) const {
+  const Capture& capture = captures_.at(index);
+  simulator.Reset();
+  simulator.ReserveParticles(capture.kind_indices.size());
+
+  for (size_t i = 0; i < capture.kind_indices.size(); i++) {
+    const ParticleKind& kind = capture.kinds[capture.kind_indices[i]];
+    glm::dvec2 position;
+    glm::vec2 velocity;
+    if (capture.is_keyframe) {
+      position = capture.positions[i];
+      velocity = capture.velocities[i];
+    } else {
+      for (int axis = 0; axis < 2; axis++) {
+        position[axis] = capture.quantized_positions[2 * i + axis] *
+                         capture.plane_size[axis] / kMaxPositionCode;
+        velocity[axis] = static_cast<float>(
+            capture.quantized_velocities[2 * i + axis] *
+            capture.velocity_scale);
+      }
+    }
+    simulator.AddParticle(
+        Particle(kind.radius, kind.mass, position, velocity, kind.color));
+  }
+}
+
+void RewindBuffer::Restore(size_t index, Simulator& simulator) {
+  if (index >= captures_.size()) {
+    throw std::out_of_range("no capture " + std::to_string(index));
+  }
+
+  /* The oldest capture is always a keyframe, as keyframes are dropped
+     together with the previews after them */
+  size_t keyframe_index = index;
+  while (!captures_[keyframe_index].is_keyframe) {
+    keyframe_index--;
+  }
+  const Capture& keyframe = captures_[keyframe_index];
+
+  Simulator::Checkpoint checkpoint = *keyframe.checkpoint;
+  checkpoint.particles.reserve(keyframe.kind_indices.size());
+  for (size_t i = 0; i < keyframe.kind_indices.size(); i++) {
+    const ParticleKind& kind = keyframe.kinds[keyframe.kind_indices[i]];
+    Particle particle(kind.radius, kind.mass, keyframe.positions[i],
+                      keyframe.velocities[i], kind.color);
+    particle.SetTimeStepLevel(keyframe.time_step_levels[i]);
+    checkpoint.particles.push_back(particle);
+  }
+  simulator.RestoreCheckpoint(checkpoint);
+
+  size_t step = captures_[index].step;
+  while (simulator.GetNumSteps() < step) {
+    simulator.Update();
+  }
+
+  while (captures_.size() > index + 1) {
+    memory_usage_ -= captures_.back().memory_usage;
+    captures_.pop_back();
+  }
+  num_captures_since_keyframe_ = index - keyframe_index;
+}
+
+void RewindBuffer::Add(const Simulator& simulator, bool is_keyframe) {
+  ChunkedView<Particle> particles = simulator.GetParticles();
+  captures_.emplace_back();
+  Capture& capture = captures_.back();
+  capture.step = simulator.GetNumSteps();
+  capture.is_keyframe = is_keyframe;
+  IndexKinds(particles, capture);
+
+  if (is_keyframe) {
+    capture.checkpoint.reset(
+        new Simulator::Checkpoint(simulator.SaveCheckpoint()));
+    std::vector<Particle>().swap(capture.checkpoint->particles);
+    capture.positions.reserve(particles.size());
+    capture.velocities.reserve(particles.size());
+    capture.time_step_levels.reserve(particles.size());
+    for (const Particle& particle : particles) {
+      capture.positions.push_back(particle.GetPrecisePosition());
+      capture.velocities.push_back(particle.GetVelocity());
+      capture.time_step_levels.push_back(
+          static_cast<uint8_t>(particle.GetTimeStepLevel()));
+    }
+    num_captures_since_keyframe_ = 0;
+  } else {
+    /* Velocities are scaled to the fastest component in the capture */
+    double max_component = 0;
+    for (const Particle& particle : particles) {
+      for (int axis = 0; axis < 2; axis++) {
+        max_component = std::max(
+            max_component, std::abs(double(particle.GetVelocity()[axis])));
+      }
+    }
+    capture.plane_size = simulator.GetSize();
+    capture.velocity_scale =
+        max_component > 0 ? max_component / kMaxVelocityCode : 1;
+
+    capture.quantized_positions.reserve(2 * particles.size());
+    capture.quantized_velocities.reserve(2 * particles.size());
+    for (const Particle& particle : particles) {
+      for (int axis = 0; axis < 2; axis++) {
+        double position = particle.GetPrecisePosition()[axis] /
+                          capture.plane_size[axis] * kMaxPositionCode;
+        position = std::min(std::max(position, 0.0), kMaxPositionCode);
+        capture.quantized_positions.push_back(
+            static_cast<uint16_t>(std::lround(position)));
+        capture.quantized_velocities.push_back(static_cast<int16_t>(
+            std::lround(particle.GetVelocity()[axis] /
+                        capture.velocity_scale)));
+      }
+    }
+    num_captures_since_keyframe_++;
+  }
+
+  capture.memory_usage = ComputeMemoryUsage(capture);
+  memory_usage_ += capture.memory_usage;
+
+  /* Drop the oldest keyframe and its previews while over budget, but never
+     the newest keyframe */
+  while (memory_usage_ > memory_budget_) {
+    size_t next_keyframe = 1;
+    while (next_keyframe < captures_.size() &&
+           !captures_[next_keyframe].is_keyframe) {
+      next_keyframe++;
+    }
+    if (next_keyframe == captures_.size()) {
+      break;
+    }
+    for (size_t i = 0; i < next_keyframe; i++) {
+      memory_usage_ -= captures_.front().memory_usage;
+      captures_.pop_front();
+    }
+  }
+}
+
+void RewindBuffer::IndexKinds(const ChunkedView<Particle>& particles,
+                              Capture& capture) {
+  /* Simulations hold few kinds of particle, and neighboring particles are
+     often of the same kind, so a linear search after checking the last
+     match is fast */
+  capture.kind_indices.reserve(particles.size());
+  size_t last = 0;
+  for (const Particle& particle : particles) {
+    size_t index = last;
+    if (index >= capture.kinds.size() ||
+        !IsKind(capture.kinds[index], particle)) {
+      index = 0;
+      while (index < capture.kinds.size() &&
+             !IsKind(capture.kinds[index], particle)) {
+        index++;
+      }
+      if (index == capture.kinds.size()) {
+        if (index == kMaxKinds) {
+          throw std::invalid_argument(
+              "too many kinds of particle to capture");
+        }
+        capture.kinds.push_back(
+            {particle.GetRadius(), particle.GetMass(), particle.GetColor()});
+      }
+    }
+    capture.kind_indices.push_back(static_cast<uint16_t>(index));
+    last = index;
+  }
+}
+
+bool RewindBuffer::IsKind(const ParticleKind& kind,
+                          const Particle& particle) {
+  return kind.radius == particle.GetRadius() &&
+         kind.mass == particle.GetMass() && kind.color == particle.GetColor();
+}
+
+size_t RewindBuffer::ComputeMemoryUsage(const Capture& capture) {
+  size_t checkpoint_usage = 0;
+  if (capture.checkpoint) {
+    checkpoint_usage =
+        sizeof(Simulator::Checkpoint) +
+        capture.checkpoint->source_backlogs.capacity() * sizeof(double);
+  }
+  return sizeof(Capture) + checkpoint_usage +
+         capture.kinds.capacity() * sizeof(ParticleKind) +
+         capture.kind_indices.capacity() * sizeof(uint16_t) +
+         capture.positions.capacity() * sizeof(glm::dvec2) +
+         capture.velocities.capacity() * sizeof(glm::vec2) +
+         capture.time_step_levels.capacity() * sizeof(uint8_t) +
+         capture.quantized_positions.capacity() * sizeof(uint16_t) +
+         capture.quantized_velocities.capacity() * sizeof(int16_t);
+}
+
+}  // namespace idealgas
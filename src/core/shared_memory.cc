@@ -0,0 +1,150 @@
+#include <core/shared_memory.h>
+
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace idealgas {
+
+#ifndef _WIN32
+
+SharedMemory SharedMemory::Create(const std::string& name, size_t size) {
+  /* Remove any segment left behind by a process which did not exit cleanly,
+     so that readers of it see the new segment under its name */
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("could not create shared memory " + name);
+  }
+
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    close(fd);
+    shm_unlink(name.c_str());
+    throw std::runtime_error("could not size shared memory " + name);
+  }
+
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    throw std::runtime_error("could not map shared memory " + name);
+  }
+
+  return SharedMemory(name, data, size, true);
+}
+
+namespace {
+
+/** Maps the whole of an existing segment */
+void* MapExisting(const std::string& name, bool is_writable, size_t& size) {
+  int fd = shm_open(name.c_str(), is_writable ? O_RDWR : O_RDONLY, 0);
+  if (fd < 0) {
+    throw std::runtime_error("could not open shared memory " + name);
+  }
+
+  struct stat status;
+  if (fstat(fd, &status) != 0 || status.st_size == 0) {
+    close(fd);
+    throw std::runtime_error("could not open shared memory " + name);
+  }
+
+  size = static_cast<size_t>(status.st_size);
+  int protection = is_writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  void* data = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("could not map shared memory " + name);
+  }
+  return data;
+}
+
+}  // namespace
+
+SharedMemory SharedMemory::Open(const std::string& name) {
+  size_t size;
+  void* data = MapExisting(name, false, size);
+  return SharedMemory(name, data, size, false);
+}
+
+SharedMemory SharedMemory::OpenWritable(const std::string& name) {
+  size_t size;
+  void* data = MapExisting(name, true, size);
+  return SharedMemory(name, data, size, false);
+}
+
+void SharedMemory::Release() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+    if (is_owner_) {
+      shm_unlink(name_.c_str());
+    }
+  }
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#else
+
+SharedMemory SharedMemory::Create(const std::string& name, size_t size) {
+  throw std::runtime_error("shared memory is not supported on this platform");
+}
+
+SharedMemory SharedMemory::Open(const std::string& name) {
+  throw std::runtime_error("shared memory is not supported on this platform");
+}
+
+SharedMemory SharedMemory::OpenWritable(const std::string& name) {
+  throw std::runtime_error("shared memory is not supported on this platform");
+}
+
+void SharedMemory::Release() {
+}
+
+#endif
+
+SharedMemory::SharedMemory(const std::string& name, void* data, size_t size,
+                           bool is_owner)
+    : name_(name), data_(data), size_(size), is_owner_(is_owner) {
+}
+
+SharedMemory::SharedMemory(SharedMemory&& other)
+    : name_(std::move(other.name_)),
+      data_(other.data_),
+      size_(other.size_),
+      is_owner_(other.is_owner_) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+SharedMemory& SharedMemory::operator=(SharedMemory&& other) {
+  if (this != &other) {
+    Release();
+    name_ = std::move(other.name_);
+    data_ = other.data_;
+    size_ = other.size_;
+    is_owner_ = other.is_owner_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+SharedMemory::~SharedMemory() {
+  Release();
+}
+
+void* SharedMemory::GetData() const {
+  return data_;
+}
+
+size_t SharedMemory::GetSize() const {
+  return size_;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,186 @@
+#include <core/spatial_grid.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace idealgas {
+
+namespace {
+
+/**
+ * Returns the cell index along one axis of the specified coordinate, wrapping
+ * it around the plane or clamping it to the edge cells.
+ */
+size_t GetCellIndex(double coordinate, double length, size_t num_cells,
+                    bool is_periodic) {
+  double cell_length = length / num_cells;
+  double index = std::floor(coordinate / cell_length);
+
+  if (is_periodic) {
+    index = std::fmod(index, (double)num_cells);
+    if (index < 0) {
+      index += num_cells;
+    }
+  }
+
+  /* Particles may be slightly past a wall, so clamp them to the edge cells.
+     This also catches rounding at the far edge of a periodic plane. */
+  if (index < 0) {
+    return 0;
+  }
+  if (index >= num_cells) {
+    return num_cells - 1;
+  }
+  return (size_t)index;
+}
+
+/**
+ * Returns the range of offsets of the adjacent cells along one axis,
+ * including the cell itself, such that no cell is visited twice when a
+ * periodic plane is less than three cells across.
+ */
+void GetAdjacentOffsets(size_t num_cells, bool is_periodic, int& first,
+                        int& last) {
+  first = -1;
+  last = 1;
+  if (is_periodic && num_cells < 3) {
+    first = 0;
+    last = (int)num_cells - 1;
+  }
+}
+
+}  // namespace
+
+template <typename ParticleType>
+BasicSpatialGrid<ParticleType>::BasicSpatialGrid()
+    : size_(0), is_periodic_(false) {
+  std::fill(num_cells_, num_cells_ + kDim, 1);
+}
+
+template <typename ParticleType>
+void BasicSpatialGrid<ParticleType>::Build(
+    const ChunkedView<ParticleType>& particles, const PreciseVector& size,
+    double cell_size, bool is_periodic) {
+  size_ = size;
+  is_periodic_ = is_periodic;
+
+  /* Use as many cells as fit, rounding down so every cell is at least
+     cell_size across */
+  size_t num_cells = 1;
+  for (int axis = 0; axis < kDim; axis++) {
+    num_cells_[axis] =
+        std::max<size_t>(1, (size_t)std::floor(size[axis] / cell_size));
+    num_cells *= num_cells_[axis];
+  }
+
+  cell_starts_.assign(num_cells + 1, 0);
+  particle_cells_.resize(particles.size());
+  cell_particles_.resize(particles.size());
+
+  /* Count the particles in each cell */
+  for (size_t i = 0; i < particles.size(); i++) {
+    size_t cell = GetCell(particles[i].GetPrecisePosition());
+    particle_cells_[i] = cell;
+    cell_starts_[cell + 1]++;
+  }
+
+  /* Turn the counts into offsets */
+  for (size_t cell = 0; cell < num_cells; cell++) {
+    cell_starts_[cell + 1] += cell_starts_[cell];
+  }
+
+  /* Place the particles in ascending order within their cells */
+  for (size_t i = 0; i < particles.size(); i++) {
+    size_t cell = particle_cells_[i];
+    cell_particles_[cell_starts_[cell]] = i;
+    cell_starts_[cell]++;
+  }
+
+  /* Placing the particles advanced every offset to the start of the next
+     cell, so shift them back */
+  for (size_t cell = num_cells; cell > 0; cell--) {
+    cell_starts_[cell] = cell_starts_[cell - 1];
+  }
+  cell_starts_[0] = 0;
+}
+
+template <typename ParticleType>
+void BasicSpatialGrid<ParticleType>::FindNeighbors(
+    const PreciseVector& position, std::vector<size_t>& neighbors) const {
+  if (cell_particles_.empty()) {
+    return;
+  }
+
+  long center[kDim];
+  int first_offsets[kDim];
+  int last_offsets[kDim];
+  int offsets[kDim];
+  for (int axis = 0; axis < kDim; axis++) {
+    center[axis] = (long)GetCellIndex(position[axis], size_[axis],
+                                      num_cells_[axis], is_periodic_);
+    GetAdjacentOffsets(num_cells_[axis], is_periodic_, first_offsets[axis],
+                       last_offsets[axis]);
+    offsets[axis] = first_offsets[axis];
+  }
+
+  /* Visit every combination of offsets, counting through them like the
+     digits of a number with the x offset as the lowest digit */
+  while (true) {
+    size_t cell = 0;
+    bool is_on_plane = true;
+    for (int axis = kDim - 1; axis >= 0; axis--) {
+      long num_cells = (long)num_cells_[axis];
+      long index = center[axis] + offsets[axis];
+      if (is_periodic_) {
+        index = (index + num_cells) % num_cells;
+      } else if (index < 0 || index >= num_cells) {
+        is_on_plane = false;
+        break;
+      }
+      cell = cell * num_cells_[axis] + (size_t)index;
+    }
+
+    if (is_on_plane) {
+      neighbors.insert(neighbors.end(),
+                       cell_particles_.begin() + cell_starts_[cell],
+                       cell_particles_.begin() + cell_starts_[cell + 1]);
+    }
+
+    int axis = 0;
+    while (axis < kDim && ++offsets[axis] > last_offsets[axis]) {
+      offsets[axis] = first_offsets[axis];
+      axis++;
+    }
+    if (axis == kDim) {
+      break;
+    }
+  }
+}
+
+template <typename ParticleType>
+size_t BasicSpatialGrid<ParticleType>::GetNumCells() const {
+  size_t num_cells = 1;
+  for (int axis = 0; axis < kDim; axis++) {
+    num_cells *= num_cells_[axis];
+  }
+  return num_cells;
+}
+
+template <typename ParticleType>
+size_t BasicSpatialGrid<ParticleType>::GetCell(
+    const PreciseVector& position) const {
+  size_t cell = 0;
+  for (int axis = kDim - 1; axis >= 0; axis--) {
+    cell = cell * num_cells_[axis] +
+           GetCellIndex(position[axis], size_[axis], num_cells_[axis],
+                        is_periodic_);
+  }
+  return cell;
+}
+
+template class BasicSpatialGrid<Particle>;
+template class BasicSpatialGrid<Particle3d>;
+template class BasicSpatialGrid<PreciseParticle>;
+template class BasicSpatialGrid<PreciseParticle3d>;
+
+}  // namespace idealgas
@@ -0,0 +1,406 @@
+#include <core/ensemble.h>
+#include <core/simulator.h>
+#include <core/sweep.h>
+
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace idealgas {
+
+namespace {
+
+const size_t kNumKeyColumns = 7;
+
+std::string Trim(const std::string& text) {
+  size_t begin = text.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  size_t end = text.find_last_not_of(" \t\r");
+  return text.substr(begin, end - begin + 1);
+}
+
+std::vector<std::string> Split(const std::string& text, char delimiter) {
+  std::vector<std::string> fields;
+  std::stringstream ss(text);
+  std::string field;
+  while (std::getline(ss, field, delimiter)) {
+    fields.push_back(field);
+  }
+  /* getline() drops a trailing empty field */
+  if (!text.empty() && text.back() == delimiter) {
+    fields.push_back("");
+  }
+  return fields;
+}
+
+std::invalid_argument ConfigError(size_t line_number,
+                                  const std::string& message) {
+  return std::invalid_argument("sweep config line " +
+                               std::to_string(line_number) + ": " + message);
+}
+
+double ParseNumber(const std::string& text, size_t line_number) {
+  std::string trimmed = Trim(text);
+  size_t num_parsed = 0;
+  double value = 0;
+  try {
+    value = std::stod(trimmed, &num_parsed);
+  } catch (const std::exception&) {
+    num_parsed = 0;
+  }
+  if (trimmed.empty() || num_parsed != trimmed.size()) {
+    throw ConfigError(line_number, "'" + trimmed + "' is not a number");
+  }
+  return value;
+}
+
+/**
+ * Parses a grid of values, i.e. a comma separated list of numbers and
+ * start:stop[:step] ranges.
+ */
+std::vector<double> ParseGrid(const std::string& text, size_t line_number) {
+  std::vector<double> values;
+  for (const std::string& item : Split(text, ',')) {
+    std::vector<std::string> bounds = Split(item, ':');
+    if (bounds.size() == 1) {
+      values.push_back(ParseNumber(bounds[0], line_number));
+      continue;
+    }
+    if (bounds.size() > 3) {
+      throw ConfigError(line_number, "'" + Trim(item) + "' is not a range");
+    }
+
+    double start = ParseNumber(bounds[0], line_number);
+    double stop = ParseNumber(bounds[1], line_number);
+    double step = bounds.size() == 3 ? ParseNumber(bounds[2], line_number) : 1;
+    if (step <= 0 || stop < start) {
+      throw ConfigError(line_number, "'" + Trim(item) + "' is an empty range");
+    }
+
+    /* Compute each value from the start rather than accumulating the step so
+       that rounding errors do not drop the stop value */
+    size_t num_values = (size_t)std::floor((stop - start) / step + 1e-9) + 1;
+    for (size_t i = 0; i < num_values; i++) {
+      values.push_back(start + i * step);
+    }
+  }
+  return values;
+}
+
+template <typename T>
+std::vector<T> ParseIntegerGrid(const std::string& text, size_t line_number) {
+  std::vector<T> values;
+  for (double value : ParseGrid(text, line_number)) {
+    if (value < 0 || value != std::floor(value)) {
+      throw ConfigError(line_number,
+                        "expected non-negative integers in '" + text + "'");
+    }
+    values.push_back((T)value);
+  }
+  return values;
+}
+
+std::string FormatNumber(double value) {
+  std::ostringstream ss;
+  ss.precision(10);
+  ss << value;
+  return ss.str();
+}
+
+}  // namespace
+
+std::string SweepJob::GetKey() const {
+  return FormatNumber(plane_width) + "," + FormatNumber(plane_height) + "," +
+         std::to_string(num_small) + "," +
+         std::to_string(num_medium) + "," + std::to_string(num_large) + "," +
+         std::to_string(seed) + "," + std::to_string(num_steps);
+}
+
+SweepConfig::SweepConfig()
+    : plane_widths_({Simulator::kDefaultPlaneWidth}),
+      nums_small_({0}),
+      nums_medium_({0}),
+      nums_large_({0}),
+      seeds_({0}),
+      nums_steps_({1000}),
+      max_speed_(1),
+      num_speed_bins_(20) {
+}
+
+SweepConfig SweepConfig::Parse(std::istream& input) {
+  SweepConfig config;
+
+  std::string line;
+  size_t line_number = 0;
+  while (std::getline(input, line)) {
+    line_number++;
+
+    /* Strip comments and skip blank lines */
+    line = Trim(line.substr(0, line.find('#')));
+    if (line.empty()) {
+      continue;
+    }
+
+    size_t equals = line.find('=');
+    if (equals == std::string::npos) {
+      throw ConfigError(line_number, "expected 'key = value'");
+    }
+    std::string key = Trim(line.substr(0, equals));
+    std::string value = Trim(line.substr(equals + 1));
+
+    if (key == "plane_width") {
+      config.plane_widths_ = ParseGrid(value, line_number);
+      for (double width : config.plane_widths_) {
+        if (width <= 0) {
+          throw ConfigError(line_number, "plane_width must be positive");
+        }
+      }
+    } else if (key == "plane_height") {
+      config.plane_heights_ = ParseGrid(value, line_number);
+      for (double height : config.plane_heights_) {
+        if (height <= 0) {
+          throw ConfigError(line_number, "plane_height must be positive");
+        }
+      }
+    } else if (key == "num_small") {
+      config.nums_small_ = ParseIntegerGrid<size_t>(value, line_number);
+    } else if (key == "num_medium") {
+      config.nums_medium_ = ParseIntegerGrid<size_t>(value, line_number);
+    } else if (key == "num_large") {
+      config.nums_large_ = ParseIntegerGrid<size_t>(value, line_number);
+    } else if (key == "seed") {
+      config.seeds_ = ParseIntegerGrid<uint32_t>(value, line_number);
+    } else if (key == "steps") {
+      config.nums_steps_ = ParseIntegerGrid<size_t>(value, line_number);
+    } else if (key == "max_speed") {
+      config.max_speed_ = ParseNumber(value, line_number);
+      if (config.max_speed_ <= 0) {
+        throw ConfigError(line_number, "max_speed must be positive");
+      }
+    } else if (key == "speed_bins") {
+      std::vector<size_t> bins = ParseIntegerGrid<size_t>(value, line_number);
+      if (bins.size() != 1 || bins[0] == 0) {
+        throw ConfigError(line_number, "speed_bins must be a single count");
+      }
+      config.num_speed_bins_ = bins[0];
+    } else {
+      throw ConfigError(line_number, "unknown parameter '" + key + "'");
+    }
+  }
+
+  return config;
+}
+
+SweepConfig SweepConfig::Load(const std::string& path) {
+  std::ifstream input(path);
+  if (!input) {
+    throw std::runtime_error("could not open sweep config " + path);
+  }
+  return Parse(input);
+}
+
+std::vector<SweepJob> SweepConfig::ExpandJobs() const {
+  std::vector<SweepJob> jobs;
+  for (double plane_width : plane_widths_) {
+    std::vector<double> plane_heights = plane_heights_;
+    if (plane_heights.empty()) {
+      plane_heights.push_back(plane_width);
+    }
+
+    for (double plane_height : plane_heights) {
+      for (size_t num_small : nums_small_) {
+        for (size_t num_medium : nums_medium_) {
+          for (size_t num_large : nums_large_) {
+            for (uint32_t seed : seeds_) {
+              for (size_t num_steps : nums_steps_) {
+                jobs.push_back({plane_width, plane_height, num_small,
+                                num_medium, num_large, seed, num_steps});
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return jobs;
+}
+
+double SweepConfig::GetMaxSpeed() const {
+  return max_speed_;
+}
+
+size_t SweepConfig::GetNumSpeedBins() const {
+  return num_speed_bins_;
+}
+
+SweepDriver::SweepDriver(const SweepConfig& config,
+                         const std::string& output_path)
+    : config_(config), output_path_(output_path) {
+}
+
+std::vector<std::string> SweepDriver::GetColumns() const {
+  std::vector<std::string> columns = {
+      "plane_width", "plane_height", "num_small",     "num_medium",
+      "num_large",   "seed",         "steps",         "kinetic_energy"};
+  for (const char* size : {"small", "medium", "large"}) {
+    for (size_t i = 0; i < config_.GetNumSpeedBins(); i++) {
+      columns.push_back(std::string(size) + "_speed_bin_" + std::to_string(i));
+    }
+  }
+  return columns;
+}
+
+std::set<std::string> SweepDriver::LoadCompletedJobs() const {
+  std::vector<std::string> rows;
+  ReadCompleteRows(rows);
+
+  std::set<std::string> keys;
+  for (const std::string& row : rows) {
+    std::vector<std::string> fields = Split(row, ',');
+    std::string key = fields[0];
+    for (size_t i = 1; i < kNumKeyColumns; i++) {
+      key += "," + fields[i];
+    }
+    keys.insert(key);
+  }
+  return keys;
+}
+
+size_t SweepDriver::Run(ThreadPool& pool) {
+  std::vector<std::string> columns = GetColumns();
+  std::string header = columns[0];
+  for (size_t i = 1; i < columns.size(); i++) {
+    header += "," + columns[i];
+  }
+
+  /* Rewrite the file without the rows an interrupted run left incomplete, so
+     that new rows are not appended onto a partial line */
+  std::vector<std::string> rows;
+  if (!ReadCompleteRows(rows)) {
+    std::ofstream rewritten(output_path_, std::ios::trunc);
+    rewritten << header << '\n';
+    for (const std::string& row : rows) {
+      rewritten << row << '\n';
+    }
+    if (!rewritten) {
+      throw std::runtime_error("could not write sweep output " + output_path_);
+    }
+  }
+
+  std::set<std::string> completed = LoadCompletedJobs();
+  std::vector<SweepJob> pending;
+  for (const SweepJob& job : config_.ExpandJobs()) {
+    if (completed.count(job.GetKey()) == 0) {
+      pending.push_back(job);
+      completed.insert(job.GetKey());
+    }
+  }
+
+  bool has_header = false;
+  {
+    std::ifstream existing(output_path_);
+    has_header =
+        existing && existing.peek() != std::ifstream::traits_type::eof();
+  }
+
+  std::ofstream output(output_path_, std::ios::app);
+  if (!output) {
+    throw std::runtime_error("could not open sweep output " + output_path_);
+  }
+  if (!has_header) {
+    output << header << '\n' << std::flush;
+  }
+
+  /* Rows are written as soon as their job finishes, so that as little work as
+     possible is lost if the sweep is interrupted */
+  std::mutex output_mutex;
+  for (const SweepJob& job : pending) {
+    const SweepJob* job_ptr = &job;
+    pool.Submit([this, job_ptr, &output, &output_mutex] {
+      std::string row = RunJob(*job_ptr);
+      std::lock_guard<std::mutex> lock(output_mutex);
+      output << row << '\n' << std::flush;
+    });
+  }
+  pool.Wait();
+
+  if (!output) {
+    throw std::runtime_error("could not write sweep output " + output_path_);
+  }
+  return pending.size();
+}
+
+bool SweepDriver::ReadCompleteRows(std::vector<std::string>& rows) const {
+  std::ifstream input(output_path_);
+  if (!input) {
+    return true;
+  }
+
+  std::vector<std::string> columns = GetColumns();
+  bool is_clean = true;
+  bool is_header = true;
+  std::string line;
+  while (std::getline(input, line)) {
+    /* getline() only sets eof when the line was not terminated, i.e. it was
+       cut off while being written */
+    bool is_terminated = !input.eof();
+
+    if (is_header) {
+      is_header = false;
+      if (is_terminated && Split(line, ',') == columns) {
+        continue;
+      }
+      throw std::runtime_error("sweep output " + output_path_ +
+                               " has different columns than the sweep");
+    }
+
+    if (is_terminated && Split(line, ',').size() == columns.size()) {
+      rows.push_back(line);
+    } else {
+      is_clean = false;
+    }
+  }
+
+  return is_clean;
+}
+
+std::string SweepDriver::RunJob(const SweepJob& job) const {
+  Simulator simulator(job.plane_width, job.plane_height, job.seed);
+  for (size_t i = 0; i < job.num_small; i++) {
+    simulator.AddRandomSmallParticle();
+  }
+  for (size_t i = 0; i < job.num_medium; i++) {
+    simulator.AddRandomMediumParticle();
+  }
+  for (size_t i = 0; i < job.num_large; i++) {
+    simulator.AddRandomLargeParticle();
+  }
+  for (size_t i = 0; i < job.num_steps; i++) {
+    simulator.Update();
+  }
+
+  std::vector<double> small(config_.GetNumSpeedBins(), 0);
+  std::vector<double> medium(config_.GetNumSpeedBins(), 0);
+  std::vector<double> large(config_.GetNumSpeedBins(), 0);
+  AccumulateSpeedFrequencies(simulator.GetSmallParticleSpeeds(),
+                             config_.GetMaxSpeed(), small);
+  AccumulateSpeedFrequencies(simulator.GetMediumParticleSpeeds(),
+                             config_.GetMaxSpeed(), medium);
+  AccumulateSpeedFrequencies(simulator.GetLargeParticleSpeeds(),
+                             config_.GetMaxSpeed(), large);
+
+  std::string row =
+      job.GetKey() + "," + FormatNumber(simulator.GetKineticEnergy());
+  for (const std::vector<double>* frequencies : {&small, &medium, &large}) {
+    for (double frequency : *frequencies) {
+      row += "," + FormatNumber(frequency);
+    }
+  }
+  return row;
+}
+
+}  // namespace idealgas
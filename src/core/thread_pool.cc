@@ -0,0 +1,145 @@
+#include <core/thread_pool.h>
+
+namespace idealgas {
+
+namespace {
+
+/** The index of the worker running on the current thread */
+thread_local size_t worker_index = ThreadPool::kNotAWorker;
+
+}  // namespace
+
+const size_t ThreadPool::kNotAWorker;
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : num_queued_(0), num_unfinished_(0), is_stopping_(false), next_queue_(0) {
+  /* hardware_concurrency() is allowed to return 0 when it cannot tell */
+  if (num_threads == 0) {
+    num_threads = 1;
+  }
+
+  for (size_t i = 0; i < num_threads; i++) {
+    queues_.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+  }
+  for (size_t i = 0; i < num_threads; i++) {
+    workers_.push_back(std::thread(&ThreadPool::RunWorker, this, i));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  has_work_.notify_all();
+
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Submit(const std::function<void()>& task) {
+  /* The counters are bumped before the task becomes visible so that a worker
+     can never finish a task that has not been counted yet */
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    num_queued_++;
+    num_unfinished_++;
+  }
+
+  size_t index = worker_index;
+  if (index == kNotAWorker || index >= queues_.size()) {
+    index = next_queue_++ % queues_.size();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+    queues_[index]->tasks.push_back(task);
+  }
+  has_work_.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  all_done_.wait(lock, [this] { return num_unfinished_ == 0; });
+
+  if (first_exception_) {
+    std::exception_ptr exception = first_exception_;
+    first_exception_ = nullptr;
+    std::rethrow_exception(exception);
+  }
+}
+
+size_t ThreadPool::GetNumThreads() const {
+  return workers_.size();
+}
+
+size_t ThreadPool::GetWorkerIndex() {
+  return worker_index;
+}
+
+void ThreadPool::RunWorker(size_t index) {
+  worker_index = index;
+
+  while (true) {
+    std::function<void()> task;
+    if (TryPopTask(index, task)) {
+      std::exception_ptr exception;
+      try {
+        task();
+      } catch (...) {
+        exception = std::current_exception();
+      }
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (exception && !first_exception_) {
+        first_exception_ = exception;
+      }
+      if (--num_unfinished_ == 0) {
+        all_done_.notify_all();
+      }
+      continue;
+    }
+
+    /* Park until there is something to steal or the pool shuts down */
+    std::unique_lock<std::mutex> lock(mutex_);
+    has_work_.wait(lock,
+                   [this] { return is_stopping_ || num_queued_ > 0; });
+    if (is_stopping_ && num_queued_ == 0) {
+      return;
+    }
+  }
+}
+
+bool ThreadPool::TryPopTask(size_t index, std::function<void()>& task) {
+  /* The owner works from the back of its queue, which keeps recently
+     submitted (and likely cache-warm) tasks local */
+  {
+    WorkQueue& own = *queues_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+    }
+  }
+
+  /* Thieves take from the front, where the oldest tasks are */
+  for (size_t offset = 1; !task && offset < queues_.size(); offset++) {
+    WorkQueue& victim = *queues_[(index + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+    }
+  }
+
+  if (!task) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  num_queued_--;
+  return true;
+}
+
+}  // namespace idealgas
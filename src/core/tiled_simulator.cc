@@ -0,0 +1,560 @@
+#include <core/tiled_simulator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "cinder/gl/gl.h"
+#include "core/boundary.h"
+#include "core/compensated_sum.h"
+#include "core/elastic_collision.h"
+#include "core/simulator.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace idealgas {
+
+constexpr double TiledSimulator::kInteractionRange;
+const size_t TiledSimulator::kStencilSize;
+
+namespace {
+
+/** The radius and mass of each species, indexed by TiledParticle::species */
+const double kRadii[] = {Simulator::kSmallRadius, Simulator::kMediumRadius,
+                         Simulator::kLargeRadius};
+const double kMasses[] = {Simulator::kSmallMass, Simulator::kMediumMass,
+                          Simulator::kLargeMass};
+
+/**
+ * The number of added particles held for a tile before they are written,
+ * which bounds the memory taken up by particles added to many tiles
+ */
+const size_t kArrivalBatchSize = 1024;
+
+/** How many tiles the prefetching thread reads ahead of those in use */
+const size_t kPrefetchDistance = 4;
+
+/** The size of the reads which bring a tile into the page cache */
+const size_t kPrefetchReadSize = 1 << 20;
+
+#ifndef _WIN32
+
+void CreateTileFile(const std::string& path) {
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("could not open " + path);
+  }
+  close(fd);
+}
+
+void AppendToTileFile(const std::string& path,
+                      const std::vector<TiledParticle>& particles) {
+  int fd = open(path.c_str(), O_WRONLY | O_APPEND);
+  if (fd < 0) {
+    throw std::runtime_error("could not open " + path);
+  }
+
+  const char* data = reinterpret_cast<const char*>(particles.data());
+  size_t size = particles.size() * sizeof(TiledParticle);
+  size_t written = 0;
+  while (written < size) {
+    ssize_t result = write(fd, data + written, size - written);
+    if (result <= 0) {
+      close(fd);
+      throw std::runtime_error("could not write " + path);
+    }
+    written += static_cast<size_t>(result);
+  }
+  close(fd);
+}
+
+void TruncateTileFile(const std::string& path, size_t num_particles) {
+  off_t size = static_cast<off_t>(num_particles * sizeof(TiledParticle));
+  if (truncate(path.c_str(), size) != 0) {
+    throw std::runtime_error("could not write " + path);
+  }
+}
+
+void RemoveTileFile(const std::string& path) {
+  unlink(path.c_str());
+}
+
+/**
+ * Reads a file through so that it is in the page cache by the time it is
+ * mapped. A file truncated meanwhile is harmlessly read short, unlike a
+ * mapping of it, which would fault.
+ */
+void ReadIntoPageCache(const std::string& path, std::vector<char>& buffer) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  off_t offset = 0;
+  ssize_t result;
+  while ((result = pread(fd, buffer.data(), buffer.size(), offset)) > 0) {
+    offset += result;
+  }
+  close(fd);
+}
+
+#else
+
+void CreateTileFile(const std::string& path) {
+  throw std::runtime_error("tiled simulations are not supported on this "
+                           "platform");
+}
+
+void AppendToTileFile(const std::string& path,
+                      const std::vector<TiledParticle>& particles) {
+}
+
+void TruncateTileFile(const std::string& path, size_t num_particles) {
+}
+
+void RemoveTileFile(const std::string& path) {
+}
+
+void ReadIntoPageCache(const std::string& path, std::vector<char>& buffer) {
+}
+
+#endif
+
+/**
+ * Resolves a collision between two particles if they are in contact and
+ * moving towards each other, with the same kernel as Simulator
+ */
+void Collide(TiledParticle& p1, TiledParticle& p2) {
+  glm::vec2 displacement(glm::dvec2(p1.x - p2.x, p1.y - p2.y));
+  glm::vec2 v1(p1.vx, p1.vy);
+  glm::vec2 v2(p2.vx, p2.vy);
+  if (!IsElasticCollision(displacement, v1, v2,
+                          kRadii[p1.species] + kRadii[p2.species])) {
+    return;
+  }
+
+  std::pair<glm::vec2, glm::vec2> velocities = ComputeElasticCollision(
+      displacement, v1, v2, static_cast<float>(kMasses[p1.species]),
+      static_cast<float>(kMasses[p2.species]));
+  p1.vx = velocities.first.x;
+  p1.vy = velocities.first.y;
+  p2.vx = velocities.second.x;
+  p2.vy = velocities.second.y;
+}
+
+}  // namespace
+
+TiledSimulator::TiledSimulator(const std::string& directory,
+                               double plane_width, double plane_height,
+                               size_t num_columns, size_t num_rows,
+                               size_t max_resident_tiles)
+    : directory_(directory),
+      plane_width_(plane_width),
+      plane_height_(plane_height),
+      num_columns_(num_columns),
+      num_rows_(num_rows),
+      tile_width_(0),
+      tile_height_(0),
+      max_resident_tiles_(max_resident_tiles),
+      num_uses_(0),
+      peak_resident_tiles_(0),
+      num_steps_(0),
+      is_stopping_(false) {
+  if (num_columns == 0 || num_rows == 0 ||
+      !(plane_width / num_columns >= kInteractionRange) ||
+      !(plane_height / num_rows >= kInteractionRange)) {
+    throw std::invalid_argument(
+        "tiles must be as wide and tall as the interaction range");
+  }
+  if (max_resident_tiles < kStencilSize) {
+    throw std::invalid_argument("at least " + std::to_string(kStencilSize) +
+                                " tiles must be resident");
+  }
+  tile_width_ = plane_width / num_columns;
+  tile_height_ = plane_height / num_rows;
+
+  size_t num_tiles = num_columns * num_rows;
+  for (size_t tile = 0; tile < num_tiles; tile++) {
+    try {
+      CreateTileFile(GetTilePath(tile));
+    } catch (...) {
+      for (size_t created = 0; created < tile; created++) {
+        RemoveTileFile(GetTilePath(created));
+      }
+      throw;
+    }
+  }
+  tile_sizes_.resize(num_tiles, 0);
+  arrivals_.resize(num_tiles);
+  resident_tiles_.reserve(max_resident_tiles);
+
+  prefetch_thread_ = std::thread(&TiledSimulator::RunPrefetcher, this);
+}
+
+TiledSimulator::~TiledSimulator() {
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    is_stopping_ = true;
+  }
+  prefetch_condition_.notify_one();
+  prefetch_thread_.join();
+
+  resident_tiles_.clear();
+  for (size_t tile = 0; tile < tile_sizes_.size(); tile++) {
+    RemoveTileFile(GetTilePath(tile));
+  }
+}
+
+void TiledSimulator::AddParticle(const TiledParticle& particle) {
+  if (particle.species > 2) {
+    throw std::invalid_argument("particle species must be 0, 1, or 2");
+  }
+  if (!(particle.x >= 0 && particle.x <= plane_width_ && particle.y >= 0 &&
+        particle.y <= plane_height_)) {
+    throw std::invalid_argument("particle is not on the plane");
+  }
+
+  size_t tile = GetTile(particle.x, particle.y);
+  arrivals_[tile].push_back(particle);
+  if (arrivals_[tile].size() >= kArrivalBatchSize) {
+    AppendToTileFile(GetTilePath(tile), arrivals_[tile]);
+    tile_sizes_[tile] += arrivals_[tile].size();
+    arrivals_[tile].clear();
+  }
+}
+
+void TiledSimulator::Update() {
+  WriteArrivals();
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    prefetch_queue_.clear();
+  }
+
+  /* A tile is first mapped as the upper right neighbor of the tile one row
+     down and one column left of it, so reading ahead starts from there */
+  size_t num_tiles = tile_sizes_.size();
+  size_t lead = num_columns_ + 1 + kPrefetchDistance;
+  for (size_t tile = 0; tile < std::min(lead, num_tiles); tile++) {
+    Prefetch(tile);
+  }
+  for (size_t tile = 0; tile < num_tiles; tile++) {
+    if (tile + lead < num_tiles) {
+      Prefetch(tile + lead);
+    }
+    UpdateTile(tile);
+  }
+
+  UnmapTiles();
+  num_steps_++;
+}
+
+void TiledSimulator::ForEachParticle(
+    const std::function<void(const TiledParticle&)>& f) {
+  WriteArrivals();
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    prefetch_queue_.clear();
+  }
+
+  size_t num_tiles = tile_sizes_.size();
+  for (size_t tile = 0; tile < std::min(kPrefetchDistance, num_tiles);
+       tile++) {
+    Prefetch(tile);
+  }
+  for (size_t tile = 0; tile < num_tiles; tile++) {
+    if (tile + kPrefetchDistance < num_tiles) {
+      Prefetch(tile + kPrefetchDistance);
+    }
+    if (tile_sizes_[tile] == 0) {
+      continue;
+    }
+
+    MappedFile file = MappedFile::Open(GetTilePath(tile));
+    const TiledParticle* particles =
+        reinterpret_cast<const TiledParticle*>(file.GetData());
+    for (size_t i = 0; i < tile_sizes_[tile]; i++) {
+      f(particles[i]);
+    }
+  }
+}
+
+double TiledSimulator::GetKineticEnergy() {
+  CompensatedSum energy;
+  ForEachParticle([&energy](const TiledParticle& p) {
+    double speed = glm::length(glm::dvec2(p.vx, p.vy));
+    energy.Add(0.5 * kMasses[p.species] * speed * speed);
+  });
+  return energy.GetSum();
+}
+
+size_t TiledSimulator::GetNumParticles() const {
+  size_t num_particles = 0;
+  for (size_t tile = 0; tile < tile_sizes_.size(); tile++) {
+    num_particles += tile_sizes_[tile] + arrivals_[tile].size();
+  }
+  return num_particles;
+}
+
+size_t TiledSimulator::GetNumSteps() const {
+  return num_steps_;
+}
+
+size_t TiledSimulator::GetPeakResidentTiles() const {
+  return peak_resident_tiles_;
+}
+
+std::string TiledSimulator::GetTilePath(size_t tile) const {
+  return directory_ + "/tile_" + std::to_string(tile) + ".bin";
+}
+
+size_t TiledSimulator::GetTile(double x, double y) const {
+  double column = std::floor(x / tile_width_);
+  double row = std::floor(y / tile_height_);
+  column = column > 0 ? std::min(column, double(num_columns_ - 1)) : 0;
+  row = row > 0 ? std::min(row, double(num_rows_ - 1)) : 0;
+  return static_cast<size_t>(row) * num_columns_ +
+         static_cast<size_t>(column);
+}
+
+void TiledSimulator::WriteArrivals() {
+  for (size_t tile = 0; tile < tile_sizes_.size(); tile++) {
+    if (!arrivals_[tile].empty()) {
+      AppendToTileFile(GetTilePath(tile), arrivals_[tile]);
+      tile_sizes_[tile] += arrivals_[tile].size();
+      arrivals_[tile].clear();
+    }
+  }
+}
+
+size_t TiledSimulator::MapTile(size_t tile, const size_t* stencil,
+                               size_t stencil_size) {
+  for (size_t i = 0; i < resident_tiles_.size(); i++) {
+    if (resident_tiles_[i].tile == tile) {
+      resident_tiles_[i].last_use = num_uses_++;
+      return i;
+    }
+  }
+
+  ResidentTile resident_tile = {tile,
+                                MappedFile::OpenWritable(GetTilePath(tile)),
+                                tile_sizes_[tile], num_uses_++};
+  if (resident_tiles_.size() < max_resident_tiles_) {
+    resident_tiles_.push_back(std::move(resident_tile));
+    peak_resident_tiles_ =
+        std::max(peak_resident_tiles_, resident_tiles_.size());
+    return resident_tiles_.size() - 1;
+  }
+
+  /* Replace the least recently used tile which is not in the stencil */
+  size_t victim = resident_tiles_.size();
+  for (size_t i = 0; i < resident_tiles_.size(); i++) {
+    const size_t* stencil_end = stencil + stencil_size;
+    if (std::find(stencil, stencil_end, resident_tiles_[i].tile) ==
+            stencil_end &&
+        (victim == resident_tiles_.size() ||
+         resident_tiles_[i].last_use < resident_tiles_[victim].last_use)) {
+      victim = i;
+    }
+  }
+  UnmapTile(resident_tiles_[victim]);
+  resident_tiles_[victim] = std::move(resident_tile);
+  return victim;
+}
+
+void TiledSimulator::UnmapTiles() {
+  for (ResidentTile& resident_tile : resident_tiles_) {
+    UnmapTile(resident_tile);
+  }
+  resident_tiles_.clear();
+}
+
+void TiledSimulator::UnmapTile(ResidentTile& resident_tile) {
+  /* The mapping must be released before its file is truncated */
+  {
+    MappedFile file(std::move(resident_tile.file));
+  }
+  if (resident_tile.num_particles != tile_sizes_[resident_tile.tile]) {
+    TruncateTileFile(GetTilePath(resident_tile.tile),
+                     resident_tile.num_particles);
+    tile_sizes_[resident_tile.tile] = resident_tile.num_particles;
+  }
+}
+
+void TiledSimulator::UpdateTile(size_t tile) {
+  /* The tile and those of its neighbors which come after it in row order:
+     to the right, and above to the left, middle, and right. Every pair of
+     neighboring tiles is in exactly one tile's stencil. */
+  size_t column = tile % num_columns_;
+  size_t row = tile / num_columns_;
+  size_t stencil[kStencilSize];
+  size_t stencil_size = 0;
+  stencil[stencil_size++] = tile;
+  if (column + 1 < num_columns_) {
+    stencil[stencil_size++] = tile + 1;
+  }
+  if (row + 1 < num_rows_) {
+    if (column > 0) {
+      stencil[stencil_size++] = tile + num_columns_ - 1;
+    }
+    stencil[stencil_size++] = tile + num_columns_;
+    if (column + 1 < num_columns_) {
+      stencil[stencil_size++] = tile + num_columns_ + 1;
+    }
+  }
+
+  size_t residents[kStencilSize];
+  for (size_t i = 0; i < stencil_size; i++) {
+    residents[i] = MapTile(stencil[i], stencil, stencil_size);
+  }
+  TiledParticle* members[kStencilSize];
+  size_t member_sizes[kStencilSize];
+  for (size_t i = 0; i < stencil_size; i++) {
+    ResidentTile& resident_tile = resident_tiles_[residents[i]];
+    members[i] =
+        reinterpret_cast<TiledParticle*>(resident_tile.file.GetMutableData());
+    member_sizes[i] = resident_tile.num_particles;
+  }
+  TiledParticle* particles = members[0];
+  size_t& num_particles = resident_tiles_[residents[0]].num_particles;
+
+  WallBoundary walls;
+  glm::dvec2 plane_size(plane_width_, plane_height_);
+  for (size_t i = 0; i < num_particles; i++) {
+    TiledParticle& particle = particles[i];
+    glm::vec2 velocity(particle.vx, particle.vy);
+    if (walls.Reflect(glm::dvec2(particle.x, particle.y),
+                      kRadii[particle.species], velocity, plane_size)) {
+      particle.vx = velocity.x;
+      particle.vy = velocity.y;
+    }
+  }
+
+  /* Grid the tile's particles and the neighbors' particles within reach of
+     it, in cells at least as wide as the interaction range */
+  double left = column * tile_width_ - kInteractionRange;
+  double bottom = row * tile_height_ - kInteractionRange;
+  double width = tile_width_ + 2 * kInteractionRange;
+  double height = tile_height_ + 2 * kInteractionRange;
+  size_t num_cell_columns = static_cast<size_t>(width / kInteractionRange);
+  size_t num_cell_rows = static_cast<size_t>(height / kInteractionRange);
+  double cell_width = width / num_cell_columns;
+  double cell_height = height / num_cell_rows;
+  size_t num_cells = num_cell_columns * num_cell_rows;
+
+  auto get_cell_column = [&](const TiledParticle& p) {
+    double cell = std::floor((p.x - left) / cell_width);
+    return static_cast<size_t>(
+        cell > 0 ? std::min(cell, double(num_cell_columns - 1)) : 0);
+  };
+  auto get_cell_row = [&](const TiledParticle& p) {
+    double cell = std::floor((p.y - bottom) / cell_height);
+    return static_cast<size_t>(
+        cell > 0 ? std::min(cell, double(num_cell_rows - 1)) : 0);
+  };
+  auto is_in_reach = [&](const TiledParticle& p) {
+    return p.x >= left && p.x <= left + width && p.y >= bottom &&
+           p.y <= bottom + height;
+  };
+
+  /* A counting sort of the entries by cell */
+  cell_starts_.assign(num_cells + 1, 0);
+  for (size_t member = 0; member < stencil_size; member++) {
+    for (size_t i = 0; i < member_sizes[member]; i++) {
+      const TiledParticle& p = members[member][i];
+      if (member == 0 || is_in_reach(p)) {
+        cell_starts_[get_cell_row(p) * num_cell_columns + get_cell_column(p) +
+                     1]++;
+      }
+    }
+  }
+  for (size_t cell = 0; cell < num_cells; cell++) {
+    cell_starts_[cell + 1] += cell_starts_[cell];
+  }
+  cell_entries_.resize(cell_starts_[num_cells]);
+  for (size_t member = 0; member < stencil_size; member++) {
+    for (size_t i = 0; i < member_sizes[member]; i++) {
+      const TiledParticle& p = members[member][i];
+      if (member == 0 || is_in_reach(p)) {
+        size_t cell = get_cell_row(p) * num_cell_columns + get_cell_column(p);
+        cell_entries_[cell_starts_[cell]++] = {static_cast<uint32_t>(member),
+                                               static_cast<uint32_t>(i)};
+      }
+    }
+  }
+  for (size_t cell = num_cells; cell > 0; cell--) {
+    cell_starts_[cell] = cell_starts_[cell - 1];
+  }
+  cell_starts_[0] = 0;
+
+  /* Resolve the tile's pairs with each other once, and with the neighbors'
+     particles, which only this tile pairs them with */
+  for (size_t i = 0; i < num_particles; i++) {
+    TiledParticle& p1 = particles[i];
+    size_t cell_column = get_cell_column(p1);
+    size_t cell_row = get_cell_row(p1);
+    size_t first_row = cell_row > 0 ? cell_row - 1 : 0;
+    size_t last_row = std::min(cell_row + 1, num_cell_rows - 1);
+    size_t first_column = cell_column > 0 ? cell_column - 1 : 0;
+    size_t last_column = std::min(cell_column + 1, num_cell_columns - 1);
+    for (size_t r = first_row; r <= last_row; r++) {
+      for (size_t c = first_column; c <= last_column; c++) {
+        size_t cell = r * num_cell_columns + c;
+        for (size_t k = cell_starts_[cell]; k < cell_starts_[cell + 1]; k++) {
+          const GridEntry& entry = cell_entries_[k];
+          if (entry.member == 0 && entry.index <= i) {
+            continue;
+          }
+          Collide(p1, members[entry.member][entry.index]);
+        }
+      }
+    }
+  }
+
+  /* No later tile collides with this one's particles, so they can be
+     moved. Those which leave are swapped out for the last particle. */
+  for (size_t i = 0; i < num_particles;) {
+    TiledParticle& particle = particles[i];
+    particle.x += particle.vx;
+    particle.y += particle.vy;
+    size_t destination = GetTile(particle.x, particle.y);
+    if (destination == tile) {
+      i++;
+      continue;
+    }
+    arrivals_[destination].push_back(particle);
+    particles[i] = particles[--num_particles];
+  }
+}
+
+void TiledSimulator::Prefetch(size_t tile) {
+  if (tile_sizes_[tile] == 0) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    prefetch_queue_.push_back(tile);
+  }
+  prefetch_condition_.notify_one();
+}
+
+void TiledSimulator::RunPrefetcher() {
+  std::vector<char> buffer(kPrefetchReadSize);
+  std::unique_lock<std::mutex> lock(prefetch_mutex_);
+  while (true) {
+    prefetch_condition_.wait(
+        lock, [this] { return is_stopping_ || !prefetch_queue_.empty(); });
+    if (is_stopping_) {
+      return;
+    }
+    size_t tile = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+
+    lock.unlock();
+    ReadIntoPageCache(GetTilePath(tile), buffer);
+    lock.lock();
+  }
+}
+
+}  // namespace idealgas
@@ -1,22 +1,141 @@
 #include <visualizer/box.h>
 
+#include <algorithm>
+#include <cstddef>
+
 namespace idealgas {
 
+namespace {
+
+/**
+ * Places a unit square, with corners at (+-1, +-1), over each particle and
+ * passes on how far each fragment is from the center in pixels
+ */
+const char* kParticleVertexShader = R"(
+#version 150
+uniform mat4 ciModelViewProjection;
+in vec4 ciPosition;
+in vec2 iPosition;
+in float iRadius;
+in vec3 iColor;
+out vec2 vOffset;
+out float vRadius;
+out vec3 vColor;
+
+void main() {
+  /* One pixel of margin for the outline, which straddles the radius */
+  vOffset = ciPosition.xy * (iRadius + 1.0);
+  vRadius = iRadius;
+  vColor = iColor;
+  gl_Position = ciModelViewProjection * vec4(iPosition + vOffset, 0.0, 1.0);
+}
+)";
+
+/**
+ * Fills the disc with the particle's color and draws a black outline one
+ * pixel wide on its edge, as drawSolidCircle() and drawStrokedCircle() did
+ */
+const char* kParticleFragmentShader = R"(
+#version 150
+in vec2 vOffset;
+in float vRadius;
+in vec3 vColor;
+out vec4 oColor;
+
+void main() {
+  float distance = length(vOffset);
+  if (distance > vRadius + 0.5) {
+    discard;
+  }
+  oColor = vec4(distance > vRadius - 0.5 ? vec3(0.0) : vColor, 1.0);
+}
+)";
+
+}  // namespace
+
 Box::Box(Simulator& simulator, const glm::vec2& top_left_corner,
          double box_length)
     : top_left_corner_(top_left_corner),
       box_length_(box_length),
-      simulator_(simulator) {
+      simulator_(simulator),
+      instance_builder_(top_left_corner, GetScaleFactor(),
+                        simulator.GetHeight()),
+      heatmap_threshold_(20000) {
+}
+
+void Box::Setup() {
+  /* Created empty, and filled with the instances every frame */
+  instance_buffer_ = ci::gl::Vbo::create(GL_ARRAY_BUFFER, 0, nullptr,
+                                         GL_DYNAMIC_DRAW);
+
+  /* One instance per particle, read with a divisor of 1 */
+  size_t stride = sizeof(ParticleInstance);
+  ci::geom::BufferLayout layout;
+  layout.append(ci::geom::Attrib::CUSTOM_0, 2, stride,
+                offsetof(ParticleInstance, position), 1);
+  layout.append(ci::geom::Attrib::CUSTOM_1, 1, stride,
+                offsetof(ParticleInstance, radius), 1);
+  layout.append(ci::geom::Attrib::CUSTOM_2, 3, stride,
+                offsetof(ParticleInstance, color), 1);
+
+  ci::gl::VboMeshRef square =
+      ci::gl::VboMesh::create(ci::geom::Rect(ci::Rectf(-1, -1, 1, 1)));
+  square->appendVbo(layout, instance_buffer_);
+
+  ci::gl::GlslProgRef shader = ci::gl::GlslProg::create(
+      ci::gl::GlslProg::Format()
+          .vertex(kParticleVertexShader)
+          .fragment(kParticleFragmentShader));
+  particle_batch_ = ci::gl::Batch::create(
+      square, shader,
+      {{ci::geom::Attrib::CUSTOM_0, "iPosition"},
+       {ci::geom::Attrib::CUSTOM_1, "iRadius"},
+       {ci::geom::Attrib::CUSTOM_2, "iColor"}});
+
+  /* One heatmap pixel per screen pixel of the box */
+  double scale_factor = GetScaleFactor();
+  size_t width = std::max<size_t>(
+      1, static_cast<size_t>(simulator_.GetWidth() * scale_factor));
+  size_t height = std::max<size_t>(
+      1, static_cast<size_t>(simulator_.GetHeight() * scale_factor));
+  heatmap_pool_.reset(new ThreadPool());
+  heatmap_.reset(new DensityHeatmap(
+      width, height, glm::dvec2(simulator_.GetWidth(), simulator_.GetHeight()),
+      {simulator_.kSmallColor, simulator_.kMediumColor,
+       simulator_.kLargeColor}));
+  heatmap_texture_ = ci::gl::Texture2d::create(
+      static_cast<int>(width), static_cast<int>(height),
+      ci::gl::Texture2d::Format().loadTopDown());
+}
+
+void Box::SetHeatmapThreshold(size_t num_particles) {
+  heatmap_threshold_ = num_particles;
 }
 
-void Box::Draw() const {
+void Box::DrawStaticLayer() const {
   DrawBox();
-  DrawParticles();
+}
+
+void Box::Draw() {
+  DrawObstacles();
+  if (IsHeatmapUsed()) {
+    DrawHeatmap();
+  } else {
+    DrawParticles();
+  }
+}
+
+double Box::GetScaleFactor() const {
+  /* Fit the longer side of the plane to the length of the box */
+  return box_length_ /
+         std::max(simulator_.GetWidth(), simulator_.GetHeight());
 }
 
 void Box::DrawBox() const {
+  double scale_factor = GetScaleFactor();
   glm::vec2 pixel_bottom_right =
-      top_left_corner_ + glm::vec2(box_length_, box_length_);
+      top_left_corner_ + glm::vec2(simulator_.GetWidth() * scale_factor,
+                                   simulator_.GetHeight() * scale_factor);
   ci::Rectf pixel_bounding_box(top_left_corner_, pixel_bottom_right);
 
   ci::gl::color(ci::Color("white"));
@@ -25,28 +144,69 @@ void Box::DrawBox() const {
   ci::gl::drawStrokedRect(pixel_bounding_box, 1.0);
 }
 
-void Box::DrawParticles() const {
-  /* The conversion factor between the dimensions used by the simulation and
-     the pixel width specified for the box */
-  double scale_factor = box_length_ / simulator_.kPlaneWidth;
+void Box::DrawObstacles() const {
+  double scale_factor = GetScaleFactor();
+  double height = simulator_.GetHeight();
 
-  for (const Particle& particle : simulator_.GetParticles()) {
-    /* Scale the radius to be in terms of pixels */
-    double radius = particle.GetRadius() * scale_factor;
+  ci::gl::color(ci::Color("gray"));
+  for (const Obstacle& obstacle : simulator_.GetObstacles().GetObstacles()) {
+    /* Flip the y coordinates so that they increase from bottom to top, as
+       is done for the particles */
+    glm::vec2 start(glm::dvec2(obstacle.start.x, height - obstacle.start.y) *
+                    scale_factor);
+    glm::vec2 end(glm::dvec2(obstacle.end.x, height - obstacle.end.y) *
+                  scale_factor);
+    start += top_left_corner_;
+    end += top_left_corner_;
 
-    /* Re-scale the position of the particle in terms of pixel position
-       in the application window and re-orient the cooridinate such that
-       the y value increases from bottom to top */
-    glm::vec2 position = particle.GetPosition();
-    position.y = simulator_.kPlaneWidth - position.y;
-    position *= scale_factor;
-    position += top_left_corner_;
+    if (obstacle.thickness > 0) {
+      ci::gl::drawSolidCircle(start, obstacle.thickness * scale_factor);
+    } else {
+      ci::gl::drawLine(start, end);
+    }
+  }
+}
 
-    ci::gl::color(particle.GetColor());
-    ci::gl::drawSolidCircle(position, radius);
-    ci::gl::color(ci::Color("black"));
-    ci::gl::drawStrokedCircle(position, radius, 1.0, -1);
+bool Box::IsHeatmapUsed() const {
+  /* The largest particles decide, so that no particle which could be seen
+     as a circle is blurred into the heatmap */
+  return heatmap_ != nullptr &&
+         simulator_.GetParticles().size() >= heatmap_threshold_ &&
+         simulator_.kLargeRadius * GetScaleFactor() < kMaxHeatmapPixelRadius;
+}
+
+void Box::DrawParticles() {
+  instance_builder_.Build(simulator_.GetParticles());
+  const std::vector<ParticleInstance>& instances =
+      instance_builder_.GetInstances();
+  if (instances.empty()) {
+    return;
   }
+
+  /* Respecifying the whole buffer lets the driver hand over fresh memory
+     instead of waiting for the previous frame's draw to finish with it */
+  instance_buffer_->bufferData(instances.size() * sizeof(ParticleInstance),
+                               instances.data(), GL_DYNAMIC_DRAW);
+  particle_batch_->drawInstanced(static_cast<GLsizei>(instances.size()));
+}
+
+void Box::DrawHeatmap() {
+  heatmap_->Build(simulator_.GetParticles(), *heatmap_pool_);
+  heatmap_texture_->update(heatmap_->GetPixels().data(), GL_RGBA,
+                           GL_UNSIGNED_BYTE, 0,
+                           static_cast<int>(heatmap_->GetWidth()),
+                           static_cast<int>(heatmap_->GetHeight()));
+
+  double scale_factor = GetScaleFactor();
+  glm::vec2 pixel_bottom_right =
+      top_left_corner_ + glm::vec2(simulator_.GetWidth() * scale_factor,
+                                   simulator_.GetHeight() * scale_factor);
+
+  /* Emptier pixels are more transparent, so blend them over the box */
+  ci::gl::ScopedBlendAlpha blend;
+  ci::gl::color(ci::Color("white"));
+  ci::gl::draw(heatmap_texture_,
+               ci::Rectf(top_left_corner_, pixel_bottom_right));
 }
 
 }  // namespace idealgas
\ No newline at end of file
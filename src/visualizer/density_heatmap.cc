@@ -0,0 +1,189 @@
+#include <visualizer/density_heatmap.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace idealgas {
+
+DensityHeatmap::DensityHeatmap(size_t width, size_t height,
+                               const glm::dvec2& plane_size,
+                               const std::vector<ci::Color>& species_colors)
+    : width_(width),
+      height_(height),
+      plane_size_(plane_size),
+      species_colors_(species_colors),
+      saturation_(4) {
+  if (width == 0 || height == 0) {
+    throw std::invalid_argument("heatmap must have at least one pixel");
+  }
+  if (species_colors.empty()) {
+    throw std::invalid_argument("heatmap must have at least one species");
+  }
+
+  counts_.resize(width_ * height_ * species_colors_.size());
+  pixels_.resize(width_ * height_ * 4);
+}
+
+void DensityHeatmap::SetSaturation(double num_particles) {
+  if (num_particles <= 0) {
+    throw std::invalid_argument("heatmap saturation must be positive");
+  }
+  saturation_ = num_particles;
+}
+
+void DensityHeatmap::Build(const ChunkedView<Particle>& particles,
+                           ThreadPool& pool) {
+  /* The particles are split into as many chunks as there are tiles, one
+     per worker, so that each pass keeps every worker busy */
+  size_t num_tasks = std::max<size_t>(1, pool.GetNumThreads());
+  size_t num_tiles = std::min(num_tasks, height_);
+  size_t chunk_size = (particles.size() + num_tasks - 1) / num_tasks;
+
+  particle_slots_.resize(particles.size());
+  sorted_slots_.resize(particles.size());
+  tile_offsets_.assign(num_tasks * num_tiles, 0);
+
+  /* Find the slot of every particle and count the particles of each chunk
+     in each tile */
+  for (size_t chunk = 0; chunk < num_tasks; chunk++) {
+    pool.Submit([this, &particles, chunk, chunk_size, num_tiles] {
+      size_t first = std::min(chunk * chunk_size, particles.size());
+      size_t last = std::min(first + chunk_size, particles.size());
+      size_t* tile_counts = &tile_offsets_[chunk * num_tiles];
+      size_t pixels_per_species = species_colors_.size() * width_;
+
+      for (size_t i = first; i < last; i++) {
+        uint32_t slot = GetSlot(particles[i]);
+        particle_slots_[i] = slot;
+        size_t row = slot / pixels_per_species;
+        tile_counts[row * num_tiles / height_]++;
+      }
+    });
+  }
+  pool.Wait();
+
+  /* Turn the counts into offsets, ordered by tile and then by chunk, so that
+     each tile's particles are contiguous */
+  tile_starts_.resize(num_tiles + 1);
+  size_t offset = 0;
+  for (size_t tile = 0; tile < num_tiles; tile++) {
+    tile_starts_[tile] = offset;
+    for (size_t chunk = 0; chunk < num_tasks; chunk++) {
+      size_t count = tile_offsets_[chunk * num_tiles + tile];
+      tile_offsets_[chunk * num_tiles + tile] = offset;
+      offset += count;
+    }
+  }
+  tile_starts_[num_tiles] = offset;
+
+  /* Each chunk writes its slots into the ranges reserved for it */
+  for (size_t chunk = 0; chunk < num_tasks; chunk++) {
+    pool.Submit([this, &particles, chunk, chunk_size, num_tiles] {
+      size_t first = std::min(chunk * chunk_size, particles.size());
+      size_t last = std::min(first + chunk_size, particles.size());
+      size_t* tile_offsets = &tile_offsets_[chunk * num_tiles];
+      size_t pixels_per_species = species_colors_.size() * width_;
+
+      for (size_t i = first; i < last; i++) {
+        uint32_t slot = particle_slots_[i];
+        size_t row = slot / pixels_per_species;
+        sorted_slots_[tile_offsets[row * num_tiles / height_]++] = slot;
+      }
+    });
+  }
+  pool.Wait();
+
+  /* Each tile's rows are only written by the task splatting it */
+  for (size_t tile = 0; tile < num_tiles; tile++) {
+    size_t first = tile_starts_[tile];
+    size_t last = tile_starts_[tile + 1];
+    pool.Submit([this, tile, num_tiles, first, last] {
+      SplatTile(tile, num_tiles, first, last);
+    });
+  }
+  pool.Wait();
+}
+
+size_t DensityHeatmap::GetWidth() const {
+  return width_;
+}
+
+size_t DensityHeatmap::GetHeight() const {
+  return height_;
+}
+
+uint32_t DensityHeatmap::GetCount(size_t x, size_t y, size_t species) const {
+  return counts_[(y * width_ + x) * species_colors_.size() + species];
+}
+
+const std::vector<uint8_t>& DensityHeatmap::GetPixels() const {
+  return pixels_;
+}
+
+uint32_t DensityHeatmap::GetSlot(const Particle& particle) const {
+  /* Flip the y axis, so that the first row is the top of the plane. Particles
+     on or past the edges are counted in the nearest pixel. */
+  const glm::dvec2& position = particle.GetPrecisePosition();
+  double column = std::floor(position.x / plane_size_.x * width_);
+  double row = std::floor((plane_size_.y - position.y) / plane_size_.y *
+                          height_);
+  size_t x = static_cast<size_t>(
+      std::min(std::max(column, 0.0), static_cast<double>(width_ - 1)));
+  size_t y = static_cast<size_t>(
+      std::min(std::max(row, 0.0), static_cast<double>(height_ - 1)));
+
+  size_t species = species_colors_.size() - 1;
+  for (size_t i = 0; i < species_colors_.size(); i++) {
+    if (particle.GetColor() == species_colors_[i]) {
+      species = i;
+      break;
+    }
+  }
+
+  return static_cast<uint32_t>((y * width_ + x) * species_colors_.size() +
+                               species);
+}
+
+void DensityHeatmap::SplatTile(size_t tile, size_t num_tiles, size_t first,
+                               size_t last) {
+  /* The rows whose tile is this one, i.e. row * num_tiles / height == tile */
+  size_t first_row = (tile * height_ + num_tiles - 1) / num_tiles;
+  size_t last_row = ((tile + 1) * height_ + num_tiles - 1) / num_tiles;
+  size_t num_species = species_colors_.size();
+
+  std::fill(counts_.begin() + first_row * width_ * num_species,
+            counts_.begin() + last_row * width_ * num_species, 0);
+  for (size_t i = first; i < last; i++) {
+    counts_[sorted_slots_[i]]++;
+  }
+
+  for (size_t pixel = first_row * width_; pixel < last_row * width_;
+       pixel++) {
+    const uint32_t* counts = &counts_[pixel * num_species];
+    uint8_t* rgba = &pixels_[pixel * 4];
+
+    uint32_t total = 0;
+    float r = 0;
+    float g = 0;
+    float b = 0;
+    for (size_t species = 0; species < num_species; species++) {
+      total += counts[species];
+      r += counts[species] * species_colors_[species].r;
+      g += counts[species] * species_colors_[species].g;
+      b += counts[species] * species_colors_[species].b;
+    }
+
+    if (total == 0) {
+      std::fill(rgba, rgba + 4, 0);
+      continue;
+    }
+    double alpha = std::min(1.0, total / saturation_);
+    rgba[0] = static_cast<uint8_t>(std::lround(255 * r / total));
+    rgba[1] = static_cast<uint8_t>(std::lround(255 * g / total));
+    rgba[2] = static_cast<uint8_t>(std::lround(255 * b / total));
+    rgba[3] = static_cast<uint8_t>(std::lround(255 * alpha));
+  }
+}
+
+}  // namespace idealgas
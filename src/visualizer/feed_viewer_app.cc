@@ -0,0 +1,89 @@
+#include <visualizer/feed_viewer_app.h>
+
+namespace idealgas {
+
+const char* const FeedViewerApp::kDefaultFeedName = "/ideal-gas";
+
+FeedViewerApp::FeedViewerApp() : feed_name_(kDefaultFeedName) {
+  ci::app::setWindowSize((int)kWindowWidth, (int)kWindowHeight);
+}
+
+void FeedViewerApp::setup() {
+  /* The first argument is the program itself */
+  const std::vector<std::string>& args = getCommandLineArgs();
+  if (args.size() >= 2) {
+    feed_name_ = args[1];
+  }
+  status_ = "Waiting for feed " + feed_name_;
+}
+
+void FeedViewerApp::update() {
+  if (reader_ && reader_->IsClosed()) {
+    reader_.reset();
+    status_ = "Feed " + feed_name_ + " closed, waiting for it to restart";
+  }
+  if (!reader_) {
+    Attach();
+  }
+
+  if (reader_ && reader_->ReadLatest(frame_)) {
+    LoadFrame();
+    status_ = "Frame " + std::to_string(frame_.frame_number) + ", " +
+              std::to_string(reader_->GetNumSkippedFrames()) + " skipped";
+  }
+}
+
+void FeedViewerApp::draw() {
+  ci::gl::clear(ci::Color8u(255, 246, 148));
+  ci::gl::drawStringCentered(status_,
+                             glm::vec2(kWindowHeight / 2, kMargin / 2),
+                             ci::Color("black"));
+
+  if (box_) {
+    box_->DrawStaticLayer();
+    box_->Draw();
+    histograms_->DrawStaticLayer();
+    histograms_->Draw();
+  }
+}
+
+void FeedViewerApp::Attach() {
+  try {
+    reader_.reset(new FrameReader(feed_name_));
+  } catch (const std::runtime_error&) {
+    /* Not published yet, try again next frame */
+    return;
+  }
+
+  /* A restarted publisher may simulate a plane of another size */
+  double width = reader_->GetPlaneWidth();
+  double height = reader_->GetPlaneHeight();
+  if (!mirror_ || mirror_->GetWidth() != width ||
+      mirror_->GetHeight() != height) {
+    histograms_.reset();
+    box_.reset();
+    mirror_.reset(new Simulator(width, height, 0));
+
+    box_.reset(new Box(*mirror_, glm::vec2(kMargin, kMargin), kBoxWidth));
+    box_->Setup();
+    histograms_.reset(new Histograms(
+        *mirror_,
+        std::vector<glm::vec2>(
+            {glm::vec2(kWindowHeight, kMargin),
+             glm::vec2(kWindowHeight, 2 * kMargin + kBoxWidth / 4),
+             glm::vec2(kWindowHeight, 3 * kMargin + 2 * kBoxWidth / 4)}),
+        kBoxWidth / 2, kBoxWidth / 4));
+    histograms_->Setup();
+  }
+}
+
+void FeedViewerApp::LoadFrame() {
+  mirror_->Reset();
+  for (const FeedParticle& particle : frame_.particles) {
+    mirror_->AddParticle(Particle(particle.radius, particle.mass,
+                                  particle.position, particle.velocity,
+                                  particle.color));
+  }
+}
+
+}  // namespace idealgas
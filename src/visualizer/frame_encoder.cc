@@ -0,0 +1,216 @@
+#include <visualizer/frame_encoder.h>
+
+#include <algorithm>
+#include <array>
+#include <sstream>
+
+namespace idealgas {
+
+namespace {
+
+/** The largest number of bytes an uncompressed deflate block can hold */
+const size_t kMaxStoredBlockSize = 65535;
+
+const std::array<uint32_t, 256>& GetCrcTable() {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> crcs;
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = crc & 1 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+      }
+      crcs[i] = crc;
+    }
+    return crcs;
+  }();
+  return table;
+}
+
+/** Returns the CRC-32 of a range of bytes, as PNG chunks are checked with */
+uint32_t GetCrc(const uint8_t* first, const uint8_t* last) {
+  const std::array<uint32_t, 256>& table = GetCrcTable();
+  uint32_t crc = 0xFFFFFFFFu;
+  for (const uint8_t* byte = first; byte != last; byte++) {
+    crc = table[(crc ^ *byte) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+void AppendBigEndian(uint32_t value, std::vector<uint8_t>& output) {
+  output.push_back(static_cast<uint8_t>(value >> 24));
+  output.push_back(static_cast<uint8_t>(value >> 16));
+  output.push_back(static_cast<uint8_t>(value >> 8));
+  output.push_back(static_cast<uint8_t>(value));
+}
+
+/**
+ * Appends a PNG chunk, whose data is whatever was appended to the output
+ * after data_start, which must have left 8 bytes for the length and type
+ */
+void FinishChunk(size_t data_start, const char* type,
+                 std::vector<uint8_t>& output) {
+  uint32_t length = static_cast<uint32_t>(output.size() - data_start);
+  uint8_t* header = &output[data_start - 8];
+  header[0] = static_cast<uint8_t>(length >> 24);
+  header[1] = static_cast<uint8_t>(length >> 16);
+  header[2] = static_cast<uint8_t>(length >> 8);
+  header[3] = static_cast<uint8_t>(length);
+  std::copy(type, type + 4, header + 4);
+
+  /* The CRC covers the type and the data */
+  const uint8_t* last = output.data() + output.size();
+  AppendBigEndian(GetCrc(&output[data_start - 4], last), output);
+}
+
+/**
+ * Leaves room for a chunk's length and type, and returns where its data
+ * starts
+ */
+size_t StartChunk(std::vector<uint8_t>& output) {
+  output.resize(output.size() + 8);
+  return output.size();
+}
+
+/**
+ * Adds a range of bytes to an Adler-32 checksum, as zlib streams are checked
+ * with. The sums are only reduced every 5552 bytes, the most which cannot
+ * overflow them.
+ */
+void UpdateAdler(const uint8_t* first, const uint8_t* last, uint32_t& a,
+                 uint32_t& b) {
+  const size_t kMaxUnreducedBytes = 5552;
+  while (first != last) {
+    size_t count = std::min<size_t>(last - first, kMaxUnreducedBytes);
+    for (const uint8_t* byte = first; byte != first + count; byte++) {
+      a += *byte;
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+    first += count;
+  }
+}
+
+/** Converts 8 bit RGB to studio range BT.601 YCbCr */
+uint8_t GetLuma(int r, int g, int b) {
+  return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+uint8_t GetBlueChroma(int r, int g, int b) {
+  return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) +
+                              128);
+}
+
+uint8_t GetRedChroma(int r, int g, int b) {
+  return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) +
+                              128);
+}
+
+}  // namespace
+
+std::string GetY4mHeader(size_t width, size_t height,
+                         size_t frames_per_second) {
+  std::stringstream header;
+  header << "YUV4MPEG2 W" << width << " H" << height << " F"
+         << frames_per_second << ":1 Ip A1:1 C444\n";
+  return header.str();
+}
+
+void EncodeY4mFrame(const RgbImage& image, std::vector<uint8_t>& output) {
+  static const char kFrameHeader[] = "FRAME\n";
+  size_t header_size = sizeof(kFrameHeader) - 1;
+  size_t num_pixels = image.width * image.height;
+  output.resize(header_size + 3 * num_pixels);
+  std::copy(kFrameHeader, kFrameHeader + header_size, output.begin());
+
+  /* The three planes follow each other, each a full resolution image */
+  uint8_t* y_plane = &output[header_size];
+  uint8_t* u_plane = y_plane + num_pixels;
+  uint8_t* v_plane = u_plane + num_pixels;
+  for (size_t i = 0; i < num_pixels; i++) {
+    int r = image.pixels[i * 3];
+    int g = image.pixels[i * 3 + 1];
+    int b = image.pixels[i * 3 + 2];
+    y_plane[i] = GetLuma(r, g, b);
+    u_plane[i] = GetBlueChroma(r, g, b);
+    v_plane[i] = GetRedChroma(r, g, b);
+  }
+}
+
+void EncodePng(const RgbImage& image, std::vector<uint8_t>& output) {
+  static const uint8_t kSignature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A,
+                                       '\n'};
+  output.assign(kSignature, kSignature + sizeof(kSignature));
+
+  /* 8 bits per channel of RGB, without interlacing */
+  size_t data_start = StartChunk(output);
+  AppendBigEndian(static_cast<uint32_t>(image.width), output);
+  AppendBigEndian(static_cast<uint32_t>(image.height), output);
+  const uint8_t kImageFormat[] = {8, 2, 0, 0, 0};
+  output.insert(output.end(), kImageFormat,
+                kImageFormat + sizeof(kImageFormat));
+  FinishChunk(data_start, "IHDR", output);
+
+  /* The image data is a zlib stream of the rows, each preceded by a filter
+     type of 0 so that it is stored as is */
+  size_t row_size = image.width * 3;
+  size_t raw_size = image.height * (row_size + 1);
+  size_t num_blocks =
+      std::max<size_t>(1, (raw_size + kMaxStoredBlockSize - 1) /
+                              kMaxStoredBlockSize);
+  output.reserve(output.size() + raw_size + 5 * num_blocks + 64);
+
+  data_start = StartChunk(output);
+  output.push_back(0x78);
+  output.push_back(0x01);
+
+  uint32_t adler_a = 1;
+  uint32_t adler_b = 0;
+  size_t row = 0;
+  size_t column = 0;
+  size_t remaining = raw_size;
+  for (size_t block = 0; block < num_blocks; block++) {
+    uint16_t block_size =
+        static_cast<uint16_t>(std::min(remaining, kMaxStoredBlockSize));
+    uint16_t inverted_size = static_cast<uint16_t>(~block_size);
+    remaining -= block_size;
+
+    output.push_back(remaining == 0 ? 1 : 0);
+    output.push_back(static_cast<uint8_t>(block_size));
+    output.push_back(static_cast<uint8_t>(block_size >> 8));
+    output.push_back(static_cast<uint8_t>(inverted_size));
+    output.push_back(static_cast<uint8_t>(inverted_size >> 8));
+
+    /* Blocks are cut without regard to rows, so copy as much of the current
+       row as fits, where column 0 of every row is its filter type */
+    size_t block_start = output.size();
+    size_t block_left = block_size;
+    while (block_left > 0) {
+      if (column == 0) {
+        output.push_back(0);
+        column++;
+        block_left--;
+      } else {
+        size_t count = std::min(block_left, row_size + 1 - column);
+        const uint8_t* source = &image.pixels[row * row_size + column - 1];
+        output.insert(output.end(), source, source + count);
+        column += count;
+        block_left -= count;
+      }
+
+      if (column > row_size) {
+        column = 0;
+        row++;
+      }
+    }
+    UpdateAdler(output.data() + block_start, output.data() + output.size(),
+                adler_a, adler_b);
+  }
+  AppendBigEndian((adler_b << 16) | adler_a, output);
+  FinishChunk(data_start, "IDAT", output);
+
+  data_start = StartChunk(output);
+  FinishChunk(data_start, "IEND", output);
+}
+
+}  // namespace idealgas
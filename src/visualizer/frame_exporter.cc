@@ -0,0 +1,167 @@
+#include <visualizer/frame_exporter.h>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace idealgas {
+
+FrameExporter::FrameExporter(FrameRasterizer& rasterizer, ExportFormat format,
+                             const std::string& output_path,
+                             size_t frames_per_second)
+    : rasterizer_(rasterizer),
+      format_(format),
+      output_path_(output_path),
+      frames_per_second_(frames_per_second) {
+}
+
+void FrameExporter::Run(Simulator& simulator, size_t num_frames,
+                        size_t steps_per_frame, ThreadPool& pool) {
+  /* Enough slots for every worker to render a frame while as many again
+     wait to be written */
+  size_t num_slots = 2 * std::max<size_t>(1, pool.GetNumThreads());
+  slots_.resize(num_slots);
+  for (FrameSlot& slot : slots_) {
+    slot.state = SlotState::kFree;
+  }
+  error_ = nullptr;
+
+  std::thread writer(&FrameExporter::WriteFrames, this, num_frames);
+
+  try {
+    for (size_t frame = 0; frame < num_frames; frame++) {
+      if (frame > 0) {
+        for (size_t step = 0; step < steps_per_frame; step++) {
+          simulator.Update();
+        }
+      }
+
+      FrameSlot& slot = slots_[frame % num_slots];
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        state_changed_.wait(lock, [this, &slot] {
+          return slot.state == SlotState::kFree || error_;
+        });
+        if (error_) {
+          break;
+        }
+      }
+
+      rasterizer_.TakeSnapshot(simulator, slot.snapshot);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot.state = SlotState::kRendering;
+      }
+      pool.Submit([this, &slot] { RenderSlot(slot); });
+    }
+  } catch (...) {
+    Fail(std::current_exception());
+  }
+
+  writer.join();
+  pool.Wait();
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+std::string FrameExporter::GetPngPath(size_t frame) const {
+  std::stringstream path;
+  path << output_path_ << std::setw(6) << std::setfill('0') << frame
+       << ".png";
+  return path.str();
+}
+
+void FrameExporter::RenderSlot(FrameSlot& slot) {
+  try {
+    rasterizer_.Render(slot.snapshot, slot.image);
+    if (format_ == ExportFormat::kY4m) {
+      EncodeY4mFrame(slot.image, slot.encoded);
+    } else {
+      EncodePng(slot.image, slot.encoded);
+    }
+  } catch (...) {
+    Fail(std::current_exception());
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slot.state = SlotState::kEncoded;
+  }
+  state_changed_.notify_all();
+}
+
+void FrameExporter::WriteFrames(size_t num_frames) {
+  try {
+    std::ofstream stream;
+    if (format_ == ExportFormat::kY4m) {
+      stream.open(output_path_, std::ios::binary | std::ios::trunc);
+      if (!stream) {
+        throw std::runtime_error("could not open export output " +
+                                 output_path_);
+      }
+      stream << GetY4mHeader(rasterizer_.GetWidth(), rasterizer_.GetHeight(),
+                             frames_per_second_);
+    }
+
+    for (size_t frame = 0; frame < num_frames; frame++) {
+      FrameSlot& slot = slots_[frame % slots_.size()];
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        state_changed_.wait(lock, [this, &slot] {
+          return slot.state == SlotState::kEncoded || error_;
+        });
+        if (error_) {
+          return;
+        }
+      }
+
+      const char* data = reinterpret_cast<const char*>(slot.encoded.data());
+      if (format_ == ExportFormat::kY4m) {
+        stream.write(data, slot.encoded.size());
+        if (!stream) {
+          throw std::runtime_error("could not write export output " +
+                                   output_path_);
+        }
+      } else {
+        std::string path = GetPngPath(frame);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(data, slot.encoded.size());
+        if (!file) {
+          throw std::runtime_error("could not write export output " + path);
+        }
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot.state = SlotState::kFree;
+      }
+      state_changed_.notify_all();
+    }
+
+    if (format_ == ExportFormat::kY4m) {
+      stream.flush();
+      if (!stream) {
+        throw std::runtime_error("could not write export output " +
+                                 output_path_);
+      }
+    }
+  } catch (...) {
+    Fail(std::current_exception());
+  }
+}
+
+void FrameExporter::Fail(std::exception_ptr error) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_) {
+      error_ = error;
+    }
+  }
+  state_changed_.notify_all();
+}
+
+}  // namespace idealgas
@@ -0,0 +1,264 @@
+#include <visualizer/frame_rasterizer.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace idealgas {
+
+namespace {
+
+struct Rgb {
+  uint8_t r, g, b;
+};
+
+Rgb ToRgb(const ci::Color& color) {
+  auto to_byte = [](float channel) {
+    return static_cast<uint8_t>(
+        std::round(std::min(std::max(channel, 0.0f), 1.0f) * 255));
+  };
+  return Rgb{to_byte(color.r), to_byte(color.g), to_byte(color.b)};
+}
+
+const Rgb kBackground = {255, 246, 148};
+const Rgb kWhite = {255, 255, 255};
+const Rgb kBlack = {0, 0, 0};
+
+void SetPixel(RgbImage& image, long x, long y, const Rgb& color) {
+  if (x < 0 || y < 0 || x >= static_cast<long>(image.width) ||
+      y >= static_cast<long>(image.height)) {
+    return;
+  }
+  uint8_t* pixel = &image.pixels[(y * image.width + x) * 3];
+  pixel[0] = color.r;
+  pixel[1] = color.g;
+  pixel[2] = color.b;
+}
+
+/** Fills the pixels whose centers are inside of the rectangle */
+void FillRect(RgbImage& image, const glm::vec2& top_left,
+              const glm::vec2& bottom_right, const Rgb& color) {
+  long first_x = std::max(0L, std::lround(std::ceil(top_left.x - 0.5f)));
+  long first_y = std::max(0L, std::lround(std::ceil(top_left.y - 0.5f)));
+  long last_x = std::min(static_cast<long>(image.width),
+                         std::lround(std::ceil(bottom_right.x - 0.5f)));
+  long last_y = std::min(static_cast<long>(image.height),
+                         std::lround(std::ceil(bottom_right.y - 0.5f)));
+
+  for (long y = first_y; y < last_y; y++) {
+    for (long x = first_x; x < last_x; x++) {
+      SetPixel(image, x, y, color);
+    }
+  }
+}
+
+/** Draws a one pixel wide outline centered on the edges of the rectangle */
+void StrokeRect(RgbImage& image, const glm::vec2& top_left,
+                const glm::vec2& bottom_right, const Rgb& color) {
+  glm::vec2 half(0.5f, 0.5f);
+  FillRect(image, top_left - half,
+           glm::vec2(bottom_right.x, top_left.y) + half, color);
+  FillRect(image, glm::vec2(top_left.x, bottom_right.y) - half,
+           bottom_right + half, color);
+  FillRect(image, top_left - half,
+           glm::vec2(top_left.x, bottom_right.y) + half, color);
+  FillRect(image, glm::vec2(bottom_right.x, top_left.y) - half,
+           bottom_right + half, color);
+}
+
+/**
+ * Fills a disc, with a black outline one pixel wide on its edge if
+ * is_outlined is set, matching the particle shader of the box
+ */
+void DrawDisc(RgbImage& image, const glm::vec2& center, float radius,
+              const Rgb& color, bool is_outlined) {
+  float extent = radius + 0.5f;
+  long first_x = std::lround(std::floor(center.x - extent));
+  long first_y = std::lround(std::floor(center.y - extent));
+  long last_x = std::lround(std::ceil(center.x + extent));
+  long last_y = std::lround(std::ceil(center.y + extent));
+
+  for (long y = first_y; y <= last_y; y++) {
+    for (long x = first_x; x <= last_x; x++) {
+      float distance =
+          glm::length(glm::vec2(x + 0.5f, y + 0.5f) - center);
+      if (!is_outlined) {
+        if (distance <= radius) {
+          SetPixel(image, x, y, color);
+        }
+      } else if (distance <= radius + 0.5f) {
+        SetPixel(image, x, y, distance > radius - 0.5f ? kBlack : color);
+      }
+    }
+  }
+}
+
+/** Draws a one pixel wide line by sampling it once per pixel */
+void DrawLine(RgbImage& image, const glm::vec2& start, const glm::vec2& end,
+              const Rgb& color) {
+  glm::vec2 delta = end - start;
+  long num_steps = std::max(
+      1L, std::lround(std::ceil(std::max(std::abs(delta.x),
+                                         std::abs(delta.y)))));
+  for (long step = 0; step <= num_steps; step++) {
+    glm::vec2 point = start + delta * (static_cast<float>(step) / num_steps);
+    SetPixel(image, std::lround(std::floor(point.x)),
+             std::lround(std::floor(point.y)), color);
+  }
+}
+
+}  // namespace
+
+const size_t FrameRasterizer::kMaxFrequency;
+const size_t FrameRasterizer::kNumSpeedIntervals;
+
+FrameRasterizer::FrameRasterizer(const Simulator& simulator, size_t height)
+    : width_(height * 3 / 2),
+      height_(height),
+      margin_(height / 10.0),
+      box_width_(height - 2 * margin_),
+      scale_factor_(box_width_ /
+                    std::max(simulator.GetWidth(), simulator.GetHeight())),
+      histogram_width_(box_width_ / 2),
+      histogram_height_(box_width_ / 4),
+      instance_builder_(glm::vec2(margin_, margin_), scale_factor_,
+                        simulator.GetHeight()),
+      histogram_colors_({simulator.kSmallColor, simulator.kMediumColor,
+                         simulator.kLargeColor}) {
+  if (height < 10) {
+    throw std::invalid_argument("frames must be at least 10 pixels high");
+  }
+
+  /* The same places as the app's histograms, relative to the height */
+  histogram_corners_ = {
+      glm::vec2(height_, margin_),
+      glm::vec2(height_, 2 * margin_ + box_width_ / 4),
+      glm::vec2(height_, 3 * margin_ + 2 * box_width_ / 4)};
+
+  RenderStaticLayer(simulator);
+}
+
+size_t FrameRasterizer::GetWidth() const {
+  return width_;
+}
+
+size_t FrameRasterizer::GetHeight() const {
+  return height_;
+}
+
+void FrameRasterizer::TakeSnapshot(const Simulator& simulator,
+                                   FrameSnapshot& snapshot) {
+  instance_builder_.Build(simulator.GetParticles());
+  const std::vector<ParticleInstance>& instances =
+      instance_builder_.GetInstances();
+  snapshot.particles.assign(instances.begin(), instances.end());
+
+  simulator.GetSmallParticleSpeeds(snapshot.small_speeds);
+  simulator.GetMediumParticleSpeeds(snapshot.medium_speeds);
+  simulator.GetLargeParticleSpeeds(snapshot.large_speeds);
+}
+
+void FrameRasterizer::Render(const FrameSnapshot& snapshot,
+                             RgbImage& image) const {
+  image.width = width_;
+  image.height = height_;
+  image.pixels.assign(static_layer_.pixels.begin(),
+                      static_layer_.pixels.end());
+
+  DrawParticles(snapshot.particles, image);
+  DrawHistogram(histogram_corners_[0], snapshot.small_speeds,
+                histogram_colors_[0], image);
+  DrawHistogram(histogram_corners_[1], snapshot.medium_speeds,
+                histogram_colors_[1], image);
+  DrawHistogram(histogram_corners_[2], snapshot.large_speeds,
+                histogram_colors_[2], image);
+}
+
+void FrameRasterizer::RenderStaticLayer(const Simulator& simulator) {
+  static_layer_.width = width_;
+  static_layer_.height = height_;
+  static_layer_.pixels.resize(width_ * height_ * 3);
+  for (size_t i = 0; i < width_ * height_; i++) {
+    static_layer_.pixels[i * 3] = kBackground.r;
+    static_layer_.pixels[i * 3 + 1] = kBackground.g;
+    static_layer_.pixels[i * 3 + 2] = kBackground.b;
+  }
+
+  /* The box, fit to the plane's proportions as Box does */
+  glm::vec2 box_top_left(margin_, margin_);
+  glm::vec2 box_bottom_right =
+      box_top_left + glm::vec2(simulator.GetWidth() * scale_factor_,
+                               simulator.GetHeight() * scale_factor_);
+  FillRect(static_layer_, box_top_left, box_bottom_right, kWhite);
+  StrokeRect(static_layer_, box_top_left, box_bottom_right, kBlack);
+
+  /* Obstacles do not move during an export, so they are drawn once here */
+  Rgb obstacle_color = ToRgb(ci::Color("gray"));
+  double height = simulator.GetHeight();
+  for (const Obstacle& obstacle : simulator.GetObstacles().GetObstacles()) {
+    glm::vec2 start(glm::dvec2(obstacle.start.x, height - obstacle.start.y) *
+                    scale_factor_);
+    glm::vec2 end(glm::dvec2(obstacle.end.x, height - obstacle.end.y) *
+                  scale_factor_);
+    start += box_top_left;
+    end += box_top_left;
+
+    if (obstacle.thickness > 0) {
+      DrawDisc(static_layer_, start,
+               static_cast<float>(obstacle.thickness * scale_factor_),
+               obstacle_color, false);
+    } else {
+      DrawLine(static_layer_, start, end, obstacle_color);
+    }
+  }
+
+  for (const glm::vec2& top_left_corner : histogram_corners_) {
+    glm::vec2 bottom_right =
+        top_left_corner + glm::vec2(histogram_width_, histogram_height_);
+    FillRect(static_layer_, top_left_corner, bottom_right, kWhite);
+    StrokeRect(static_layer_, top_left_corner, bottom_right, kBlack);
+  }
+}
+
+void FrameRasterizer::DrawParticles(
+    const std::vector<ParticleInstance>& particles, RgbImage& image) const {
+  for (const ParticleInstance& particle : particles) {
+    DrawDisc(image, particle.position, particle.radius,
+             ToRgb(particle.color), true);
+  }
+}
+
+void FrameRasterizer::DrawHistogram(const glm::vec2& top_left_corner,
+                                    const std::vector<double>& speeds,
+                                    const ci::Color& color,
+                                    RgbImage& image) const {
+  /* Sort the speeds into intervals as Histograms does, with the last
+     interval unbounded */
+  std::array<size_t, kNumSpeedIntervals> frequencies;
+  frequencies.fill(0);
+  double interval_width = kMaxSpeed / kNumSpeedIntervals;
+  for (double speed : speeds) {
+    size_t interval = static_cast<size_t>(speed / interval_width);
+    frequencies[std::min(interval, kNumSpeedIntervals - 1)]++;
+  }
+
+  Rgb bar_color = ToRgb(color);
+  double bar_width = histogram_width_ / kNumSpeedIntervals;
+  glm::vec2 bar_bottom_left =
+      top_left_corner + glm::vec2(0, histogram_height_);
+  for (size_t frequency : frequencies) {
+    double bar_height =
+        static_cast<double>(std::min(frequency, kMaxFrequency)) /
+        kMaxFrequency * histogram_height_;
+
+    glm::vec2 bar_top_left = bar_bottom_left + glm::vec2(0, -bar_height);
+    glm::vec2 bar_bottom_right = bar_bottom_left + glm::vec2(bar_width, 0);
+    FillRect(image, bar_top_left, bar_bottom_right, bar_color);
+    StrokeRect(image, bar_top_left, bar_bottom_right, kBlack);
+
+    bar_bottom_left += glm::vec2(bar_width, 0);
+  }
+}
+
+}  // namespace idealgas
@@ -3,15 +3,26 @@
 namespace idealgas {
 
 void Histograms::Setup() {
-  /* Fill the vectors representing speed and frequency */
-  speed_intervals_.push_back(0);
+  /* Fill the vector representing frequency */
   freq_intervals_.push_back(0);
-  for (size_t i = 1; i <= kNumSpeedIntervals; i++) {
-    speed_intervals_.push_back(speed_intervals_.back() + kSpeedIntervalWidth);
-  }
   for (size_t i = 1; i <= kNumFreqIntervals; i++) {
     freq_intervals_.push_back(freq_intervals_.back() + kFreqIntervalWidth);
   }
+
+  /* Format the axis labels, with a '+' at the end of the last label since
+     the last interval is unbounded */
+  for (double speed : speed_histogram_.GetIntervals()) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << speed * 10;
+    speed_labels_.push_back(ss.str());
+  }
+  speed_labels_.back() += "+";
+  for (size_t frequency : freq_intervals_) {
+    freq_labels_.push_back(std::to_string(frequency));
+  }
+  freq_labels_.back() += "+";
+
+  label_font_ = cinder::Font("Arial", 8);
 }
 
 Histograms::Histograms(const Simulator& simulator,
@@ -20,11 +31,17 @@ Histograms::Histograms(const Simulator& simulator,
     : top_left_corners_(top_left_corners),
       graph_width_(graph_width),
       graph_height_(graph_height),
-      simulator_(simulator) {
+      simulator_(simulator),
+      speed_histogram_(kMaxSpeed, kNumSpeedIntervals) {
 }
 
-void Histograms::Draw() const {
+void Histograms::DrawStaticLayer() const {
   DrawBorders();
+  DrawXAxis();
+  DrawYAxis();
+}
+
+void Histograms::Draw() const {
   DrawGraphs();
 }
 
@@ -42,53 +59,18 @@ void Histograms::DrawBorders() const {
 }
 
 void Histograms::DrawGraphs() const {
-  /* Obtain speed data from the simulator */
-  std::vector<double> small_speeds = simulator_.GetSmallParticleSpeeds();
-  std::vector<double> medium_speeds = simulator_.GetMediumParticleSpeeds();
-  std::vector<double> large_speeds = simulator_.GetLargeParticleSpeeds();
-
-  /* Obtain frequencies based on the speed */
-  std::vector<size_t> small_freqs = GetSpeedFrequencies(small_speeds);
-  std::vector<size_t> med_freqs = GetSpeedFrequencies(medium_speeds);
-  std::vector<size_t> large_freqs = GetSpeedFrequencies(large_speeds);
-
-  /* Draw histogram basd on the frequencies */
-  DrawHistogramBars(top_left_corners_[0], small_freqs, simulator_.kSmallColor);
-  DrawHistogramBars(top_left_corners_[1], med_freqs, simulator_.kMediumColor);
-  DrawHistogramBars(top_left_corners_[2], large_freqs, simulator_.kLargeColor);
-
-  /* Draw axes and labels */
-  DrawXAxis();
-  DrawYAxis();
-}
-
-std::vector<size_t> Histograms::GetSpeedFrequencies(
-    const std::vector<double>& speeds) const {
-  std::vector<size_t> frequencies;
-  for (size_t i = 0; i < kNumSpeedIntervals - 1; i++) {
-    double interval_min = speed_intervals_[i];
-    double interval_max = speed_intervals_[i + 1];
-
-    size_t count = 0;
-    for (double speed : speeds) {
-      if (speed >= interval_min && speed < interval_max) {
-        count++;
-      }
-    }
-    frequencies.push_back(count);
-  }
-
-  /* The last histogram interval is unbounded, deal with it seperately */
-  double interval_min = speed_intervals_[speed_intervals_.size() - 2];
-  size_t count = 0;
-  for (double speed : speeds) {
-    if (speed >= interval_min) {
-      count++;
-    }
-  }
-  frequencies.push_back(count);
-
-  return frequencies;
+  /* Obtain the frequencies of each size's speeds from the simulator, and
+     draw each histogram based on them */
+  speed_histogram_.Build(simulator_);
+  DrawHistogramBars(top_left_corners_[0],
+                    speed_histogram_.GetSmallFrequencies(),
+                    simulator_.kSmallColor);
+  DrawHistogramBars(top_left_corners_[1],
+                    speed_histogram_.GetMediumFrequencies(),
+                    simulator_.kMediumColor);
+  DrawHistogramBars(top_left_corners_[2],
+                    speed_histogram_.GetLargeFrequencies(),
+                    simulator_.kLargeColor);
 }
 
 void Histograms::DrawHistogramBars(const glm::vec2& top_left_corner,
@@ -126,21 +108,11 @@ void Histograms::DrawXAxis() const {
     glm::vec2 bot_left_corner =
         top_left_corner + glm::vec2(0, graph_height_ + spacer);
 
-    for (size_t i = 0; i < kNumSpeedIntervals; i++) {
-      std::stringstream ss;
-      ss << std::fixed << std::setprecision(1) << speed_intervals_[i] * 10;
-      std::string speed = ss.str();
-      ci::gl::drawStringCentered(speed, bot_left_corner, ci::Color("black"),
-                                 cinder::Font("Arial", 8));
+    for (const std::string& label : speed_labels_) {
+      ci::gl::drawStringCentered(label, bot_left_corner, ci::Color("black"),
+                                 label_font_);
       bot_left_corner += glm::vec2(graph_width_ / kNumSpeedIntervals, 0);
     }
-
-    /* Add '+' to end of label, deal with it separately */
-    std::stringstream ss;
-    ss << std::fixed << std::setprecision(1) << speed_intervals_.back() * 10;
-    std::string speed = ss.str();
-    ci::gl::drawStringCentered(speed + "+", bot_left_corner, ci::Color("black"),
-                               cinder::Font("Arial", 8));
   }
 }
 
@@ -151,17 +123,11 @@ void Histograms::DrawYAxis() const {
     glm::vec2 bot_left_corner =
         top_left_corner + glm::vec2(-spacer, graph_height_);
 
-    for (size_t i = 0; i < kNumFreqIntervals; i++) {
-      ci::gl::drawStringCentered(std::to_string(freq_intervals_[i]),
-                                 bot_left_corner, ci::Color("black"),
-                                 cinder::Font("Arial", 8));
+    for (const std::string& label : freq_labels_) {
+      ci::gl::drawStringCentered(label, bot_left_corner, ci::Color("black"),
+                                 label_font_);
       bot_left_corner += glm::vec2(0, -graph_height_ / kNumFreqIntervals);
     }
-
-    /* Add '+' to end of label, deal with it separately */
-    ci::gl::drawStringCentered(std::to_string(freq_intervals_.back()) + "+",
-                               bot_left_corner, ci::Color("black"),
-                               cinder::Font("Arial", 8));
   }
 }
 
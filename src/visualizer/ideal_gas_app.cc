@@ -1,5 +1,7 @@
 #include <visualizer/ideal_gas_app.h>
 
+#include <algorithm>
+
 namespace idealgas {
 
 IdealGasApp::IdealGasApp()
@@ -10,56 +12,172 @@ IdealGasApp::IdealGasApp()
               {glm::vec2(kWindowHeight, kMargin),
                glm::vec2(kWindowHeight, 2 * kMargin + kBoxWidth / 4),
                glm::vec2(kWindowHeight, 3 * kMargin + 2 * kBoxWidth / 4)}),
-          kBoxWidth / 2, kBoxWidth / 4) {
+          kBoxWidth / 2, kBoxWidth / 4),
+      is_paused_(false),
+      scrub_index_(0),
+      labeled_num_particles_(0) {
   ci::app::setWindowSize((int)kWindowWidth, (int)kWindowHeight);
 }
 
 void IdealGasApp::setup() {
+  box_.Setup();
   histograms_.Setup();
+  rewind_.RecordKeyframe(simulator_);
 }
 
 void IdealGasApp::draw() {
-  /* Set background to light yellow */
-  ci::gl::clear(ci::Color8u(255, 246, 148));
+  if (!static_layer_) {
+    RenderStaticLayer();
+  }
 
-  /* Draw text instructions */
-  ci::gl::drawStringCentered(
-      "Press 1, 2, or 3 to add a random small, medium, or large particle, "
-      "respectively. Press Backspace to empty the box.",
-      glm::vec2(kWindowHeight / 2, kMargin / 2), ci::Color("black"));
+  /* The layer covers the whole window, so it replaces clearing it. White
+     leaves the texture's colors untinted. */
+  ci::gl::color(ci::Color("white"));
+  ci::gl::draw(static_layer_->getColorTexture(),
+               ci::Rectf(glm::vec2(0), glm::vec2(ci::app::getWindowSize())));
 
+  if (num_particles_label_.empty() ||
+      simulator_.GetNumParticles() != labeled_num_particles_) {
+    labeled_num_particles_ = simulator_.GetNumParticles();
+    num_particles_label_ =
+        "Number of Particles: " + std::to_string(labeled_num_particles_);
+  }
   ci::gl::drawStringCentered(
-      "Number of Particles: " + std::to_string(simulator_.GetNumParticles()),
+      num_particles_label_,
       glm::vec2(kWindowHeight / 2, kWindowHeight - kMargin / 2),
       ci::Color("blue"));
+  if (is_paused_) {
+    ci::gl::drawStringCentered(
+        paused_label_,
+        glm::vec2(kWindowHeight / 2, kWindowHeight - kMargin / 2 + 20),
+        ci::Color("blue"));
+  }
+
+  box_.Draw();
+  histograms_.Draw();
+}
+
+void IdealGasApp::resize() {
+  /* Rendered again at the new size by the next draw() */
+  static_layer_.reset();
+}
+
+void IdealGasApp::RenderStaticLayer() {
+  /* The framebuffer has a pixel per physical pixel, while drawing is done in
+     window coordinates as it is on screen */
+  glm::ivec2 size = ci::app::toPixels(ci::app::getWindowSize());
+  static_layer_ = ci::gl::Fbo::create(size.x, size.y,
+                                      ci::gl::Fbo::Format().samples(4));
+
+  ci::gl::ScopedFramebuffer framebuffer(static_layer_);
+  ci::gl::ScopedViewport viewport(glm::ivec2(0), static_layer_->getSize());
+  ci::gl::ScopedMatrices matrices;
+  ci::gl::setMatricesWindow(ci::app::getWindowSize());
+
+  /* Set background to light yellow */
+  ci::gl::clear(ci::Color8u(255, 246, 148));
+
+  /* Draw text instructions */
+  ci::gl::drawStringCentered(kInstructions,
+                             glm::vec2(kWindowHeight / 2, kMargin / 2),
+                             ci::Color("black"));
+  ci::gl::drawStringCentered(kRewindInstructions,
+                             glm::vec2(kWindowHeight / 2, kMargin / 2 + 20),
+                             ci::Color("black"));
 
   ci::gl::drawStringCentered(
-      "Histograms of small, medium, and large particles",
+      kHistogramsTitle,
       glm::vec2(2 * kMargin + kBoxWidth + kBoxWidth / 4, kMargin / 2),
       ci::Color("black"));
 
-  box_.Draw();
-  histograms_.Draw();
+  box_.DrawStaticLayer();
+  histograms_.DrawStaticLayer();
 }
 
 void IdealGasApp::update() {
-  simulator_.Update();
+  if (!is_paused_) {
+    simulator_.Update();
+    rewind_.Record(simulator_);
+  }
 }
 
 void IdealGasApp::keyDown(ci::app::KeyEvent event) {
   switch (event.getCode()) {
+    case ci::app::KeyEvent::KEY_SPACE:
+      TogglePause();
+      return;
+    case ci::app::KeyEvent::KEY_LEFT:
+      Scrub(-1);
+      return;
+    case ci::app::KeyEvent::KEY_RIGHT:
+      Scrub(1);
+      return;
     case ci::app::KeyEvent::KEY_1:
+      RestoreScrubbedCapture();
       simulator_.AddRandomSmallParticle();
       break;
     case ci::app::KeyEvent::KEY_2:
+      RestoreScrubbedCapture();
       simulator_.AddRandomMediumParticle();
       break;
     case ci::app::KeyEvent::KEY_3:
+      RestoreScrubbedCapture();
       simulator_.AddRandomLargeParticle();
       break;
     case ci::app::KeyEvent::KEY_DELETE:
+      RestoreScrubbedCapture();
       simulator_.Reset();
       break;
+    default:
+      return;
+  }
+
+  /* Re-simulating from an earlier capture would not repeat the change */
+  rewind_.RecordKeyframe(simulator_);
+  if (is_paused_) {
+    Scrub(0);
+  }
+}
+
+void IdealGasApp::TogglePause() {
+  if (is_paused_) {
+    RestoreScrubbedCapture();
+    is_paused_ = false;
+  } else {
+    /* Capture the step paused at, so that resuming without scrubbing
+       continues from exactly there */
+    rewind_.RecordKeyframe(simulator_);
+    is_paused_ = true;
+    scrub_index_ = rewind_.GetNumCaptures() - 1;
+    Scrub(0);
+  }
+}
+
+void IdealGasApp::Scrub(int num_captures) {
+  if (!is_paused_) {
+    TogglePause();
+  }
+
+  /* Changes while paused add captures and may drop old ones, so scrubbing
+     by 0 moves to the newest capture */
+  size_t last_index = rewind_.GetNumCaptures() - 1;
+  if (num_captures == 0) {
+    scrub_index_ = last_index;
+  } else if (num_captures < 0) {
+    scrub_index_ -= std::min(scrub_index_, size_t(-num_captures));
+  } else {
+    scrub_index_ = std::min(last_index, scrub_index_ + num_captures);
+  }
+
+  rewind_.Preview(scrub_index_, simulator_);
+  paused_label_ = "Paused at step " +
+                  std::to_string(rewind_.GetStep(scrub_index_)) + " of " +
+                  std::to_string(rewind_.GetStep(last_index));
+}
+
+void IdealGasApp::RestoreScrubbedCapture() {
+  if (is_paused_) {
+    rewind_.Restore(scrub_index_, simulator_);
   }
 }
 
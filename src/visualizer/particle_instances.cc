@@ -0,0 +1,39 @@
+#include <visualizer/particle_instances.h>
+
+namespace idealgas {
+
+ParticleInstanceBuilder::ParticleInstanceBuilder(
+    const glm::vec2& top_left_corner, double scale_factor,
+    double plane_height)
+    : top_left_corner_(top_left_corner),
+      scale_factor_(scale_factor),
+      plane_height_(plane_height) {
+}
+
+void ParticleInstanceBuilder::Build(const ChunkedView<Particle>& particles) {
+  instances_.resize(particles.size());
+
+  for (size_t i = 0; i < particles.size(); i++) {
+    const Particle& particle = particles[i];
+    ParticleInstance& instance = instances_[i];
+
+    /* Re-scale the position of the particle in terms of pixel position in
+       the window and re-orient the coordinate such that the y value
+       increases from bottom to top. The scaling is done in double precision
+       since the plane may be much larger than the box. */
+    glm::dvec2 plane_position = particle.GetPrecisePosition();
+    plane_position.y = plane_height_ - plane_position.y;
+    instance.position = glm::vec2(plane_position * scale_factor_);
+    instance.position += top_left_corner_;
+
+    instance.radius = static_cast<float>(particle.GetRadius() * scale_factor_);
+    instance.color = particle.GetColor();
+  }
+}
+
+const std::vector<ParticleInstance>& ParticleInstanceBuilder::GetInstances()
+    const {
+  return instances_;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,68 @@
+#include <visualizer/speed_histogram.h>
+
+#include <algorithm>
+
+namespace idealgas {
+
+SpeedHistogramBuilder::SpeedHistogramBuilder(double max_speed,
+                                             size_t num_intervals)
+    : small_frequencies_(num_intervals),
+      medium_frequencies_(num_intervals),
+      large_frequencies_(num_intervals) {
+  /* Summed interval by interval, so that the boundaries match the axis
+     labels exactly */
+  double interval_width = max_speed / num_intervals;
+  intervals_.push_back(0);
+  for (size_t i = 1; i <= num_intervals; i++) {
+    intervals_.push_back(intervals_.back() + interval_width);
+  }
+}
+
+void SpeedHistogramBuilder::Build(const Simulator& simulator) {
+  simulator.GetSmallParticleSpeeds(speeds_);
+  CountSpeeds(speeds_, small_frequencies_);
+  simulator.GetMediumParticleSpeeds(speeds_);
+  CountSpeeds(speeds_, medium_frequencies_);
+  simulator.GetLargeParticleSpeeds(speeds_);
+  CountSpeeds(speeds_, large_frequencies_);
+}
+
+const std::vector<size_t>& SpeedHistogramBuilder::GetSmallFrequencies()
+    const {
+  return small_frequencies_;
+}
+
+const std::vector<size_t>& SpeedHistogramBuilder::GetMediumFrequencies()
+    const {
+  return medium_frequencies_;
+}
+
+const std::vector<size_t>& SpeedHistogramBuilder::GetLargeFrequencies()
+    const {
+  return large_frequencies_;
+}
+
+const std::vector<double>& SpeedHistogramBuilder::GetIntervals() const {
+  return intervals_;
+}
+
+void SpeedHistogramBuilder::CountSpeeds(
+    const std::vector<double>& speeds,
+    std::vector<size_t>& frequencies) const {
+  std::fill(frequencies.begin(), frequencies.end(), 0);
+
+  /* Each speed is counted in the last interval starting at or below it, so
+     the last interval is unbounded. The end boundary of the last interval is
+     left out of the search for that reason. */
+  std::vector<double>::const_iterator first = intervals_.begin();
+  std::vector<double>::const_iterator last = intervals_.end() - 1;
+  for (double speed : speeds) {
+    if (!(speed >= 0)) {
+      continue;
+    }
+    size_t interval = std::upper_bound(first, last, speed) - first - 1;
+    frequencies[interval]++;
+  }
+}
+
+}  // namespace idealgas
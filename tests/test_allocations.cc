@@ -0,0 +1,130 @@
+#include <core/simulator.h>
+#include <visualizer/speed_histogram.h>
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <new>
+
+using namespace idealgas;
+
+/*
+ * The test binary replaces the global allocation functions with ones that
+ * count every allocation, so that tests can require code not to touch the
+ * heap. Array and nothrow allocations go through these as well.
+ */
+
+namespace {
+
+std::atomic<size_t> num_allocations(0);
+
+/**
+ * Returns the number of heap allocations made by the specified function.
+ * Only meaningful while no other thread allocates.
+ */
+template <typename Function>
+size_t CountAllocations(Function function) {
+  size_t before = num_allocations.load();
+  function();
+  return num_allocations.load() - before;
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  num_allocations++;
+  void* memory = std::malloc(size > 0 ? size : 1);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+TEST_CASE("Allocation counting") {
+  SECTION("Heap allocations are counted") {
+    size_t count = CountAllocations([] {
+      /* Stored through a volatile pointer so it cannot be optimized out */
+      int* volatile memory = new int(1);
+      delete memory;
+    });
+    REQUIRE(count == 1);
+  }
+
+  SECTION("Reused buffers do not allocate") {
+    std::vector<double> buffer(100);
+    size_t count = CountAllocations([&buffer] {
+      buffer.clear();
+      buffer.resize(50);
+    });
+    REQUIRE(count == 0);
+  }
+}
+
+TEST_CASE("Steady-state frames do not allocate") {
+  Simulator simulator(100, 100, 6);
+  for (size_t i = 0; i < 100; i++) {
+    simulator.AddRandomSmallParticle();
+    simulator.AddRandomMediumParticle();
+    simulator.AddRandomLargeParticle();
+  }
+
+  /* What the app computes each frame: an update, then the speed histograms
+     of each size of particle, binned as Histograms bins them */
+  SpeedHistogramBuilder speed_histogram(1, 20);
+  auto frame = [&] {
+    simulator.Update();
+    speed_histogram.Build(simulator);
+  };
+
+  SECTION("Walls") {
+    /* The first frames grow the buffers to their steady-state size */
+    for (size_t i = 0; i < 10; i++) {
+      frame();
+    }
+
+    size_t count = CountAllocations([&frame] {
+      for (size_t i = 0; i < 100; i++) {
+        frame();
+      }
+    });
+    REQUIRE(count == 0);
+  }
+
+  SECTION("Periodic edges, reordering, and block time steps") {
+    simulator.SetBoundaryMode(BoundaryMode::kPeriodic);
+    simulator.SetReorderInterval(7);
+    simulator.SetBlockTimeSteps(3, 0.5);
+    for (size_t i = 0; i < 10; i++) {
+      frame();
+    }
+
+    size_t count = CountAllocations([&frame] {
+      for (size_t i = 0; i < 100; i++) {
+        frame();
+      }
+    });
+    REQUIRE(count == 0);
+  }
+}
+
+TEST_CASE("Batched insertions grow the particle storage geometrically") {
+  Simulator simulator(100, 100, 6);
+  Particle particle(1, 1, glm::vec2(50, 50), glm::vec2(0, 0));
+  simulator.AddParticle(particle);
+
+  /* A flow which adds more particles than it removes, one batch at a time */
+  size_t count = CountAllocations([&simulator, &particle] {
+    for (size_t i = 0; i < 1000; i++) {
+      simulator.QueueParticleInsertion(particle);
+      simulator.QueueParticleInsertion(particle);
+      simulator.QueueParticleRemoval(simulator.GetParticleHandle(0));
+      simulator.ApplyQueuedChanges();
+    }
+  });
+  REQUIRE(simulator.GetNumParticles() == 1001);
+  REQUIRE(count < 100);
+}
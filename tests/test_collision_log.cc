@@ -0,0 +1,193 @@
+#include <core/ensemble.h>
+
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <thread>
+
+using namespace idealgas;
+
+TEST_CASE("SPSC ring") {
+  SECTION("Capacity is rounded up to a power of two") {
+    SpscRing<int> ring(5);
+    REQUIRE(ring.GetCapacity() == 8);
+  }
+
+  SECTION("Values are popped in order until the ring is full") {
+    SpscRing<int> ring(4);
+    for (int i = 0; i < 4; i++) {
+      REQUIRE(ring.TryPush(i));
+    }
+    REQUIRE_FALSE(ring.TryPush(4));
+
+    std::vector<int> values;
+    REQUIRE(ring.PopAll(values) == 4);
+    REQUIRE(values == std::vector<int>({0, 1, 2, 3}));
+
+    /* Popping frees the slots */
+    REQUIRE(ring.TryPush(5));
+    REQUIRE(ring.PopAll(values) == 1);
+    REQUIRE(values.back() == 5);
+  }
+
+  SECTION("Values cross threads in order") {
+    SpscRing<size_t> ring(64);
+    const size_t kNumValues = 200000;
+    std::thread producer([&ring, kNumValues]() {
+      for (size_t i = 0; i < kNumValues;) {
+        if (ring.TryPush(i)) {
+          i++;
+        }
+      }
+    });
+
+    std::vector<size_t> values;
+    while (values.size() < kNumValues) {
+      ring.PopAll(values);
+    }
+    producer.join();
+
+    bool is_ordered = true;
+    for (size_t i = 0; i < values.size(); i++) {
+      is_ordered = is_ordered && values[i] == i;
+    }
+    REQUIRE(is_ordered);
+  }
+}
+
+TEST_CASE("Collision log") {
+  std::string path = "test_collision_log.bin";
+  std::remove(path.c_str());
+
+  SECTION("Collisions between pairs and with walls are logged") {
+    Simulator simulator(200, 100, 1);
+    simulator.AddParticle(Particle(1, 1, glm::dvec2(50, 50), glm::vec2(1, 0),
+                                   ci::Color("red")));
+    simulator.AddParticle(Particle(2, 4, glm::dvec2(52.5, 50),
+                                   glm::vec2(-1, 0), ci::Color("green")));
+    simulator.AddParticle(Particle(1, 1, glm::dvec2(199.5, 20),
+                                   glm::vec2(0.5, 0), ci::Color("red")));
+    {
+      CollisionLog log(path);
+      simulator.SetCollisionLog(&log.AddChannel(), 7);
+      simulator.Update();
+      simulator.Update();
+    }
+
+    std::vector<CollisionEvent> events = ReadCollisionLog(path);
+    REQUIRE(events.size() == 2);
+
+    const CollisionEvent& wall = events[0];
+    REQUIRE(wall.kind == CollisionKind::kWall);
+    REQUIRE(wall.step == 0);
+    REQUIRE(wall.particle1 == 2);
+    REQUIRE(wall.particle2 == kNoParticle);
+    REQUIRE(wall.relative_speed == Approx(0.5));
+    REQUIRE(wall.impulse == Approx(1));
+    REQUIRE(wall.source == 7);
+    REQUIRE(wall.species1 == CollisionSpecies::kSmall);
+
+    /* A head-on collision reverses the small particle's velocity, as the
+       large one is four times as heavy */
+    const CollisionEvent& pair = events[1];
+    REQUIRE(pair.kind == CollisionKind::kPair);
+    REQUIRE(pair.step == 0);
+    REQUIRE(pair.particle1 == 0);
+    REQUIRE(pair.particle2 == 1);
+    REQUIRE(pair.relative_speed == Approx(2));
+    REQUIRE(pair.impulse == Approx(3.2));
+    REQUIRE(pair.species1 == CollisionSpecies::kSmall);
+    REQUIRE(pair.species2 == CollisionSpecies::kOther);
+  }
+
+  SECTION("Events are either written or counted as dropped") {
+    const size_t kNumEvents = 100000;
+    std::unique_ptr<CollisionLog> log(new CollisionLog(path, 16));
+    CollisionLogChannel& channel = log->AddChannel();
+    CollisionEvent event = CollisionEvent();
+    for (size_t i = 0; i < kNumEvents; i++) {
+      event.step = i;
+      channel.Append(event);
+    }
+    uint64_t num_dropped = log->GetNumDropped();
+    REQUIRE(num_dropped == channel.GetNumDropped());
+    log.reset();
+
+    std::vector<CollisionEvent> events = ReadCollisionLog(path);
+    REQUIRE(events.size() + num_dropped == kNumEvents);
+    for (size_t i = 1; i < events.size(); i++) {
+      REQUIRE(events[i].step > events[i - 1].step);
+    }
+  }
+
+  SECTION("Ensemble members log to their own channels") {
+    ThreadPool pool(4);
+    Ensemble ensemble(1, 10);
+    for (uint32_t seed = 0; seed < 8; seed++) {
+      ensemble.AddMember({seed, 40, 20, 10});
+    }
+    {
+      CollisionLog log(path);
+      ensemble.SetCollisionLog(&log);
+      ensemble.Run(50, pool);
+      REQUIRE(log.GetNumDropped() == 0);
+    }
+
+    /* Every member logs the same pairs as when it is run alone */
+    std::vector<CollisionEvent> events = ReadCollisionLog(path);
+    for (uint32_t seed = 0; seed < 8; seed++) {
+      Simulator simulator(seed);
+      for (size_t i = 0; i < 40; i++) {
+        simulator.AddRandomSmallParticle();
+      }
+      for (size_t i = 0; i < 20; i++) {
+        simulator.AddRandomMediumParticle();
+      }
+      for (size_t i = 0; i < 10; i++) {
+        simulator.AddRandomLargeParticle();
+      }
+      for (size_t i = 0; i < 50; i++) {
+        simulator.Update();
+      }
+
+      size_t num_pairs = 0;
+      uint64_t last_step = 0;
+      for (const CollisionEvent& event : events) {
+        if (event.source != seed) {
+          continue;
+        }
+        REQUIRE(event.step >= last_step);
+        last_step = event.step;
+        if (event.kind == CollisionKind::kPair) {
+          num_pairs++;
+        }
+      }
+      REQUIRE(num_pairs == simulator.GetNumCollisions());
+    }
+  }
+
+  SECTION("Repeated ensemble runs reuse their channels") {
+    ThreadPool pool(4);
+    Ensemble ensemble(1, 10);
+    ensemble.AddMember({0, 10, 10, 10});
+    CollisionLog log(path);
+    ensemble.SetCollisionLog(&log);
+    ensemble.Run(5, pool);
+    size_t num_channels = log.GetNumChannels();
+    REQUIRE(num_channels == 5);
+
+    for (size_t run = 0; run < 10; run++) {
+      ensemble.Run(5, pool);
+    }
+    REQUIRE(log.GetNumChannels() == num_channels);
+  }
+
+  SECTION("Other files are not read as logs") {
+    {
+      std::ofstream file(path);
+      file << "step,particle\n";
+    }
+    REQUIRE_THROWS_AS(ReadCollisionLog(path), std::runtime_error);
+  }
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,43 @@
+#include <core/compensated_sum.h>
+
+#include <catch2/catch.hpp>
+
+using namespace idealgas;
+
+TEST_CASE("CompensatedSum") {
+  SECTION("Empty sum is zero") {
+    CompensatedSum sum;
+    REQUIRE(sum.GetSum() == 0);
+  }
+
+  SECTION("Small terms are not lost next to a large one") {
+    CompensatedSum sum;
+    double naive = 1e16;
+    sum.Add(1e16);
+    for (int i = 0; i < 1000; i++) {
+      sum.Add(1);
+      naive += 1;
+    }
+
+    /* Every 1 is rounded away from the naive sum */
+    REQUIRE(naive == 1e16);
+    REQUIRE(sum.GetSum() == 1e16 + 1000);
+  }
+
+  SECTION("Cancellation of large terms") {
+    CompensatedSum sum;
+    sum.Add(1);
+    sum.Add(1e100);
+    sum.Add(1);
+    sum.Add(-1e100);
+    REQUIRE(sum.GetSum() == 2);
+  }
+
+  SECTION("Many terms of a repeating decimal") {
+    CompensatedSum sum;
+    for (int i = 0; i < 1000000; i++) {
+      sum.Add(0.1);
+    }
+    REQUIRE(sum.GetSum() == 100000);
+  }
+}
@@ -0,0 +1,123 @@
+#include <visualizer/density_heatmap.h>
+
+#include <catch2/catch.hpp>
+#include <random>
+
+using namespace idealgas;
+
+namespace {
+
+const std::vector<ci::Color> kSpecies = {ci::Color("red"), ci::Color("blue"),
+                                         ci::Color(0, 0, 0)};
+
+}  // namespace
+
+TEST_CASE("DensityHeatmap") {
+  /* A 100x50 plane at 1 pixel per 10 units */
+  DensityHeatmap heatmap(10, 5, glm::dvec2(100, 50), kSpecies);
+  ThreadPool pool(4);
+
+  SECTION("Invalid heatmaps are rejected") {
+    REQUIRE_THROWS_AS(DensityHeatmap(0, 5, glm::dvec2(100, 50), kSpecies),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(
+        DensityHeatmap(10, 5, glm::dvec2(100, 50), std::vector<ci::Color>()),
+        std::invalid_argument);
+    REQUIRE_THROWS_AS(heatmap.SetSaturation(0), std::invalid_argument);
+  }
+
+  SECTION("Particles are counted in their pixel and species") {
+    std::vector<Particle> particles;
+    particles.push_back(Particle(1, 1, glm::dvec2(5, 45), glm::vec2(0, 0),
+                                 ci::Color("red")));
+    particles.push_back(Particle(1, 1, glm::dvec2(7, 42), glm::vec2(0, 0),
+                                 ci::Color("blue")));
+    particles.push_back(Particle(1, 1, glm::dvec2(95, 5), glm::vec2(0, 0),
+                                 ci::Color("green")));
+
+    heatmap.Build(particles, pool);
+
+    /* y is flipped, so the top left pixel holds the top left of the plane */
+    REQUIRE(heatmap.GetCount(0, 0, 0) == 1);
+    REQUIRE(heatmap.GetCount(0, 0, 1) == 1);
+    REQUIRE(heatmap.GetCount(0, 0, 2) == 0);
+
+    /* Other colors are counted as the last species */
+    REQUIRE(heatmap.GetCount(9, 4, 2) == 1);
+    REQUIRE(heatmap.GetCount(5, 2, 0) == 0);
+  }
+
+  SECTION("Particles on or past the edges are counted in the nearest pixel") {
+    std::vector<Particle> particles;
+    particles.push_back(Particle(1, 1, glm::dvec2(100, 0), glm::vec2(0, 0),
+                                 ci::Color("red")));
+    particles.push_back(Particle(1, 1, glm::dvec2(-3, 60), glm::vec2(0, 0),
+                                 ci::Color("red")));
+
+    heatmap.Build(particles, pool);
+
+    REQUIRE(heatmap.GetCount(9, 4, 0) == 1);
+    REQUIRE(heatmap.GetCount(0, 0, 0) == 1);
+  }
+
+  SECTION("Pixels mix their species' colors and saturate") {
+    heatmap.SetSaturation(4);
+    std::vector<Particle> particles;
+    particles.push_back(Particle(1, 1, glm::dvec2(5, 45), glm::vec2(0, 0),
+                                 ci::Color("red")));
+    particles.push_back(Particle(1, 1, glm::dvec2(5, 45), glm::vec2(0, 0),
+                                 ci::Color("blue")));
+    for (size_t i = 0; i < 5; i++) {
+      particles.push_back(Particle(1, 1, glm::dvec2(55, 25), glm::vec2(0, 0),
+                                   ci::Color("blue")));
+    }
+
+    heatmap.Build(particles, pool);
+    const std::vector<uint8_t>& pixels = heatmap.GetPixels();
+
+    REQUIRE(pixels.size() == 10 * 5 * 4);
+    REQUIRE(pixels[0] == 128);
+    REQUIRE(pixels[1] == 0);
+    REQUIRE(pixels[2] == 128);
+    REQUIRE(pixels[3] == 128);
+
+    size_t full = (2 * 10 + 5) * 4;
+    REQUIRE(pixels[full + 2] == 255);
+    REQUIRE(pixels[full + 3] == 255);
+
+    /* Empty pixels are transparent */
+    REQUIRE(pixels[4 + 3] == 0);
+  }
+
+  SECTION("Any number of workers counts the same particles") {
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> x(0, 100);
+    std::uniform_real_distribution<double> y(0, 50);
+    std::vector<Particle> particles;
+    for (size_t i = 0; i < 5000; i++) {
+      particles.push_back(Particle(1, 1, glm::dvec2(x(generator), y(generator)),
+                                   glm::vec2(0, 0), kSpecies[i % 3]));
+    }
+
+    ThreadPool serial_pool(1);
+    DensityHeatmap serial(10, 5, glm::dvec2(100, 50), kSpecies);
+    serial.Build(particles, serial_pool);
+    heatmap.Build(particles, pool);
+
+    /* Rebuilding reuses the counts, which must start over */
+    heatmap.Build(particles, pool);
+
+    uint32_t total = 0;
+    for (size_t y = 0; y < 5; y++) {
+      for (size_t x = 0; x < 10; x++) {
+        for (size_t species = 0; species < 3; species++) {
+          REQUIRE(heatmap.GetCount(x, y, species) ==
+                  serial.GetCount(x, y, species));
+          total += heatmap.GetCount(x, y, species);
+        }
+      }
+    }
+    REQUIRE(total == 5000);
+    REQUIRE(heatmap.GetPixels() == serial.GetPixels());
+  }
+}
@@ -0,0 +1,203 @@
+#include <core/domain_channel.h>
+#include <core/domain_simulator.h>
+
+#include <catch2/catch.hpp>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+using namespace idealgas;
+
+namespace {
+
+const double kPlaneWidth = 60;
+const double kPlaneHeight = 30;
+
+/**
+ * Runs a simulation divided among threads, which stand in for processes, and
+ * returns the particles of every strip
+ */
+std::vector<Particle> RunDomains(const std::vector<Particle>& particles,
+                                 size_t num_strips, size_t num_updates) {
+  std::vector<std::unique_ptr<SharedMemoryChannel>> creators;
+  std::vector<std::unique_ptr<SharedMemoryChannel>> openers;
+  for (size_t edge = 0; edge + 1 < num_strips; edge++) {
+    std::string name = "/ideal-gas-test-domain-" + std::to_string(edge);
+    /* A small capacity sends most messages in several parts */
+    creators.emplace_back(
+        new SharedMemoryChannel(SharedMemoryChannel::Create(name, 256, 10)));
+    openers.emplace_back(
+        new SharedMemoryChannel(SharedMemoryChannel::Open(name, 10)));
+  }
+
+  std::vector<std::vector<Particle>> results(num_strips);
+  std::vector<std::thread> threads;
+  for (size_t strip = 0; strip < num_strips; strip++) {
+    DomainChannel* left = strip > 0 ? openers[strip - 1].get() : nullptr;
+    DomainChannel* right =
+        strip + 1 < num_strips ? creators[strip].get() : nullptr;
+    threads.emplace_back([&, strip, left, right] {
+      DomainSimulator simulator(kPlaneWidth, kPlaneHeight, num_strips, strip,
+                                left, right);
+      for (const Particle& particle : particles) {
+        simulator.AddParticle(particle);
+      }
+      for (size_t update = 0; update < num_updates; update++) {
+        simulator.Update();
+      }
+      results[strip] = simulator.GetParticles();
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<Particle> all;
+  for (const std::vector<Particle>& result : results) {
+    all.insert(all.end(), result.begin(), result.end());
+  }
+  return all;
+}
+
+std::vector<Particle> RunSimulator(const std::vector<Particle>& particles,
+                                   size_t num_updates) {
+  Simulator simulator(kPlaneWidth, kPlaneHeight, 0);
+  for (const Particle& particle : particles) {
+    simulator.AddParticle(particle);
+  }
+  for (size_t update = 0; update < num_updates; update++) {
+    simulator.Update();
+  }
+  return simulator.GetParticles();
+}
+
+/** Checks that every particle of one run is in the other */
+void RequireSameParticles(const std::vector<Particle>& expected,
+                          const std::vector<Particle>& actual) {
+  REQUIRE(actual.size() == expected.size());
+  for (const Particle& particle : actual) {
+    bool is_matched = false;
+    for (const Particle& other : expected) {
+      is_matched |=
+          particle.GetPrecisePosition() == other.GetPrecisePosition() &&
+          particle.GetVelocity() == other.GetVelocity() &&
+          particle.GetRadius() == other.GetRadius();
+    }
+    REQUIRE(is_matched);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Shared memory channels") {
+  SharedMemoryChannel creator =
+      SharedMemoryChannel::Create("/ideal-gas-test-channel", 64, 10);
+  SharedMemoryChannel opener =
+      SharedMemoryChannel::Open("/ideal-gas-test-channel", 10);
+
+  SECTION("Messages arrive whole and in order") {
+    std::vector<std::vector<char>> messages = {
+        {'a', 'b', 'c'}, {}, std::vector<char>(1000, 'd'), {'e'}};
+    std::thread sender([&creator, &messages] {
+      for (const std::vector<char>& message : messages) {
+        creator.Send(message);
+      }
+    });
+    std::vector<char> received;
+    for (const std::vector<char>& message : messages) {
+      opener.Receive(received);
+      REQUIRE(received == message);
+    }
+    sender.join();
+  }
+
+  SECTION("Both ends send") {
+    std::vector<char> message(100, 'x');
+    std::vector<char> received;
+    opener.Send({'y'});
+    creator.Receive(received);
+    REQUIRE(received == std::vector<char>{'y'});
+
+    std::thread sender([&creator, &message] { creator.Send(message); });
+    opener.Receive(received);
+    sender.join();
+    REQUIRE(received == message);
+  }
+
+  SECTION("Waiting for a missing end times out") {
+    SharedMemoryChannel channel =
+        SharedMemoryChannel::Create("/ideal-gas-test-channel-alone", 64, 0.01);
+    std::vector<char> received;
+    REQUIRE_THROWS_AS(channel.Receive(received), std::runtime_error);
+  }
+
+  SECTION("Opening a missing channel throws") {
+    REQUIRE_THROWS_AS(SharedMemoryChannel::Open("/ideal-gas-test-missing"),
+                      std::runtime_error);
+  }
+}
+
+TEST_CASE("Domain decomposition") {
+  SECTION("Strips must exist and have matching channels") {
+    SharedMemoryChannel channel =
+        SharedMemoryChannel::Create("/ideal-gas-test-domain-arguments");
+    REQUIRE_THROWS_AS(DomainSimulator(60, 30, 2, 2, &channel, nullptr),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(DomainSimulator(60, 30, 2, 0, nullptr, nullptr),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(DomainSimulator(60, 30, 2, 0, &channel, &channel),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(DomainSimulator(4, 30, 2, 0, nullptr, &channel),
+                      std::invalid_argument);
+  }
+
+  SECTION("Each process keeps the particles of its strip") {
+    SharedMemoryChannel channel =
+        SharedMemoryChannel::Create("/ideal-gas-test-domain-strip");
+    DomainSimulator simulator(60, 30, 2, 0, nullptr, &channel);
+    REQUIRE(simulator.AddParticle(Particle(1, 1, glm::dvec2(29, 5),
+                                           glm::vec2(0, 0))));
+    REQUIRE_FALSE(simulator.AddParticle(Particle(1, 1, glm::dvec2(30, 5),
+                                                 glm::vec2(0, 0))));
+    REQUIRE(simulator.GetParticles().size() == 1);
+    REQUIRE_THROWS_AS(simulator.AddParticle(Particle(
+                          5, 1, glm::dvec2(10, 5), glm::vec2(0, 0))),
+                      std::invalid_argument);
+  }
+
+  SECTION("A collision across an edge matches one process") {
+    std::vector<Particle> particles = {
+        Particle(1, 1, glm::dvec2(27.5, 15), glm::vec2(0.5, 0.125)),
+        Particle(1.5, 4, glm::dvec2(32.5, 15.25), glm::vec2(-0.5, 0))};
+    RequireSameParticles(RunSimulator(particles, 20),
+                         RunDomains(particles, 2, 20));
+  }
+
+  SECTION("Particles migrate between strips") {
+    std::vector<Particle> particles = {
+        Particle(1, 1, glm::dvec2(5, 10), glm::vec2(0.5, 0.25)),
+        Particle(1, 1, glm::dvec2(55, 20), glm::vec2(-1, 0))};
+    std::vector<Particle> expected = RunSimulator(particles, 150);
+    RequireSameParticles(expected, RunDomains(particles, 3, 150));
+  }
+
+  SECTION("A gas matches one process") {
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<double> x(2, kPlaneWidth - 2);
+    std::uniform_real_distribution<double> y(2, kPlaneHeight - 2);
+    std::uniform_real_distribution<float> velocity(-0.5, 0.5);
+    std::vector<Particle> particles;
+    for (size_t i = 0; i < 200; i++) {
+      double radius = i % 2 == 0 ? 1 : 1.5;
+      double mass = i % 2 == 0 ? 1 : 4;
+      particles.emplace_back(radius, mass,
+                             glm::dvec2(x(generator), y(generator)),
+                             glm::vec2(velocity(generator),
+                                       velocity(generator)));
+    }
+
+    RequireSameParticles(RunSimulator(particles, 200),
+                         RunDomains(particles, 3, 200));
+  }
+}
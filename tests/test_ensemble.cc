@@ -0,0 +1,71 @@
+#include <core/ensemble.h>
+
+#include <catch2/catch.hpp>
+
+using namespace idealgas;
+
+TEST_CASE("Ensemble Run() functionality") {
+  ThreadPool pool(4);
+  Ensemble ensemble(1, 20);
+
+  SECTION("Empty ensemble") {
+    EnsembleResult result = ensemble.Run(10, pool);
+    REQUIRE(result.num_members == 0);
+    REQUIRE(result.kinetic_energy == 0);
+    REQUIRE(result.small_speed_frequencies.size() == 20);
+  }
+
+  SECTION("Histograms average the number of particles of each size") {
+    for (uint32_t seed = 0; seed < 16; seed++) {
+      ensemble.AddMember({seed, 5, 3, 2});
+    }
+    EnsembleResult result = ensemble.Run(10, pool);
+
+    double small = 0;
+    double medium = 0;
+    double large = 0;
+    for (size_t i = 0; i < 20; i++) {
+      small += result.small_speed_frequencies[i];
+      medium += result.medium_speed_frequencies[i];
+      large += result.large_speed_frequencies[i];
+    }
+    REQUIRE(result.num_members == 16);
+    REQUIRE(small == Approx(5));
+    REQUIRE(medium == Approx(3));
+    REQUIRE(large == Approx(2));
+    REQUIRE(result.num_steps == Approx(10));
+  }
+
+  SECTION("Results match running the members one at a time") {
+    ensemble.AddMember({1, 10, 0, 0});
+    ensemble.AddMember({2, 0, 10, 0});
+    EnsembleResult result = ensemble.Run(50, pool);
+
+    double energy = 0;
+    for (const EnsembleMember& member : ensemble.GetMembers()) {
+      Simulator simulator(member.seed);
+      for (size_t i = 0; i < member.num_small; i++) {
+        simulator.AddRandomSmallParticle();
+      }
+      for (size_t i = 0; i < member.num_medium; i++) {
+        simulator.AddRandomMediumParticle();
+      }
+      for (size_t i = 0; i < 50; i++) {
+        simulator.Update();
+      }
+      energy += simulator.GetKineticEnergy();
+    }
+
+    REQUIRE(result.kinetic_energy == Approx(energy / 2));
+  }
+
+  SECTION("Members stop once the stop condition is met") {
+    ensemble.AddMember({1, 1, 0, 0});
+    ensemble.AddMember({2, 1, 0, 0});
+    EnsembleResult result = ensemble.Run(
+        100, pool,
+        [](const Simulator& simulator, size_t step) { return step == 7; });
+
+    REQUIRE(result.num_steps == Approx(7));
+  }
+}
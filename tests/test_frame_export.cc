@@ -0,0 +1,225 @@
+#include <visualizer/frame_exporter.h>
+
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+using namespace idealgas;
+
+namespace {
+
+std::vector<uint8_t> ReadBytes(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                              std::istreambuf_iterator<char>());
+}
+
+const uint8_t* GetPixel(const RgbImage& image, size_t x, size_t y) {
+  return &image.pixels[(y * image.width + x) * 3];
+}
+
+uint32_t ReadBigEndian(const uint8_t* bytes) {
+  return static_cast<uint32_t>(bytes[0]) << 24 | bytes[1] << 16 |
+         bytes[2] << 8 | bytes[3];
+}
+
+void AddParticles(Simulator& simulator) {
+  for (size_t i = 0; i < 5; i++) {
+    simulator.AddRandomSmallParticle();
+    simulator.AddRandomMediumParticle();
+    simulator.AddRandomLargeParticle();
+  }
+}
+
+}  // namespace
+
+TEST_CASE("FrameRasterizer") {
+  /* A 100x100 plane in a 160 pixel box with its corner at (20, 20) */
+  Simulator simulator(1);
+  FrameRasterizer rasterizer(simulator, 200);
+  FrameSnapshot snapshot;
+  RgbImage image;
+
+  SECTION("Frames follow the app's proportions") {
+    REQUIRE(rasterizer.GetWidth() == 300);
+    REQUIRE(rasterizer.GetHeight() == 200);
+    REQUIRE_THROWS_AS(FrameRasterizer(simulator, 5), std::invalid_argument);
+  }
+
+  SECTION("The background and box are drawn") {
+    rasterizer.TakeSnapshot(simulator, snapshot);
+    rasterizer.Render(snapshot, image);
+
+    REQUIRE(image.width == 300);
+    REQUIRE(image.pixels.size() == 300 * 200 * 3);
+    REQUIRE(GetPixel(image, 5, 5)[1] == 246);
+    REQUIRE(GetPixel(image, 100, 100)[1] == 255);
+    REQUIRE(GetPixel(image, 19, 100)[1] == 0);
+  }
+
+  SECTION("Particles are drawn as outlined discs") {
+    simulator.AddParticle(Particle(5, 4, glm::dvec2(50, 50), glm::vec2(0, 0),
+                                   ci::Color("green")));
+    rasterizer.TakeSnapshot(simulator, snapshot);
+    rasterizer.Render(snapshot, image);
+
+    const uint8_t* center = GetPixel(image, 100, 100);
+    REQUIRE(center[0] == 0);
+    REQUIRE(center[1] == 255);
+    const uint8_t* edge = GetPixel(image, 100, 107);
+    REQUIRE(edge[1] == 0);
+    REQUIRE(GetPixel(image, 100, 110)[1] == 255);
+  }
+
+  SECTION("Histogram bars are drawn from the snapshot's speeds") {
+    simulator.AddParticle(Particle(1, 1, glm::dvec2(50, 50),
+                                   glm::vec2(0.01, 0), ci::Color("red")));
+    rasterizer.TakeSnapshot(simulator, snapshot);
+
+    /* The snapshot is independent of the simulator */
+    simulator.Reset();
+    rasterizer.Render(snapshot, image);
+
+    /* The first bar of the first histogram, at (200, 20), is 1/15 of its
+       40 pixel height */
+    const uint8_t* bar = GetPixel(image, 202, 58);
+    REQUIRE(bar[0] == 255);
+    REQUIRE(bar[1] == 0);
+    REQUIRE(GetPixel(image, 202, 55)[1] == 255);
+    REQUIRE(GetPixel(image, 222, 58)[1] == 255);
+  }
+}
+
+TEST_CASE("Frame encoders") {
+  RgbImage image;
+  image.width = 200;
+  image.height = 200;
+  image.pixels.assign(200 * 200 * 3, 255);
+  image.pixels[0] = image.pixels[1] = image.pixels[2] = 0;
+  std::vector<uint8_t> output;
+
+  SECTION("Y4M frames are planar studio range YCbCr") {
+    REQUIRE(GetY4mHeader(300, 200, 60) ==
+            "YUV4MPEG2 W300 H200 F60:1 Ip A1:1 C444\n");
+
+    EncodeY4mFrame(image, output);
+    REQUIRE(output.size() == 6 + 3 * 200 * 200);
+    REQUIRE(std::string(output.begin(), output.begin() + 6) == "FRAME\n");
+
+    size_t plane_size = 200 * 200;
+    REQUIRE(output[6] == 16);
+    REQUIRE(output[7] == 235);
+    REQUIRE(output[6 + plane_size] == 128);
+    REQUIRE(output[6 + 2 * plane_size + 1] == 128);
+  }
+
+  SECTION("PNG files store the rows in checked chunks") {
+    EncodePng(image, output);
+
+    REQUIRE(output[0] == 0x89);
+    REQUIRE(std::string(output.begin() + 1, output.begin() + 4) == "PNG");
+    REQUIRE(ReadBigEndian(&output[8]) == 13);
+    REQUIRE(std::string(output.begin() + 12, output.begin() + 16) == "IHDR");
+    REQUIRE(ReadBigEndian(&output[16]) == 200);
+    REQUIRE(ReadBigEndian(&output[20]) == 200);
+
+    /* Every IEND chunk has the same CRC */
+    std::vector<uint8_t> iend(output.end() - 12, output.end());
+    REQUIRE(std::string(iend.begin() + 4, iend.begin() + 8) == "IEND");
+    REQUIRE(ReadBigEndian(&iend[8]) == 0xAE426082);
+
+    /* Unpack the stored deflate blocks of the IDAT chunk */
+    size_t idat = 8 + 25;
+    REQUIRE(std::string(output.begin() + idat + 4,
+                        output.begin() + idat + 8) == "IDAT");
+    size_t position = idat + 10;
+    std::vector<uint8_t> raw;
+    bool is_final = false;
+    while (!is_final) {
+      is_final = output[position] == 1;
+      size_t size = output[position + 1] | output[position + 2] << 8;
+      size_t inverted_size = output[position + 3] | output[position + 4] << 8;
+      REQUIRE(inverted_size == (~size & 0xFFFF));
+      raw.insert(raw.end(), output.begin() + position + 5,
+                 output.begin() + position + 5 + size);
+      position += 5 + size;
+    }
+
+    REQUIRE(raw.size() == 200 * (1 + 200 * 3));
+    REQUIRE(raw[0] == 0);
+    REQUIRE(raw[1] == 0);
+    REQUIRE(raw[4] == 255);
+    REQUIRE(raw[601] == 0);
+    REQUIRE(raw[602] == 255);
+
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (uint8_t byte : raw) {
+      a = (a + byte) % 65521;
+      b = (b + a) % 65521;
+    }
+    REQUIRE(ReadBigEndian(&output[position]) == (b << 16 | a));
+  }
+}
+
+TEST_CASE("FrameExporter") {
+  Simulator simulator(1);
+  AddParticles(simulator);
+  FrameRasterizer rasterizer(simulator, 40);
+  ThreadPool pool(3);
+
+  /* The same run rendered one frame at a time */
+  Simulator reference(1);
+  AddParticles(reference);
+  FrameRasterizer reference_rasterizer(reference, 40);
+  FrameSnapshot snapshot;
+  RgbImage image;
+  std::vector<std::vector<uint8_t>> frames;
+  for (size_t frame = 0; frame < 10; frame++) {
+    if (frame > 0) {
+      for (size_t step = 0; step < 3; step++) {
+        reference.Update();
+      }
+    }
+    reference_rasterizer.TakeSnapshot(reference, snapshot);
+    reference_rasterizer.Render(snapshot, image);
+    frames.push_back(std::vector<uint8_t>());
+    EncodeY4mFrame(image, frames.back());
+  }
+
+  SECTION("Y4M streams hold every frame in order") {
+    std::string path = "test_export.y4m";
+    FrameExporter exporter(rasterizer, ExportFormat::kY4m, path, 30);
+    exporter.Run(simulator, 10, 3, pool);
+
+    std::vector<uint8_t> expected;
+    std::string header = GetY4mHeader(60, 40, 30);
+    expected.insert(expected.end(), header.begin(), header.end());
+    for (const std::vector<uint8_t>& frame : frames) {
+      expected.insert(expected.end(), frame.begin(), frame.end());
+    }
+    REQUIRE(ReadBytes(path) == expected);
+    std::remove(path.c_str());
+  }
+
+  SECTION("PNG sequences write a file per frame") {
+    FrameExporter exporter(rasterizer, ExportFormat::kPng, "test_export_");
+    exporter.Run(simulator, 3, 1, pool);
+
+    REQUIRE(exporter.GetPngPath(2) == "test_export_000002.png");
+    for (size_t frame = 0; frame < 3; frame++) {
+      std::vector<uint8_t> file = ReadBytes(exporter.GetPngPath(frame));
+      REQUIRE(file.size() > 60 * 40 * 3);
+      REQUIRE(file[1] == 'P');
+      std::remove(exporter.GetPngPath(frame).c_str());
+    }
+  }
+
+  SECTION("Unwritable outputs are reported") {
+    FrameExporter exporter(rasterizer, ExportFormat::kY4m,
+                           "missing_directory/test_export.y4m");
+    REQUIRE_THROWS_AS(exporter.Run(simulator, 10, 1, pool),
+                      std::runtime_error);
+  }
+}
@@ -0,0 +1,122 @@
+#include <core/frame_feed.h>
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <thread>
+
+using namespace idealgas;
+
+TEST_CASE("Frame feed") {
+  const std::string kName = "/ideal-gas-test-feed";
+  Simulator simulator(200, 100, 1);
+  FeedFrame frame;
+
+  SECTION("Readers cannot attach before the feed is published") {
+    REQUIRE_THROWS_AS(FrameReader(kName), std::runtime_error);
+  }
+
+  SECTION("Frames are read as they were published") {
+    /* Species go by radius and mass, whatever the color */
+    simulator.AddParticle(Particle(1, 1, glm::dvec2(10.25, 20.5),
+                                   glm::vec2(0.5, -0.25), ci::Color(1, 0, 1)));
+    simulator.AddParticle(Particle(3, 7, glm::dvec2(150, 75),
+                                   glm::vec2(0, 1), simulator.kLargeColor));
+    FramePublisher publisher(kName, simulator, 10);
+    FrameReader reader(kName);
+
+    REQUIRE(reader.GetPlaneWidth() == 200);
+    REQUIRE(reader.GetPlaneHeight() == 100);
+    REQUIRE_FALSE(reader.ReadLatest(frame));
+
+    publisher.Publish(simulator);
+    REQUIRE(reader.ReadLatest(frame));
+    REQUIRE(frame.frame_number == 0);
+    REQUIRE(frame.particles.size() == 2);
+
+    const FeedParticle& small = frame.particles[0];
+    REQUIRE(small.position == glm::dvec2(10.25, 20.5));
+    REQUIRE(small.velocity == glm::vec2(0.5, -0.25));
+    REQUIRE(small.radius == 1);
+    REQUIRE(small.mass == 1);
+    REQUIRE(small.species == FeedSpecies::kSmall);
+    REQUIRE(small.color == ci::Color(1, 0, 1));
+
+    const FeedParticle& other = frame.particles[1];
+    REQUIRE(other.radius == 3);
+    REQUIRE(other.mass == 7);
+    REQUIRE(other.species == FeedSpecies::kOther);
+    REQUIRE(other.color == simulator.kLargeColor);
+
+    /* Each frame is only read once */
+    REQUIRE_FALSE(reader.ReadLatest(frame));
+  }
+
+  SECTION("Slow readers skip to the newest frame") {
+    simulator.AddRandomSmallParticle();
+    FramePublisher publisher(kName, simulator, 10, 3);
+    FrameReader reader(kName);
+
+    publisher.Publish(simulator);
+    REQUIRE(reader.ReadLatest(frame));
+    for (size_t i = 0; i < 10; i++) {
+      publisher.Publish(simulator);
+    }
+    REQUIRE(reader.ReadLatest(frame));
+    REQUIRE(frame.frame_number == 10);
+    REQUIRE(reader.GetNumSkippedFrames() == 9);
+  }
+
+  SECTION("Frames with too many particles are rejected") {
+    FramePublisher publisher(kName, simulator, 1);
+    simulator.AddRandomSmallParticle();
+    simulator.AddRandomSmallParticle();
+    REQUIRE_THROWS_AS(publisher.Publish(simulator), std::invalid_argument);
+  }
+
+  SECTION("Readers see when the publisher closes the feed") {
+    std::unique_ptr<FramePublisher> publisher(
+        new FramePublisher(kName, simulator, 10));
+    FrameReader reader(kName);
+    REQUIRE_FALSE(reader.IsClosed());
+
+    publisher.reset();
+    REQUIRE(reader.IsClosed());
+    REQUIRE_THROWS_AS(FrameReader(kName), std::runtime_error);
+  }
+
+  SECTION("Readers never see a frame the publisher is writing") {
+    /* Every particle of frame n is at x = n, so a torn frame has particles
+       from different frames */
+    const size_t kNumParticles = 500;
+    FramePublisher publisher(kName, simulator, kNumParticles, 2);
+    FrameReader reader(kName);
+
+    std::atomic<bool> is_done(false);
+    std::thread writer([&] {
+      for (size_t n = 0; n < 2000; n++) {
+        simulator.Reset();
+        for (size_t i = 0; i < kNumParticles; i++) {
+          simulator.AddParticle(Particle(1, 1, glm::dvec2(n, 50),
+                                         glm::vec2(0, 0), ci::Color("red")));
+        }
+        publisher.Publish(simulator);
+      }
+      is_done = true;
+    });
+
+    size_t num_read = 0;
+    bool is_consistent = true;
+    while (!is_done) {
+      if (reader.ReadLatest(frame)) {
+        num_read++;
+        for (const FeedParticle& particle : frame.particles) {
+          is_consistent &= particle.position.x == frame.frame_number;
+        }
+      }
+    }
+    writer.join();
+
+    REQUIRE(is_consistent);
+    REQUIRE(num_read > 0);
+  }
+}
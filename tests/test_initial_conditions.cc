@@ -0,0 +1,186 @@
+#include <core/initial_conditions.h>
+
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace idealgas;
+
+namespace {
+
+void WriteFile(const std::string& path, const std::string& contents) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file << contents;
+}
+
+}  // namespace
+
+TEST_CASE("Loading particles from CSV files") {
+  std::string path = "test_initial_conditions.csv";
+  ThreadPool pool(4);
+  Simulator simulator(1);
+
+  SECTION("Rows are read with their species") {
+    WriteFile(path,
+              "x,y,vx,vy,species\n"
+              "10.25, 20.5, 0.5, -0.25, small\r\n"
+              "\n"
+              "1e1,2.5E-1,-1,+0.125,large");
+    LoadCsvParticles(path, simulator, pool);
+
+    const std::vector<Particle>& particles = simulator.GetParticles();
+    REQUIRE(particles.size() == 2);
+    REQUIRE(particles[0].GetPrecisePosition() == glm::dvec2(10.25, 20.5));
+    REQUIRE(particles[0].GetVelocity() == glm::vec2(0.5, -0.25));
+    REQUIRE(particles[0].GetRadius() == simulator.kSmallRadius);
+    REQUIRE(particles[0].GetColor() == simulator.kSmallColor);
+    REQUIRE(particles[1].GetPrecisePosition() == glm::dvec2(10, 0.25));
+    REQUIRE(particles[1].GetVelocity() == glm::vec2(-1, 0.125));
+    REQUIRE(particles[1].GetMass() == simulator.kLargeMass);
+  }
+
+  SECTION("Large files are read in order and rounded like strtod") {
+    std::stringstream contents;
+    contents.precision(17);
+    std::vector<std::string> numbers;
+    const size_t kNumRows = 20000;
+    for (size_t i = 0; i < kNumRows; i++) {
+      contents << i * 0.001 + 0.1 << ',' << 1.0 / (i + 3) << ",0.3,"
+               << "12345678901234567890e-21,"
+               << (i % 3 == 0 ? "small" : i % 3 == 1 ? "medium" : "large")
+               << '\n';
+    }
+    WriteFile(path, contents.str());
+    simulator.AddRandomSmallParticle();
+    LoadCsvParticles(path, simulator, pool);
+
+    const std::vector<Particle>& particles = simulator.GetParticles();
+    REQUIRE(particles.size() == kNumRows + 1);
+
+    bool is_exact = true;
+    bool is_ordered = true;
+    std::stringstream expected;
+    expected.precision(17);
+    for (size_t i = 0; i < kNumRows; i++) {
+      const Particle& particle = particles[i + 1];
+      expected.str("");
+      expected.clear();
+      expected << i * 0.001 + 0.1 << ' ' << 1.0 / (i + 3);
+      double x;
+      double y;
+      expected >> x >> y;
+      is_ordered = is_ordered && particle.GetPrecisePosition().x == x;
+      is_exact = is_exact && particle.GetPrecisePosition().y == y &&
+                 particle.GetVelocity().x == 0.3f &&
+                 particle.GetVelocity().y ==
+                     static_cast<float>(std::strtod(
+                         "12345678901234567890e-21", nullptr));
+    }
+    REQUIRE(is_ordered);
+    REQUIRE(is_exact);
+    REQUIRE(particles[2].GetMass() == simulator.kMediumMass);
+  }
+
+  SECTION("Malformed rows are reported with their line") {
+    WriteFile(path, "1,2,3,4,small\n1,2,3,4,huge\n");
+    REQUIRE_THROWS_WITH(LoadCsvParticles(path, simulator, pool),
+                        Catch::Contains(path + ":2: species"));
+    REQUIRE(simulator.GetNumParticles() == 0);
+
+    WriteFile(path, "1,2,3,4,small\n\n1,2,3,small\n");
+    REQUIRE_THROWS_WITH(LoadCsvParticles(path, simulator, pool),
+                        Catch::Contains(":3: expected a number"));
+
+    WriteFile(path, "1,2,3,4,small,5\n");
+    REQUIRE_THROWS_WITH(LoadCsvParticles(path, simulator, pool),
+                        Catch::Contains(":1: expected 5 columns"));
+  }
+
+  SECTION("The first malformed row is reported whichever chunk fails first") {
+    /* The first chunk's error is at its end, so the other chunks reach
+       theirs sooner */
+    const size_t kNumRows = 20000;
+    std::string contents;
+    for (size_t i = 1; i <= kNumRows; i++) {
+      contents += i == kNumRows / 5 || i > kNumRows / 2 ? "1,2,3,4,huge\n"
+                                                          : "1,2,3,4,small\n";
+    }
+    WriteFile(path, contents);
+
+    for (size_t run = 0; run < 10; run++) {
+      REQUIRE_THROWS_WITH(
+          LoadCsvParticles(path, simulator, pool),
+          Catch::Contains(":" + std::to_string(kNumRows / 5) + ": species"));
+    }
+  }
+
+  SECTION("Missing files cannot be loaded") {
+    REQUIRE_THROWS_AS(
+        LoadCsvParticles("no_such_file.csv", simulator, pool),
+        std::runtime_error);
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Binary particle files") {
+  std::string path = "test_initial_conditions.bin";
+  Simulator simulator(3);
+  for (size_t i = 0; i < 50; i++) {
+    simulator.AddRandomSmallParticle();
+    simulator.AddRandomMediumParticle();
+    simulator.AddRandomLargeParticle();
+  }
+
+  SECTION("Particles are loaded as they were saved") {
+    SaveBinaryParticles(path, simulator);
+    Simulator loaded(3);
+    LoadBinaryParticles(path, loaded);
+
+    REQUIRE(loaded.GetNumParticles() == simulator.GetNumParticles());
+    for (size_t i = 0; i < simulator.GetNumParticles(); i++) {
+      const Particle& expected = simulator.GetParticles()[i];
+      const Particle& particle = loaded.GetParticles()[i];
+      REQUIRE(particle.GetPrecisePosition() == expected.GetPrecisePosition());
+      REQUIRE(particle.GetVelocity() == expected.GetVelocity());
+      REQUIRE(particle.GetRadius() == expected.GetRadius());
+      REQUIRE(particle.GetMass() == expected.GetMass());
+      REQUIRE(particle.GetColor() == expected.GetColor());
+    }
+  }
+
+  SECTION("Only particles of the three species can be saved") {
+    simulator.AddParticle(Particle(5, 5, glm::dvec2(50, 50), glm::vec2(0, 0),
+                                   ci::Color("white")));
+    REQUIRE_THROWS_AS(SaveBinaryParticles(path, simulator),
+                      std::invalid_argument);
+  }
+
+  SECTION("Malformed files are rejected") {
+    SaveBinaryParticles(path, simulator);
+    std::ifstream input(path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(input)),
+                         std::istreambuf_iterator<char>());
+    input.close();
+    Simulator loaded(3);
+
+    WriteFile(path, contents.substr(0, contents.size() - 1));
+    REQUIRE_THROWS_WITH(LoadBinaryParticles(path, loaded),
+                        Catch::Contains("does not hold 150 particles"));
+
+    std::string unknown_species = contents;
+    unknown_species.back() = 7;
+    WriteFile(path, unknown_species);
+    REQUIRE_THROWS_WITH(LoadBinaryParticles(path, loaded),
+                        Catch::Contains("unknown species 7"));
+
+    WriteFile(path, "x,y,vx,vy,species\n");
+    REQUIRE_THROWS_WITH(LoadBinaryParticles(path, loaded),
+                        Catch::Contains("not a particle file"));
+    REQUIRE(loaded.GetNumParticles() == 0);
+  }
+
+  std::remove(path.c_str());
+}
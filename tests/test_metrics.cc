@@ -0,0 +1,188 @@
+#include <core/metrics_server.h>
+
+#include <catch2/catch.hpp>
+#include <thread>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace idealgas;
+
+namespace {
+
+struct Pair {
+  uint64_t first;
+  uint64_t second;
+  double third;
+};
+
+#ifndef _WIN32
+/** Sends a request to a local port and returns the whole response */
+std::string Fetch(uint16_t port, const std::string& request) {
+  int connection = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = sockaddr_in();
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  REQUIRE(connect(connection, reinterpret_cast<sockaddr*>(&address),
+                  sizeof(address)) == 0);
+  REQUIRE(send(connection, request.data(), request.size(), 0) ==
+          static_cast<ssize_t>(request.size()));
+
+  std::string response;
+  char buffer[512];
+  ssize_t result;
+  while ((result = recv(connection, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, static_cast<size_t>(result));
+  }
+  close(connection);
+  return response;
+}
+#endif
+
+}  // namespace
+
+TEST_CASE("Seqlock") {
+  SECTION("Values start out zeroed") {
+    SeqLock<Pair> lock;
+    Pair value = lock.Load();
+    REQUIRE(value.first == 0);
+    REQUIRE(value.second == 0);
+    REQUIRE(value.third == 0);
+  }
+
+  SECTION("The last value stored is loaded") {
+    SeqLock<Pair> lock;
+    lock.Store({1, 2, 0.5});
+    lock.Store({3, 4, 1.5});
+    Pair value = lock.Load();
+    REQUIRE(value.first == 3);
+    REQUIRE(value.second == 4);
+    REQUIRE(value.third == 1.5);
+  }
+
+  SECTION("Readers never see a value which is partly stored") {
+    SeqLock<Pair> lock;
+    const uint64_t kNumStores = 100000;
+    std::thread writer([&lock, kNumStores]() {
+      for (uint64_t i = 1; i <= kNumStores; i++) {
+        lock.Store({i, i * 3, static_cast<double>(i) / 2});
+      }
+    });
+
+    bool is_consistent = true;
+    uint64_t last = 0;
+    while (last < kNumStores) {
+      Pair value = lock.Load();
+      if (value.second != value.first * 3 ||
+          value.third != static_cast<double>(value.first) / 2 ||
+          value.first < last) {
+        is_consistent = false;
+      }
+      last = value.first;
+    }
+    writer.join();
+    REQUIRE(is_consistent);
+  }
+}
+
+TEST_CASE("Metrics recorder") {
+  Simulator simulator(200, 100, 1);
+  simulator.AddParticle(Particle(1, 1, glm::dvec2(50, 50), glm::vec2(1, 0),
+                                 simulator.kSmallColor));
+  /* Species go by radius and mass, whatever the color */
+  simulator.AddParticle(Particle(1, 1, glm::dvec2(51.5, 50),
+                                 glm::vec2(-1, 0)));
+  simulator.AddParticle(Particle(1.25, 2, glm::dvec2(150, 20),
+                                 glm::vec2(0, 1), ci::Color(1, 0.5, 0)));
+  simulator.AddParticle(Particle(3, 3, glm::dvec2(150, 80), glm::vec2(1, 1),
+                                 simulator.kLargeColor));
+
+  SECTION("Nothing is published before the first record") {
+    MetricsRecorder recorder;
+    MetricsSnapshot snapshot = recorder.GetSnapshot();
+    REQUIRE(snapshot.num_steps == 0);
+    REQUIRE(snapshot.kinetic_energy == 0);
+  }
+
+  SECTION("Snapshots count updates, collisions and species") {
+    MetricsRecorder recorder(0);
+    recorder.Record(simulator);
+    double initial_energy = simulator.GetKineticEnergy();
+    for (size_t i = 0; i < 5; i++) {
+      simulator.Update();
+    }
+    recorder.Record(simulator);
+
+    MetricsSnapshot snapshot = recorder.GetSnapshot();
+    REQUIRE(snapshot.num_steps == 5);
+    REQUIRE(snapshot.num_collisions == 1);
+    REQUIRE(snapshot.collisions_per_step == Approx(0.2));
+    REQUIRE(snapshot.steps_per_second > 0);
+    REQUIRE(snapshot.kinetic_energy == Approx(initial_energy));
+    REQUIRE(snapshot.energy_drift == Approx(0).margin(1e-9));
+    REQUIRE(snapshot.num_small == 2);
+    REQUIRE(snapshot.num_medium == 1);
+    REQUIRE(snapshot.num_large == 0);
+    REQUIRE(snapshot.num_other == 1);
+  }
+
+  SECTION("Snapshots are only taken once the interval passes") {
+    MetricsRecorder recorder(3600);
+    recorder.Record(simulator);
+    simulator.Update();
+    recorder.Record(simulator);
+    REQUIRE(recorder.GetSnapshot().num_steps == 0);
+  }
+
+  SECTION("Snapshots are formatted for Prometheus") {
+    MetricsSnapshot snapshot = MetricsSnapshot();
+    snapshot.num_steps = 12;
+    snapshot.num_collisions = 3;
+    snapshot.kinetic_energy = 2.5;
+    snapshot.num_medium = 7;
+    std::string text = FormatPrometheus(snapshot);
+
+    REQUIRE(text.find("# TYPE idealgas_steps_total counter\n"
+                      "idealgas_steps_total 12\n") != std::string::npos);
+    REQUIRE(text.find("idealgas_collisions_total 3\n") != std::string::npos);
+    REQUIRE(text.find("# TYPE idealgas_kinetic_energy gauge\n"
+                      "idealgas_kinetic_energy 2.5\n") != std::string::npos);
+    REQUIRE(text.find("idealgas_particles{species=\"medium\"} 7\n") !=
+            std::string::npos);
+  }
+}
+
+#ifndef _WIN32
+TEST_CASE("Metrics server") {
+  Simulator simulator(1);
+  simulator.AddRandomLargeParticle();
+  MetricsRecorder recorder;
+  recorder.Record(simulator);
+  MetricsServer server(recorder, 0);
+  REQUIRE(server.GetPort() != 0);
+
+  SECTION("Metrics are served at /metrics") {
+    std::string response =
+        Fetch(server.GetPort(), "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n");
+    REQUIRE(response.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+    REQUIRE(response.find("idealgas_particles{species=\"large\"} 1\n") !=
+            std::string::npos);
+  }
+
+  SECTION("Other paths are not found") {
+    std::string response =
+        Fetch(server.GetPort(), "GET / HTTP/1.1\r\n\r\n");
+    REQUIRE(response.compare(0, 22, "HTTP/1.1 404 Not Found") == 0);
+  }
+
+  SECTION("Ports in use cannot be listened on") {
+    REQUIRE_THROWS_AS(MetricsServer(recorder, server.GetPort()),
+                      std::runtime_error);
+  }
+}
+#endif
@@ -0,0 +1,87 @@
+#include <core/morton_order.h>
+
+#include <catch2/catch.hpp>
+
+using namespace idealgas;
+
+TEST_CASE("EncodeMorton() functionality") {
+  SECTION("Origin") {
+    REQUIRE(EncodeMorton(0, 0) == 0);
+  }
+
+  SECTION("Bits of x and y are interleaved") {
+    REQUIRE(EncodeMorton(1, 0) == 1);
+    REQUIRE(EncodeMorton(0, 1) == 2);
+    REQUIRE(EncodeMorton(3, 3) == 15);
+    REQUIRE(EncodeMorton(0xffff, 0) == 0x55555555);
+    REQUIRE(EncodeMorton(0, 0xffff) == 0xaaaaaaaa);
+  }
+
+  SECTION("Only the lower 16 bits are used") {
+    REQUIRE(EncodeMorton(0x10001, 0x10000) == 1);
+  }
+
+  SECTION("Bits of x, y, and z are interleaved in 3D") {
+    REQUIRE(EncodeMorton(1, 0, 0) == 1);
+    REQUIRE(EncodeMorton(0, 1, 0) == 2);
+    REQUIRE(EncodeMorton(0, 0, 1) == 4);
+    REQUIRE(EncodeMorton(3, 0, 0) == 9);
+    REQUIRE(EncodeMorton(0x3ff, 0x3ff, 0x3ff) == 0x3fffffff);
+  }
+
+  SECTION("Only the lower 10 bits are used in 3D") {
+    REQUIRE(EncodeMorton(0x401, 0x400, 0x400) == 1);
+  }
+}
+
+TEST_CASE("MortonOrder Compute() functionality") {
+  MortonOrder morton_order;
+  std::vector<Particle> particles;
+
+  SECTION("No particles") {
+    REQUIRE(morton_order.Compute(particles, glm::dvec2(100, 100)).empty());
+  }
+
+  SECTION("Quadrants are visited in Z order") {
+    particles.push_back(Particle(1, 1, glm::vec2(75, 75), glm::vec2(0, 0)));
+    particles.push_back(Particle(1, 1, glm::vec2(25, 75), glm::vec2(0, 0)));
+    particles.push_back(Particle(1, 1, glm::vec2(75, 25), glm::vec2(0, 0)));
+    particles.push_back(Particle(1, 1, glm::vec2(25, 25), glm::vec2(0, 0)));
+
+    REQUIRE(morton_order.Compute(particles, glm::dvec2(100, 100)) ==
+            std::vector<size_t>({3, 2, 1, 0}));
+  }
+
+  SECTION("Particles in the same place keep their order") {
+    particles.push_back(Particle(1, 1, glm::vec2(50, 50), glm::vec2(0, 0)));
+    particles.push_back(Particle(1, 1, glm::vec2(50, 50), glm::vec2(0, 0)));
+    particles.push_back(Particle(1, 1, glm::vec2(1, 1), glm::vec2(0, 0)));
+
+    REQUIRE(morton_order.Compute(particles, glm::dvec2(100, 100)) ==
+            std::vector<size_t>({2, 0, 1}));
+  }
+
+  SECTION("Particles past the walls are ordered at the edges") {
+    particles.push_back(Particle(1, 1, glm::vec2(101, 101), glm::vec2(0, 0)));
+    particles.push_back(Particle(1, 1, glm::vec2(-1, -1), glm::vec2(0, 0)));
+    particles.push_back(Particle(1, 1, glm::vec2(50, 50), glm::vec2(0, 0)));
+
+    REQUIRE(morton_order.Compute(particles, glm::dvec2(100, 100)) ==
+            std::vector<size_t>({1, 2, 0}));
+  }
+}
+
+TEST_CASE("MortonOrder Compute() in 3D") {
+  MortonOrder morton_order;
+  std::vector<Particle3d> particles;
+  glm::vec3 rest(0, 0, 0);
+  particles.push_back(Particle3d(1, 1, glm::vec3(90, 90, 90), rest));
+  particles.push_back(Particle3d(1, 1, glm::vec3(10, 10, 90), rest));
+  particles.push_back(Particle3d(1, 1, glm::vec3(10, 10, 10), rest));
+  particles.push_back(Particle3d(1, 1, glm::vec3(90, 10, 10), rest));
+
+  /* The curve visits the octants in the order of their z, y, x bits */
+  REQUIRE(morton_order.Compute(particles, glm::dvec3(100, 100, 100)) ==
+          std::vector<size_t>({2, 3, 1, 0}));
+}
+
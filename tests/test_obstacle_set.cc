@@ -0,0 +1,130 @@
+#include <core/obstacle_set.h>
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <sstream>
+
+using namespace idealgas;
+
+TEST_CASE("ObstacleSet Reflect() functionality") {
+  ObstacleSet obstacles;
+
+  SECTION("No obstacles") {
+    obstacles.Build();
+    glm::vec2 velocity(1, 0);
+    REQUIRE_FALSE(obstacles.Reflect(glm::dvec2(50, 50), 1, velocity));
+    REQUIRE(velocity == glm::vec2(1, 0));
+  }
+
+  SECTION("Particle moving into a segment is reflected") {
+    obstacles.AddSegment(glm::dvec2(50, 0), glm::dvec2(50, 100));
+    obstacles.Build();
+
+    glm::vec2 velocity(1, 2);
+    REQUIRE(obstacles.Reflect(glm::dvec2(49.5, 50), 1, velocity));
+    REQUIRE(velocity == glm::vec2(-1, 2));
+  }
+
+  SECTION("Particle moving away from a segment is not reflected") {
+    obstacles.AddSegment(glm::dvec2(50, 0), glm::dvec2(50, 100));
+    obstacles.Build();
+
+    glm::vec2 velocity(-1, 2);
+    REQUIRE_FALSE(obstacles.Reflect(glm::dvec2(49.5, 50), 1, velocity));
+    REQUIRE(velocity == glm::vec2(-1, 2));
+  }
+
+  SECTION("Particle past the end of a segment is not reflected") {
+    obstacles.AddSegment(glm::dvec2(50, 0), glm::dvec2(50, 10));
+    obstacles.Build();
+
+    glm::vec2 velocity(1, 0);
+    REQUIRE_FALSE(obstacles.Reflect(glm::dvec2(49.5, 50), 1, velocity));
+  }
+
+  SECTION("Particle hitting a disc head on is reflected back") {
+    obstacles.AddDisc(glm::dvec2(50, 50), 5);
+    obstacles.Build();
+
+    glm::vec2 velocity(0, -3);
+    REQUIRE(obstacles.Reflect(glm::dvec2(50, 55.5), 1, velocity));
+    REQUIRE(velocity == glm::vec2(0, 3));
+  }
+
+  SECTION("Particle hitting a polygon corner is reflected once") {
+    obstacles.AddPolygon({glm::dvec2(40, 40), glm::dvec2(60, 40),
+                          glm::dvec2(60, 60), glm::dvec2(40, 60)});
+    obstacles.Build();
+
+    glm::vec2 velocity(-1, -1);
+    REQUIRE(obstacles.Reflect(glm::dvec2(60.5, 60.5), 1, velocity));
+    REQUIRE(velocity.x == Approx(1));
+    REQUIRE(velocity.y == Approx(1));
+  }
+
+  SECTION("Hierarchy finds the same contacts as checking every obstacle") {
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<double> coordinate(0, 1000);
+    std::uniform_real_distribution<double> offset(-5, 5);
+
+    std::vector<Obstacle> segments;
+    for (size_t i = 0; i < 2000; i++) {
+      glm::dvec2 start(coordinate(generator), coordinate(generator));
+      glm::dvec2 end = start + glm::dvec2(offset(generator), offset(generator));
+      obstacles.AddSegment(start, end);
+      segments.push_back({start, end, 0});
+    }
+    obstacles.Build();
+
+    for (size_t i = 0; i < 2000; i++) {
+      glm::dvec2 position(coordinate(generator), coordinate(generator));
+      glm::vec2 velocity((float)offset(generator), (float)offset(generator));
+
+      /* Reflect off of each segment on its own, in any order, to see whether
+         any contact exists */
+      bool expected = false;
+      for (const Obstacle& segment : segments) {
+        ObstacleSet single;
+        single.AddSegment(segment.start, segment.end);
+        single.Build();
+        glm::vec2 single_velocity = velocity;
+        expected = expected || single.Reflect(position, 2, single_velocity);
+        if (expected) {
+          break;
+        }
+      }
+
+      REQUIRE(obstacles.Reflect(position, 2, velocity) == expected);
+    }
+  }
+}
+
+TEST_CASE("ObstacleSet parsing") {
+  SECTION("Every type of obstacle") {
+    std::istringstream input(
+        "# A nozzle\n"
+        "segment 0 0 10 10\n"
+        "disc 50 50 5  # trailing comment\n"
+        "\n"
+        "polygon 0 0 1 0 1 1\n");
+    ObstacleSet obstacles = ObstacleSet::Parse(input);
+
+    REQUIRE(obstacles.GetObstacles().size() == 5);
+    glm::vec2 velocity(0, -1);
+    REQUIRE(obstacles.Reflect(glm::dvec2(50, 55.5), 1, velocity));
+  }
+
+  SECTION("Malformed obstacles are rejected") {
+    std::istringstream unknown("wall 0 0 1 1\n");
+    REQUIRE_THROWS_AS(ObstacleSet::Parse(unknown), std::invalid_argument);
+
+    std::istringstream missing("segment 0 0 1\n");
+    REQUIRE_THROWS_AS(ObstacleSet::Parse(missing), std::invalid_argument);
+
+    std::istringstream not_a_number("disc 0 zero 1\n");
+    REQUIRE_THROWS_AS(ObstacleSet::Parse(not_a_number), std::invalid_argument);
+
+    std::istringstream odd_polygon("polygon 0 0 1 0 1 1 2\n");
+    REQUIRE_THROWS_AS(ObstacleSet::Parse(odd_polygon), std::invalid_argument);
+  }
+}
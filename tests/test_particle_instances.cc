@@ -0,0 +1,61 @@
+#include <visualizer/particle_instances.h>
+
+#include <catch2/catch.hpp>
+
+using namespace idealgas;
+
+TEST_CASE("ParticleInstanceBuilder") {
+  /* A 100x50 plane drawn at (10, 20) with 4 pixels per unit */
+  ParticleInstanceBuilder builder(glm::vec2(10, 20), 4, 50);
+
+  SECTION("No particles") {
+    builder.Build(std::vector<Particle>());
+    REQUIRE(builder.GetInstances().empty());
+  }
+
+  SECTION("Particles are placed in window pixels with y flipped") {
+    std::vector<Particle> particles;
+    particles.push_back(Particle(1, 1, glm::dvec2(0, 0), glm::vec2(1, 0),
+                                 ci::Color("red")));
+    particles.push_back(Particle(1.5, 4, glm::dvec2(100, 50), glm::vec2(0, 1),
+                                 ci::Color("green")));
+
+    builder.Build(particles);
+    const std::vector<ParticleInstance>& instances = builder.GetInstances();
+
+    REQUIRE(instances.size() == 2);
+    REQUIRE(instances[0].position == glm::vec2(10, 220));
+    REQUIRE(instances[0].radius == 4);
+    REQUIRE(instances[0].color == ci::Color("red"));
+    REQUIRE(instances[1].position == glm::vec2(410, 20));
+    REQUIRE(instances[1].radius == 6);
+    REQUIRE(instances[1].color == ci::Color("green"));
+  }
+
+  SECTION("Positions far from the origin are scaled in double precision") {
+    ParticleInstanceBuilder large_plane(glm::vec2(0, 0), 1e-6, 1e8);
+    std::vector<Particle> particles;
+    particles.push_back(Particle(1, 1, glm::dvec2(1e8 - 0.5, 0.5),
+                                 glm::vec2(0, 0)));
+
+    large_plane.Build(particles);
+
+    REQUIRE(large_plane.GetInstances()[0].position.x == Approx(100));
+    REQUIRE(large_plane.GetInstances()[0].position.y == Approx(100));
+  }
+
+  SECTION("Rebuilding replaces the instances") {
+    std::vector<Particle> particles(
+        3, Particle(1, 1, glm::dvec2(50, 25), glm::vec2(0, 0)));
+    builder.Build(particles);
+    particles.pop_back();
+    builder.Build(particles);
+
+    REQUIRE(builder.GetInstances().size() == 2);
+    REQUIRE(builder.GetInstances()[1].position == glm::vec2(210, 120));
+  }
+
+  SECTION("Instances are tightly packed floats") {
+    REQUIRE(sizeof(ParticleInstance) == 6 * sizeof(float));
+  }
+}
@@ -0,0 +1,158 @@
+#include <core/particle_store.h>
+
+#include <catch2/catch.hpp>
+
+using namespace idealgas;
+
+TEST_CASE("ParticleStore functionality") {
+  ParticleStore store;
+  Particle p1(1, 1, glm::vec2(1, 1), glm::vec2(0, 0));
+  Particle p2(2, 1, glm::vec2(2, 2), glm::vec2(0, 0));
+  Particle p3(3, 1, glm::vec2(3, 3), glm::vec2(0, 0));
+
+  SECTION("Empty store") {
+    REQUIRE(store.Size() == 0);
+    REQUIRE_FALSE(store.Contains({0, 0}));
+    REQUIRE_THROWS_AS(store.Get({0, 0}), std::out_of_range);
+  }
+
+  SECTION("Inserted particles are stored in order") {
+    ParticleHandle h1 = store.Insert(p1);
+    ParticleHandle h2 = store.Insert(p2);
+
+    REQUIRE(store.Size() == 2);
+    REQUIRE(store.GetParticles()[0] == p1);
+    REQUIRE(store.GetIndex(h2) == 1);
+    REQUIRE(store.GetHandle(0) == h1);
+  }
+
+  SECTION("Removing the last particle") {
+    store.Insert(p1);
+    ParticleHandle h2 = store.Insert(p2);
+    REQUIRE(store.Remove(h2));
+
+    REQUIRE(store.Size() == 1);
+    REQUIRE(store.GetParticles()[0] == p1);
+  }
+
+  SECTION("Removing a particle swaps in the last particle") {
+    ParticleHandle h1 = store.Insert(p1);
+    ParticleHandle h2 = store.Insert(p2);
+    ParticleHandle h3 = store.Insert(p3);
+    REQUIRE(store.Remove(h1));
+
+    REQUIRE(store.GetParticles()[0] == p3);
+    REQUIRE(store.GetIndex(h3) == 0);
+    REQUIRE(store.Get(h2) == p2);
+  }
+
+  SECTION("Slots are reused with a new generation") {
+    ParticleHandle h1 = store.Insert(p1);
+    store.Remove(h1);
+    ParticleHandle h2 = store.Insert(p2);
+
+    REQUIRE(h2.slot == h1.slot);
+    REQUIRE(h2.generation == h1.generation + 1);
+    REQUIRE_FALSE(store.Contains(h1));
+    REQUIRE_FALSE(store.Remove(h1));
+    REQUIRE(store.Get(h2) == p2);
+  }
+
+  SECTION("Clearing invalidates every handle") {
+    ParticleHandle h1 = store.Insert(p1);
+    ParticleHandle h2 = store.Insert(p2);
+    store.Clear();
+
+    REQUIRE(store.Size() == 0);
+    REQUIRE_FALSE(store.Contains(h1));
+    REQUIRE_FALSE(store.Contains(h2));
+  }
+
+  SECTION("Permuting keeps handles valid") {
+    ParticleHandle h1 = store.Insert(p1);
+    ParticleHandle h2 = store.Insert(p2);
+    ParticleHandle h3 = store.Insert(p3);
+    store.Permute({2, 0, 1});
+
+    REQUIRE(store.GetParticles()[0] == p3);
+    REQUIRE(store.GetParticles()[1] == p1);
+    REQUIRE(store.GetIndex(h1) == 1);
+    REQUIRE(store.GetIndex(h2) == 2);
+    REQUIRE(store.GetHandle(0) == h3);
+  }
+
+  SECTION("Particles can be updated in place") {
+    ParticleHandle h1 = store.Insert(p1);
+    store.GetMutable(0).SetVelocity(glm::vec2(1, 0));
+
+    REQUIRE(store.Get(h1).GetVelocity() == glm::vec2(1, 0));
+  }
+}
+
+TEST_CASE("Shared particle stores") {
+  /* Enough particles to fill a few chunks */
+  size_t num_particles = 8 * SharedChunkedVector<Particle>::kChunkSize + 10;
+  ParticleStore store;
+  std::vector<ParticleHandle> handles;
+  for (size_t i = 0; i < num_particles; i++) {
+    handles.push_back(store.Insert(
+        Particle(1, 1, glm::vec2(i % 100, i / 100), glm::vec2(0, 0))));
+  }
+  std::vector<Particle> particles = store.GetParticles();
+  size_t full_usage = num_particles * sizeof(Particle);
+
+  store.Share();
+  ParticleStore copy = store;
+
+  SECTION("Copies of a shared store share its memory") {
+    REQUIRE(store.GetUnsharedMemoryUsage() < full_usage / 100);
+    REQUIRE(copy.GetUnsharedMemoryUsage() < full_usage / 100);
+
+    std::vector<ParticleStore> copies(100, store);
+    size_t total_usage = 0;
+    for (const ParticleStore& other : copies) {
+      total_usage += other.GetUnsharedMemoryUsage();
+    }
+    REQUIRE(total_usage < full_usage);
+  }
+
+  SECTION("Removing a particle only copies the chunks written to") {
+    REQUIRE(copy.Remove(handles[5]));
+    REQUIRE(copy.GetUnsharedMemoryUsage() < full_usage / 2);
+
+    REQUIRE(copy.Size() == num_particles - 1);
+    REQUIRE_FALSE(copy.Contains(handles[5]));
+    REQUIRE(copy.GetIndex(handles.back()) == 5);
+    REQUIRE(store.Contains(handles[5]));
+    REQUIRE(store.GetParticles() == particles);
+    REQUIRE(copy.GetParticles()[5] == particles.back());
+  }
+
+  SECTION("Inserting a particle only copies the last chunk") {
+    Particle particle(2, 2, glm::vec2(50, 50), glm::vec2(1, 1));
+    ParticleHandle handle = copy.Insert(particle);
+    REQUIRE(copy.GetUnsharedMemoryUsage() < full_usage / 2);
+
+    REQUIRE(copy.Get(handle) == particle);
+    REQUIRE_FALSE(store.Contains(handle));
+    REQUIRE(store.Size() == num_particles);
+  }
+
+  SECTION("Reading a shared store copies nothing") {
+    size_t num_read = 0;
+    for (const Particle& particle : copy.GetParticles()) {
+      num_read += particle.GetRadius() == 1;
+    }
+    REQUIRE(num_read == num_particles);
+    REQUIRE(copy.Get(handles.back()) == particles.back());
+    REQUIRE(copy.GetUnsharedMemoryUsage() < full_usage / 100);
+    REQUIRE(store.GetUnsharedMemoryUsage() < full_usage / 100);
+  }
+
+  SECTION("Writing to a particle only copies its chunk") {
+    copy.GetMutable(0).SetVelocity(glm::vec2(1, 0));
+    REQUIRE(copy.GetUnsharedMemoryUsage() < full_usage / 4);
+    REQUIRE(store.GetParticles() == particles);
+    REQUIRE(copy.GetParticles()[0].GetVelocity() == glm::vec2(1, 0));
+  }
+}
@@ -0,0 +1,174 @@
+#include <core/rewind_buffer.h>
+
+#include <catch2/catch.hpp>
+
+using namespace idealgas;
+
+namespace {
+
+/** Sets up a simulation which uses every source of randomness and state */
+void Configure(Simulator& simulator) {
+  ParticleSource source = {{Wall::kLeft, 10, 50}, 0.3, 1, 1,
+                           ci::Color("red"), 0.5, 0.2};
+  simulator.AddSource(source);
+  ParticleSink sink = {{Wall::kRight, 10, 50}};
+  simulator.AddSink(sink);
+  simulator.SetReorderInterval(7);
+}
+
+bool IsSameState(const Simulator& simulator1, const Simulator& simulator2) {
+  const std::vector<Particle>& particles1 = simulator1.GetParticles();
+  const std::vector<Particle>& particles2 = simulator2.GetParticles();
+  if (simulator1.GetNumSteps() != simulator2.GetNumSteps() ||
+      particles1.size() != particles2.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < particles1.size(); i++) {
+    if (particles1[i].GetPrecisePosition() !=
+            particles2[i].GetPrecisePosition() ||
+        particles1[i].GetVelocity() != particles2[i].GetVelocity() ||
+        particles1[i].GetRadius() != particles2[i].GetRadius() ||
+        !(particles1[i].GetColor() == particles2[i].GetColor())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST_CASE("Rewind buffer") {
+  Simulator simulator(100, 60, 7);
+  Configure(simulator);
+  for (size_t i = 0; i < 40; i++) {
+    simulator.AddRandomSmallParticle();
+    simulator.AddRandomMediumParticle();
+    simulator.AddRandomLargeParticle();
+  }
+
+  SECTION("Intervals must be positive") {
+    REQUIRE_THROWS_AS(RewindBuffer(0, 4), std::invalid_argument);
+    REQUIRE_THROWS_AS(RewindBuffer(4, 0), std::invalid_argument);
+  }
+
+  SECTION("Captures are taken every few steps") {
+    RewindBuffer rewind(3, 4);
+    rewind.Record(simulator);
+    for (size_t i = 0; i < 10; i++) {
+      simulator.Update();
+      rewind.Record(simulator);
+    }
+    REQUIRE(rewind.GetNumCaptures() == 4);
+    REQUIRE(rewind.GetStep(0) == 0);
+    REQUIRE(rewind.GetStep(3) == 9);
+  }
+
+  SECTION("Restoring any capture continues exactly as the original did") {
+    RewindBuffer rewind(3, 4);
+    std::vector<Simulator::Checkpoint> expected;
+    rewind.Record(simulator);
+    expected.push_back(simulator.SaveCheckpoint());
+    while (simulator.GetNumSteps() < 150) {
+      simulator.Update();
+      rewind.Record(simulator);
+      if (rewind.GetNumCaptures() > expected.size()) {
+        expected.push_back(simulator.SaveCheckpoint());
+      }
+    }
+    REQUIRE(rewind.GetNumCaptures() == 51);
+
+    /* Indices in the middle of a group of previews, on a keyframe, and at
+       the end, restored in decreasing order as restoring drops the captures
+       after the one restored */
+    for (size_t index : {50, 41, 40, 17, 1}) {
+      Simulator restored(100, 60, 99);
+      Configure(restored);
+      rewind.Restore(index, restored);
+
+      Simulator reference(100, 60, 99);
+      Configure(reference);
+      reference.RestoreCheckpoint(expected[index]);
+      REQUIRE(IsSameState(restored, reference));
+      REQUIRE(rewind.GetNumCaptures() == index + 1);
+
+      /* Random emissions continue in the same way too */
+      for (size_t i = 0; i < 60; i++) {
+        restored.Update();
+        reference.Update();
+      }
+      REQUIRE(IsSameState(restored, reference));
+    }
+  }
+
+  SECTION("Previews are close to the captured particles") {
+    RewindBuffer rewind(1, 10);
+    rewind.Record(simulator);
+    simulator.Update();
+    rewind.Record(simulator);
+    Simulator preview(100, 60, 1);
+    rewind.Preview(1, preview);
+
+    REQUIRE(preview.GetNumParticles() == simulator.GetNumParticles());
+    double max_speed = 0;
+    for (const Particle& particle : simulator.GetParticles()) {
+      max_speed = std::max(max_speed,
+                           double(glm::length(particle.GetVelocity())));
+    }
+    for (size_t i = 0; i < simulator.GetNumParticles(); i++) {
+      const Particle& expected = simulator.GetParticles()[i];
+      const Particle& particle = preview.GetParticles()[i];
+      REQUIRE(particle.GetPrecisePosition().x ==
+              Approx(expected.GetPrecisePosition().x).margin(1e-3));
+      REQUIRE(particle.GetPrecisePosition().y ==
+              Approx(expected.GetPrecisePosition().y).margin(1e-3));
+      REQUIRE(particle.GetVelocity().x ==
+              Approx(expected.GetVelocity().x).margin(max_speed * 1e-4));
+      REQUIRE(particle.GetMass() == expected.GetMass());
+      REQUIRE(particle.GetColor() == expected.GetColor());
+    }
+  }
+
+  SECTION("Changes between updates are kept by keyframes") {
+    RewindBuffer rewind(2, 8);
+    rewind.Record(simulator);
+    simulator.Update();
+    simulator.AddRandomLargeParticle();
+    rewind.RecordKeyframe(simulator);
+    simulator.AddRandomLargeParticle();
+    rewind.RecordKeyframe(simulator);
+    REQUIRE(rewind.GetNumCaptures() == 2);
+
+    for (size_t i = 0; i < 4; i++) {
+      simulator.Update();
+      rewind.Record(simulator);
+    }
+    REQUIRE(rewind.GetStep(rewind.GetNumCaptures() - 1) == 5);
+    Simulator::Checkpoint expected = simulator.SaveCheckpoint();
+    Simulator restored(100, 60, 1);
+    Configure(restored);
+    rewind.Restore(rewind.GetNumCaptures() - 1, restored);
+    Simulator reference(100, 60, 1);
+    Configure(reference);
+    reference.RestoreCheckpoint(expected);
+    REQUIRE(IsSameState(restored, reference));
+  }
+
+  SECTION("Memory stays within the budget") {
+    const size_t kBudget = 64 * 1024;
+    RewindBuffer rewind(1, 8, kBudget);
+    size_t max_usage = 0;
+    for (size_t i = 0; i < 2000; i++) {
+      simulator.Update();
+      rewind.Record(simulator);
+      max_usage = std::max(max_usage, rewind.GetMemoryUsage());
+    }
+    REQUIRE(max_usage <= kBudget);
+    REQUIRE(rewind.GetStep(0) > 1000);
+
+    /* The oldest capture left can still be restored */
+    Simulator restored(100, 60, 1);
+    Configure(restored);
+    rewind.Restore(0, restored);
+    REQUIRE(restored.GetNumSteps() == rewind.GetStep(0));
+  }
+}
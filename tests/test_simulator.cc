@@ -1,4 +1,6 @@
+#include <core/precision_benchmark.h>
 #include <core/simulator.h>
+#include <core/thread_pool.h>
 
 #include <catch2/catch.hpp>
 
@@ -682,4 +684,898 @@ TEST_CASE("Get___ParticleSpeeds() functionality") {
     REQUIRE(large_particles[2] == glm::length(p3.GetVelocity()));
     REQUIRE(large_particles[3] == glm::length(p4.GetVelocity()));
   }
-}
\ No newline at end of file
+}
+TEST_CASE("Rectangular and large planes") {
+  SECTION("Walls are placed at the width and height of the plane") {
+    Simulator simulator(200, 50, 0);
+    simulator.AddParticle(Particle(1, 1, glm::vec2(199, 49), glm::vec2(1, 1)));
+    simulator.AddParticle(Particle(1, 1, glm::vec2(99, 49), glm::vec2(1, 1)));
+
+    simulator.Update();
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    /* The second particle is against the top wall only */
+    REQUIRE(particles[0].GetVelocity() == glm::vec2(-1, -1));
+    REQUIRE(particles[1].GetVelocity() == glm::vec2(1, -1));
+  }
+
+  SECTION("Random particles are spawned inside the plane") {
+    Simulator simulator(1000, 10, 0);
+    for (size_t i = 0; i < 100; i++) {
+      simulator.AddRandomLargeParticle();
+    }
+
+    for (const Particle& p : simulator.GetParticles()) {
+      REQUIRE(p.GetPrecisePosition().x >= 1.5);
+      REQUIRE(p.GetPrecisePosition().x <= 1000 - 1.5);
+      REQUIRE(p.GetPrecisePosition().y >= 1.5);
+      REQUIRE(p.GetPrecisePosition().y <= 10 - 1.5);
+    }
+  }
+
+  SECTION("Particles far from the origin move accurately") {
+    Simulator simulator(1e7, 1e7, 0);
+    glm::dvec2 start(5e6, 5e6);
+    simulator.AddParticle(Particle(1, 1, start, glm::vec2(0.001f, 0)));
+
+    /* A float position this far out cannot change by less than 0.5 */
+    size_t n = 1000;
+    for (size_t i = 0; i < n; i++) {
+      simulator.Update();
+    }
+
+    double moved = simulator.GetParticles()[0].GetPrecisePosition().x - start.x;
+    REQUIRE(moved == Approx(n * 0.001).epsilon(1e-4));
+  }
+
+  SECTION("Collisions are detected far from the origin") {
+    Simulator simulator(1e7, 1e7, 0);
+    simulator.AddParticle(Particle(1, 1, glm::dvec2(5e6 + 0.1, 5e6),
+                                   glm::vec2(0, 0.01f)));
+    simulator.AddParticle(Particle(1, 1, glm::dvec2(5e6 + 0.1, 5e6 + 1.99),
+                                   glm::vec2(0, -0.01f)));
+
+    simulator.Update();
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    REQUIRE(particles[0].GetVelocity() == glm::vec2(0, -0.01f));
+    REQUIRE(particles[1].GetVelocity() == glm::vec2(0, 0.01f));
+  }
+}
+
+TEST_CASE("Periodic boundaries") {
+  Simulator simulator;
+  simulator.SetBoundaryMode(BoundaryMode::kPeriodic);
+
+  SECTION("Particles against a wall keep their velocity") {
+    Particle particle(1, 1, glm::vec2(1, 50), glm::vec2(-1, 5));
+    simulator.AddParticle(particle);
+
+    simulator.Update();
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    REQUIRE(particles[0].GetVelocity() == glm::vec2(-1, 5));
+  }
+
+  SECTION("Particles leaving the plane wrap around") {
+    simulator.AddParticle(Particle(1, 1, glm::vec2(99.5, 0.5),
+                                   glm::vec2(1, -1)));
+
+    simulator.Update();
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    REQUIRE(particles[0].GetPosition() == glm::vec2(0.5, 99.5));
+  }
+
+  SECTION("Particles collide across the edges of the plane") {
+    Particle p1(1, 1, glm::vec2(30, 0.5), glm::vec2(0, -1));
+    Particle p2(1, 1, glm::vec2(30, 99), glm::vec2(0, 1));
+    simulator.AddParticle(p1);
+    simulator.AddParticle(p2);
+
+    simulator.Update();
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    REQUIRE(particles[0].GetVelocity() == glm::vec2(0, 1));
+    REQUIRE(particles[1].GetVelocity() == glm::vec2(0, -1));
+  }
+
+  SECTION("Particles across the edges moving apart do not collide") {
+    Particle p1(1, 1, glm::vec2(0.5, 30), glm::vec2(1, 0));
+    Particle p2(1, 1, glm::vec2(99, 30), glm::vec2(-1, 0));
+    simulator.AddParticle(p1);
+    simulator.AddParticle(p2);
+
+    simulator.Update();
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    REQUIRE(particles[0].GetVelocity() == glm::vec2(1, 0));
+    REQUIRE(particles[1].GetVelocity() == glm::vec2(-1, 0));
+  }
+
+  SECTION("Kinetic energy is conserved") {
+    for (size_t i = 0; i < 50; i++) {
+      simulator.AddRandomSmallParticle();
+      simulator.AddRandomLargeParticle();
+    }
+    double energy = simulator.GetKineticEnergy();
+    for (size_t i = 0; i < 200; i++) {
+      simulator.Update();
+    }
+
+    REQUIRE(simulator.GetKineticEnergy() == Approx(energy).epsilon(1e-3));
+    for (const Particle& p : simulator.GetParticles()) {
+      REQUIRE(p.GetPrecisePosition().x >= 0);
+      REQUIRE(p.GetPrecisePosition().x < 100);
+      REQUIRE(p.GetPrecisePosition().y >= 0);
+      REQUIRE(p.GetPrecisePosition().y < 100);
+    }
+  }
+}
+
+TEST_CASE("Particle handles and reordering") {
+  Simulator simulator;
+
+  SECTION("Handles refer to the particles they were returned for") {
+    Particle p1(1, 1, glm::vec2(75, 75), glm::vec2(0, 0));
+    Particle p2(1, 1, glm::vec2(25, 25), glm::vec2(0, 0));
+    ParticleHandle h1 = simulator.AddParticle(p1);
+    ParticleHandle h2 = simulator.AddParticle(p2);
+    REQUIRE(simulator.GetParticleHandle(1) == h2);
+    REQUIRE(simulator.GetParticle(h1) == p1);
+    REQUIRE(simulator.GetParticle(h2) == p2);
+  }
+
+  SECTION("Handles are invalidated by a reset") {
+    ParticleHandle handle =
+        simulator.AddParticle(Particle(1, 1, glm::vec2(5, 5), glm::vec2(0, 0)));
+    simulator.Reset();
+    REQUIRE_FALSE(simulator.ContainsParticle(handle));
+    REQUIRE_THROWS_AS(simulator.GetParticle(handle), std::out_of_range);
+  }
+
+  SECTION("Particles are stored in Morton order after a reorder") {
+    Particle p1(1, 1, glm::vec2(75, 75), glm::vec2(0, 0));
+    Particle p2(1, 1, glm::vec2(25, 25), glm::vec2(0, 0));
+    ParticleHandle h1 = simulator.AddParticle(p1);
+    ParticleHandle h2 = simulator.AddParticle(p2);
+    simulator.SetReorderInterval(1);
+
+    simulator.Update();
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    REQUIRE(particles[0] == p2);
+    REQUIRE(particles[1] == p1);
+    REQUIRE(simulator.GetParticleHandle(0) == h2);
+    REQUIRE(simulator.GetParticle(h1) == p1);
+  }
+
+  SECTION("Reordering only happens every interval") {
+    Particle p1(1, 1, glm::vec2(75, 75), glm::vec2(0, 0));
+    Particle p2(1, 1, glm::vec2(25, 25), glm::vec2(0, 0));
+    ParticleHandle h1 = simulator.AddParticle(p1);
+    ParticleHandle h2 = simulator.AddParticle(p2);
+    simulator.SetReorderInterval(3);
+
+    simulator.Update();
+    simulator.Update();
+    REQUIRE(simulator.GetParticleHandle(0) == h1);
+    simulator.Update();
+    REQUIRE(simulator.GetParticleHandle(0) == h2);
+  }
+
+  SECTION("Particles can be put in the order of their handles") {
+    Particle p1(1, 1, glm::vec2(75, 75), glm::vec2(0, 0));
+    Particle p2(1, 1, glm::vec2(25, 25), glm::vec2(0, 0));
+    ParticleHandle h1 = simulator.AddParticle(p1);
+    ParticleHandle h2 = simulator.AddParticle(p2);
+    REQUIRE_THROWS_AS(simulator.SetParticleOrder({h2}), std::invalid_argument);
+
+    simulator.SetParticleOrder({h2, h1});
+    REQUIRE(simulator.GetParticles()[0] == p2);
+    REQUIRE(simulator.GetParticleHandle(1) == h1);
+    REQUIRE(simulator.GetParticle(h1) == p1);
+  }
+
+  SECTION("A particle cannot be given two places in the order") {
+    Particle p1(1, 1, glm::vec2(75, 75), glm::vec2(0, 0));
+    Particle p2(1, 1, glm::vec2(25, 25), glm::vec2(0, 0));
+    Particle p3(1, 1, glm::vec2(50, 50), glm::vec2(0, 0));
+    ParticleHandle h1 = simulator.AddParticle(p1);
+    simulator.AddParticle(p2);
+    ParticleHandle h3 = simulator.AddParticle(p3);
+
+    REQUIRE_THROWS_AS(simulator.SetParticleOrder({h3, h1, h3}),
+                      std::invalid_argument);
+    REQUIRE(simulator.GetParticles()[0] == p1);
+    REQUIRE(simulator.GetParticles()[1] == p2);
+    REQUIRE(simulator.GetParticles()[2] == p3);
+  }
+
+  SECTION("Handles follow their particles through a run") {
+    Simulator reordered(3);
+    Simulator reference(3);
+    reordered.SetReorderInterval(1);
+    for (size_t i = 0; i < 100; i++) {
+      reordered.AddRandomSmallParticle();
+      reference.AddRandomSmallParticle();
+    }
+    std::vector<ParticleHandle> handles;
+    for (size_t i = 0; i < 100; i++) {
+      handles.push_back(reordered.GetParticleHandle(i));
+    }
+
+    /* Reordering changes the order later collisions are resolved in, so
+       compare right after the first reorder */
+    reordered.Update();
+    reference.Update();
+    for (size_t i = 0; i < 100; i++) {
+      REQUIRE(reordered.GetParticle(handles[i]) == reference.GetParticles()[i]);
+    }
+  }
+
+  SECTION("The occupied volume does not change the results") {
+    Simulator packed(3);
+    Simulator reference(3);
+    REQUIRE_THROWS_AS(packed.SetOccupiedVolume(-1), std::invalid_argument);
+    packed.SetOccupiedVolume(100);
+    for (size_t i = 0; i < 100; i++) {
+      packed.AddRandomSmallParticle();
+      reference.AddRandomSmallParticle();
+    }
+
+    for (size_t step = 0; step < 50; step++) {
+      packed.Update();
+      reference.Update();
+    }
+    REQUIRE(packed.GetParticles() == reference.GetParticles());
+  }
+}
+
+TEST_CASE("Particle removal and queued changes") {
+  Simulator simulator;
+  Particle p1(1, 1, glm::vec2(10, 10), glm::vec2(0, 0));
+  Particle p2(1, 1, glm::vec2(20, 20), glm::vec2(0, 0));
+  Particle p3(1, 1, glm::vec2(30, 30), glm::vec2(0, 0));
+  ParticleHandle h1 = simulator.AddParticle(p1);
+  ParticleHandle h2 = simulator.AddParticle(p2);
+  ParticleHandle h3 = simulator.AddParticle(p3);
+
+  SECTION("Removing a particle moves the last particle into its place") {
+    REQUIRE(simulator.RemoveParticle(h1));
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    REQUIRE(particles.size() == 2);
+    REQUIRE(particles[0] == p3);
+    REQUIRE(particles[1] == p2);
+    REQUIRE(simulator.GetParticle(h3) == p3);
+    REQUIRE_FALSE(simulator.ContainsParticle(h1));
+  }
+
+  SECTION("Removing a particle twice fails") {
+    REQUIRE(simulator.RemoveParticle(h2));
+    REQUIRE_FALSE(simulator.RemoveParticle(h2));
+    REQUIRE(simulator.GetNumParticles() == 2);
+  }
+
+  SECTION("Stale handles do not refer to particles reusing their slot") {
+    simulator.RemoveParticle(h2);
+    ParticleHandle h4 = simulator.AddParticle(p1);
+
+    REQUIRE(h4.slot == h2.slot);
+    REQUIRE(h4 != h2);
+    REQUIRE_FALSE(simulator.ContainsParticle(h2));
+  }
+
+  SECTION("Queued changes are applied at the next update") {
+    simulator.QueueParticleRemoval(h1);
+    simulator.QueueParticleRemoval(h1);
+    simulator.QueueParticleInsertion(p1);
+    simulator.QueueParticleInsertion(p1);
+    REQUIRE(simulator.GetNumParticles() == 3);
+
+    simulator.Update();
+    REQUIRE(simulator.GetNumParticles() == 4);
+    REQUIRE_FALSE(simulator.ContainsParticle(h1));
+    REQUIRE(simulator.ContainsParticle(h2));
+  }
+
+  SECTION("Reset drops queued changes") {
+    simulator.QueueParticleInsertion(p1);
+    simulator.Reset();
+    simulator.Update();
+    REQUIRE(simulator.GetParticles().empty());
+  }
+}
+
+TEST_CASE("Sources and sinks") {
+  Simulator simulator;
+  ParticleSource source = {{Wall::kLeft, 40, 60}, 0.5, 1, 1,
+                           ci::Color("red"), 1, 0.5};
+
+  SECTION("Sources emit particles at their rate") {
+    simulator.AddSource(source);
+    for (size_t i = 0; i < 10; i++) {
+      simulator.Update();
+    }
+
+    REQUIRE(simulator.GetNumParticles() == 5);
+  }
+
+  SECTION("Emitted particles start on the segment moving into the plane") {
+    source.segment = {Wall::kTop, 10, 20};
+    source.rate = 3;
+    simulator.AddSource(source);
+    simulator.Update();
+
+    REQUIRE(simulator.GetNumParticles() == 3);
+    for (const Particle& p : simulator.GetParticles()) {
+      /* Particles have moved by one update since being emitted */
+      glm::dvec2 start = p.GetPrecisePosition() - glm::dvec2(p.GetVelocity());
+      REQUIRE(start.x >= 10);
+      REQUIRE(start.x <= 20);
+      REQUIRE(start.y == Approx(99));
+      REQUIRE(p.GetVelocity().y <= -1);
+      REQUIRE(p.GetVelocity().y >= -1.5);
+      REQUIRE(std::abs(p.GetVelocity().x) <= 0.5);
+    }
+  }
+
+  SECTION("Sinks absorb particles hitting them") {
+    simulator.AddSink({{Wall::kRight, 40, 60}});
+    simulator.AddParticle(Particle(1, 1, glm::vec2(99, 50), glm::vec2(1, 0)));
+
+    simulator.Update();
+    REQUIRE(simulator.GetParticles().empty());
+  }
+
+  SECTION("Particles hitting the wall beside a sink bounce") {
+    simulator.AddSink({{Wall::kRight, 40, 60}});
+    simulator.AddParticle(Particle(1, 1, glm::vec2(99, 70), glm::vec2(1, 0)));
+
+    simulator.Update();
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    REQUIRE(particles.size() == 1);
+    REQUIRE(particles[0].GetVelocity() == glm::vec2(-1, 0));
+  }
+
+  SECTION("Particles moving away from a sink are not absorbed") {
+    simulator.AddSink({{Wall::kBottom, 0, 100}});
+    simulator.AddParticle(Particle(1, 1, glm::vec2(50, 1), glm::vec2(0, 1)));
+
+    simulator.Update();
+    REQUIRE(simulator.GetNumParticles() == 1);
+  }
+
+  SECTION("A source and an opposite sink reach a steady state") {
+    source.segment = {Wall::kLeft, 0, 100};
+    source.thermal_speed = 0;
+    simulator.AddSource(source);
+    simulator.AddSink({{Wall::kRight, 0, 100}});
+
+    /* Particles cross the plane in about 100 updates */
+    for (size_t i = 0; i < 300; i++) {
+      simulator.Update();
+    }
+    size_t num_particles = simulator.GetNumParticles();
+    for (size_t i = 0; i < 100; i++) {
+      simulator.Update();
+    }
+
+    REQUIRE(num_particles > 0);
+    REQUIRE(simulator.GetNumParticles() <= num_particles + 5);
+    REQUIRE(simulator.GetNumParticles() + 5 >= num_particles);
+  }
+
+  SECTION("Checkpoints only restore with the same sources") {
+    simulator.AddSource(source);
+    simulator.Update();
+    Simulator::Checkpoint checkpoint = simulator.SaveCheckpoint();
+    simulator.Update();
+
+    Simulator other;
+    REQUIRE_THROWS_AS(other.RestoreCheckpoint(checkpoint),
+                      std::invalid_argument);
+
+    /* The backlog of half a particle carries over, so the next update emits
+       as it did after the checkpoint was saved */
+    other.AddSource(source);
+    other.RestoreCheckpoint(checkpoint);
+    other.Update();
+    REQUIRE(other.GetNumParticles() == simulator.GetNumParticles());
+  }
+}
+
+TEST_CASE("Obstacles") {
+  Simulator simulator;
+  ObstacleSet obstacles;
+  obstacles.AddSegment(glm::dvec2(50, 0), glm::dvec2(50, 60));
+  simulator.SetObstacles(obstacles);
+
+  SECTION("Particles bounce off of obstacles") {
+    simulator.AddParticle(Particle(1, 1, glm::vec2(49, 30), glm::vec2(1, 1)));
+
+    simulator.Update();
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    REQUIRE(particles[0].GetVelocity() == glm::vec2(-1, 1));
+  }
+
+  SECTION("Particles pass beside obstacles") {
+    simulator.AddParticle(Particle(1, 1, glm::vec2(49, 70), glm::vec2(1, 1)));
+
+    simulator.Update();
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    REQUIRE(particles[0].GetVelocity() == glm::vec2(1, 1));
+  }
+
+  SECTION("Obstacles apply with periodic boundaries") {
+    simulator.SetBoundaryMode(BoundaryMode::kPeriodic);
+    simulator.AddParticle(Particle(1, 1, glm::vec2(51, 30), glm::vec2(-1, 0)));
+
+    simulator.Update();
+    std::vector<Particle> particles = simulator.GetParticles();
+
+    REQUIRE(particles[0].GetVelocity() == glm::vec2(1, 0));
+  }
+}
+
+TEST_CASE("Compile-time policies") {
+  SECTION("Fixed boundaries match the selectable boundary") {
+    Simulator selectable(100, 100, 5);
+    selectable.SetBoundaryMode(BoundaryMode::kPeriodic);
+    BasicSimulator<2, PeriodicBoundary, NoForce, float> periodic(100, 100, 5);
+    for (size_t i = 0; i < 200; i++) {
+      selectable.AddRandomSmallParticle();
+      periodic.AddRandomSmallParticle();
+    }
+
+    for (size_t step = 0; step < 100; step++) {
+      selectable.Update();
+      periodic.Update();
+    }
+
+    REQUIRE(selectable.GetParticles() == periodic.GetParticles());
+  }
+
+  SECTION("Walls bounce particles") {
+    BasicSimulator<2, WallBoundary, NoForce, float> simulator(100, 100, 0);
+    simulator.AddParticle(Particle(1, 1, glm::vec2(99, 50), glm::vec2(1, 0)));
+
+    simulator.Update();
+
+    REQUIRE(simulator.GetParticles()[0].GetVelocity() == glm::vec2(-1, 0));
+  }
+
+  SECTION("A uniform force accelerates particles") {
+    UniformForce gravity(glm::dvec2(0, -0.25));
+    BasicSimulator<2, WallBoundary, UniformForce, float> simulator(
+        100, 100, 0, WallBoundary(), gravity);
+    simulator.AddParticle(Particle(1, 1, glm::vec2(50, 50), glm::vec2(1, 0)));
+
+    simulator.Update();
+    simulator.Update();
+    const Particle& particle = simulator.GetParticles()[0];
+
+    REQUIRE(particle.GetVelocity() == glm::vec2(1, -0.5f));
+    REQUIRE(particle.GetPosition() == glm::vec2(52, 49.25f));
+  }
+
+  SECTION("Particles fall and bounce off of the floor") {
+    BasicSimulator<2, WallBoundary, UniformForce, float> simulator(
+        100, 100, 0, WallBoundary(), UniformForce(glm::dvec2(0, -0.5)));
+    simulator.AddParticle(Particle(1, 1, glm::vec2(50, 5), glm::vec2(0, 0)));
+
+    double lowest = 5;
+    bool has_bounced = false;
+    for (size_t step = 0; step < 20; step++) {
+      simulator.Update();
+      const Particle& particle = simulator.GetParticles()[0];
+      lowest = std::min(lowest, particle.GetPrecisePosition().y);
+      has_bounced = has_bounced || particle.GetVelocity().y > 0;
+    }
+
+    REQUIRE(has_bounced);
+    REQUIRE(lowest >= 0);
+    REQUIRE(lowest < 1);
+  }
+
+  SECTION("Collisions computed in double precision conserve energy") {
+    BasicSimulator<2, WallBoundary, NoForce, double> simulator(100, 100, 2);
+    for (size_t i = 0; i < 100; i++) {
+      simulator.AddRandomSmallParticle();
+      simulator.AddRandomLargeParticle();
+    }
+    double initial_energy = simulator.GetKineticEnergy();
+
+    for (size_t step = 0; step < 500; step++) {
+      simulator.Update();
+    }
+
+    REQUIRE(simulator.GetKineticEnergy() ==
+            Approx(initial_energy).epsilon(1e-5));
+  }
+}
+
+TEST_CASE("3D hard-sphere gas") {
+  Simulator3d simulator;
+
+  SECTION("The default box is a cube") {
+    REQUIRE(simulator.GetSize() == glm::dvec3(100, 100, 100));
+  }
+
+  SECTION("Particles collide head on along z") {
+    simulator.AddParticle(Particle3d(1, 1, glm::vec3(50, 50, 49.5),
+                                     glm::vec3(0, 0, 0.5)));
+    simulator.AddParticle(Particle3d(1, 1, glm::vec3(50, 50, 50.5),
+                                     glm::vec3(0, 0, -0.5)));
+
+    simulator.Update();
+    std::vector<Particle3d> particles = simulator.GetParticles();
+
+    REQUIRE(particles[0].GetVelocity() == glm::vec3(0, 0, -0.5));
+    REQUIRE(particles[1].GetVelocity() == glm::vec3(0, 0, 0.5));
+  }
+
+  SECTION("Oblique collisions conserve momentum and energy") {
+    simulator.AddParticle(Particle3d(1, 1, glm::vec3(50, 50, 50),
+                                     glm::vec3(0.5, 0.1, 0.2)));
+    simulator.AddParticle(Particle3d(1.5, 4, glm::vec3(51.5, 50.5, 51),
+                                     glm::vec3(-0.1, 0, -0.3)));
+    glm::vec3 momentum = 1.0f * simulator.GetParticles()[0].GetVelocity() +
+                         4.0f * simulator.GetParticles()[1].GetVelocity();
+    double energy = simulator.GetKineticEnergy();
+
+    simulator.Update();
+    std::vector<Particle3d> particles = simulator.GetParticles();
+    glm::vec3 new_momentum =
+        1.0f * particles[0].GetVelocity() + 4.0f * particles[1].GetVelocity();
+
+    REQUIRE(particles[0].GetVelocity() != glm::vec3(0.5, 0.1, 0.2));
+    REQUIRE(new_momentum.x == Approx(momentum.x));
+    REQUIRE(new_momentum.y == Approx(momentum.y));
+    REQUIRE(new_momentum.z == Approx(momentum.z));
+    REQUIRE(simulator.GetKineticEnergy() == Approx(energy));
+  }
+
+  SECTION("Particles bounce off of the front and back walls") {
+    simulator.AddParticle(Particle3d(1, 1, glm::vec3(50, 50, 99),
+                                     glm::vec3(0, 0, 1)));
+    simulator.AddParticle(Particle3d(1, 1, glm::vec3(50, 20, 1),
+                                     glm::vec3(0, 0, -1)));
+
+    simulator.Update();
+    std::vector<Particle3d> particles = simulator.GetParticles();
+
+    REQUIRE(particles[0].GetVelocity() == glm::vec3(0, 0, -1));
+    REQUIRE(particles[1].GetVelocity() == glm::vec3(0, 0, 1));
+  }
+
+  SECTION("Particles wrap around along z in a periodic box") {
+    simulator.SetBoundaryMode(BoundaryMode::kPeriodic);
+    simulator.AddParticle(Particle3d(1, 1, glm::vec3(50, 50, 99.5),
+                                     glm::vec3(0, 0, 1)));
+
+    simulator.Update();
+
+    REQUIRE(simulator.GetParticles()[0].GetPrecisePosition() ==
+            glm::dvec3(50, 50, 0.5));
+  }
+
+  SECTION("A gas stays in the box and conserves energy") {
+    Simulator3d gas(40, 40, 3);
+    for (size_t i = 0; i < 300; i++) {
+      gas.AddRandomSmallParticle();
+      gas.AddRandomMediumParticle();
+      gas.AddRandomLargeParticle();
+    }
+    double initial_energy = gas.GetKineticEnergy();
+
+    for (size_t step = 0; step < 300; step++) {
+      gas.Update();
+    }
+
+    for (const Particle3d& particle : gas.GetParticles()) {
+      for (int axis = 0; axis < 3; axis++) {
+        REQUIRE(particle.GetPrecisePosition()[axis] >= -1);
+        REQUIRE(particle.GetPrecisePosition()[axis] <= 41);
+      }
+    }
+    REQUIRE(gas.GetKineticEnergy() == Approx(initial_energy).epsilon(1e-3));
+    REQUIRE(gas.GetSmallParticleSpeeds().size() == 300);
+    REQUIRE(gas.GetMediumParticleSpeeds().size() == 300);
+    REQUIRE(gas.GetLargeParticleSpeeds().size() == 300);
+  }
+}
+
+TEST_CASE("Double precision") {
+  SECTION("Velocities are stored in double precision") {
+    PreciseSimulator simulator(100, 100, 0);
+    glm::dvec2 velocity(0.1, 1.0 / 3);
+    simulator.AddParticle(
+        PreciseParticle(1, 1, glm::dvec2(50, 50), velocity));
+
+    simulator.Update();
+
+    REQUIRE(simulator.GetParticles()[0].GetVelocity() == velocity);
+    REQUIRE(simulator.GetParticles()[0].GetPrecisePosition() ==
+            glm::dvec2(50, 50) + velocity);
+  }
+
+  SECTION("Momentum is summed over every particle") {
+    Simulator simulator(100, 100, 0);
+    simulator.AddParticle(Particle(1, 1, glm::vec2(20, 20), glm::vec2(1, 0)));
+    simulator.AddParticle(
+        Particle(1, 4, glm::vec2(60, 60), glm::vec2(0.5, -0.25)));
+
+    REQUIRE(simulator.GetMomentum() == glm::dvec2(3, -1));
+    REQUIRE(simulator.GetKineticEnergy() == Approx(0.5 + 0.5 * 4 * 0.3125));
+  }
+
+  SECTION("A float and a double run start from the same gas") {
+    Simulator single(100, 100, 4);
+    PreciseSimulator precise(100, 100, 4);
+    for (size_t i = 0; i < 50; i++) {
+      single.AddRandomMediumParticle();
+      precise.AddRandomMediumParticle();
+    }
+
+    REQUIRE(single.GetKineticEnergy() == precise.GetKineticEnergy());
+  }
+
+  SECTION("Double precision drifts less than single precision") {
+    DriftReport single = MeasureDrift<Simulator>("float", 50, 300, 7);
+    DriftReport precise = MeasureDrift<PreciseSimulator>("double", 50, 300, 7);
+
+    REQUIRE(single.num_particles == 150);
+    REQUIRE(single.max_energy_drift > 0);
+    REQUIRE(precise.max_energy_drift < single.max_energy_drift);
+    REQUIRE(precise.max_momentum_drift < single.max_momentum_drift);
+    REQUIRE(precise.max_energy_drift < 1e-9);
+    REQUIRE(precise.max_momentum_drift < 1e-9);
+  }
+}
+
+TEST_CASE("Block time steps") {
+  Simulator simulator(100, 100, 0);
+
+  SECTION("Invalid levels are rejected") {
+    REQUIRE_THROWS_AS(simulator.SetBlockTimeSteps(-1, 0.5),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(
+        simulator.SetBlockTimeSteps(Simulator::kMaxTimeStepLevel + 1, 0.5),
+        std::invalid_argument);
+    REQUIRE_THROWS_AS(simulator.SetBlockTimeSteps(2, 0), std::invalid_argument);
+  }
+
+  SECTION("Slow particles are moved once per block") {
+    simulator.SetBlockTimeSteps(4, 0.5);
+    simulator.AddParticle(
+        Particle(1, 1, glm::dvec2(20, 50), glm::vec2(0.125, 0)));
+    simulator.AddParticle(Particle(1, 1, glm::dvec2(50, 20), glm::vec2(0, 1)));
+
+    for (size_t step = 0; step < 6; step++) {
+      simulator.Update();
+    }
+
+    /* 0.125 * 4 is the furthest the slow particle may move per update */
+    const Particle& slow = simulator.GetParticles()[0];
+    REQUIRE(slow.GetTimeStepLevel() == 2);
+    REQUIRE(slow.GetPrecisePosition() == glm::dvec2(20.5, 50));
+    REQUIRE(simulator.GetCurrentPosition(slow) == glm::dvec2(20.75, 50));
+    REQUIRE(simulator.GetParticles()[1].GetTimeStepLevel() == 0);
+    REQUIRE(simulator.GetNumParticleUpdates() == 1 + 6);
+  }
+
+  SECTION("Collisions across levels match updating every step") {
+    Simulator every_step(100, 100, 0);
+    simulator.SetBlockTimeSteps(4, 0.5);
+    for (Simulator* sim : {&simulator, &every_step}) {
+      sim->AddParticle(
+          Particle(1, 1, glm::dvec2(50, 50), glm::vec2(0.125, 0)));
+      sim->AddParticle(
+          Particle(1, 1, glm::dvec2(53.75, 50), glm::vec2(-0.5, 0)));
+    }
+
+    for (size_t step = 0; step < 8; step++) {
+      simulator.Update();
+      every_step.Update();
+    }
+
+    for (size_t i = 0; i < 2; i++) {
+      const Particle& block = simulator.GetParticles()[i];
+      const Particle& expected = every_step.GetParticles()[i];
+      REQUIRE(block.GetVelocity() == expected.GetVelocity());
+      glm::dvec2 position = simulator.GetCurrentPosition(block);
+      REQUIRE(position.x == Approx(expected.GetPrecisePosition().x));
+      REQUIRE(position.y == Approx(expected.GetPrecisePosition().y));
+    }
+
+    /* The slow particle was hit, and now moves faster than the other */
+    REQUIRE(simulator.GetParticles()[0].GetVelocity() == glm::vec2(-0.5, 0));
+  }
+
+  SECTION("A wide mixture of speeds is updated less often") {
+    /* A few fast particles among many slow ones, on a lattice */
+    simulator.SetBlockTimeSteps(4, 0.5);
+    for (size_t i = 0; i < 200; i++) {
+      glm::dvec2 position(5 + 10 * (i % 10), 2.5 + 5 * (i / 10));
+      glm::vec2 velocity = i % 10 == 0 ? glm::vec2(0.5, 0.25)
+                                       : glm::vec2(0.025, -0.0125 * (i % 3));
+      simulator.AddParticle(Particle(1, 1, position, velocity));
+    }
+    double initial_energy = simulator.GetKineticEnergy();
+
+    size_t num_steps = 400;
+    for (size_t step = 0; step < num_steps; step++) {
+      simulator.Update();
+    }
+
+    REQUIRE(simulator.GetNumParticleUpdates() < 200 * num_steps / 2);
+    REQUIRE(simulator.GetKineticEnergy() ==
+            Approx(initial_energy).epsilon(1e-4));
+    for (const Particle& particle : simulator.GetParticles()) {
+      glm::dvec2 position = simulator.GetCurrentPosition(particle);
+      REQUIRE(position.x >= -1);
+      REQUIRE(position.x <= 101);
+      REQUIRE(position.y >= -1);
+      REQUIRE(position.y <= 101);
+    }
+  }
+
+  SECTION("Turning block time steps off brings every particle up to date") {
+    simulator.SetBlockTimeSteps(3, 0.5);
+    simulator.AddParticle(
+        Particle(1, 1, glm::dvec2(20, 50), glm::vec2(0.0625, 0)));
+    for (size_t step = 0; step < 5; step++) {
+      simulator.Update();
+    }
+
+    simulator.SetBlockTimeSteps(0, 0);
+
+    const Particle& particle = simulator.GetParticles()[0];
+    REQUIRE(particle.GetTimeStepLevel() == 0);
+    REQUIRE(particle.GetPrecisePosition() == glm::dvec2(20.3125, 50));
+  }
+}
+
+TEST_CASE("Forks") {
+  Simulator simulator(100, 100, 7);
+  simulator.SetReorderInterval(5);
+  simulator.SetBlockTimeSteps(2, 0.5);
+  for (size_t i = 0; i < 100; i++) {
+    simulator.AddRandomSmallParticle();
+    simulator.AddRandomMediumParticle();
+    simulator.AddRandomLargeParticle();
+  }
+  for (size_t step = 0; step < 10; step++) {
+    simulator.Update();
+  }
+
+  SECTION("A fork continues exactly as the simulation does") {
+    Simulator fork = simulator.Fork();
+    REQUIRE(fork.GetNumSteps() == simulator.GetNumSteps());
+    for (size_t step = 0; step < 50; step++) {
+      simulator.Update();
+      fork.Update();
+    }
+
+    REQUIRE(fork.GetParticles() == simulator.GetParticles());
+    REQUIRE(fork.GetNumCollisions() == simulator.GetNumCollisions());
+  }
+
+  SECTION("Changing a fork does not change the simulation") {
+    std::vector<Particle> particles = simulator.GetParticles();
+    Simulator fork = simulator.Fork();
+    fork.RemoveParticle(fork.GetParticleHandle(0));
+    fork.AddRandomLargeParticle();
+    fork.Update();
+
+    REQUIRE(simulator.GetParticles() == particles);
+    REQUIRE_FALSE(fork.GetParticles() == particles);
+  }
+
+  SECTION("Forks share the simulation's particles until changed") {
+    std::vector<Simulator> forks;
+    for (size_t i = 0; i < 100; i++) {
+      forks.push_back(simulator.Fork());
+    }
+    size_t particles_usage = 300 * sizeof(Particle);
+    for (const Simulator& fork : forks) {
+      REQUIRE(fork.GetUnsharedMemoryUsage() < particles_usage / 10);
+    }
+
+    forks[0].Update();
+    REQUIRE(forks[0].GetUnsharedMemoryUsage() >= particles_usage);
+    REQUIRE(forks[1].GetUnsharedMemoryUsage() < particles_usage / 10);
+  }
+
+  SECTION("Forks can be updated concurrently") {
+    /* Each fork is changed differently, then all of them and the
+       simulation are updated on separate threads */
+    std::vector<Simulator> forks;
+    std::vector<Simulator> expected;
+    for (size_t i = 0; i < 8; i++) {
+      forks.push_back(simulator.Fork());
+      forks.back().AddParticle(Particle(1, 1, glm::vec2(10 * i + 5, 50),
+                                        glm::vec2(0.5, -0.5)));
+      expected.push_back(forks.back().Fork());
+    }
+    Simulator reference = simulator.Fork();
+
+    ThreadPool pool(4);
+    for (Simulator& fork : forks) {
+      Simulator* fork_ptr = &fork;
+      pool.Submit([fork_ptr] {
+        for (size_t step = 0; step < 50; step++) {
+          fork_ptr->Update();
+        }
+      });
+    }
+    Simulator* simulator_ptr = &simulator;
+    pool.Submit([simulator_ptr] {
+      for (size_t step = 0; step < 50; step++) {
+        simulator_ptr->Update();
+      }
+    });
+    pool.Wait();
+
+    for (size_t i = 0; i < forks.size(); i++) {
+      for (size_t step = 0; step < 50; step++) {
+        expected[i].Update();
+      }
+      REQUIRE(forks[i].GetParticles() == expected[i].GetParticles());
+    }
+    for (size_t step = 0; step < 50; step++) {
+      reference.Update();
+    }
+    REQUIRE(simulator.GetParticles() == reference.GetParticles());
+  }
+}
+
+TEST_CASE("Memory of forks") {
+  /* Enough particles to fill a few chunks */
+  Simulator simulator(1000, 1000, 3);
+  size_t num_particles = 4 * SharedChunkedVector<Particle>::kChunkSize + 10;
+  for (size_t i = 0; i < num_particles; i++) {
+    simulator.AddRandomSmallParticle();
+  }
+  ParticleHandle handle = simulator.GetParticleHandle(num_particles / 2);
+  size_t particles_usage = num_particles * sizeof(Particle);
+
+  std::vector<Simulator> forks;
+  for (size_t i = 0; i < 4; i++) {
+    forks.push_back(simulator.Fork());
+  }
+
+  SECTION("Reading forks and the simulation copies nothing") {
+    std::vector<double> speeds;
+    for (Simulator& fork : forks) {
+      REQUIRE(fork.GetKineticEnergy() == simulator.GetKineticEnergy());
+      REQUIRE(fork.GetParticle(handle) == simulator.GetParticle(handle));
+      fork.GetSmallParticleSpeeds(speeds);
+      REQUIRE(speeds.size() == num_particles);
+    }
+    for (const Simulator& fork : forks) {
+      REQUIRE(fork.GetUnsharedMemoryUsage() < particles_usage / 10);
+    }
+    REQUIRE(simulator.GetUnsharedMemoryUsage() < particles_usage / 10);
+  }
+
+  SECTION("Updating a fork copies its particles once") {
+    forks[0].Update();
+    forks[0].Update();
+    REQUIRE(forks[0].GetUnsharedMemoryUsage() >= particles_usage);
+    REQUIRE(forks[0].GetUnsharedMemoryUsage() < 2 * particles_usage);
+    REQUIRE(forks[1].GetUnsharedMemoryUsage() < particles_usage / 10);
+
+    /* The simulation still shares its particles with the other forks */
+    simulator.Update();
+    REQUIRE(simulator.GetUnsharedMemoryUsage() >= particles_usage);
+    REQUIRE(simulator.GetUnsharedMemoryUsage() < 2 * particles_usage);
+    REQUIRE(forks[1].GetUnsharedMemoryUsage() < particles_usage / 10);
+    REQUIRE(forks[1].GetParticles() == forks[2].GetParticles());
+  }
+}
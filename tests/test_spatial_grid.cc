@@ -0,0 +1,97 @@
+#include <core/spatial_grid.h>
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+
+using namespace idealgas;
+
+namespace {
+
+std::vector<size_t> FindSortedNeighbors(const SpatialGrid& grid,
+                                        const glm::dvec2& position) {
+  std::vector<size_t> neighbors;
+  grid.FindNeighbors(position, neighbors);
+  std::sort(neighbors.begin(), neighbors.end());
+  return neighbors;
+}
+
+}  // namespace
+
+TEST_CASE("SpatialGrid FindNeighbors() functionality") {
+  SpatialGrid grid;
+  std::vector<Particle> particles;
+  particles.push_back(Particle(1, 1, glm::vec2(5, 5), glm::vec2(0, 0)));
+  particles.push_back(Particle(1, 1, glm::vec2(15, 5), glm::vec2(0, 0)));
+  particles.push_back(Particle(1, 1, glm::vec2(50, 50), glm::vec2(0, 0)));
+  particles.push_back(Particle(1, 1, glm::vec2(95, 5), glm::vec2(0, 0)));
+  particles.push_back(Particle(1, 1, glm::vec2(5, 95), glm::vec2(0, 0)));
+
+  SECTION("Empty grid") {
+    grid.Build(std::vector<Particle>(), glm::dvec2(100, 100), 10, false);
+    REQUIRE(FindSortedNeighbors(grid, glm::dvec2(5, 5)).empty());
+  }
+
+  SECTION("Particles in the same and adjacent cells are found") {
+    grid.Build(particles, glm::dvec2(100, 100), 10, false);
+    REQUIRE(grid.GetNumCells() == 100);
+    REQUIRE(FindSortedNeighbors(grid, glm::dvec2(5, 5)) ==
+            std::vector<size_t>({0, 1}));
+    REQUIRE(FindSortedNeighbors(grid, glm::dvec2(45, 45)) ==
+            std::vector<size_t>({2}));
+  }
+
+  SECTION("Walls do not wrap around") {
+    grid.Build(particles, glm::dvec2(100, 100), 10, false);
+    REQUIRE(FindSortedNeighbors(grid, glm::dvec2(99, 99)).empty());
+  }
+
+  SECTION("Periodic planes wrap around at the edges") {
+    grid.Build(particles, glm::dvec2(100, 100), 10, true);
+    REQUIRE(FindSortedNeighbors(grid, glm::dvec2(1, 1)) ==
+            std::vector<size_t>({0, 1, 3, 4}));
+  }
+
+  SECTION("Particles past the walls are placed in the edge cells") {
+    particles.push_back(Particle(1, 1, glm::vec2(-0.5, 50), glm::vec2(0, 0)));
+    grid.Build(particles, glm::dvec2(100, 100), 10, false);
+    REQUIRE(FindSortedNeighbors(grid, glm::dvec2(1, 50)) ==
+            std::vector<size_t>({5}));
+  }
+
+  SECTION("Small periodic planes do not find a particle twice") {
+    grid.Build(particles, glm::dvec2(100, 100), 60, true);
+    REQUIRE(grid.GetNumCells() == 1);
+    REQUIRE(FindSortedNeighbors(grid, glm::dvec2(5, 5)).size() == 5);
+  }
+}
+
+TEST_CASE("SpatialGrid in 3D") {
+  BasicSpatialGrid<Particle3d> grid;
+  std::vector<Particle3d> particles;
+  glm::vec3 rest(0, 0, 0);
+  particles.push_back(Particle3d(1, 1, glm::vec3(5, 5, 5), rest));
+  particles.push_back(Particle3d(1, 1, glm::vec3(5, 5, 15), rest));
+  particles.push_back(Particle3d(1, 1, glm::vec3(5, 5, 25), rest));
+  particles.push_back(Particle3d(1, 1, glm::vec3(5, 5, 95), rest));
+  particles.push_back(Particle3d(1, 1, glm::vec3(15, 15, 15), rest));
+
+  SECTION("Cells are adjacent along every axis") {
+    grid.Build(particles, glm::dvec3(100, 100, 100), 10, false);
+    REQUIRE(grid.GetNumCells() == 1000);
+
+    std::vector<size_t> neighbors;
+    grid.FindNeighbors(glm::dvec3(5, 5, 5), neighbors);
+    std::sort(neighbors.begin(), neighbors.end());
+    REQUIRE(neighbors == std::vector<size_t>({0, 1, 4}));
+  }
+
+  SECTION("Periodic boxes wrap around along z") {
+    grid.Build(particles, glm::dvec3(100, 100, 100), 10, true);
+
+    std::vector<size_t> neighbors;
+    grid.FindNeighbors(glm::dvec3(5, 5, 5), neighbors);
+    std::sort(neighbors.begin(), neighbors.end());
+    REQUIRE(neighbors == std::vector<size_t>({0, 1, 3, 4}));
+  }
+}
+
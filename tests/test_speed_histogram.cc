@@ -0,0 +1,79 @@
+#include <visualizer/speed_histogram.h>
+
+#include <catch2/catch.hpp>
+
+using namespace idealgas;
+
+TEST_CASE("SpeedHistogramBuilder") {
+  /* The app's histograms: 20 intervals of width 0.05, the last unbounded */
+  SpeedHistogramBuilder builder(1, 20);
+  Simulator simulator(100, 100, 6);
+
+  SECTION("Intervals are summed from 0 to the maximum speed") {
+    const std::vector<double>& intervals = builder.GetIntervals();
+    REQUIRE(intervals.size() == 21);
+    REQUIRE(intervals.front() == 0);
+    REQUIRE(intervals[1] == Approx(0.05));
+    REQUIRE(intervals.back() == Approx(1));
+  }
+
+  SECTION("No particles") {
+    builder.Build(simulator);
+    REQUIRE(builder.GetSmallFrequencies() == std::vector<size_t>(20, 0));
+    REQUIRE(builder.GetMediumFrequencies() == std::vector<size_t>(20, 0));
+    REQUIRE(builder.GetLargeFrequencies() == std::vector<size_t>(20, 0));
+  }
+
+  SECTION("Speeds are counted in the interval starting at or below them") {
+    simulator.AddParticle(
+        Particle(1, 1, glm::vec2(10, 10), glm::vec2(0, 0)));
+    simulator.AddParticle(
+        Particle(1, 1, glm::vec2(20, 10), glm::vec2(0.07, 0)));
+    simulator.AddParticle(
+        Particle(1, 1, glm::vec2(30, 10), glm::vec2(0, 0.08)));
+
+    builder.Build(simulator);
+    const std::vector<size_t>& frequencies = builder.GetSmallFrequencies();
+
+    REQUIRE(frequencies.size() == 20);
+    REQUIRE(frequencies[0] == 1);
+    REQUIRE(frequencies[1] == 2);
+    REQUIRE(frequencies[2] == 0);
+  }
+
+  SECTION("The last interval counts every faster speed") {
+    simulator.AddParticle(
+        Particle(1, 1, glm::vec2(10, 10), glm::vec2(0.97, 0)));
+    simulator.AddParticle(
+        Particle(1, 1, glm::vec2(20, 10), glm::vec2(3, 4)));
+
+    builder.Build(simulator);
+
+    REQUIRE(builder.GetSmallFrequencies()[19] == 2);
+  }
+
+  SECTION("Each size of particle has its own histogram") {
+    simulator.AddParticle(
+        Particle(1, 1, glm::vec2(10, 10), glm::vec2(0.12, 0)));
+    simulator.AddParticle(
+        Particle(1.25, 2, glm::vec2(20, 10), glm::vec2(0.52, 0)));
+    simulator.AddParticle(
+        Particle(1.5, 4, glm::vec2(30, 10), glm::vec2(0.83, 0)));
+
+    builder.Build(simulator);
+
+    REQUIRE(builder.GetSmallFrequencies()[2] == 1);
+    REQUIRE(builder.GetMediumFrequencies()[10] == 1);
+    REQUIRE(builder.GetLargeFrequencies()[16] == 1);
+    REQUIRE(builder.GetMediumFrequencies()[2] == 0);
+  }
+
+  SECTION("Rebuilding replaces the frequencies") {
+    simulator.AddParticle(
+        Particle(1, 1, glm::vec2(10, 10), glm::vec2(0.07, 0)));
+    builder.Build(simulator);
+    builder.Build(simulator);
+
+    REQUIRE(builder.GetSmallFrequencies()[1] == 1);
+  }
+}
@@ -0,0 +1,138 @@
+#include <core/sweep.h>
+
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace idealgas;
+
+namespace {
+
+std::vector<std::string> ReadLines(const std::string& path) {
+  std::ifstream input(path);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(input, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+}  // namespace
+
+TEST_CASE("SweepConfig parsing") {
+  SECTION("Empty config is a single default job") {
+    std::istringstream input("");
+    std::vector<SweepJob> jobs = SweepConfig::Parse(input).ExpandJobs();
+    REQUIRE(jobs.size() == 1);
+    REQUIRE(jobs[0].plane_width == Approx(100));
+    REQUIRE(jobs[0].plane_height == Approx(100));
+  }
+
+  SECTION("Rectangular planes") {
+    std::istringstream input(
+        "plane_width = 100, 200\n"
+        "plane_height = 50\n");
+    std::vector<SweepJob> jobs = SweepConfig::Parse(input).ExpandJobs();
+    REQUIRE(jobs.size() == 2);
+    REQUIRE(jobs[1].plane_width == Approx(200));
+    REQUIRE(jobs[1].plane_height == Approx(50));
+  }
+
+  SECTION("Lists, ranges, and comments") {
+    std::istringstream input(
+        "# A comment\n"
+        "plane_width = 100, 200   # trailing comment\n"
+        "\n"
+        "num_small = 0:10:5\n"
+        "seed = 1:3\n"
+        "steps = 50\n");
+    std::vector<SweepJob> jobs = SweepConfig::Parse(input).ExpandJobs();
+
+    /* 2 widths * 3 small counts * 3 seeds */
+    REQUIRE(jobs.size() == 18);
+    REQUIRE(jobs[0].plane_width == Approx(100));
+    REQUIRE(jobs[0].num_small == 0);
+    REQUIRE(jobs[0].seed == 1);
+    REQUIRE(jobs[17].plane_width == Approx(200));
+    REQUIRE(jobs[17].plane_height == Approx(200));
+    REQUIRE(jobs[17].num_small == 10);
+    REQUIRE(jobs[17].seed == 3);
+    REQUIRE(jobs[17].num_steps == 50);
+  }
+
+  SECTION("Malformed configs are rejected") {
+    std::istringstream unknown("temperature = 5\n");
+    REQUIRE_THROWS_AS(SweepConfig::Parse(unknown), std::invalid_argument);
+
+    std::istringstream not_a_number("num_small = ten\n");
+    REQUIRE_THROWS_AS(SweepConfig::Parse(not_a_number), std::invalid_argument);
+
+    std::istringstream not_an_integer("num_small = 1.5\n");
+    REQUIRE_THROWS_AS(SweepConfig::Parse(not_an_integer),
+                      std::invalid_argument);
+
+    std::istringstream empty_range("seed = 5:1\n");
+    REQUIRE_THROWS_AS(SweepConfig::Parse(empty_range), std::invalid_argument);
+
+    std::istringstream no_value("seed\n");
+    REQUIRE_THROWS_AS(SweepConfig::Parse(no_value), std::invalid_argument);
+  }
+}
+
+TEST_CASE("SweepDriver Run() functionality") {
+  std::string path = "test_sweep_output.csv";
+  std::remove(path.c_str());
+
+  std::istringstream input(
+      "num_small = 5, 10\n"
+      "num_large = 2\n"
+      "seed = 1:2\n"
+      "steps = 5\n"
+      "speed_bins = 4\n");
+  SweepConfig config = SweepConfig::Parse(input);
+  SweepDriver driver(config, path);
+  ThreadPool pool(2);
+
+  SECTION("Every job writes a row") {
+    REQUIRE(driver.Run(pool) == 4);
+
+    std::vector<std::string> lines = ReadLines(path);
+    REQUIRE(lines.size() == 5);
+    REQUIRE(lines[0].find("plane_width,plane_height,num_small") == 0);
+    REQUIRE(driver.LoadCompletedJobs().size() == 4);
+  }
+
+  SECTION("Completed jobs are skipped on restart") {
+    driver.Run(pool);
+    REQUIRE(driver.Run(pool) == 0);
+    REQUIRE(ReadLines(path).size() == 5);
+  }
+
+  SECTION("Incomplete rows are rerun") {
+    driver.Run(pool);
+    std::vector<std::string> lines = ReadLines(path);
+
+    /* Simulate a run killed while writing its last row */
+    std::ofstream truncated(path, std::ios::trunc);
+    for (size_t i = 0; i < 3; i++) {
+      truncated << lines[i] << '\n';
+    }
+    truncated << lines[3].substr(0, 10);
+    truncated.close();
+
+    REQUIRE(driver.Run(pool) == 2);
+    REQUIRE(ReadLines(path).size() == 5);
+  }
+
+  SECTION("Output of a different sweep is rejected") {
+    driver.Run(pool);
+
+    std::istringstream other_input("speed_bins = 10\n");
+    SweepDriver other(SweepConfig::Parse(other_input), path);
+    REQUIRE_THROWS_AS(other.Run(pool), std::runtime_error);
+  }
+
+  std::remove(path.c_str());
+}
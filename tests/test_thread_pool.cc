@@ -0,0 +1,72 @@
+#include <core/thread_pool.h>
+
+#include <catch2/catch.hpp>
+#include <stdexcept>
+
+using namespace idealgas;
+
+TEST_CASE("ThreadPool runs submitted tasks") {
+  ThreadPool pool(4);
+
+  SECTION("Waiting with no tasks returns immediately") {
+    pool.Wait();
+    REQUIRE(pool.GetNumThreads() == 4);
+  }
+
+  SECTION("Every task is run exactly once") {
+    std::vector<std::atomic<int>> runs(1000);
+    for (std::atomic<int>& run : runs) {
+      run = 0;
+    }
+    for (size_t i = 0; i < runs.size(); i++) {
+      std::atomic<int>* run = &runs[i];
+      pool.Submit([run] { (*run)++; });
+    }
+    pool.Wait();
+
+    for (const std::atomic<int>& run : runs) {
+      REQUIRE(run == 1);
+    }
+  }
+
+  SECTION("Tasks can submit more tasks") {
+    std::atomic<int> count(0);
+    ThreadPool* pool_ptr = &pool;
+    for (size_t i = 0; i < 10; i++) {
+      pool.Submit([pool_ptr, &count] {
+        for (size_t j = 0; j < 10; j++) {
+          pool_ptr->Submit([&count] { count++; });
+        }
+      });
+    }
+    pool.Wait();
+
+    REQUIRE(count == 100);
+  }
+
+  SECTION("Tasks know which worker runs them") {
+    std::atomic<bool> all_workers(true);
+    for (size_t i = 0; i < 100; i++) {
+      pool.Submit([&all_workers] {
+        if (ThreadPool::GetWorkerIndex() >= 4) {
+          all_workers = false;
+        }
+      });
+    }
+    pool.Wait();
+
+    REQUIRE(all_workers);
+    REQUIRE(ThreadPool::GetWorkerIndex() == ThreadPool::kNotAWorker);
+  }
+
+  SECTION("Exceptions thrown by tasks are rethrown by Wait()") {
+    pool.Submit([] { throw std::runtime_error("task failed"); });
+    REQUIRE_THROWS_AS(pool.Wait(), std::runtime_error);
+
+    /* The pool is still usable afterwards */
+    std::atomic<int> count(0);
+    pool.Submit([&count] { count++; });
+    pool.Wait();
+    REQUIRE(count == 1);
+  }
+}
@@ -0,0 +1,182 @@
+#include <core/simulator.h>
+#include <core/tiled_simulator.h>
+
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+
+/* Tiled simulations are only supported where files can be mapped */
+#ifndef _WIN32
+#include <unistd.h>
+
+using namespace idealgas;
+
+namespace {
+
+/**
+ * A new directory under the system's temporary directory for the tile files
+ * of one simulation, removed once it goes out of scope. It must outlive the
+ * simulation, which removes its files when it is destroyed.
+ */
+class TemporaryDirectory {
+ public:
+  TemporaryDirectory() {
+    const char* root = std::getenv("TMPDIR");
+    std::string pattern =
+        std::string(root != nullptr ? root : "/tmp") + "/idealgas-XXXXXX";
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    if (mkdtemp(path.data()) == nullptr) {
+      throw std::runtime_error("could not create a temporary directory");
+    }
+    path_ = path.data();
+  }
+
+  ~TemporaryDirectory() {
+    rmdir(path_.c_str());
+  }
+
+  const std::string& GetPath() const {
+    return path_;
+  }
+
+ private:
+  std::string path_;
+};
+
+TiledParticle MakeParticle(double x, double y, float vx, float vy,
+                           uint32_t species = 0) {
+  return {x, y, vx, vy, species, 0};
+}
+
+std::vector<TiledParticle> GetParticles(TiledSimulator& simulator) {
+  std::vector<TiledParticle> particles;
+  simulator.ForEachParticle([&particles](const TiledParticle& particle) {
+    particles.push_back(particle);
+  });
+  return particles;
+}
+
+/**
+ * Runs a pair of small particles in a tiled simulation and in a Simulator,
+ * and checks that they end up in the same place
+ */
+void RequirePairMatchesSimulator(const TiledParticle& p1,
+                                 const TiledParticle& p2) {
+  TemporaryDirectory directory;
+  TiledSimulator tiled(directory.GetPath(), 40, 40, 4, 4);
+  tiled.AddParticle(p1);
+  tiled.AddParticle(p2);
+  Simulator simulator(40, 40, 1);
+  for (const TiledParticle& p : {p1, p2}) {
+    simulator.AddParticle(Particle(1, 1, glm::dvec2(p.x, p.y),
+                                   glm::vec2(p.vx, p.vy)));
+  }
+
+  for (size_t step = 0; step < 20; step++) {
+    tiled.Update();
+    simulator.Update();
+  }
+
+  std::vector<TiledParticle> tiled_particles = GetParticles(tiled);
+  REQUIRE(tiled_particles.size() == 2);
+  for (const TiledParticle& p : tiled_particles) {
+    bool is_matched = false;
+    for (const Particle& particle : simulator.GetParticles()) {
+      is_matched |= particle.GetPrecisePosition() == glm::dvec2(p.x, p.y) &&
+                    particle.GetVelocity() == glm::vec2(p.vx, p.vy);
+    }
+    REQUIRE(is_matched);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Tiled simulations") {
+  TemporaryDirectory directory;
+  SECTION("Tiles must hold every interaction of their particles") {
+    REQUIRE_THROWS_AS(TiledSimulator(directory.GetPath(), 10, 10, 4, 1),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(TiledSimulator(directory.GetPath(), 10, 10, 0, 1),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(TiledSimulator(directory.GetPath(), 100, 100, 4, 4, 4),
+                      std::invalid_argument);
+  }
+
+  SECTION("Particles must be on the plane") {
+    TiledSimulator simulator(directory.GetPath(), 40, 40, 4, 4);
+    REQUIRE_THROWS_AS(simulator.AddParticle(MakeParticle(-1, 5, 0, 0)),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(simulator.AddParticle(MakeParticle(5, 5, 0, 0, 3)),
+                      std::invalid_argument);
+  }
+
+  SECTION("Particles move between tiles") {
+    TiledSimulator simulator(directory.GetPath(), 40, 40, 4, 4);
+    simulator.AddParticle(MakeParticle(5, 5, 0.5, 0.25));
+    for (size_t step = 0; step < 40; step++) {
+      simulator.Update();
+    }
+
+    std::vector<TiledParticle> particles = GetParticles(simulator);
+    REQUIRE(particles.size() == 1);
+    REQUIRE(particles[0].x == 25);
+    REQUIRE(particles[0].y == 15);
+    REQUIRE(simulator.GetNumSteps() == 40);
+  }
+
+  SECTION("Collisions across the side of a tile match Simulator") {
+    RequirePairMatchesSimulator(MakeParticle(7.5, 20, 0.5, 0.125),
+                                MakeParticle(12.5, 20.25, -0.5, 0));
+  }
+
+  SECTION("Collisions across the corner of a tile match Simulator") {
+    RequirePairMatchesSimulator(MakeParticle(8, 8, 0.25, 0.25),
+                                MakeParticle(12, 12.5, -0.25, -0.25));
+    RequirePairMatchesSimulator(MakeParticle(12, 8, -0.25, 0.25),
+                                MakeParticle(8.5, 12, 0.25, -0.25));
+  }
+
+  SECTION("A gas keeps its particles and energy") {
+    TiledSimulator simulator(directory.GetPath(), 60, 60, 6, 6, 6);
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> position(2, 58);
+    std::uniform_real_distribution<float> velocity(-0.5, 0.5);
+    for (uint32_t i = 0; i < 600; i++) {
+      simulator.AddParticle(MakeParticle(position(generator),
+                                         position(generator),
+                                         velocity(generator),
+                                         velocity(generator), i % 3));
+    }
+    double initial_energy = simulator.GetKineticEnergy();
+
+    for (size_t step = 0; step < 100; step++) {
+      simulator.Update();
+    }
+
+    std::vector<TiledParticle> particles = GetParticles(simulator);
+    REQUIRE(particles.size() == 600);
+    REQUIRE(simulator.GetNumParticles() == 600);
+    REQUIRE(simulator.GetKineticEnergy() ==
+            Approx(initial_energy).epsilon(1e-4));
+    for (const TiledParticle& particle : particles) {
+      REQUIRE(particle.x >= -1);
+      REQUIRE(particle.x <= 61);
+      REQUIRE(particle.y >= -1);
+      REQUIRE(particle.y <= 61);
+    }
+    REQUIRE(simulator.GetPeakResidentTiles() <= 6);
+  }
+
+  SECTION("Particles are added in batches") {
+    TiledSimulator simulator(directory.GetPath(), 40, 40, 4, 4);
+    for (size_t i = 0; i < 5000; i++) {
+      simulator.AddParticle(MakeParticle(5, 5 + i * 1e-3, 0, 0));
+    }
+    REQUIRE(simulator.GetNumParticles() == 5000);
+    REQUIRE(GetParticles(simulator).size() == 5000);
+  }
+}
+
+#endif